@@ -2,6 +2,8 @@
 
 #include "base/thread.hpp"
 
+#include "std/algorithm.hpp"
+#include "std/atomic.hpp"
 #include "std/vector.hpp"
 
 
@@ -118,3 +120,29 @@ UNIT_TEST(SimpleThreadTest4)
 
   TEST_EQUAL(a, 1, ("test a"));
 }
+
+UNIT_TEST(RunInThreads)
+{
+  for (size_t threadsCount : {0, 1, 4, 100})
+  {
+    size_t const kTasksCount = 1000;
+    vector<size_t> done(kTasksCount, 0);
+    atomic<size_t> workersCount(0);
+    threads::RunInThreads(kTasksCount, threadsCount, [&]()
+    {
+      ++workersCount;
+      return [&](size_t i) { ++done[i]; };
+    });
+    TEST_EQUAL(done, vector<size_t>(kTasksCount, 1), (threadsCount));
+    TEST_EQUAL(workersCount.load(), max(threadsCount, static_cast<size_t>(1)), ());
+  }
+
+  // Threads aren't started for absent tasks.
+  atomic<size_t> workersCount(0);
+  threads::RunInThreads(2, 10, [&]()
+  {
+    ++workersCount;
+    return [](size_t) {};
+  });
+  TEST_EQUAL(workersCount.load(), 2, ());
+}
@@ -4,6 +4,8 @@
 #include "base/cancellable.hpp"
 #include "base/macros.hpp"
 
+#include "std/algorithm.hpp"
+#include "std/atomic.hpp"
 #include "std/bind.hpp"
 #include "std/cstdint.hpp"
 #include "std/function.hpp"
@@ -137,4 +139,28 @@ private:
 
   thread m_thread;
 };
+
+/// Runs tasks [0, tasksCount) in threadsCount threads including the calling one. Every thread
+/// calls makeWorker() once for its own state, and the worker takes indexes of tasks
+/// from a shared counter, so long tasks don't hold the rest.
+/// @param makeWorker  Returns a callable object with the task index as the argument.
+template <class TMakeWorker>
+void RunInThreads(size_t tasksCount, size_t threadsCount, TMakeWorker const & makeWorker)
+{
+  atomic<size_t> nextTask(0);
+  auto const run = [&]()
+  {
+    auto worker = makeWorker();
+    for (size_t i = nextTask++; i < tasksCount; i = nextTask++)
+      worker(i);
+  };
+
+  threadsCount = max(min(threadsCount, tasksCount), static_cast<size_t>(1));
+  vector<SimpleThread> threads;
+  for (size_t i = 1; i < threadsCount; ++i)
+    threads.emplace_back(run);
+  run();
+  for (auto & t : threads)
+    t.join();
+}
 }  // namespace threads
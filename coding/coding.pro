@@ -57,6 +57,7 @@ HEADERS += \
     diff.hpp \
     diff_patch_common.hpp \
     endianness.hpp \
+    external_sort.hpp \
     file_container.hpp \
     file_name_utils.hpp \
     file_reader.hpp \
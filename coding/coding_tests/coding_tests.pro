@@ -22,6 +22,7 @@ SOURCES += ../../testing/testingmain.cpp \
     dd_vector_test.cpp \
     diff_test.cpp \
     endianness_test.cpp \
+    external_sort_test.cpp \
     file_container_test.cpp \
     file_data_test.cpp \
     file_sort_test.cpp \
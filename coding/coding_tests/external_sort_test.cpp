@@ -0,0 +1,133 @@
+#include "testing/benchmark.hpp"
+#include "testing/testing.hpp"
+
+#include "coding/external_sort.hpp"
+
+#include "base/timer.hpp"
+
+#include "std/random.hpp"
+
+namespace
+{
+using TItem = pair<uint64_t, uint32_t>;
+
+struct ItemKey
+{
+  uint64_t operator()(TItem const & item) const { return item.first; }
+};
+
+struct LessByKey
+{
+  bool operator()(TItem const & i1, TItem const & i2) const { return i1.first < i2.first; }
+};
+
+struct ItemsCollector
+{
+  vector<TItem> m_items;
+  void operator()(TItem const & item) { m_items.push_back(item); }
+};
+
+vector<TItem> MakeItems(size_t count, uint64_t maxKey)
+{
+  mt19937 rnd(0);
+  uniform_int_distribution<uint64_t> key(0, maxKey);
+  vector<TItem> items(count);
+  for (size_t i = 0; i < count; ++i)
+    items[i] = make_pair(key(rnd), static_cast<uint32_t>(rnd()));
+  return items;
+}
+
+template <class TKey>
+vector<TItem> SortItems(vector<TItem> const & items, size_t memoryBytes, size_t threadsCount)
+{
+  ItemsCollector out;
+  ExternalSorter<TItem, ItemsCollector, less<TItem>, TKey> sorter(
+      memoryBytes, "external_sort_test.tmp", out, threadsCount);
+  for (TItem const & item : items)
+    sorter.Add(item);
+  sorter.SortAndFinish();
+  return out.m_items;
+}
+
+void TestSort(vector<TItem> const & items, size_t memoryBytes)
+{
+  vector<TItem> expected = items;
+  sort(expected.begin(), expected.end());
+
+  for (size_t threadsCount : {0, 1, 3})
+  {
+    TEST(SortItems<NoRadixKey>(items, memoryBytes, threadsCount) == expected,
+         (memoryBytes, threadsCount));
+    TEST(SortItems<ItemKey>(items, memoryBytes, threadsCount) == expected,
+         (memoryBytes, threadsCount));
+  }
+}
+}  // namespace
+
+UNIT_TEST(ExternalSorter_InMemory)
+{
+  TestSort(MakeItems(1000, numeric_limits<uint64_t>::max()), 1024 * 1024);
+  TestSort({}, 1024 * 1024);
+}
+
+UNIT_TEST(ExternalSorter_Runs)
+{
+  // Many runs, equal keys and keys with equal bytes.
+  TestSort(MakeItems(20000, numeric_limits<uint64_t>::max()), 1000);
+  TestSort(MakeItems(20000, 100), 10000);
+  TestSort(MakeItems(20001, 1 << 20), 100000);
+}
+
+UNIT_TEST(ExternalSorter_EqualItemsInOrderOfBuffers)
+{
+  // Keys are distinct in any 100 successive items, so there are no equal keys in a buffer,
+  // and the second value is the number of the repeat of a key.
+  vector<TItem> items;
+  for (uint32_t i = 0; i < 20000; ++i)
+    items.emplace_back(i % 100, i / 100);
+  vector<TItem> expected = items;
+  sort(expected.begin(), expected.end());
+
+  for (size_t threadsCount : {0, 1, 3})
+  {
+    ItemsCollector out;
+    ExternalSorter<TItem, ItemsCollector, LessByKey, ItemKey> sorter(
+        1000, "external_sort_test.tmp", out, threadsCount);
+    for (TItem const & item : items)
+      sorter.Add(item);
+    sorter.SortAndFinish();
+    TEST(out.m_items == expected, (threadsCount));
+  }
+}
+
+UNIT_TEST(ExternalSorter_Destructor)
+{
+  vector<TItem> items = MakeItems(5000, 1000);
+  ItemsCollector out;
+  {
+    ExternalSorter<TItem, ItemsCollector> sorter(1000, "external_sort_test.tmp", out);
+    for (TItem const & item : items)
+      sorter.Add(item);
+  }
+  sort(items.begin(), items.end());
+  TEST(out.m_items == items, ());
+}
+
+BENCHMARK_TEST(ExternalSorter)
+{
+  // Items take 16MB, so they are sorted in several runs.
+  vector<TItem> const items = MakeItems(1000000, numeric_limits<uint64_t>::max() >> 20);
+  size_t const kMemory = 4 * 1024 * 1024;
+
+  for (size_t threadsCount : {0, 1, 4})
+  {
+    my::Timer timer;
+    TEST_EQUAL(SortItems<NoRadixKey>(items, kMemory, threadsCount).size(), items.size(), ());
+    double const comparisonTime = timer.ElapsedSeconds();
+
+    timer.Reset();
+    TEST_EQUAL(SortItems<ItemKey>(items, kMemory, threadsCount).size(), items.size(), ());
+    LOG(LINFO, ("Threads:", threadsCount, "comparison sort:", comparisonTime,
+                "radix sort:", timer.ElapsedSeconds()));
+  }
+}
@@ -0,0 +1,394 @@
+#pragma once
+#include "coding/file_reader.hpp"
+#include "coding/file_writer.hpp"
+
+#include "base/assert.hpp"
+#include "base/exception.hpp"
+#include "base/logging.hpp"
+#include "base/thread.hpp"
+
+#include "std/algorithm.hpp"
+#include "std/condition_variable.hpp"
+#include "std/deque.hpp"
+#include "std/functional.hpp"
+#include "std/mutex.hpp"
+#include "std/queue.hpp"
+#include "std/string.hpp"
+#include "std/type_traits.hpp"
+#include "std/unique_ptr.hpp"
+#include "std/utility.hpp"
+#include "std/vector.hpp"
+
+/// Key functor of ExternalSorter for items without radix keys.
+struct NoRadixKey
+{
+};
+
+/// Sorts items which don't fit the memory.
+/// Added items are collected to buffers, and full buffers are sorted and written as sorted runs
+/// to the temporary file by threadsCount threads, while the next buffer is filled by the calling
+/// thread (0 threads means sorting in the calling thread). SortAndFinish() merges runs
+/// to the output sink. Items which fit one buffer are sorted without the temporary file.
+/// Equal items of different buffers are output in the order of adding of buffers.
+///
+/// All buffers, including scratch buffers of radix sort, fit memoryBytes.
+///
+/// If KeyT isn't NoRadixKey, KeyT()(item) returns uint64_t key which is consistent
+/// with LessT: items with less keys are less. Runs are sorted by the radix sort of keys,
+/// and items with equal keys are sorted by LessT then.
+template <
+    typename T,                           // Item type.
+    class OutputSinkT = FileWriter,       // Sink to output into result file.
+    typename LessT = less<T>,             // Item comparator.
+    class KeyT = NoRadixKey               // Radix key of an item.
+>
+class ExternalSorter
+{
+public:
+  ExternalSorter(size_t memoryBytes, string const & tmpFileName, OutputSinkT & outputSink,
+                 size_t threadsCount = 1, LessT fLess = LessT())
+    : m_tmpFileName(tmpFileName)
+    , m_bufferCapacity(max(size_t(16), memoryBytes / sizeof(T) / GetBuffersCount(threadsCount)))
+    , m_outputSink(outputSink)
+    , m_less(fLess)
+  {
+    m_buffer.reserve(m_bufferCapacity);
+    for (size_t i = 0; i < threadsCount; ++i)
+      m_threads.emplace_back([this]() { SortBuffers(); });
+  }
+
+  ~ExternalSorter()
+  {
+    if (m_finished)
+      return;
+
+    try
+    {
+      SortAndFinish();
+    }
+    catch (RootException const & e)
+    {
+      LOG(LERROR, (e.Msg()));
+    }
+    catch (std::exception const & e)
+    {
+      LOG(LERROR, (e.what()));
+    }
+  }
+
+  void Add(T const & item)
+  {
+    if (m_buffer.size() == m_bufferCapacity)
+      FlushBuffer();
+    m_buffer.push_back(item);
+  }
+
+  void SortAndFinish()
+  {
+    ASSERT(!m_finished, ());
+    m_finished = true;
+
+    if (!m_flushed)
+    {
+      // All items are in memory.
+      StopThreads();
+      SortItems(m_buffer, m_scratch);
+      for (T const & item : m_buffer)
+        m_outputSink(item);
+      FreeBuffers();
+      return;
+    }
+
+    FlushBuffer();
+    StopThreads();
+    FreeBuffers();
+    if (m_exception)
+      MYTHROW(Writer::WriteException, (m_exception->Msg()));
+
+    m_tmpWriter.reset();
+    MergeRuns();
+    FileWriter::DeleteFileX(m_tmpFileName);
+  }
+
+private:
+  struct Run
+  {
+    uint64_t m_beg;
+    uint64_t m_end;
+    // Number of the buffer of the run, threads write runs in any order.
+    size_t m_index;
+  };
+
+  /// The buffer filled by the calling thread and a buffer per sorting thread, and a scratch buffer
+  /// per sorting thread (the calling one when there are no threads) for radix sort.
+  static size_t GetBuffersCount(size_t threadsCount)
+  {
+    size_t const scratchCount = is_same<KeyT, NoRadixKey>::value ? 0 : max(threadsCount, size_t(1));
+    return threadsCount + 1 + scratchCount;
+  }
+
+  /// Reads a sorted run by chunks.
+  class RunReader
+  {
+    FileReader const & m_reader;
+    uint64_t m_pos;
+    uint64_t m_end;
+    vector<T> m_chunk;
+    size_t m_chunkPos = 0;
+    size_t m_chunkSize;
+
+  public:
+    RunReader(FileReader const & reader, Run const & run, size_t chunkSize)
+      : m_reader(reader), m_pos(run.m_beg), m_end(run.m_end), m_chunkSize(chunkSize)
+    {
+    }
+
+    bool Next(T & item)
+    {
+      if (m_chunkPos == m_chunk.size())
+      {
+        if (m_pos == m_end)
+          return false;
+        m_chunk.resize(static_cast<size_t>(min(static_cast<uint64_t>(m_chunkSize), m_end - m_pos)));
+        m_reader.Read(m_pos * sizeof(T), m_chunk.data(), m_chunk.size() * sizeof(T));
+        m_pos += m_chunk.size();
+        m_chunkPos = 0;
+      }
+      item = m_chunk[m_chunkPos++];
+      return true;
+    }
+  };
+
+  template <class K = KeyT>
+  typename enable_if<is_same<K, NoRadixKey>::value, void>::type
+  SortItems(vector<T> & items, vector<T> & /* scratch */) const
+  {
+    sort(items.begin(), items.end(), m_less);
+  }
+
+  /// LSD radix sort by bytes of keys, bytes which are the same for all items are skipped.
+  template <class K = KeyT>
+  typename enable_if<!is_same<K, NoRadixKey>::value, void>::type
+  SortItems(vector<T> & items, vector<T> & scratch) const
+  {
+    KeyT const key;
+    size_t counts[8][256] = {};
+    for (T const & item : items)
+    {
+      uint64_t const k = key(item);
+      for (size_t b = 0; b < 8; ++b)
+        ++counts[b][(k >> (8 * b)) & 0xFF];
+    }
+
+    scratch.resize(items.size());
+    for (size_t b = 0; b < 8; ++b)
+    {
+      if (find(counts[b], counts[b] + 256, items.size()) != counts[b] + 256)
+        continue;
+
+      size_t offsets[256];
+      size_t sum = 0;
+      for (size_t i = 0; i < 256; ++i)
+      {
+        offsets[i] = sum;
+        sum += counts[b][i];
+      }
+      for (T const & item : items)
+        scratch[offsets[(key(item) >> (8 * b)) & 0xFF]++] = item;
+      items.swap(scratch);
+    }
+
+    for (auto it = items.begin(); it != items.end();)
+    {
+      uint64_t const k = key(*it);
+      auto end = it + 1;
+      while (end != items.end() && key(*end) == k)
+        ++end;
+      if (end - it > 1)
+        sort(it, end, m_less);
+      it = end;
+    }
+  }
+
+  void WriteRun(vector<T> const & items, size_t index)
+  {
+    lock_guard<mutex> lock(m_fileMutex);
+    if (m_exception)
+      return;
+
+    try
+    {
+      if (!m_tmpWriter)
+        m_tmpWriter.reset(new FileWriter(m_tmpFileName));
+      uint64_t const beg = m_tmpWriter->Pos() / sizeof(T);
+      m_tmpWriter->Write(items.data(), items.size() * sizeof(T));
+      m_runs.push_back({beg, beg + items.size(), index});
+    }
+    catch (RootException const & e)
+    {
+      m_exception.reset(new RootException(e));
+    }
+  }
+
+  void FlushBuffer()
+  {
+    if (m_buffer.empty())
+      return;
+
+    m_flushed = true;
+    size_t const index = m_buffersCount++;
+    if (m_threads.empty())
+    {
+      SortItems(m_buffer, m_scratch);
+      WriteRun(m_buffer, index);
+      m_buffer.clear();
+      return;
+    }
+
+    unique_lock<mutex> lock(m_mutex);
+    // Waits for a spare buffer: at most threads count buffers are sorted at the same time.
+    m_bufferSorted.wait(lock, [this]()
+    {
+      return m_fullBuffers.size() + m_sortedCount < m_threads.size() || !m_spareBuffers.empty();
+    });
+    m_fullBuffers.emplace_back(index, move(m_buffer));
+    if (!m_spareBuffers.empty())
+    {
+      m_buffer = move(m_spareBuffers.back());
+      m_spareBuffers.pop_back();
+    }
+    else
+    {
+      m_buffer = vector<T>();
+    }
+    m_buffer.clear();
+    m_buffer.reserve(m_bufferCapacity);
+    lock.unlock();
+    m_bufferAdded.notify_one();
+  }
+
+  void SortBuffers()
+  {
+    vector<T> scratch;
+    while (true)
+    {
+      size_t index;
+      vector<T> buffer;
+      {
+        unique_lock<mutex> lock(m_mutex);
+        m_bufferAdded.wait(lock, [this]() { return !m_fullBuffers.empty() || m_stopped; });
+        if (m_fullBuffers.empty())
+          return;
+        index = m_fullBuffers.front().first;
+        buffer = move(m_fullBuffers.front().second);
+        m_fullBuffers.pop_front();
+        ++m_sortedCount;
+      }
+
+      SortItems(buffer, scratch);
+      WriteRun(buffer, index);
+
+      {
+        lock_guard<mutex> lock(m_mutex);
+        --m_sortedCount;
+        m_spareBuffers.push_back(move(buffer));
+      }
+      m_bufferSorted.notify_one();
+    }
+  }
+
+  void StopThreads()
+  {
+    {
+      lock_guard<mutex> lock(m_mutex);
+      m_stopped = true;
+    }
+    m_bufferAdded.notify_all();
+    for (auto & thread : m_threads)
+      thread.join();
+    m_threads.clear();
+  }
+
+  void FreeBuffers()
+  {
+    m_spareBuffers.clear();
+    m_buffer.clear();
+    m_buffer.shrink_to_fit();
+    m_scratch.clear();
+    m_scratch.shrink_to_fit();
+  }
+
+  void MergeRuns()
+  {
+    if (m_runs.empty())
+      return;
+
+    sort(m_runs.begin(), m_runs.end(), [](Run const & r1, Run const & r2)
+    {
+      return r1.m_index < r2.m_index;
+    });
+
+    // Memory of buffers is used for chunks of runs.
+    size_t const chunkSize = max(size_t(16), m_bufferCapacity / m_runs.size());
+    FileReader const reader(m_tmpFileName);
+    vector<RunReader> readers;
+    for (Run const & run : m_runs)
+      readers.emplace_back(reader, run, chunkSize);
+
+    // Min-heap of the current items of runs, equal items are taken in the order of buffers.
+    using TItem = pair<T, size_t>;
+    auto const greater = [this](TItem const & r1, TItem const & r2)
+    {
+      if (m_less(r2.first, r1.first))
+        return true;
+      if (m_less(r1.first, r2.first))
+        return false;
+      return r1.second > r2.second;
+    };
+    priority_queue<TItem, vector<TItem>, decltype(greater)> heap(greater);
+    T item;
+    for (size_t i = 0; i < readers.size(); ++i)
+    {
+      if (readers[i].Next(item))
+        heap.emplace(item, i);
+    }
+
+    while (!heap.empty())
+    {
+      TItem const top = heap.top();
+      heap.pop();
+      m_outputSink(top.first);
+      if (readers[top.second].Next(item))
+        heap.emplace(item, top.second);
+    }
+  }
+
+  string const m_tmpFileName;
+  size_t const m_bufferCapacity;
+  OutputSinkT & m_outputSink;
+  LessT m_less;
+
+  // The buffer filled by the calling thread.
+  vector<T> m_buffer;
+  vector<T> m_scratch;
+  size_t m_buffersCount = 0;
+  bool m_flushed = false;
+  bool m_finished = false;
+
+  // Buffers of sorting threads.
+  vector<threads::SimpleThread> m_threads;
+  mutex m_mutex;
+  condition_variable m_bufferAdded;
+  condition_variable m_bufferSorted;
+  // Full buffers with their numbers.
+  deque<pair<size_t, vector<T>>> m_fullBuffers;
+  vector<vector<T>> m_spareBuffers;
+  size_t m_sortedCount = 0;
+  bool m_stopped = false;
+
+  // The temporary file with runs.
+  mutex m_fileMutex;
+  unique_ptr<FileWriter> m_tmpWriter;
+  vector<Run> m_runs;
+  unique_ptr<RootException> m_exception;
+};
@@ -44,6 +44,7 @@
 #define GEOM_INDEX_TMP_EXT ".geomidx.tmp"
 #define CELL2FEATURE_SORTED_EXT ".c2f.sorted"
 #define CELL2FEATURE_TMP_EXT ".c2f.tmp"
+#define SORTED_MID_POINTS_TMP_EXT ".midpoints.tmp"
 
 #define COUNTRIES_FILE  "countries.txt"
 
@@ -57,6 +58,8 @@
 #define PACKED_POLYGONS_FILE "packed_polygons.bin"
 #define PACKED_POLYGONS_INFO_TAG "info"
 
+#define CROSS_MWM_OVERLAY_FILE "cross_mwm_overlay.bin"
+
 #define EXTERNAL_RESOURCES_FILE "external_resources.txt"
 
 /// How many langs we're supporting on indexing stage
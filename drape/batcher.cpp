@@ -5,11 +5,63 @@
 
 #include "base/assert.hpp"
 
+#include "std/algorithm.hpp"
 #include "std/bind.hpp"
 
 namespace dp
 {
 
+namespace
+{
+
+/// Triangle lists are split into buffers by triangles.
+class ListIndexesGenerator
+{
+public:
+  uint16_t GetVertexUnit() const { return 3; }
+  uint16_t GetIndexCount(uint16_t vertexCount) const { return vertexCount; }
+
+  void Generate(uint16_t vertexCount, uint16_t startIndex, uint16_t * indexes) const
+  {
+    for (uint16_t i = 0; i < vertexCount; ++i)
+      indexes[i] = startIndex + i;
+  }
+};
+
+/// Lists of strips are split into buffers by strips.
+class ListOfStripIndexesGenerator
+{
+public:
+  explicit ListOfStripIndexesGenerator(uint8_t vertexStride) : m_vertexStride(vertexStride)
+  {
+    ASSERT_GREATER_OR_EQUAL(m_vertexStride, 3, ());
+  }
+
+  uint16_t GetVertexUnit() const { return m_vertexStride; }
+  uint16_t GetIndexCount(uint16_t vertexCount) const
+  {
+    return vertexCount / m_vertexStride * 3 * (m_vertexStride - 2);
+  }
+
+  void Generate(uint16_t vertexCount, uint16_t startIndex, uint16_t * indexes) const
+  {
+    for (uint16_t base = 0; base < vertexCount; base += m_vertexStride)
+    {
+      for (uint16_t i = 0; i + 2 < m_vertexStride; ++i)
+      {
+        *indexes++ = startIndex + base + i;
+        *indexes++ = startIndex + base + i + 1;
+        *indexes++ = startIndex + base + i + 2;
+      }
+    }
+  }
+
+private:
+  uint8_t m_vertexStride;
+};
+
+} // namespace
+
 class Batcher::CallbacksWrapper
 {
 public:
@@ -139,6 +191,19 @@ void Batcher::InsertListOfStrip(GLState const & state, RefPointer<AttributeProvi
   InsertTriangles<TriangleListOfStripBatch>(state, params, handle, vertexStride);
 }
 
+void Batcher::InsertTriangleLists(GLState const & state, BindingInfo const & binding,
+                                  TVertexSpan const * spans, size_t spansCount)
+{
+  AddPendingSpans(state, binding, spans, spansCount, 0 /* vertexStride */);
+}
+
+void Batcher::InsertListsOfStrip(GLState const & state, BindingInfo const & binding,
+                                 TVertexSpan const * spans, size_t spansCount, uint8_t vertexStride)
+{
+  ASSERT_GREATER(vertexStride, 0, ());
+  AddPendingSpans(state, binding, spans, spansCount, vertexStride);
+}
+
 void Batcher::StartSession(flush_fn const & flusher)
 {
   m_flushInterface = flusher;
@@ -146,6 +211,7 @@ void Batcher::StartSession(flush_fn const & flusher)
 
 void Batcher::EndSession()
 {
+  InsertAllPendingSpans();
   Flush();
   m_flushInterface = flush_fn();
 }
@@ -195,12 +261,155 @@ void Batcher::Flush()
   m_buckets.clear();
 }
 
+void Batcher::AddPendingSpans(GLState const & state, BindingInfo const & binding,
+                              TVertexSpan const * spans, size_t spansCount, uint8_t vertexStride)
+{
+  ASSERT(!binding.IsDynamic(), ("Dynamic attributes need overlay handles, use InsertTriangles."));
+
+  auto it = m_pendingSpans.find(state);
+  if (it != m_pendingSpans.end() &&
+      (it->second.m_vertexStride != vertexStride ||
+       it->second.m_binding < binding || binding < it->second.m_binding))
+  {
+    InsertPendingSpans(state);
+    it = m_pendingSpans.end();
+  }
+  if (it == m_pendingSpans.end())
+    it = m_pendingSpans.insert(make_pair(state, PendingSpans(binding, vertexStride))).first;
+
+  PendingSpans & pending = it->second;
+  uint16_t const vertexSize = binding.GetElementSize();
+  for (size_t i = 0; i < spansCount; ++i)
+  {
+    char const * data = static_cast<char const *>(spans[i].first);
+    pending.m_vertexes.insert(pending.m_vertexes.end(), data, data + spans[i].second * vertexSize);
+    pending.m_counts.push_back(spans[i].second);
+    pending.m_vertexCount += spans[i].second;
+  }
+
+  // Vertexes which fill a buffer are inserted at once, so pending copies stay small.
+  if (pending.m_vertexCount >= m_vertexBufferSize)
+    InsertPendingSpans(state);
+}
+
+void Batcher::InsertPendingSpans(GLState const & state)
+{
+  auto const it = m_pendingSpans.find(state);
+  if (it == m_pendingSpans.end())
+    return;
+
+  PendingSpans const & pending = it->second;
+  uint16_t const vertexSize = pending.m_binding.GetElementSize();
+  m_pendingSpansList.clear();
+  char const * data = pending.m_vertexes.data();
+  for (uint16_t const count : pending.m_counts)
+  {
+    m_pendingSpansList.push_back(TVertexSpan(data, count));
+    data += count * vertexSize;
+  }
+
+  if (pending.m_vertexStride == 0)
+  {
+    InsertSpans(it->first, pending.m_binding, m_pendingSpansList.data(), m_pendingSpansList.size(),
+                ListIndexesGenerator());
+  }
+  else
+  {
+    InsertSpans(it->first, pending.m_binding, m_pendingSpansList.data(), m_pendingSpansList.size(),
+                ListOfStripIndexesGenerator(pending.m_vertexStride));
+  }
+  m_pendingSpans.erase(it);
+}
+
+void Batcher::InsertAllPendingSpans()
+{
+  while (!m_pendingSpans.empty())
+  {
+    GLState const state = m_pendingSpans.begin()->first;
+    InsertPendingSpans(state);
+  }
+}
+
+template <typename TGenerator>
+void Batcher::InsertSpans(GLState const & state, BindingInfo const & binding,
+                          TVertexSpan const * spans, size_t spansCount, TGenerator const & generator)
+{
+  uint16_t const vertexUnit = generator.GetVertexUnit();
+  uint16_t const indexUnit = generator.GetIndexCount(vertexUnit);
+  uint16_t const vertexSize = binding.GetElementSize();
+
+  RefPointer<VertexArrayBuffer> vao = GetBucket(state)->GetBuffer();
+  m_bulkIndexes.clear();
+  m_bulkVertexes.clear();
+  uint16_t pendingVertexCount = 0;
+
+  for (size_t i = 0; i < spansCount; ++i)
+  {
+    char const * data = static_cast<char const *>(spans[i].first);
+    uint16_t restCount = spans[i].second;
+    ASSERT_EQUAL(restCount % vertexUnit, 0, ());
+
+    while (restCount >= vertexUnit)
+    {
+      uint16_t const avVertex = vao->GetAvailableVertexCount() - pendingVertexCount;
+      uint16_t const avIndex = vao->GetAvailableIndexCount() - m_bulkIndexes.size();
+      uint16_t const unitsCount = min(min(restCount, avVertex) / vertexUnit, avIndex / indexUnit);
+      if (unitsCount == 0)
+      {
+        SubmitBulk(binding, vao);
+        pendingVertexCount = 0;
+        FinalizeBucket(state);
+        vao = GetBucket(state)->GetBuffer();
+        CHECK(vao->GetAvailableVertexCount() >= vertexUnit &&
+              vao->GetAvailableIndexCount() >= indexUnit, ("Buffers are too small for a primitive."));
+        continue;
+      }
+
+      uint16_t const vertexCount = unitsCount * vertexUnit;
+      size_t const indexOffset = m_bulkIndexes.size();
+      m_bulkIndexes.resize(indexOffset + unitsCount * indexUnit);
+      generator.Generate(vertexCount, vao->GetStartIndexValue() + pendingVertexCount,
+                         &m_bulkIndexes[indexOffset]);
+
+      // Shapes which lie in memory one after another are uploaded by one call.
+      if (!m_bulkVertexes.empty() &&
+          static_cast<char const *>(m_bulkVertexes.back().first) +
+            m_bulkVertexes.back().second * vertexSize == data)
+        m_bulkVertexes.back().second += vertexCount;
+      else
+        m_bulkVertexes.push_back(TVertexSpan(data, vertexCount));
+
+      pendingVertexCount += vertexCount;
+      data += vertexCount * vertexSize;
+      restCount -= vertexCount;
+    }
+  }
+
+  SubmitBulk(binding, vao);
+}
+
+void Batcher::SubmitBulk(BindingInfo const & binding, RefPointer<VertexArrayBuffer> vao)
+{
+  if (m_bulkIndexes.empty())
+    return;
+
+  vao->UploadIndexes(m_bulkIndexes.data(), m_bulkIndexes.size());
+  for (size_t i = 0; i < m_bulkVertexes.size(); ++i)
+    vao->UploadData(binding, m_bulkVertexes[i].first, m_bulkVertexes[i].second);
+
+  m_bulkIndexes.clear();
+  m_bulkVertexes.clear();
+}
+
 template <typename TBatcher>
 void Batcher::InsertTriangles(GLState const & state,
                               RefPointer<AttributeProvider> params,
                               TransferPointer<OverlayHandle> transferHandle,
                               uint8_t vertexStride)
 {
+  // Shapes which are inserted earlier keep their order in buffers of the state.
+  InsertPendingSpans(state);
+
   RefPointer<RenderBucket> bucket = GetBucket(state);
   RefPointer<VertexArrayBuffer> vao = bucket->GetBuffer();
 
@@ -5,9 +5,12 @@
 #include "drape/render_bucket.hpp"
 #include "drape/attribute_provider.hpp"
 #include "drape/overlay_handle.hpp"
+#include "drape/geometry_arena.hpp"
 
 #include "std/map.hpp"
 #include "std/function.hpp"
+#include "std/utility.hpp"
+#include "std/vector.hpp"
 
 namespace dp
 {
@@ -15,6 +18,7 @@ namespace dp
 class RenderBucket;
 class AttributeProvider;
 class OverlayHandle;
+class VertexArrayBuffer;
 
 class Batcher
 {
@@ -38,6 +42,20 @@ public:
   void InsertListOfStrip(GLState const & state, RefPointer<AttributeProvider> params,
                          TransferPointer<OverlayHandle> handle, uint8_t vertexStride);
 
+  /// Vertexes of one shape in the single interleaved stream and their count.
+  typedef pair<void const *, uint16_t> TVertexSpan;
+
+  /// Bulk insertion of shapes with the same static stream. Vertexes of shapes are collected by
+  /// states and inserted together at EndSession(), before insertion of the same state by
+  /// an attribute provider or when a buffer can be filled. So vertexes of all shapes of a state
+  /// are uploaded by one call and indexes are generated once for all shapes that fit into a buffer.
+  void InsertTriangleLists(GLState const & state, BindingInfo const & binding,
+                           TVertexSpan const * spans, size_t spansCount);
+  void InsertListsOfStrip(GLState const & state, BindingInfo const & binding,
+                          TVertexSpan const * spans, size_t spansCount, uint8_t vertexStride);
+
+  /// Scratch memory for geometry of shapes inserted into this batcher.
+  GeometryArena & GetArena() { return m_arena; }
 
   typedef function<void (GLState const &, TransferPointer<RenderBucket> )> flush_fn;
   void StartSession(flush_fn const & flusher);
@@ -51,6 +69,17 @@ private:
                        TransferPointer<OverlayHandle> handle,
                        uint8_t vertexStride = 0);
 
+  /// @param vertexStride  Stride of a list of strips or 0 for a triangle list.
+  void AddPendingSpans(GLState const & state, BindingInfo const & binding,
+                       TVertexSpan const * spans, size_t spansCount, uint8_t vertexStride);
+  void InsertPendingSpans(GLState const & state);
+  void InsertAllPendingSpans();
+
+  template <typename TGenerator>
+  void InsertSpans(GLState const & state, BindingInfo const & binding,
+                   TVertexSpan const * spans, size_t spansCount, TGenerator const & generator);
+  void SubmitBulk(BindingInfo const & binding, RefPointer<VertexArrayBuffer> vao);
+
   class CallbacksWrapper;
   void ChangeBuffer(RefPointer<CallbacksWrapper> wrapper, bool checkFilledBuffer);
   RefPointer<RenderBucket> GetBucket(GLState const & state);
@@ -67,6 +96,26 @@ private:
 
   uint32_t m_indexBufferSize;
   uint32_t m_vertexBufferSize;
+
+  /// Copies of vertexes of shapes which are not inserted yet.
+  struct PendingSpans
+  {
+    PendingSpans(BindingInfo const & binding, uint8_t vertexStride)
+      : m_binding(binding), m_vertexStride(vertexStride) {}
+
+    BindingInfo m_binding;
+    uint8_t m_vertexStride;
+    vector<char> m_vertexes;
+    vector<uint16_t> m_counts;
+    uint32_t m_vertexCount = 0;
+  };
+  map<GLState, PendingSpans> m_pendingSpans;
+
+  /// Indexes and vertexes of bulk insertion which are not uploaded yet.
+  vector<uint16_t> m_bulkIndexes;
+  vector<TVertexSpan> m_bulkVertexes;
+  vector<TVertexSpan> m_pendingSpansList;
+  GeometryArena m_arena;
 };
 
 class BatcherFactory
@@ -41,7 +41,9 @@ SOURCES += \
     $$DRAPE_DIR/stipple_pen_resource.cpp \
     $$DRAPE_DIR/texture_of_colors.cpp \
     $$DRAPE_DIR/glyph_manager.cpp \
-    $$DRAPE_DIR/utils/vertex_decl.cpp
+    $$DRAPE_DIR/utils/vertex_decl.cpp \
+    $$DRAPE_DIR/geometry_arena.cpp \
+    $$DRAPE_DIR/overlay_grid.cpp
 
 HEADERS += \
     $$ROOT_DIR/sdf_image/sdf_image.h \
@@ -88,4 +90,6 @@ HEADERS += \
     $$DRAPE_DIR/glsl_types.hpp \
     $$DRAPE_DIR/glsl_func.hpp \
     $$DRAPE_DIR/glyph_manager.hpp \
-    $$DRAPE_DIR/utils/vertex_decl.hpp
+    $$DRAPE_DIR/utils/vertex_decl.hpp \
+    $$DRAPE_DIR/geometry_arena.hpp \
+    $$DRAPE_DIR/overlay_grid.hpp
@@ -9,7 +9,9 @@
 
 #include "drape/drape_tests/glmock_functions.hpp"
 
+#include "base/macros.hpp"
 #include "base/stl_add.hpp"
+#include "base/timer.hpp"
 
 #include "std/bind.hpp"
 #include "std/cstring.hpp"
@@ -385,3 +387,274 @@ UNIT_TEST(BatchListOfStript_partial)
       vaoAcceptor.m_vao[i].Destroy();
   }
 }
+
+namespace
+{
+  BindingInfo MakePositionBinding(uint8_t componentCount)
+  {
+    BindingInfo binding(1);
+    BindingDecl & decl = binding.GetBindingDecl(0);
+    decl.m_attributeName = "position";
+    decl.m_componentCount = componentCount;
+    decl.m_componentType = gl_const::GLFloatType;
+    decl.m_offset = 0;
+    decl.m_stride = 0;
+    return binding;
+  }
+}
+
+UNIT_TEST(BatchTriangleLists_Bulk)
+{
+  int const VERTEX_COUNT = 12;
+  float data[3 * VERTEX_COUNT];
+  for (int i = 0; i < 3 * VERTEX_COUNT; ++i)
+    data[i] = (float)i;
+
+  unsigned short indexes[VERTEX_COUNT];
+  for (int i = 0; i < VERTEX_COUNT; ++i)
+    indexes[i] = i;
+
+  // Shapes of 6, 3 and 3 vertexes go to the same buffers.
+  BatcherExpectations expectations;
+  expectations.RunTest(data, indexes, VERTEX_COUNT, 3, VERTEX_COUNT,
+                       [&data](Batcher * batcher, GLState const & state, RefPointer<AttributeProvider>)
+  {
+    Batcher::TVertexSpan const spans[] = { Batcher::TVertexSpan(data, 6),
+                                           Batcher::TVertexSpan(data + 3 * 6, 3),
+                                           Batcher::TVertexSpan(data + 3 * 9, 3) };
+    batcher->InsertTriangleLists(state, MakePositionBinding(3), spans, ARRAY_SIZE(spans));
+  });
+}
+
+UNIT_TEST(BatchTriangleLists_BulkByShapes)
+{
+  int const VERTEX_COUNT = 12;
+  float data[3 * VERTEX_COUNT];
+  for (int i = 0; i < 3 * VERTEX_COUNT; ++i)
+    data[i] = (float)i;
+
+  unsigned short indexes[VERTEX_COUNT];
+  for (int i = 0; i < VERTEX_COUNT; ++i)
+    indexes[i] = i;
+
+  // Shapes in separate arrays are inserted by separate calls, but they are uploaded together.
+  BatcherExpectations expectations;
+  expectations.RunTest(data, indexes, VERTEX_COUNT, 3, VERTEX_COUNT,
+                       [&data](Batcher * batcher, GLState const & state, RefPointer<AttributeProvider>)
+  {
+    vector<float> first(data, data + 3 * 6);
+    vector<float> second(data + 3 * 6, data + 3 * VERTEX_COUNT);
+    Batcher::TVertexSpan const firstSpan(first.data(), 6);
+    batcher->InsertTriangleLists(state, MakePositionBinding(3), &firstSpan, 1);
+    Batcher::TVertexSpan const secondSpan(second.data(), 6);
+    batcher->InsertTriangleLists(state, MakePositionBinding(3), &secondSpan, 1);
+  });
+}
+
+UNIT_TEST(BatchListsOfStrip_Bulk)
+{
+  int const VERTEX_COUNT = 12;
+  int const INDEX_COUNT = 18;
+
+  float data[3 * VERTEX_COUNT];
+  for (int i = 0; i < VERTEX_COUNT * 3; ++i)
+    data[i] = (float)i;
+
+  unsigned short indexes[INDEX_COUNT] =
+    { 0, 1, 2, 1, 2, 3, 4, 5, 6, 5, 6, 7, 8, 9, 10, 9, 10, 11};
+
+  BatcherExpectations expectations;
+  expectations.RunTest(data, indexes, VERTEX_COUNT, 3, INDEX_COUNT,
+                       [&data](Batcher * batcher, GLState const & state, RefPointer<AttributeProvider>)
+  {
+    Batcher::TVertexSpan const spans[] = { Batcher::TVertexSpan(data, 8),
+                                           Batcher::TVertexSpan(data + 3 * 8, 4) };
+    batcher->InsertListsOfStrip(state, MakePositionBinding(3), spans, ARRAY_SIZE(spans), 4);
+  });
+}
+
+UNIT_TEST(BatchListsOfStrip_BulkPartial)
+{
+  uint32_t const VertexCount = 16;
+  uint32_t const ComponentCount = 3;
+  uint32_t const VertexArraySize = VertexCount * ComponentCount;
+  uint32_t const IndexCount = 24;
+
+  uint32_t const FirstBufferVertexPortion = 12;
+  uint32_t const SecondBufferVertexPortion = VertexCount - FirstBufferVertexPortion;
+  uint32_t const FirstBufferIndexPortion = 18;
+  uint32_t const SecondBufferIndexPortion = IndexCount - FirstBufferIndexPortion;
+
+  float vertexData[VertexArraySize];
+  for (uint32_t i = 0; i < VertexArraySize; ++i)
+    vertexData[i] = (float)i;
+
+  uint16_t indexData[IndexCount] =
+    { 0, 1, 2,
+      1, 2, 3,
+      4, 5, 6,
+      5, 6, 7,
+      8, 9, 10,
+      9, 10, 11,
+      0, 1, 2, // start new buffer
+      1, 2, 3};
+
+  PartialBatcherTest::BufferNode node1(FirstBufferIndexPortion * sizeof(uint16_t),
+                                       FirstBufferVertexPortion * ComponentCount * sizeof(float),
+                                       indexData, vertexData);
+
+  PartialBatcherTest::BufferNode node2(SecondBufferIndexPortion * sizeof(uint16_t),
+                                       SecondBufferVertexPortion * ComponentCount * sizeof(float),
+                                       indexData + FirstBufferIndexPortion,
+                                       vertexData + FirstBufferVertexPortion * ComponentCount);
+
+  // The second shape is split between buffers by strips.
+  Batcher::TVertexSpan const spans[] = { Batcher::TVertexSpan(vertexData, 4),
+                                         Batcher::TVertexSpan(vertexData + 4 * ComponentCount, 12) };
+
+  typedef pair<uint32_t, uint32_t> IndexVertexCount;
+  vector<IndexVertexCount> srcData;
+  srcData.push_back(make_pair(30, 12));
+  srcData.push_back(make_pair(30, 13));
+  srcData.push_back(make_pair(18, 30));
+  srcData.push_back(make_pair(19, 30));
+
+  for (size_t i = 0; i < srcData.size(); ++i)
+  {
+    InSequence seq;
+    PartialBatcherTest test;
+    test.AddBufferNode(node1);
+    test.AddBufferNode(node2);
+    test.CloseExpection();
+
+    GLState state(0, GLState::GeometryLayer);
+
+    VAOAcceptor vaoAcceptor;
+    Batcher batcher(srcData[i].first, srcData[i].second);
+    batcher.StartSession(bind(&VAOAcceptor::FlushFullBucket, &vaoAcceptor, _1, _2));
+    batcher.InsertListsOfStrip(state, MakePositionBinding(ComponentCount), spans, ARRAY_SIZE(spans), 4);
+    batcher.EndSession();
+
+    for (size_t i = 0; i < vaoAcceptor.m_vao.size(); ++i)
+      vaoAcceptor.m_vao[i].Destroy();
+  }
+}
+
+UNIT_TEST(GeometryArena_Test)
+{
+  GeometryArena arena(64);
+  {
+    GeometryArena::Scope scope(arena);
+    ArenaVector<uint32_t> v(arena, 2);
+    for (uint32_t i = 0; i < 100; ++i)
+      v.push_back(i);
+    TEST_EQUAL(v.size(), 100, ());
+    for (uint32_t i = 0; i < 100; ++i)
+      TEST_EQUAL(v[i], i, ());
+
+    double * d = arena.Allocate<double>(3);
+    TEST_EQUAL(reinterpret_cast<uintptr_t>(d) % alignof(double), 0, ());
+  }
+
+  // Memory is reused after rewinding.
+  size_t const capacity = arena.GetCapacity();
+  for (int i = 0; i < 10; ++i)
+  {
+    GeometryArena::Scope scope(arena);
+    ArenaVector<uint32_t> v(arena, 2);
+    for (uint32_t j = 0; j < 100; ++j)
+      v.push_back(j);
+  }
+  TEST_EQUAL(arena.GetCapacity(), capacity, ());
+
+  // Vectors without initial capacity grow too.
+  {
+    GeometryArena::Scope scope(arena);
+    ArenaVector<uint32_t> v(arena, 0);
+    TEST(v.empty(), ());
+    for (uint32_t i = 0; i < 10; ++i)
+      v.push_back(i);
+    TEST_EQUAL(v.size(), 10, ());
+    for (uint32_t i = 0; i < 10; ++i)
+      TEST_EQUAL(v[i], i, ());
+  }
+}
+
+namespace
+{
+  void ExpectAnyBuffers()
+  {
+    EXPECTGL(glGenBuffer()).WillRepeatedly(Return(1));
+    EXPECTGL(glBindBuffer(_, _)).Times(testing::AnyNumber());
+    EXPECTGL(glBufferData(_, _, _, _)).Times(testing::AnyNumber());
+    EXPECTGL(glBufferSubData(_, _, _, _)).Times(testing::AnyNumber());
+    EXPECTGL(glDeleteBuffer(_)).Times(testing::AnyNumber());
+  }
+
+  struct BucketsCounter
+  {
+    void Flush(GLState const &, TransferPointer<RenderBucket> bucket)
+    {
+      MasterPointer<RenderBucket> p(bucket);
+      p.Destroy();
+      ++m_count;
+    }
+
+    size_t m_count = 0;
+  };
+}
+
+// Vertexes of line shapes: 12 floats as gpu::LineVertex, 4 vertexes per strip.
+UNIT_TEST(Batcher_BulkVertexesPerSecond)
+{
+  uint8_t const kComponentCount = 12;
+  uint16_t const kShapeVertexCount = 32;
+  size_t const kShapesCount = 20000;
+
+  ExpectAnyBuffers();
+
+  vector<float> data(kShapesCount * kShapeVertexCount * kComponentCount);
+  for (size_t i = 0; i < data.size(); ++i)
+    data[i] = static_cast<float>(i % 1000);
+
+  BindingInfo const binding = MakePositionBinding(kComponentCount);
+  GLState const state(0, GLState::GeometryLayer);
+  double const vertexCount = static_cast<double>(kShapesCount * kShapeVertexCount);
+
+  double providerSeconds;
+  {
+    BucketsCounter counter;
+    Batcher batcher;
+    batcher.StartSession(bind(&BucketsCounter::Flush, &counter, _1, _2));
+    my::Timer timer;
+    for (size_t i = 0; i < kShapesCount; ++i)
+    {
+      AttributeProvider provider(1, kShapeVertexCount);
+      provider.InitStream(0, binding,
+                          MakeStackRefPointer<void>(&data[i * kShapeVertexCount * kComponentCount]));
+      batcher.InsertListOfStrip(state, MakeStackRefPointer(&provider), 4);
+    }
+    batcher.EndSession();
+    providerSeconds = timer.ElapsedSeconds();
+  }
+
+  // Every shape is inserted by its own call as LineShape does.
+  double bulkSeconds;
+  {
+    BucketsCounter counter;
+    Batcher batcher;
+    batcher.StartSession(bind(&BucketsCounter::Flush, &counter, _1, _2));
+    my::Timer timer;
+    for (size_t i = 0; i < kShapesCount; ++i)
+    {
+      Batcher::TVertexSpan const span(&data[i * kShapeVertexCount * kComponentCount],
+                                      kShapeVertexCount);
+      batcher.InsertListsOfStrip(state, binding, &span, 1, 4);
+    }
+    batcher.EndSession();
+    bulkSeconds = timer.ElapsedSeconds();
+  }
+
+  LOG(LINFO, ("Vertexes per second, attribute providers:", vertexCount / providerSeconds,
+              "bulk:", vertexCount / bulkSeconds));
+}
@@ -35,6 +35,7 @@ SOURCES += \
     glyph_mng_tests.cpp \
     glyph_packer_test.cpp \
     font_texture_tests.cpp \
+    overlay_tree_tests.cpp \
     img.cpp \
 
 HEADERS += \
@@ -0,0 +1,318 @@
+#include "testing/testing.hpp"
+#include "testing/benchmark.hpp"
+
+#include "drape/overlay_tree.hpp"
+
+#include "geometry/tree4d.hpp"
+
+#include "base/logging.hpp"
+#include "base/timer.hpp"
+
+#include "std/random.hpp"
+#include "std/unique_ptr.hpp"
+#include "std/vector.hpp"
+
+using namespace dp;
+
+namespace
+{
+
+m2::RectD const kScreenRect(0, 0, 1024, 768);
+
+ScreenBase MakeScreen(m2::PointD const & shift = m2::PointD::Zero())
+{
+  m2::RectD rect = kScreenRect;
+  rect.Offset(shift);
+  return ScreenBase(m2::RectI(0, 0, kScreenRect.SizeX(), kScreenRect.SizeY()), m2::AnyRectD(rect));
+}
+
+class Handles
+{
+public:
+  SquareHandle & Add(m2::PointD const & pivot, m2::PointD const & size, double priority)
+  {
+    m_handles.emplace_back(new SquareHandle(FeatureID(), dp::Center, pivot, size, priority));
+    return *m_handles.back();
+  }
+
+  size_t GetCount() const { return m_handles.size(); }
+  SquareHandle & operator[](size_t i) { return *m_handles[i]; }
+
+  template <typename TTree>
+  void Place(TTree & tree, ScreenBase const & screen, bool canOverlap = false)
+  {
+    tree.StartOverlayPlacing(screen, canOverlap);
+    for (auto & handle : m_handles)
+      tree.Add(MakeStackRefPointer<OverlayHandle>(handle.get()));
+    tree.EndOverlayPlacing();
+  }
+
+private:
+  vector<unique_ptr<SquareHandle>> m_handles;
+};
+
+/// Collision detection on the KD-tree which OverlayTree used before, for comparison.
+class KdOverlayTree
+{
+  struct Traits
+  {
+    ScreenBase m_modelView;
+
+    m2::RectD const LimitRect(RefPointer<OverlayHandle> handle)
+    {
+      return handle->GetPixelRect(m_modelView);
+    }
+  };
+
+public:
+  void StartOverlayPlacing(ScreenBase const & screen, bool canOverlap)
+  {
+    m_tree = m4::Tree<RefPointer<OverlayHandle>, Traits>(Traits{ screen });
+    m_screen = screen;
+    m_canOverlap = canOverlap;
+  }
+
+  void Add(RefPointer<OverlayHandle> handle)
+  {
+    handle->SetIsVisible(m_canOverlap);
+    handle->Update(m_screen);
+    if (!handle->IsValid())
+      return;
+
+    m2::RectD const pixelRect = handle->GetPixelRect(m_screen);
+    if (!m_screen.PixelRect().IsIntersect(pixelRect))
+    {
+      handle->SetIsVisible(false);
+      return;
+    }
+
+    buffer_vector<RefPointer<OverlayHandle>, 8> elements;
+    m_tree.ForEachInRect(pixelRect, [&](RefPointer<OverlayHandle> r)
+    {
+      if (handle->IsIntersect(m_screen, *r.GetRaw()))
+        elements.push_back(r);
+    });
+
+    for (auto const & e : elements)
+      if (handle->GetPriority() < e->GetPriority())
+        return;
+
+    for (auto const & e : elements)
+      m_tree.Erase(e);
+
+    m_tree.Add(handle, pixelRect);
+  }
+
+  void EndOverlayPlacing()
+  {
+    m_tree.ForEach([](RefPointer<OverlayHandle> handle) { handle->SetIsVisible(true); });
+    m_tree.Clear();
+  }
+
+private:
+  m4::Tree<RefPointer<OverlayHandle>, Traits> m_tree;
+  ScreenBase m_screen;
+  bool m_canOverlap = false;
+};
+
+/// Overlays of a city screen: captions and POI of different size and priority which are denser
+/// in the centre, and a road caption every 50 pixels.
+void MakeCityOverlays(size_t count, uint32_t seed, Handles & handles)
+{
+  mt19937 rng(seed);
+  normal_distribution<double> x(kScreenRect.SizeX() / 2, kScreenRect.SizeX() / 3);
+  normal_distribution<double> y(kScreenRect.SizeY() / 2, kScreenRect.SizeY() / 3);
+  uniform_int_distribution<int> kind(0, 2);
+  uniform_int_distribution<int> priority(0, 1000);
+  uniform_real_distribution<double> captionLength(30, 150);
+
+  for (size_t i = 0; i < count; ++i)
+  {
+    m2::PointD const pivot(x(rng), y(rng));
+    switch (kind(rng))
+    {
+    case 0: handles.Add(pivot, m2::PointD(24, 24), priority(rng)); break;
+    case 1: handles.Add(pivot, m2::PointD(captionLength(rng), 16), priority(rng)); break;
+    default: handles.Add(pivot, m2::PointD(captionLength(rng), 12), priority(rng) / 10); break;
+    }
+  }
+}
+
+void TestPlacement(Handles & handles, ScreenBase const & screen)
+{
+  vector<m2::RectD> visible;
+  for (size_t i = 0; i < handles.GetCount(); ++i)
+  {
+    if (handles[i].IsVisible())
+      visible.push_back(handles[i].GetPixelRect(screen));
+  }
+
+  for (size_t i = 0; i < visible.size(); ++i)
+  {
+    for (size_t j = i + 1; j < visible.size(); ++j)
+      TEST(!visible[i].IsIntersect(visible[j]), (visible[i], visible[j]));
+  }
+
+  // Every hidden handle on the screen is hidden by a visible one with not lower priority.
+  for (size_t i = 0; i < handles.GetCount(); ++i)
+  {
+    SquareHandle & h = handles[i];
+    m2::RectD const rect = h.GetPixelRect(screen);
+    if (h.IsVisible() || !screen.PixelRect().IsIntersect(rect))
+      continue;
+
+    bool isHidden = false;
+    for (size_t j = 0; j < handles.GetCount() && !isHidden; ++j)
+    {
+      isHidden = handles[j].IsVisible() && handles[j].GetPriority() >= h.GetPriority() &&
+                 handles[j].GetPixelRect(screen).IsIntersect(rect);
+    }
+    TEST(isHidden, (i, rect));
+  }
+}
+
+/// Frames of slow panning.
+template <typename TTree>
+double MeasureFrameMs(TTree & tree, Handles & handles, size_t framesCount)
+{
+  my::Timer timer;
+  for (size_t frame = 0; frame < framesCount; ++frame)
+    handles.Place(tree, MakeScreen(m2::PointD(frame, frame / 2)));
+  return timer.ElapsedSeconds() * 1000 / framesCount;
+}
+
+} // namespace
+
+UNIT_TEST(OverlayTree_HigherPriorityWins)
+{
+  ScreenBase const screen = MakeScreen();
+  for (bool const highFirst : { true, false })
+  {
+    Handles handles;
+    SquareHandle & h1 = handles.Add(m2::PointD(100, 100), m2::PointD(40, 20), highFirst ? 10 : 5);
+    SquareHandle & h2 = handles.Add(m2::PointD(120, 105), m2::PointD(40, 20), highFirst ? 5 : 10);
+    SquareHandle & h3 = handles.Add(m2::PointD(300, 300), m2::PointD(40, 20), 1);
+    SquareHandle & h4 = handles.Add(m2::PointD(2000, 300), m2::PointD(40, 20), 100);
+
+    OverlayTree tree;
+    handles.Place(tree, screen);
+    TEST_EQUAL(h1.IsVisible(), highFirst, ());
+    TEST_EQUAL(h2.IsVisible(), !highFirst, ());
+    TEST(h3.IsVisible(), ());
+    TEST(!h4.IsVisible(), ());
+  }
+}
+
+UNIT_TEST(OverlayTree_LowerPriorityDoesntHideHigher)
+{
+  // The middle handle intersects both others. The KD-tree placement loses the left one:
+  // the middle one evicts it and then is evicted by the right one.
+  Handles handles;
+  SquareHandle & left = handles.Add(m2::PointD(100, 100), m2::PointD(40, 20), 1);
+  SquareHandle & middle = handles.Add(m2::PointD(130, 100), m2::PointD(40, 20), 2);
+  SquareHandle & right = handles.Add(m2::PointD(160, 100), m2::PointD(40, 20), 3);
+
+  OverlayTree tree;
+  handles.Place(tree, MakeScreen());
+  TEST(left.IsVisible(), ());
+  TEST(!middle.IsVisible(), ());
+  TEST(right.IsVisible(), ());
+}
+
+UNIT_TEST(OverlayTree_EqualPriorityKeepsPreviousFrame)
+{
+  Handles handles;
+  SquareHandle & first = handles.Add(m2::PointD(100, 100), m2::PointD(40, 20), 5);
+  SquareHandle & second = handles.Add(m2::PointD(110, 100), m2::PointD(40, 20), 5);
+
+  OverlayTree tree;
+  handles.Place(tree, MakeScreen());
+  TEST(first.IsVisible(), ());
+  TEST(!second.IsVisible(), ());
+
+  // Order of addition has changed, but the handle visible in the previous frame stays.
+  tree.StartOverlayPlacing(MakeScreen());
+  tree.Add(MakeStackRefPointer<OverlayHandle>(&second));
+  tree.Add(MakeStackRefPointer<OverlayHandle>(&first));
+  tree.EndOverlayPlacing();
+  TEST(first.IsVisible(), ());
+  TEST(!second.IsVisible(), ());
+}
+
+UNIT_TEST(OverlayTree_CanOverlap)
+{
+  Handles handles;
+  SquareHandle & h1 = handles.Add(m2::PointD(100, 100), m2::PointD(40, 20), 1);
+  SquareHandle & h2 = handles.Add(m2::PointD(110, 100), m2::PointD(40, 20), 2);
+  SquareHandle & h3 = handles.Add(m2::PointD(-100, 100), m2::PointD(40, 20), 2);
+
+  OverlayTree tree;
+  handles.Place(tree, MakeScreen(), true /* canOverlap */);
+  TEST(h1.IsVisible(), ());
+  TEST(h2.IsVisible(), ());
+  TEST(!h3.IsVisible(), ());
+}
+
+UNIT_TEST(OverlayTree_CityPlacement)
+{
+  OverlayTree tree;
+  Handles handles;
+  MakeCityOverlays(3000, 1, handles);
+
+  for (int frame = 0; frame < 5; ++frame)
+  {
+    ScreenBase const screen = MakeScreen(m2::PointD(frame * 7, -frame * 3));
+    handles.Place(tree, screen);
+    TestPlacement(handles, screen);
+  }
+}
+
+UNIT_TEST(OverlayGrid_FindInRect)
+{
+  OverlayGrid grid(10.0);
+  grid.Reset(m2::RectD(0, 0, 100, 100));
+  grid.Add(0, m2::RectD(5, 5, 35, 15));
+  grid.Add(1, m2::RectD(50, 50, 60, 60));
+  grid.Add(2, m2::RectD(-20, 90, 5, 120));
+
+  vector<uint32_t> found;
+  auto const collect = [&found](uint32_t id)
+  {
+    found.push_back(id);
+    return false;
+  };
+
+  TEST(!grid.FindInRect(m2::RectD(0, 0, 100, 100), collect), ());
+  sort(found.begin(), found.end());
+  TEST_EQUAL(found, vector<uint32_t>({ 0, 1, 2 }), ());
+
+  found.clear();
+  grid.FindInRect(m2::RectD(20, 12, 25, 14), collect);
+  TEST_EQUAL(found, vector<uint32_t>({ 0 }), ());
+
+  found.clear();
+  grid.FindInRect(m2::RectD(-50, 95, -40, 200), collect);
+  TEST_EQUAL(found, vector<uint32_t>({ 2 }), ());
+
+  TEST(grid.FindInRect(m2::RectD(55, 55, 56, 56), [](uint32_t id) { return id == 1; }), ());
+
+  grid.Reset(m2::RectD(0, 0, 50, 50));
+  TEST(!grid.FindInRect(m2::RectD(0, 0, 50, 50), [](uint32_t) { return true; }), ());
+}
+
+BENCHMARK_TEST(OverlayTreeVersusKdTree)
+{
+  size_t const kFramesCount = 50;
+
+  for (size_t const count : { 1000, 5000, 10000 })
+  {
+    Handles handles;
+    MakeCityOverlays(count, count, handles);
+
+    KdOverlayTree kdTree;
+    OverlayTree tree;
+    double const kdMs = MeasureFrameMs(kdTree, handles, kFramesCount);
+    double const gridMs = MeasureFrameMs(tree, handles, kFramesCount);
+    LOG(LINFO, ("Handles:", count, "ms per frame, KD-tree:", kdMs, "grid:", gridMs));
+  }
+}
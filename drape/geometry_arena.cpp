@@ -0,0 +1,71 @@
+#include "drape/geometry_arena.hpp"
+
+#include "std/algorithm.hpp"
+
+namespace dp
+{
+
+GeometryArena::GeometryArena(size_t chunkSize)
+  : m_chunkSize(chunkSize)
+  , m_current(0)
+  , m_offset(0)
+{
+  CHECK_GREATER(m_chunkSize, 0, ());
+}
+
+void * GeometryArena::Allocate(size_t size, size_t alignment)
+{
+  ASSERT_GREATER(alignment, 0, ());
+  for (; m_current < m_chunks.size(); ++m_current, m_offset = 0)
+  {
+    Chunk & chunk = m_chunks[m_current];
+    uintptr_t const begin = reinterpret_cast<uintptr_t>(chunk.m_data.get());
+    size_t const offset = ((begin + m_offset + alignment - 1) / alignment) * alignment - begin;
+    if (offset + size <= chunk.m_size)
+    {
+      m_offset = offset + size;
+      return chunk.m_data.get() + offset;
+    }
+  }
+
+  // operator new[] returns memory aligned for any fundamental type.
+  Chunk chunk;
+  chunk.m_size = max(m_chunkSize, size);
+  chunk.m_data.reset(new char[chunk.m_size]);
+  m_chunks.push_back(move(chunk));
+
+  m_current = m_chunks.size() - 1;
+  m_offset = size;
+  return m_chunks.back().m_data.get();
+}
+
+GeometryArena::Mark GeometryArena::GetMark() const
+{
+  Mark mark;
+  mark.m_chunk = m_current;
+  mark.m_offset = m_offset;
+  return mark;
+}
+
+void GeometryArena::Rewind(Mark const & mark)
+{
+  ASSERT(mark.m_chunk < m_current || (mark.m_chunk == m_current && mark.m_offset <= m_offset), ());
+  m_current = mark.m_chunk;
+  m_offset = mark.m_offset;
+}
+
+void GeometryArena::Reset()
+{
+  m_current = 0;
+  m_offset = 0;
+}
+
+size_t GeometryArena::GetCapacity() const
+{
+  size_t capacity = 0;
+  for (Chunk const & chunk : m_chunks)
+    capacity += chunk.m_size;
+  return capacity;
+}
+
+} // namespace dp
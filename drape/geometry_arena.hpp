@@ -0,0 +1,128 @@
+#pragma once
+
+#include "base/assert.hpp"
+
+#include "std/algorithm.hpp"
+#include "std/noncopyable.hpp"
+#include "std/type_traits.hpp"
+#include "std/unique_ptr.hpp"
+#include "std/vector.hpp"
+
+namespace dp
+{
+
+/// Scratch memory for vertexes of shapes which are built before insertion into a batcher.
+/// Memory of chunks is reused, so building of geometry doesn't allocate in steady state.
+/// The arena isn't thread-safe, every batcher and so every reading thread has its own one.
+class GeometryArena : private noncopyable
+{
+public:
+  /// Position to rewind to.
+  struct Mark
+  {
+    size_t m_chunk;
+    size_t m_offset;
+  };
+
+  /// Releases allocations made after construction of the scope.
+  class Scope : private noncopyable
+  {
+  public:
+    explicit Scope(GeometryArena & arena) : m_arena(arena), m_mark(arena.GetMark()) {}
+    ~Scope() { m_arena.Rewind(m_mark); }
+
+  private:
+    GeometryArena & m_arena;
+    Mark const m_mark;
+  };
+
+  explicit GeometryArena(size_t chunkSize = kDefaultChunkSize);
+
+  void * Allocate(size_t size, size_t alignment);
+
+  template <typename T>
+  T * Allocate(size_t count)
+  {
+    return static_cast<T *>(Allocate(count * sizeof(T), alignof(T)));
+  }
+
+  Mark GetMark() const;
+  void Rewind(Mark const & mark);
+  /// Releases all allocations and keeps memory.
+  void Reset();
+
+  size_t GetCapacity() const;
+
+private:
+  static size_t const kDefaultChunkSize = 64 * 1024;
+
+  struct Chunk
+  {
+    unique_ptr<char[]> m_data;
+    size_t m_size;
+  };
+
+  size_t const m_chunkSize;
+  vector<Chunk> m_chunks;
+  size_t m_current;
+  size_t m_offset;
+};
+
+/// Vector of items in memory of an arena. Grown storage is taken from the arena again,
+/// the old one is released on rewinding of the arena. Items are never destroyed,
+/// so they must be trivially destructible.
+template <typename T>
+class ArenaVector : private noncopyable
+{
+  static_assert(is_trivially_destructible<T>::value, "Items of arena are never destroyed.");
+
+public:
+  ArenaVector(GeometryArena & arena, size_t capacity = 16)
+    : m_arena(arena), m_data(arena.Allocate<T>(capacity)), m_size(0), m_capacity(capacity)
+  {
+  }
+
+  void push_back(T const & value)
+  {
+    if (m_size == m_capacity)
+      reserve(max<size_t>(1, 2 * m_capacity));
+    m_data[m_size++] = value;
+  }
+
+  /// New items are not initialized.
+  void resize(size_t size)
+  {
+    reserve(size);
+    m_size = size;
+  }
+
+  void reserve(size_t capacity)
+  {
+    if (capacity <= m_capacity)
+      return;
+
+    T * data = m_arena.Allocate<T>(capacity);
+    std::uninitialized_copy(m_data, m_data + m_size, data);
+    m_data = data;
+    m_capacity = capacity;
+  }
+
+  T & operator[](size_t i) { ASSERT_LESS(i, m_size, ()); return m_data[i]; }
+  T const & operator[](size_t i) const { ASSERT_LESS(i, m_size, ()); return m_data[i]; }
+
+  T * data() { return m_data; }
+  T const * data() const { return m_data; }
+  size_t size() const { return m_size; }
+  bool empty() const { return m_size == 0; }
+
+  T * begin() { return m_data; }
+  T * end() { return m_data + m_size; }
+
+private:
+  GeometryArena & m_arena;
+  T * m_data;
+  size_t m_size;
+  size_t m_capacity;
+};
+
+} // namespace dp
@@ -0,0 +1,66 @@
+#include "drape/overlay_grid.hpp"
+
+#include "base/assert.hpp"
+#include "base/math.hpp"
+
+#include "std/algorithm.hpp"
+#include "std/cmath.hpp"
+
+namespace dp
+{
+
+OverlayGrid::OverlayGrid(double cellSize)
+  : m_cellSize(cellSize)
+{
+  ASSERT_GREATER(m_cellSize, 0.0, ());
+}
+
+void OverlayGrid::Reset(m2::RectD const & rect)
+{
+  m_origin = rect.LeftBottom();
+  m_width = max(1, static_cast<int>(ceil(rect.SizeX() / m_cellSize)));
+  m_height = max(1, static_cast<int>(ceil(rect.SizeY() / m_cellSize)));
+
+  size_t const cellsCount = static_cast<size_t>(m_width) * m_height;
+  if (m_cells.size() < cellsCount)
+    m_cells.resize(cellsCount);
+
+  for (size_t i = 0; i < cellsCount; ++i)
+    m_cells[i].clear();
+
+  m_stamps.clear();
+  m_queryStamp = 0;
+}
+
+void OverlayGrid::Add(uint32_t id, m2::RectD const & rect)
+{
+  ASSERT_EQUAL(id, m_stamps.size(), ());
+  m_stamps.push_back(0);
+
+  CellRange const range = GetCellRange(rect);
+  for (int y = range.m_minY; y <= range.m_maxY; ++y)
+  {
+    for (int x = range.m_minX; x <= range.m_maxX; ++x)
+      m_cells[y * m_width + x].push_back(id);
+  }
+}
+
+OverlayGrid::CellRange OverlayGrid::GetCellRange(m2::RectD const & rect) const
+{
+  CellRange range = { 0, 0, -1, -1 };
+  if (m_width == 0 || m_height == 0)
+    return range;
+
+  auto const toCell = [this](double v, double origin, int size)
+  {
+    return static_cast<int>(my::clamp(floor((v - origin) / m_cellSize), 0.0, size - 1.0));
+  };
+
+  range.m_minX = toCell(rect.minX(), m_origin.x, m_width);
+  range.m_maxX = toCell(rect.maxX(), m_origin.x, m_width);
+  range.m_minY = toCell(rect.minY(), m_origin.y, m_height);
+  range.m_maxY = toCell(rect.maxY(), m_origin.y, m_height);
+  return range;
+}
+
+} // namespace dp
@@ -0,0 +1,76 @@
+#pragma once
+
+#include "geometry/rect2d.hpp"
+
+#include "std/cstdint.hpp"
+#include "std/vector.hpp"
+
+namespace dp
+{
+
+/// Uniform grid of square cells over the screen for collision queries of overlays.
+/// Every element is registered in all cells which its rect covers. Cells keep their memory
+/// between frames, so the grid rebuilt on every frame doesn't allocate once it's warmed up.
+class OverlayGrid
+{
+public:
+  explicit OverlayGrid(double cellSize);
+
+  /// Removes all elements and covers rect by cells.
+  void Reset(m2::RectD const & rect);
+
+  /// Elements are identified by consecutive ids starting from zero.
+  void Add(uint32_t id, m2::RectD const & rect);
+
+  /// Calls fn(id) for every element which cells intersect rect, every element only once,
+  /// until fn returns true.
+  /// @return true if fn has returned true.
+  template <typename TFn>
+  bool FindInRect(m2::RectD const & rect, TFn const & fn)
+  {
+    CellRange const range = GetCellRange(rect);
+    if (range.IsEmpty())
+      return false;
+
+    ++m_queryStamp;
+    for (int y = range.m_minY; y <= range.m_maxY; ++y)
+    {
+      for (int x = range.m_minX; x <= range.m_maxX; ++x)
+      {
+        for (uint32_t const id : m_cells[y * m_width + x])
+        {
+          if (m_stamps[id] == m_queryStamp)
+            continue;
+
+          m_stamps[id] = m_queryStamp;
+          if (fn(id))
+            return true;
+        }
+      }
+    }
+
+    return false;
+  }
+
+private:
+  struct CellRange
+  {
+    int m_minX, m_minY, m_maxX, m_maxY;
+
+    bool IsEmpty() const { return m_minX > m_maxX || m_minY > m_maxY; }
+  };
+
+  CellRange GetCellRange(m2::RectD const & rect) const;
+
+  double const m_cellSize;
+  m2::PointD m_origin;
+  int m_width = 0;
+  int m_height = 0;
+
+  vector<vector<uint32_t>> m_cells;
+  /// Stamp of the last query which has visited an element.
+  vector<uint32_t> m_stamps;
+  uint32_t m_queryStamp = 0;
+};
+
+} // namespace dp
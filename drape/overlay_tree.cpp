@@ -1,71 +1,115 @@
 #include "drape/overlay_tree.hpp"
 
-#include "std/bind.hpp"
+#include "std/algorithm.hpp"
 
 namespace dp
 {
 
+namespace
+{
+
+double const kGridCellSize = 64.0;
+
+} // namespace
+
+OverlayTree::OverlayTree()
+  : m_canOverlap(false)
+  , m_grid(kGridCellSize)
+{
+}
+
 void OverlayTree::StartOverlayPlacing(ScreenBase const & screen, bool canOverlap)
 {
-  m_traits.m_modelView = screen;
+  m_modelView = screen;
   m_canOverlap = canOverlap;
-  ASSERT(IsEmpty(), ());
+  ASSERT(m_candidates.empty(), ());
 }
 
 void OverlayTree::Add(RefPointer<OverlayHandle> handle)
 {
-  ScreenBase const & modelView = GetModelView();
+  bool const wasVisible = handle->IsValid() && handle->IsVisible();
 
   handle->SetIsVisible(m_canOverlap);
-  handle->Update(modelView);
+  handle->Update(m_modelView);
 
   if (!handle->IsValid())
     return;
 
-  m2::RectD const pixelRect = handle->GetPixelRect(modelView);
-  if (!m_traits.m_modelView.PixelRect().IsIntersect(pixelRect))
+  m2::RectD const pixelRect = handle->GetPixelRect(m_modelView);
+  if (!m_modelView.PixelRect().IsIntersect(pixelRect))
   {
     handle->SetIsVisible(false);
     return;
   }
 
-  typedef buffer_vector<RefPointer<OverlayHandle>, 8> OverlayContainerT;
-  OverlayContainerT elements;
-  /*
-   * Find elements that already on OverlayTree and it's pixel rect
-   * intersect with handle pixel rect ("Intersected elements")
-   */
-  ForEachInRect(pixelRect, [&] (RefPointer<OverlayHandle> r)
-  {
-    if (handle->IsIntersect(modelView, *r.GetRaw()))
-      elements.push_back(r);
-  });
+  if (m_canOverlap)
+    return;
+
+  m_shapeBuffer.clear();
+  handle->GetPixelShape(m_modelView, m_shapeBuffer);
 
-  double const inputPriority = handle->GetPriority();
-  /*
-   * In this loop we decide which element must be visible
-   * If input element "handle" more priority than all "Intersected elements"
-   * than we remove all "Intersected elements" and insert input element "handle"
-   * But if some of already inserted elements more priority than we don't insert "handle"
-   */
-  for (OverlayContainerT::const_iterator it = elements.begin(); it != elements.end(); ++it)
-    if (inputPriority < (*it)->GetPriority())
-      return;
-
-  for (OverlayContainerT::const_iterator it = elements.begin(); it != elements.end(); ++it)
-    Erase(*it);
-
-  BaseT::Add(handle, pixelRect);
+  Candidate candidate;
+  candidate.m_handle = handle;
+  candidate.m_pixelRect = pixelRect;
+  candidate.m_shapeOffset = m_shapes.size();
+  candidate.m_shapeCount = m_shapeBuffer.size();
+  candidate.m_order = m_candidates.size();
+  candidate.m_wasVisible = wasVisible;
+  m_candidates.push_back(candidate);
+  m_shapes.insert(m_shapes.end(), m_shapeBuffer.begin(), m_shapeBuffer.end());
 }
 
 void OverlayTree::EndOverlayPlacing()
 {
-  ForEach([] (RefPointer<OverlayHandle> handle)
+  sort(m_candidates.begin(), m_candidates.end(), [](Candidate const & l, Candidate const & r)
   {
-    handle->SetIsVisible(true);
+    double const lPriority = l.m_handle->GetPriority();
+    double const rPriority = r.m_handle->GetPriority();
+    if (lPriority != rPriority)
+      return lPriority > rPriority;
+    if (l.m_wasVisible != r.m_wasVisible)
+      return l.m_wasVisible;
+    return l.m_order < r.m_order;
   });
 
-  Clear();
+  m_grid.Reset(m_modelView.PixelRect());
+  m_placed.clear();
+
+  for (Candidate & candidate : m_candidates)
+  {
+    bool const isOverlapped = m_grid.FindInRect(candidate.m_pixelRect, [&](uint32_t id)
+    {
+      Candidate const & placed = m_candidates[m_placed[id]];
+      return placed.m_pixelRect.IsIntersect(candidate.m_pixelRect) && IsIntersect(placed, candidate);
+    });
+
+    if (isOverlapped)
+      continue;
+
+    uint32_t const id = m_placed.size();
+    m_placed.push_back(&candidate - m_candidates.data());
+    m_grid.Add(id, candidate.m_pixelRect);
+    candidate.m_handle->SetIsVisible(true);
+  }
+
+  m_candidates.clear();
+  m_shapes.clear();
+}
+
+bool OverlayTree::IsIntersect(Candidate const & c1, Candidate const & c2) const
+{
+  m2::RectF const * shape1 = m_shapes.data() + c1.m_shapeOffset;
+  m2::RectF const * shape2 = m_shapes.data() + c2.m_shapeOffset;
+  for (uint32_t i = 0; i < c1.m_shapeCount; ++i)
+  {
+    for (uint32_t j = 0; j < c2.m_shapeCount; ++j)
+    {
+      if (shape1[i].IsIntersect(shape2[j]))
+        return true;
+    }
+  }
+
+  return false;
 }
 
 } // namespace dp
@@ -1,43 +1,51 @@
 #pragma once
 
+#include "drape/overlay_grid.hpp"
 #include "drape/overlay_handle.hpp"
 
 #include "geometry/screenbase.hpp"
-#include "geometry/tree4d.hpp"
 
+#include "std/vector.hpp"
 
 namespace dp
 {
 
-namespace detail
+/// Placement of overlays without collisions. Handles are collected by Add and placed in
+/// EndOverlayPlacing in deterministic order: higher priority first, then handles which were
+/// visible in the previous frame (so equal labels don't blink), then in order of addition.
+/// Placed handles are kept in a uniform grid over the screen which reuses its memory
+/// from frame to frame.
+class OverlayTree
 {
-
-struct OverlayTraits
-{
-  ScreenBase m_modelView;
-
-  inline m2::RectD const LimitRect(RefPointer<OverlayHandle> handle)
-  {
-    return handle->GetPixelRect(m_modelView);
-  }
-};
-
-}
-
-class OverlayTree : public m4::Tree<RefPointer<OverlayHandle>, detail::OverlayTraits>
-{
-  typedef m4::Tree<RefPointer<OverlayHandle>, detail::OverlayTraits> BaseT;
-
 public:
+  OverlayTree();
+
   void StartOverlayPlacing(ScreenBase const & screen, bool canOverlap = false);
   void Add(RefPointer<OverlayHandle> handle);
   void EndOverlayPlacing();
 
 private:
-  ScreenBase const & GetModelView() const { return m_traits.m_modelView; }
+  struct Candidate
+  {
+    RefPointer<OverlayHandle> m_handle;
+    m2::RectD m_pixelRect;
+    /// Pixel shape of the handle in m_shapes.
+    uint32_t m_shapeOffset;
+    uint32_t m_shapeCount;
+    uint32_t m_order;
+    bool m_wasVisible;
+  };
 
-private:
+  bool IsIntersect(Candidate const & c1, Candidate const & c2) const;
+
+  ScreenBase m_modelView;
   bool m_canOverlap;
+
+  vector<Candidate> m_candidates;
+  vector<uint32_t> m_placed;
+  vector<m2::RectF> m_shapes;
+  OverlayHandle::Rects m_shapeBuffer;
+  OverlayGrid m_grid;
 };
 
 } // namespace dp
@@ -3,11 +3,9 @@
 #include "drape/shader_def.hpp"
 #include "drape/glstate.hpp"
 #include "drape/batcher.hpp"
-#include "drape/attribute_provider.hpp"
 #include "drape/texture_manager.hpp"
 #include "drape/utils/vertex_decl.hpp"
 
-#include "base/buffer_vector.hpp"
 #include "base/logging.hpp"
 
 #include "std/algorithm.hpp"
@@ -27,7 +25,8 @@ void AreaShape::Draw(dp::RefPointer<dp::Batcher> batcher, dp::RefPointer<dp::Tex
   textures->GetColorRegion(m_params.m_color, region);
   glsl::vec2 const colorPoint = glsl::ToVec2(region.GetTexRect().Center());
 
-  buffer_vector<gpu::SolidTexturingVertex, 128> vertexes;
+  dp::GeometryArena::Scope arenaScope(batcher->GetArena());
+  dp::ArenaVector<gpu::SolidTexturingVertex> vertexes(batcher->GetArena(), m_vertexes.size());
   vertexes.resize(m_vertexes.size());
   transform(m_vertexes.begin(), m_vertexes.end(), vertexes.begin(), [&colorPoint, this](m2::PointF const & vertex)
   {
@@ -39,9 +38,8 @@ void AreaShape::Draw(dp::RefPointer<dp::Batcher> batcher, dp::RefPointer<dp::Tex
   dp::GLState state(gpu::TEXTURING_PROGRAM, dp::GLState::GeometryLayer);
   state.SetColorTexture(region.GetTexture());
 
-  dp::AttributeProvider provider(1, m_vertexes.size());
-  provider.InitStream(0, gpu::SolidTexturingVertex::GetBindingInfo(), dp::MakeStackRefPointer<void>(vertexes.data()));
-  batcher->InsertTriangleList(state, dp::MakeStackRefPointer(&provider));
+  dp::Batcher::TVertexSpan const span(vertexes.data(), vertexes.size());
+  batcher->InsertTriangleLists(state, gpu::SolidTexturingVertex::GetBindingInfo(), &span, 1);
 }
 
 } // namespace df
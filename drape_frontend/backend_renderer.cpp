@@ -6,12 +6,15 @@
 
 #include "drape_frontend/threads_commutator.hpp"
 #include "drape_frontend/message_subclasses.hpp"
+#include "drape_frontend/shaped_text_cache.hpp"
 
 #include "drape/oglcontextfactory.hpp"
 #include "drape/texture_manager.hpp"
 
 #include "platform/platform.hpp"
 
+#include "base/logging.hpp"
+
 #include "std/bind.hpp"
 
 namespace df
@@ -103,6 +106,12 @@ void BackendRenderer::ReleaseResources()
   m_readManager.Destroy();
   m_batchersPool.Destroy();
 
+  // Shaped texts refer to glyphs in textures.
+  ShapedTextCache & shapedTextCache = ShapedTextCache::Instance();
+  LOG(LINFO, (shapedTextCache.GetStats()));
+  shapedTextCache.Clear();
+  shapedTextCache.ResetStats();
+
   m_textures->Release();
   m_textures.Destroy();
 }
@@ -115,7 +124,7 @@ void BackendRenderer::Routine::Do()
   m_renderer.InitGLDependentResource();
 
   while (!IsCancelled())
-    m_renderer.ProcessSingleMessage();
+    m_renderer.ProcessMessages();
 
   m_renderer.ReleaseResources();
 }
@@ -39,6 +39,9 @@ SOURCES += \
     path_symbol_shape.cpp \
     text_layout.cpp \
     map_data_provider.cpp \
+    read_scheduler.cpp \
+    line_tessellation.cpp \
+    shaped_text_cache.cpp \
 
 HEADERS += \
     engine_context.hpp \
@@ -75,3 +78,6 @@ HEADERS += \
     text_layout.hpp \
     intrusive_vector.hpp \
     map_data_provider.hpp \
+    read_scheduler.hpp \
+    line_tessellation.hpp \
+    shaped_text_cache.hpp \
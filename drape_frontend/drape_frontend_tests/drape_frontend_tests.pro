@@ -13,3 +13,7 @@ SOURCES += \
     memory_feature_index_tests.cpp \
     fribidi_tests.cpp \
     object_pool_tests.cpp \
+    read_scheduler_tests.cpp \
+    message_queue_tests.cpp \
+    line_tessellation_tests.cpp \
+    shaped_text_cache_tests.cpp \
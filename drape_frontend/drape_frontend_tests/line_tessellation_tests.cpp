@@ -0,0 +1,268 @@
+#include "testing/testing.hpp"
+#include "testing/benchmark.hpp"
+
+#include "drape_frontend/line_tessellation.hpp"
+
+#include "drape/geometry_arena.hpp"
+
+#include "base/logging.hpp"
+#include "base/math.hpp"
+#include "base/timer.hpp"
+
+#include "std/cmath.hpp"
+#include "std/random.hpp"
+#include "std/vector.hpp"
+
+namespace
+{
+
+/// Polyline which looks like a city road in mercator: short segments of several meters with
+/// smooth turns and sharp corners at crossroads.
+vector<glsl::vec2> MakeRoad(size_t pointsCount, uint32_t seed)
+{
+  mt19937 rng(seed);
+  uniform_real_distribution<double> turn(-0.3, 0.3);
+  uniform_real_distribution<double> step(2e-5, 2e-4);
+  uniform_int_distribution<int> crossroad(0, 15);
+
+  vector<glsl::vec2> road;
+  road.reserve(pointsCount);
+
+  double x = 37.6, y = 67.4, angle = 0.0;
+  for (size_t i = 0; i < pointsCount; ++i)
+  {
+    road.push_back(glsl::vec2(x, y));
+    angle += crossroad(rng) == 0 ? math::pi / 2 : turn(rng);
+    double const len = step(rng);
+    x += len * cos(angle);
+    y += len * sin(angle);
+  }
+  return road;
+}
+
+bool IsEqual(float a, float b)
+{
+  return my::AlmostEqualULPs(a, b, 4);
+}
+
+void TestSameAsScalar(vector<glsl::vec2> const & points, float halfWidth)
+{
+  size_t const count = points.size() - 1;
+  vector<glsl::vec2> tangents(count), normals(count), refTangents(count), refNormals(count);
+  vector<float> lengths(count), refLengths(count);
+
+  df::CalculateLineSegments(points.data(), points.size(), halfWidth,
+                            tangents.data(), normals.data(), lengths.data());
+  df::CalculateLineSegmentsScalar(points.data(), points.size(), halfWidth,
+                                  refTangents.data(), refNormals.data(), refLengths.data());
+
+  for (size_t i = 0; i < count; ++i)
+  {
+    TEST(IsEqual(tangents[i].x, refTangents[i].x) && IsEqual(tangents[i].y, refTangents[i].y),
+         (points.size(), i));
+    TEST(IsEqual(normals[i].x, refNormals[i].x) && IsEqual(normals[i].y, refNormals[i].y),
+         (points.size(), i));
+    TEST(IsEqual(lengths[i], refLengths[i]), (points.size(), i, lengths[i], refLengths[i]));
+  }
+}
+
+vector<m2::PointD> ToPath(vector<glsl::vec2> const & points)
+{
+  vector<m2::PointD> path;
+  path.reserve(points.size());
+  for (auto const & p : points)
+    path.push_back(m2::PointD(p.x, p.y));
+  return path;
+}
+
+df::LineViewParams MakeLineParams(dp::LineJoin join, bool isSolid)
+{
+  df::LineViewParams params;
+  params.m_depth = 0.0f;
+  params.m_color = dp::Color(255, 255, 255, 255);
+  params.m_width = 10.0f;
+  params.m_cap = dp::RoundCap;
+  params.m_join = join;
+  // Pixels in a mercator unit at zoom 17.
+  params.m_baseGtoPScale = 1.0e5f;
+  if (!isSolid)
+    params.m_pattern = buffer_vector<uint8_t, 8>({ 6, 4 });
+  return params;
+}
+
+df::LineStipple MakeStipple(bool isSolid)
+{
+  df::LineStipple stipple;
+  stipple.m_texRect = m2::RectF(0.0f, 0.0f, 0.25f, 0.01f);
+  stipple.m_isSolid = isSolid;
+  if (!isSolid)
+  {
+    // Pattern is repeated in the mask as StipplePenRasterizator does.
+    stipple.m_maskLength = 250.0f;
+    stipple.m_patternLength = 10.0f;
+  }
+  return stipple;
+}
+
+} // namespace
+
+UNIT_TEST(LineTessellation_Simple)
+{
+  vector<glsl::vec2> const points = { glsl::vec2(0, 0), glsl::vec2(3, 4), glsl::vec2(3, 0),
+                                      glsl::vec2(3, -2), glsl::vec2(1, -2), glsl::vec2(1, -1) };
+  size_t const count = points.size() - 1;
+  vector<glsl::vec2> tangents(count), normals(count);
+  vector<float> lengths(count);
+  df::CalculateLineSegments(points.data(), points.size(), 2.0f,
+                            tangents.data(), normals.data(), lengths.data());
+
+  TEST_ALMOST_EQUAL_ULPS(lengths[0], 5.0f, ());
+  TEST_ALMOST_EQUAL_ULPS(tangents[0].x, 0.6f, ());
+  TEST_ALMOST_EQUAL_ULPS(tangents[0].y, 0.8f, ());
+  TEST_ALMOST_EQUAL_ULPS(normals[0].x, 1.6f, ());
+  TEST_ALMOST_EQUAL_ULPS(normals[0].y, -1.2f, ());
+
+  TEST_EQUAL(lengths[1], 4.0f, ());
+  TEST_EQUAL(glsl::ToPoint(tangents[1]), m2::PointF(0.0f, -1.0f), ());
+  TEST_EQUAL(glsl::ToPoint(normals[1]), m2::PointF(-2.0f, 0.0f), ());
+
+  TEST_EQUAL(lengths[3], 2.0f, ());
+  TEST_EQUAL(glsl::ToPoint(tangents[3]), m2::PointF(-1.0f, 0.0f), ());
+  TEST_EQUAL(glsl::ToPoint(normals[3]), m2::PointF(0.0f, 2.0f), ());
+
+  // The tail after SIMD lanes.
+  TEST_EQUAL(lengths[4], 1.0f, ());
+  TEST_EQUAL(glsl::ToPoint(tangents[4]), m2::PointF(0.0f, 1.0f), ());
+  TEST_EQUAL(glsl::ToPoint(normals[4]), m2::PointF(2.0f, 0.0f), ());
+}
+
+UNIT_TEST(LineTessellation_SameAsScalar)
+{
+  // All tails of SIMD lanes.
+  for (size_t pointsCount = 2; pointsCount < 20; ++pointsCount)
+    TestSameAsScalar(MakeRoad(pointsCount, pointsCount), 5.0f);
+
+  TestSameAsScalar(MakeRoad(1000, 42), 0.5f);
+  TestSameAsScalar(MakeRoad(1001, 43), 12.0f);
+}
+
+UNIT_TEST(LineTessellation_DegenerateSegments)
+{
+  vector<glsl::vec2> const points = { glsl::vec2(1, 1), glsl::vec2(1, 1), glsl::vec2(4, 5),
+                                      glsl::vec2(4, 5), glsl::vec2(4, 5), glsl::vec2(4, 6) };
+  size_t const count = points.size() - 1;
+  vector<glsl::vec2> tangents(count), normals(count);
+  vector<float> lengths(count);
+  df::CalculateLineSegments(points.data(), points.size(), 1.0f,
+                            tangents.data(), normals.data(), lengths.data());
+
+  vector<float> const expected = { 0.0f, 5.0f, 0.0f, 0.0f, 1.0f };
+  for (size_t i = 0; i < count; ++i)
+    TEST(IsEqual(lengths[i], expected[i]), (i, lengths[i]));
+}
+
+UNIT_TEST(LineTessellation_SameVertexesAsScalar)
+{
+  dp::GeometryArena arena;
+  for (dp::LineJoin join : { dp::MiterJoin, dp::BevelJoin, dp::RoundJoin })
+  {
+    for (bool isSolid : { true, false })
+    {
+      df::LineViewParams const params = MakeLineParams(join, isSolid);
+      df::LineStipple const stipple = MakeStipple(isSolid);
+      vector<m2::PointD> const path = ToPath(MakeRoad(101, 7));
+
+      dp::GeometryArena::Scope scope(arena);
+      dp::ArenaVector<gpu::LineVertex> geometry(arena), refGeometry(arena);
+      df::TessellateLine(path, params, glsl::vec2(0.5f, 0.5f), stipple, arena, geometry);
+      df::TessellateLine(path, params, glsl::vec2(0.5f, 0.5f), stipple, arena, refGeometry,
+                         &df::CalculateLineSegmentsScalar);
+
+      TEST_EQUAL(geometry.size(), refGeometry.size(), (join, isSolid));
+      TEST_GREATER(geometry.size(), 8 * (path.size() - 1), (join, isSolid));
+      for (size_t i = 0; i < geometry.size(); ++i)
+      {
+        gpu::LineVertex const & v = geometry[i];
+        gpu::LineVertex const & ref = refGeometry[i];
+        TEST(IsEqual(v.m_position.x, ref.m_position.x) && IsEqual(v.m_position.y, ref.m_position.y),
+             (join, isSolid, i));
+        TEST(fabs(v.m_normal.x - ref.m_normal.x) < 1e-4 && fabs(v.m_normal.y - ref.m_normal.y) < 1e-4,
+             (join, isSolid, i));
+        TEST(fabs(v.m_maskTexCoord.x - ref.m_maskTexCoord.x) < 1e-4, (join, isSolid, i));
+      }
+    }
+  }
+}
+
+BENCHMARK_TEST(LineTessellationSegmentsPerSecond)
+{
+  size_t const kRoadsCount = 1000;
+  size_t const kRepeatCount = 50;
+
+  // City tile at high zoom: many roads from a dozen to a few hundred points.
+  vector<vector<glsl::vec2>> roads;
+  size_t segmentsCount = 0;
+  for (size_t i = 0; i < kRoadsCount; ++i)
+  {
+    roads.push_back(MakeRoad(12 + (i * 37) % 300, i));
+    segmentsCount += roads.back().size() - 1;
+  }
+
+  vector<glsl::vec2> tangents(segmentsCount), normals(segmentsCount);
+  vector<float> lengths(segmentsCount);
+
+  auto const run = [&](decltype(&df::CalculateLineSegments) fn)
+  {
+    my::Timer timer;
+    for (size_t k = 0; k < kRepeatCount; ++k)
+    {
+      for (auto const & road : roads)
+        fn(road.data(), road.size(), 5.0f, tangents.data(), normals.data(), lengths.data());
+    }
+    return kRepeatCount * segmentsCount / timer.ElapsedSeconds();
+  };
+
+  double const scalar = run(&df::CalculateLineSegmentsScalar);
+  double const simd = run(&df::CalculateLineSegments);
+  LOG(LINFO, ("Segments per second, scalar:", scalar, "simd:", simd, "speedup:", simd / scalar));
+}
+
+BENCHMARK_TEST(LineShapeVertexesPerSecond)
+{
+  size_t const kRoadsCount = 1000;
+  size_t const kRepeatCount = 10;
+
+  vector<vector<m2::PointD>> roads;
+  for (size_t i = 0; i < kRoadsCount; ++i)
+    roads.push_back(ToPath(MakeRoad(12 + (i * 37) % 300, i)));
+
+  // The whole LineShape::Draw without texture lookups and insertion into the batcher.
+  dp::GeometryArena arena;
+  auto const run = [&](df::LineViewParams const & params, df::LineStipple const & stipple,
+                       df::TCalculateLineSegmentsFn fn)
+  {
+    size_t vertexesCount = 0;
+    my::Timer timer;
+    for (size_t k = 0; k < kRepeatCount; ++k)
+    {
+      for (auto const & road : roads)
+      {
+        dp::GeometryArena::Scope scope(arena);
+        dp::ArenaVector<gpu::LineVertex> geometry(arena, 8 * road.size());
+        df::TessellateLine(road, params, glsl::vec2(0.5f, 0.5f), stipple, arena, geometry, fn);
+        vertexesCount += geometry.size();
+      }
+    }
+    return vertexesCount / timer.ElapsedSeconds();
+  };
+
+  for (bool isSolid : { true, false })
+  {
+    df::LineViewParams const params = MakeLineParams(dp::RoundJoin, isSolid);
+    df::LineStipple const stipple = MakeStipple(isSolid);
+    double const scalar = run(params, stipple, &df::CalculateLineSegmentsScalar);
+    double const simd = run(params, stipple, &df::CalculateLineSegments);
+    LOG(LINFO, ("LineShape vertexes per second, solid:", isSolid, "scalar:", scalar,
+                "simd:", simd, "speedup:", simd / scalar));
+  }
+}
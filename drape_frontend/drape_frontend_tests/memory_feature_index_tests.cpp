@@ -5,10 +5,15 @@
 #include "base/thread.hpp"
 #include "base/thread_pool.hpp"
 #include "base/condition.hpp"
+#include "base/logging.hpp"
+#include "base/timer.hpp"
 
 #include "std/vector.hpp"
 #include "std/set.hpp"
 #include "std/bind.hpp"
+#include "std/atomic.hpp"
+#include "std/shared_ptr.hpp"
+#include "std/thread.hpp"
 
 #include <cstdlib>
 #include <ctime>
@@ -213,3 +218,144 @@ UNIT_TEST(MemoryFeatureIndex_MT_Test)
 
   TEST_EQUAL(allFeatures.size(), readedFeatures.size(), ());
 }
+
+namespace
+{
+  /// Tiles of a row share half of their features with neighbours, as tiles do on a screen.
+  void GenerateTiles(size_t tilesCount, size_t featuresPerTile, vector<MwmSet::MwmId> const & mwms,
+                     vector<vector<df::FeatureInfo> > & tiles)
+  {
+    tiles.resize(tilesCount);
+    for (size_t t = 0; t < tilesCount; ++t)
+    {
+      MwmSet::MwmId const & mwm = mwms[t % mwms.size()];
+      uint32_t const first = static_cast<uint32_t>(t * featuresPerTile / 2);
+      for (uint32_t i = 0; i < featuresPerTile; ++i)
+        tiles[t].push_back(df::FeatureInfo(FeatureID(mwm, first + i)));
+    }
+  }
+
+  vector<MwmSet::MwmId> MakeMwms(size_t count)
+  {
+    vector<MwmSet::MwmId> mwms;
+    for (size_t i = 0; i < count; ++i)
+      mwms.push_back(MwmSet::MwmId(make_shared<MwmInfo>()));
+    return mwms;
+  }
+
+  /// Every thread reads and removes its own tiles again and again.
+  double ReadAndRemove(df::MemoryFeatureIndex & index, vector<vector<df::FeatureInfo> > & tiles,
+                       size_t threadsCount, size_t iterations)
+  {
+    my::Timer timer;
+    vector<thread> threads;
+    for (size_t t = 0; t < threadsCount; ++t)
+    {
+      threads.emplace_back([&index, &tiles, t, threadsCount, iterations]()
+      {
+        for (size_t it = 0; it < iterations; ++it)
+        {
+          for (size_t i = t; i < tiles.size(); i += threadsCount)
+          {
+            vector<size_t> result;
+            index.ReadFeaturesRequest(tiles[i], result);
+            index.RemoveFeatures(tiles[i]);
+          }
+        }
+      });
+    }
+    for (auto & t : threads)
+      t.join();
+    return timer.ElapsedSeconds();
+  }
+}
+
+UNIT_TEST(MemoryFeatureIndex_ConcurrentStressTest)
+{
+  size_t const kThreadsCount = 8;
+  vector<vector<df::FeatureInfo> > tiles;
+  GenerateTiles(64, 2000, MakeMwms(3), tiles);
+
+  df::MemoryFeatureIndex index;
+
+  // Threads read overlapping tiles at the same time, every feature has exactly one owner.
+  vector<thread> threads;
+  for (size_t t = 0; t < kThreadsCount; ++t)
+  {
+    threads.emplace_back([&index, &tiles, t, kThreadsCount]()
+    {
+      for (size_t i = t; i < tiles.size(); i += kThreadsCount)
+      {
+        vector<size_t> result;
+        index.ReadFeaturesRequest(tiles[i], result);
+        TEST(is_sorted(result.begin(), result.end()), ());
+        for (size_t j : result)
+          TEST(tiles[i][j].m_isOwner, ());
+      }
+    });
+  }
+  for (auto & t : threads)
+    t.join();
+
+  set<FeatureID> allFeatures;
+  set<FeatureID> readedFeatures;
+  for (auto const & tile : tiles)
+  {
+    for (auto const & info : tile)
+    {
+      allFeatures.insert(info.m_id);
+      if (info.m_isOwner)
+        TEST(readedFeatures.insert(info.m_id).second, (info.m_id));
+    }
+  }
+  TEST_EQUAL(allFeatures.size(), readedFeatures.size(), ());
+
+  // Removing of odd tiles makes their features free for even tiles.
+  threads.clear();
+  for (size_t t = 0; t < kThreadsCount; ++t)
+  {
+    threads.emplace_back([&index, &tiles, t, kThreadsCount]()
+    {
+      for (size_t i = 2 * t + 1; i < tiles.size(); i += 2 * kThreadsCount)
+        index.RemoveFeatures(tiles[i]);
+    });
+  }
+  for (auto & t : threads)
+    t.join();
+
+  for (size_t i = 0; i < tiles.size(); i += 2)
+  {
+    vector<size_t> result;
+    index.ReadFeaturesRequest(tiles[i], result);
+    for (auto const & info : tiles[i])
+      TEST(info.m_isOwner, ());
+  }
+
+  // Concurrent reading and removing leaves the index empty.
+  for (size_t i = 0; i < tiles.size(); i += 2)
+    index.RemoveFeatures(tiles[i]);
+  ReadAndRemove(index, tiles, kThreadsCount, 5);
+  for (auto & tile : tiles)
+  {
+    vector<size_t> result;
+    index.ReadFeaturesRequest(tile, result);
+    TEST_EQUAL(result.size(), tile.size(), ());
+    index.RemoveFeatures(tile);
+  }
+}
+
+UNIT_TEST(MemoryFeatureIndex_Scaling)
+{
+  vector<vector<df::FeatureInfo> > tiles;
+  GenerateTiles(64, 2000, MakeMwms(3), tiles);
+
+  size_t const kIterations = 5;
+  double const features = static_cast<double>(tiles.size() * tiles[0].size() * kIterations);
+  for (size_t threadsCount : {1, 2, 4, 8})
+  {
+    df::MemoryFeatureIndex index;
+    double const seconds = ReadAndRemove(index, tiles, threadsCount, kIterations);
+    LOG(LINFO, ("Threads:", threadsCount, "features read and removed per second:",
+                features / seconds));
+  }
+}
@@ -0,0 +1,240 @@
+#include "testing/testing.hpp"
+#include "testing/benchmark.hpp"
+
+#include "drape_frontend/message_queue.hpp"
+
+#include "base/logging.hpp"
+#include "base/timer.hpp"
+
+#include "std/algorithm.hpp"
+#include "std/atomic.hpp"
+#include "std/chrono.hpp"
+#include "std/thread.hpp"
+#include "std/vector.hpp"
+
+namespace
+{
+
+class TestMessage : public df::Message
+{
+public:
+  TestMessage(size_t producer, size_t index, atomic<size_t> * aliveCount = nullptr)
+    : m_producer(producer), m_index(index), m_pushTime(steady_clock::now()),
+      m_aliveCount(aliveCount)
+  {
+    SetType(Message::InvalidateRect);
+    if (m_aliveCount != nullptr)
+      ++(*m_aliveCount);
+  }
+
+  ~TestMessage()
+  {
+    if (m_aliveCount != nullptr)
+      --(*m_aliveCount);
+  }
+
+  size_t m_producer;
+  size_t m_index;
+  steady_clock::time_point m_pushTime;
+
+private:
+  atomic<size_t> * m_aliveCount;
+};
+
+void Push(df::MessageQueue & queue, size_t producer, size_t index)
+{
+  queue.PushMessage(dp::MovePointer<df::Message>(new TestMessage(producer, index)));
+}
+
+/// Pops messages of all producers and checks that messages of every producer keep their order.
+void PopAndCheckOrder(df::MessageQueue & queue, size_t producersCount, size_t messagesCount)
+{
+  vector<size_t> nextIndex(producersCount, 0);
+  size_t popped = 0;
+  while (popped < producersCount * messagesCount)
+  {
+    df::MessageQueue::TMessages messages;
+    popped += queue.PopMessages(100, 32, messages);
+    for (dp::MasterPointer<df::Message> & message : messages)
+    {
+      TestMessage * m = static_cast<TestMessage *>(message.GetRaw());
+      TEST_EQUAL(m->m_index, nextIndex[m->m_producer], (m->m_producer));
+      ++nextIndex[m->m_producer];
+      message.Destroy();
+    }
+  }
+}
+
+} // namespace
+
+UNIT_TEST(MessageQueue_SingleThread)
+{
+  df::MessageQueue queue(4);
+  for (size_t i = 0; i < 3; ++i)
+    Push(queue, 0, i);
+
+  for (size_t i = 0; i < 3; ++i)
+  {
+    dp::TransferPointer<df::Message> transfer = queue.PopMessage(0);
+    dp::MasterPointer<df::Message> message(transfer);
+    TEST(!message.IsNull(), ());
+    TEST_EQUAL(static_cast<TestMessage *>(message.GetRaw())->m_index, i, ());
+    message.Destroy();
+  }
+
+  dp::TransferPointer<df::Message> transfer = queue.PopMessage(0);
+  TEST(transfer.IsNull(), ());
+}
+
+UNIT_TEST(MessageQueue_OverflowKeepsOrder)
+{
+  // The ring of 8 cells overflows, messages go to the overflow list and back to the ring.
+  df::MessageQueue queue(8);
+  for (size_t i = 0; i < 20; ++i)
+    Push(queue, 0, i);
+  PopAndCheckOrder(queue, 1, 10);
+
+  for (size_t i = 20; i < 40; ++i)
+    Push(queue, 0, i);
+
+  df::MessageQueue::TMessages messages;
+  TEST_EQUAL(queue.PopMessages(0, 100, messages), 20, ());
+  for (size_t i = 0; i < messages.size(); ++i)
+  {
+    TEST_EQUAL(static_cast<TestMessage *>(messages[i].GetRaw())->m_index, 20 + i, ());
+    messages[i].Destroy();
+  }
+}
+
+UNIT_TEST(MessageQueue_ManyProducers)
+{
+  size_t const kProducersCount = 4;
+  size_t const kMessagesCount = 20000;
+
+  // The small ring overflows under load.
+  df::MessageQueue queue(64);
+  vector<thread> producers;
+  for (size_t p = 0; p < kProducersCount; ++p)
+  {
+    producers.emplace_back([&queue, p]()
+    {
+      for (size_t i = 0; i < kMessagesCount; ++i)
+        Push(queue, p, i);
+    });
+  }
+
+  PopAndCheckOrder(queue, kProducersCount, kMessagesCount);
+  for (auto & producer : producers)
+    producer.join();
+}
+
+UNIT_TEST(MessageQueue_CancelWait)
+{
+  df::MessageQueue queue;
+  thread canceller([&queue]()
+  {
+    this_thread::sleep_for(milliseconds(20));
+    queue.CancelWait();
+  });
+
+  // Infinite waiting is interrupted.
+  dp::TransferPointer<df::Message> transfer = queue.PopMessage(-1);
+  TEST(transfer.IsNull(), ());
+  canceller.join();
+}
+
+UNIT_TEST(MessageQueue_ClearQuery)
+{
+  atomic<size_t> aliveCount(0);
+  {
+    df::MessageQueue queue(4);
+    for (size_t i = 0; i < 10; ++i)
+      queue.PushMessage(dp::MovePointer<df::Message>(new TestMessage(0, i, &aliveCount)));
+    TEST_EQUAL(aliveCount, 10, ());
+
+    queue.ClearQuery();
+    TEST_EQUAL(aliveCount, 0, ());
+
+    for (size_t i = 0; i < 3; ++i)
+      queue.PushMessage(dp::MovePointer<df::Message>(new TestMessage(0, i, &aliveCount)));
+  }
+  TEST_EQUAL(aliveCount, 0, ());
+}
+
+BENCHMARK_TEST(MessageQueueThroughput)
+{
+  size_t const kMessagesCount = 200000;
+
+  for (size_t producersCount : {1, 2, 4})
+  {
+    df::MessageQueue queue;
+    vector<double> latencies;
+    latencies.reserve(producersCount * kMessagesCount);
+
+    my::Timer timer;
+    vector<thread> producers;
+    for (size_t p = 0; p < producersCount; ++p)
+    {
+      producers.emplace_back([&queue, p]()
+      {
+        for (size_t i = 0; i < kMessagesCount; ++i)
+          Push(queue, p, i);
+      });
+    }
+
+    while (latencies.size() < producersCount * kMessagesCount)
+    {
+      df::MessageQueue::TMessages messages;
+      queue.PopMessages(100, 64, messages);
+      steady_clock::time_point const now = steady_clock::now();
+      for (dp::MasterPointer<df::Message> & message : messages)
+      {
+        TestMessage * m = static_cast<TestMessage *>(message.GetRaw());
+        latencies.push_back(duration_cast<duration<double, std::micro>>(now - m->m_pushTime).count());
+        message.Destroy();
+      }
+    }
+    double const seconds = timer.ElapsedSeconds();
+    for (auto & producer : producers)
+      producer.join();
+
+    sort(latencies.begin(), latencies.end());
+    LOG(LINFO, ("Producers:", producersCount, "messages per second:", latencies.size() / seconds,
+                "latency under load median, us:", latencies[latencies.size() / 2],
+                "99%, us:", latencies[latencies.size() * 99 / 100]));
+  }
+}
+
+BENCHMARK_TEST(MessageQueueWakeUpLatency)
+{
+  size_t const kMessagesCount = 1000;
+
+  // Messages come one by one to the sleeping consumer as tiles are read.
+  df::MessageQueue queue;
+  thread producer([&queue]()
+  {
+    for (size_t i = 0; i < kMessagesCount; ++i)
+    {
+      this_thread::sleep_for(microseconds(200));
+      Push(queue, 0, i);
+    }
+  });
+
+  vector<double> latencies;
+  while (latencies.size() < kMessagesCount)
+  {
+    dp::TransferPointer<df::Message> transfer = queue.PopMessage(100);
+    dp::MasterPointer<df::Message> message(transfer);
+    if (message.IsNull())
+      continue;
+    TestMessage * m = static_cast<TestMessage *>(message.GetRaw());
+    latencies.push_back(
+        duration_cast<duration<double, std::micro>>(steady_clock::now() - m->m_pushTime).count());
+    message.Destroy();
+  }
+  producer.join();
+
+  sort(latencies.begin(), latencies.end());
+  LOG(LINFO, ("Wake up latency median, us:", latencies[latencies.size() / 2],
+              "99%, us:", latencies[latencies.size() * 99 / 100]));
+}
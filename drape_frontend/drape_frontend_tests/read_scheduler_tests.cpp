@@ -0,0 +1,273 @@
+#include "testing/testing.hpp"
+
+#include "drape_frontend/read_scheduler.hpp"
+
+#include "base/thread.hpp"
+
+#include "std/chrono.hpp"
+#include "std/condition_variable.hpp"
+#include "std/algorithm.hpp"
+#include "std/mutex.hpp"
+#include "std/unique_ptr.hpp"
+#include "std/thread.hpp"
+#include "std/vector.hpp"
+
+namespace
+{
+
+class TestTask : public threads::IRoutine
+{
+public:
+  TestTask(int id, vector<int> & order, mutex & orderMutex)
+    : m_id(id), m_order(order), m_orderMutex(orderMutex)
+  {
+  }
+
+  void Do() override
+  {
+    lock_guard<mutex> lock(m_orderMutex);
+    m_order.push_back(m_id);
+  }
+
+private:
+  int m_id;
+  vector<int> & m_order;
+  mutex & m_orderMutex;
+};
+
+/// Blocks a worker until it's opened.
+class GateTask : public threads::IRoutine
+{
+public:
+  void Do() override
+  {
+    unique_lock<mutex> lock(m_mutex);
+    m_started = true;
+    m_cv.notify_all();
+    m_cv.wait(lock, [this]() { return m_opened; });
+  }
+
+  void WaitStarted()
+  {
+    unique_lock<mutex> lock(m_mutex);
+    m_cv.wait(lock, [this]() { return m_started; });
+  }
+
+  void Open()
+  {
+    lock_guard<mutex> lock(m_mutex);
+    m_opened = true;
+    m_cv.notify_all();
+  }
+
+private:
+  mutex m_mutex;
+  condition_variable m_cv;
+  bool m_started = false;
+  bool m_opened = false;
+};
+
+class FinishCounter
+{
+public:
+  void operator()(threads::IRoutine *)
+  {
+    lock_guard<mutex> lock(m_mutex);
+    ++m_count;
+    m_cv.notify_all();
+  }
+
+  void Wait(size_t count)
+  {
+    unique_lock<mutex> lock(m_mutex);
+    m_cv.wait(lock, [this, count]() { return m_count >= count; });
+  }
+
+private:
+  mutex m_mutex;
+  condition_variable m_cv;
+  size_t m_count = 0;
+};
+
+} // namespace
+
+UNIT_TEST(ReadScheduler_PriorityOrder)
+{
+  FinishCounter counter;
+  df::ReadScheduler scheduler(1, ref(counter));
+
+  df::TileKey const center(0, 0, 10);
+  scheduler.SetViewport(center.GetGlobalRect().Center(), 10);
+
+  GateTask gate;
+  scheduler.Push(center, &gate);
+  gate.WaitStarted();
+
+  vector<int> order;
+  mutex orderMutex;
+  vector<unique_ptr<TestTask>> tasks;
+  vector<df::TileKey> const keys = { df::TileKey(5, 5, 10), df::TileKey(0, 0, 9),
+                                     df::TileKey(1, 0, 10), df::TileKey(0, 0, 10),
+                                     df::TileKey(-3, 2, 10), df::TileKey(0, 0, 12) };
+  for (size_t i = 0; i < keys.size(); ++i)
+  {
+    tasks.emplace_back(new TestTask(static_cast<int>(i), order, orderMutex));
+    scheduler.Push(keys[i], tasks.back().get());
+  }
+
+  gate.Open();
+  counter.Wait(keys.size() + 1);
+  scheduler.Stop();
+
+  vector<int> const expected = { 3, 2, 4, 0, 1, 5 };
+  TEST_EQUAL(order, expected, ());
+}
+
+UNIT_TEST(ReadScheduler_FollowsViewport)
+{
+  FinishCounter counter;
+  df::ReadScheduler scheduler(1, ref(counter));
+
+  GateTask gate;
+  scheduler.Push(df::TileKey(0, 0, 10), &gate);
+  gate.WaitStarted();
+
+  vector<int> order;
+  mutex orderMutex;
+  TestTask task0(0, order, orderMutex);
+  TestTask task1(1, order, orderMutex);
+  scheduler.Push(df::TileKey(0, 0, 10), &task0);
+  scheduler.Push(df::TileKey(10, 10, 10), &task1);
+
+  // Queued tasks are reordered without pushing them again.
+  scheduler.SetViewport(df::TileKey(10, 10, 10).GetGlobalRect().Center(), 10);
+
+  gate.Open();
+  counter.Wait(3);
+  scheduler.Stop();
+
+  vector<int> const expected = { 1, 0 };
+  TEST_EQUAL(order, expected, ());
+}
+
+UNIT_TEST(ReadScheduler_Cancel)
+{
+  FinishCounter counter;
+  df::ReadScheduler scheduler(1, ref(counter));
+
+  GateTask gate;
+  scheduler.Push(df::TileKey(0, 0, 10), &gate);
+  gate.WaitStarted();
+
+  vector<int> order;
+  mutex orderMutex;
+  vector<unique_ptr<TestTask>> tasks;
+  for (int i = 0; i < 10; ++i)
+  {
+    tasks.emplace_back(new TestTask(i, order, orderMutex));
+    scheduler.Push(df::TileKey(i, 0, 10), tasks.back().get());
+  }
+
+  scheduler.Cancel([](df::TileKey const & key) { return key.m_x % 2 == 1; });
+
+  gate.Open();
+  counter.Wait(tasks.size() + 1);
+  scheduler.Stop();
+
+  TEST_EQUAL(order.size(), 5, ());
+  for (int id : order)
+    TEST_EQUAL(id % 2, 0, (id));
+
+  df::ReadScheduler::Metrics const metrics = scheduler.GetMetrics();
+  TEST_EQUAL(metrics.m_tasksCount, tasks.size() + 1, ());
+  TEST_EQUAL(metrics.m_cancelledCount, 5, ());
+}
+
+UNIT_TEST(ReadScheduler_Metrics)
+{
+  FinishCounter counter;
+  df::ReadScheduler scheduler(1, ref(counter));
+
+  mutex metricsMutex;
+  vector<df::ReadScheduler::TaskMetrics> taskMetrics;
+  scheduler.SetMetricsFn([&](df::ReadScheduler::TaskMetrics const & m)
+  {
+    lock_guard<mutex> lock(metricsMutex);
+    taskMetrics.push_back(m);
+  });
+
+  GateTask gate;
+  scheduler.Push(df::TileKey(0, 0, 10), &gate);
+  gate.WaitStarted();
+
+  vector<int> order;
+  mutex orderMutex;
+  TestTask task(0, order, orderMutex);
+  scheduler.Push(df::TileKey(1, 1, 10), &task);
+
+  this_thread::sleep_for(milliseconds(50));
+  gate.Open();
+  counter.Wait(2);
+  scheduler.Stop();
+
+  TEST_EQUAL(taskMetrics.size(), 2, ());
+  // The gate was read for at least the time the task was queued.
+  TEST_GREATER_OR_EQUAL(taskMetrics[0].m_readSeconds, 0.05, ());
+  TEST_GREATER_OR_EQUAL(taskMetrics[1].m_queueSeconds, 0.05, ());
+  TEST(taskMetrics[1].m_tileKey == df::TileKey(1, 1, 10), ());
+  TEST(!taskMetrics[1].m_cancelled, ());
+
+  df::ReadScheduler::Metrics const metrics = scheduler.GetMetrics();
+  TEST_EQUAL(metrics.m_tasksCount, 2, ());
+  TEST_GREATER_OR_EQUAL(metrics.m_maxQueueSeconds, 0.05, ());
+  TEST_GREATER_OR_EQUAL(metrics.m_totalReadSeconds, 0.05, ());
+}
+
+UNIT_TEST(ReadScheduler_ManyWorkers)
+{
+  size_t const kTasksCount = 1000;
+
+  FinishCounter counter;
+  df::ReadScheduler scheduler(4, ref(counter));
+
+  vector<int> order;
+  mutex orderMutex;
+  vector<unique_ptr<TestTask>> tasks;
+  for (size_t i = 0; i < kTasksCount; ++i)
+  {
+    int const id = static_cast<int>(i);
+    tasks.emplace_back(new TestTask(id, order, orderMutex));
+    scheduler.Push(df::TileKey(id % 32, id / 32, 10), tasks.back().get());
+  }
+
+  counter.Wait(kTasksCount);
+  scheduler.Stop();
+
+  TEST_EQUAL(order.size(), kTasksCount, ());
+  sort(order.begin(), order.end());
+  for (size_t i = 0; i < kTasksCount; ++i)
+    TEST_EQUAL(order[i], static_cast<int>(i), ());
+  TEST_EQUAL(scheduler.GetMetrics().m_tasksCount, kTasksCount, ());
+}
+
+UNIT_TEST(ReadScheduler_StopFinishesQueuedTasks)
+{
+  FinishCounter counter;
+  df::ReadScheduler scheduler(1, ref(counter));
+
+  GateTask gate;
+  scheduler.Push(df::TileKey(0, 0, 10), &gate);
+  gate.WaitStarted();
+
+  vector<int> order;
+  mutex orderMutex;
+  TestTask task(0, order, orderMutex);
+  scheduler.Push(df::TileKey(1, 1, 10), &task);
+
+  thread opener([&gate]() { gate.Open(); });
+  scheduler.Stop();
+  opener.join();
+
+  counter.Wait(2);
+  TEST(task.IsCancelled(), ());
+}
@@ -0,0 +1,193 @@
+#include "testing/testing.hpp"
+#include "testing/benchmark.hpp"
+
+#include "drape_frontend/fribidi.hpp"
+#include "drape_frontend/shaped_text_cache.hpp"
+
+#include "base/logging.hpp"
+#include "base/timer.hpp"
+
+#include "std/atomic.hpp"
+#include "std/thread.hpp"
+#include "std/vector.hpp"
+
+using namespace df;
+
+namespace
+{
+
+/// Shaping without textures: bidi reordering and one empty glyph per character.
+class TestShaper
+{
+public:
+  TestShaper(strings::UniString const & text, atomic<size_t> & shapedCount)
+    : m_text(text), m_shapedCount(shapedCount)
+  {
+  }
+
+  void operator()(ShapedText & result) const
+  {
+    ++m_shapedCount;
+    strings::UniString const visibleText = fribidi::log2vis(m_text);
+    result.m_glyphs.resize(visibleText.size());
+    result.m_delimIndexes.push_back(visibleText.size());
+  }
+
+private:
+  strings::UniString const & m_text;
+  atomic<size_t> & m_shapedCount;
+};
+
+void GetShaped(ShapedTextCache & cache, string const & text, atomic<size_t> & shapedCount,
+               ShapedText & result)
+{
+  strings::UniString const uniText = strings::MakeUniString(text);
+  cache.Get(ShapedTextKey(uniText, false /* splitLines */), TestShaper(uniText, shapedCount), result);
+}
+
+} // namespace
+
+UNIT_TEST(ShapedTextCache_HitAndMiss)
+{
+  ShapedTextCache cache(8);
+  atomic<size_t> shapedCount(0);
+
+  ShapedText shaped;
+  GetShaped(cache, "Tverskaya", shapedCount, shaped);
+  TEST_EQUAL(shapedCount, 1, ());
+  TEST_EQUAL(shaped.m_glyphs.size(), 9, ());
+  TEST_EQUAL(shaped.m_delimIndexes.size(), 1, ());
+
+  ShapedText cached;
+  GetShaped(cache, "Tverskaya", shapedCount, cached);
+  TEST_EQUAL(shapedCount, 1, ());
+  TEST_EQUAL(cached.m_glyphs.size(), 9, ());
+  TEST_EQUAL(cached.m_delimIndexes, shaped.m_delimIndexes, ());
+
+  // The same text with other line splitting is another entry.
+  strings::UniString const text = strings::MakeUniString("Tverskaya");
+  cache.Get(ShapedTextKey(text, true /* splitLines */), TestShaper(text, shapedCount), cached);
+  TEST_EQUAL(shapedCount, 2, ());
+  TEST_EQUAL(cache.GetSize(), 2, ());
+
+  ShapedTextCache::Stats const stats = cache.GetStats();
+  TEST_EQUAL(stats.m_hitsCount, 1, ());
+  TEST_EQUAL(stats.m_missesCount, 2, ());
+  TEST_ALMOST_EQUAL_ULPS(stats.GetHitRate(), 1.0 / 3.0, ());
+
+  cache.Clear();
+  cache.ResetStats();
+  TEST_EQUAL(cache.GetSize(), 0, ());
+  TEST_EQUAL(cache.GetStats().m_hitsCount, 0, ());
+}
+
+UNIT_TEST(ShapedTextCache_EvictsLeastRecentlyUsed)
+{
+  ShapedTextCache cache(3);
+  atomic<size_t> shapedCount(0);
+  ShapedText shaped;
+
+  GetShaped(cache, "a", shapedCount, shaped);
+  GetShaped(cache, "b", shapedCount, shaped);
+  GetShaped(cache, "c", shapedCount, shaped);
+  // "a" becomes the most recently used, so "b" is evicted by "d".
+  GetShaped(cache, "a", shapedCount, shaped);
+  GetShaped(cache, "d", shapedCount, shaped);
+  TEST_EQUAL(shapedCount, 4, ());
+  TEST_EQUAL(cache.GetSize(), 3, ());
+
+  GetShaped(cache, "a", shapedCount, shaped);
+  GetShaped(cache, "c", shapedCount, shaped);
+  GetShaped(cache, "d", shapedCount, shaped);
+  TEST_EQUAL(shapedCount, 4, ());
+
+  GetShaped(cache, "b", shapedCount, shaped);
+  TEST_EQUAL(shapedCount, 5, ());
+  TEST_EQUAL(cache.GetSize(), 3, ());
+}
+
+UNIT_TEST(ShapedTextCache_ManyThreads)
+{
+  size_t const kThreadsCount = 4;
+  size_t const kNamesCount = 200;
+
+  ShapedTextCache cache(kNamesCount / 2);
+  atomic<size_t> shapedCount(0);
+
+  vector<thread> threads;
+  for (size_t t = 0; t < kThreadsCount; ++t)
+  {
+    threads.emplace_back([&cache, &shapedCount, t]()
+    {
+      ShapedText shaped;
+      for (size_t i = 0; i < 20 * kNamesCount; ++i)
+      {
+        string const name = "Street " + strings::to_string((i * 7 + t) % kNamesCount);
+        GetShaped(cache, name, shapedCount, shaped);
+        TEST_EQUAL(shaped.m_glyphs.size(), name.size(), ());
+      }
+    });
+  }
+
+  for (thread & t : threads)
+    t.join();
+
+  ShapedTextCache::Stats const stats = cache.GetStats();
+  TEST_EQUAL(stats.m_hitsCount + stats.m_missesCount, kThreadsCount * 20 * kNamesCount, ());
+  TEST_EQUAL(stats.m_missesCount, shapedCount, ());
+  TEST_LESS_OR_EQUAL(cache.GetSize(), kNamesCount / 2, ());
+}
+
+BENCHMARK_TEST(ShapedTextCachePanningCity)
+{
+  // City of 32x32 tiles, every tile has captions of its own buildings and
+  // names of streets which cross several tiles, as in the real map.
+  int const kCitySize = 32;
+  int const kViewportSize = 4;
+  int const kStreetLength = 6;
+
+  auto const tileNames = [&](int x, int y)
+  {
+    vector<string> names;
+    for (int i = 0; i < 20; ++i)
+      names.push_back(strings::to_string(x * 100 + i) + " " + strings::to_string(y) + " house");
+    for (int i = 0; i < 10; ++i)
+    {
+      names.push_back("Street " + strings::to_string(y * 10 + i) + " " +
+                      strings::to_string(x / kStreetLength));
+      names.push_back("Avenue " + strings::to_string(x * 10 + i) + " " +
+                      strings::to_string(y / kStreetLength));
+    }
+    names.push_back("\xD7\xA8\xD7\x97\xD7\x95\xD7\x91 " + strings::to_string(x + y)); // Hebrew, bidi.
+    return names;
+  };
+
+  ShapedTextCache cache(ShapedTextCache::kDefaultCapacity);
+  atomic<size_t> shapedCount(0);
+  ShapedText shaped;
+  size_t requestsCount = 0;
+
+  my::Timer timer;
+  // Pan through the city row by row, all tiles of the viewport are read on every step.
+  for (int viewY = 0; viewY + kViewportSize <= kCitySize; viewY += kViewportSize / 2)
+  {
+    for (int viewX = 0; viewX + kViewportSize <= kCitySize; ++viewX)
+    {
+      for (int y = viewY; y < viewY + kViewportSize; ++y)
+      {
+        for (int x = viewX; x < viewX + kViewportSize; ++x)
+        {
+          for (string const & name : tileNames(x, y))
+          {
+            GetShaped(cache, name, shapedCount, shaped);
+            ++requestsCount;
+          }
+        }
+      }
+    }
+  }
+
+  ShapedTextCache::Stats const stats = cache.GetStats();
+  TEST_EQUAL(stats.m_hitsCount + stats.m_missesCount, requestsCount, ());
+  LOG(LINFO, ("Panning of a city, requests:", requestsCount, "seconds:", timer.ElapsedSeconds(), stats));
+}
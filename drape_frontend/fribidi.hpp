@@ -7,7 +7,7 @@
 namespace fribidi
 {
 
-strings::UniString log2vis(strings::UniString const & str)
+inline strings::UniString log2vis(strings::UniString const & str)
 {
   size_t const count = str.size();
   if (count == 0)
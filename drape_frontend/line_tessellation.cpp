@@ -0,0 +1,413 @@
+#include "drape_frontend/line_tessellation.hpp"
+
+#include "drape/glsl_func.hpp"
+
+#include "base/assert.hpp"
+
+#include "std/cmath.hpp"
+
+#if defined(__SSE2__) || defined(_M_X64) || (defined(_M_IX86_FP) && _M_IX86_FP >= 2)
+#define DF_LINE_SSE2
+#include <emmintrin.h>
+#elif defined(__ARM_NEON__) || defined(__ARM_NEON)
+#define DF_LINE_NEON
+#include <arm_neon.h>
+#endif
+
+namespace df
+{
+
+namespace
+{
+
+static_assert(sizeof(glsl::vec2) == 2 * sizeof(float), "Points must be tightly packed.");
+
+size_t const kLanesCount = 4;
+
+float const SEGMENT = 0.0f;
+float const CAP = 1.0f;
+float const LEFT_WIDTH = 1.0f;
+float const RIGHT_WIDTH = -1.0f;
+size_t const TEX_BEG_IDX = 0;
+size_t const TEX_END_IDX = 1;
+
+struct TexDescription
+{
+  float m_globalLength;
+  glsl::vec2 m_texCoord;
+};
+
+class TextureCoordGenerator
+{
+public:
+  TextureCoordGenerator(float const baseGtoPScale, LineStipple const & stipple)
+    : m_baseGtoPScale(baseGtoPScale)
+    , m_basePtoGScale(1.0f / baseGtoPScale)
+    , m_stipple(stipple)
+  {
+  }
+
+  bool GetTexCoords(TexDescription & desc)
+  {
+    m2::RectF const & texRect = m_stipple.m_texRect;
+    if (m_stipple.m_isSolid)
+    {
+      desc.m_texCoord = glsl::ToVec2(texRect.Center());
+      return true;
+    }
+
+    float const pxLength = desc.m_globalLength * m_baseGtoPScale;
+    float const maskRest = m_stipple.m_maskLength - m_pxCursor;
+
+    if (maskRest < pxLength)
+    {
+      desc.m_globalLength = maskRest * m_basePtoGScale;
+      desc.m_texCoord = glsl::vec2(texRect.maxX(), texRect.Center().y);
+      return false;
+    }
+
+    float texX = texRect.minX() + ((m_pxCursor + pxLength) / m_stipple.m_maskLength) * texRect.SizeX();
+    m_pxCursor = fmodf(m_pxCursor + pxLength, m_stipple.m_patternLength);
+
+    desc.m_texCoord = glsl::vec2(texX, texRect.Center().y);
+    return true;
+  }
+
+private:
+  float const m_baseGtoPScale;
+  float const m_basePtoGScale;
+  LineStipple const & m_stipple;
+  float m_pxCursor = 0.0f;
+};
+
+void CalculateScalar(glsl::vec2 const * points, size_t from, size_t to, float halfWidth,
+                     glsl::vec2 * tangents, glsl::vec2 * leftNormals, float * lengths)
+{
+  for (size_t i = from; i < to; ++i)
+  {
+    glsl::vec2 const dir = points[i + 1] - points[i];
+    glsl::vec2 const tangent = glsl::normalize(dir);
+    tangents[i] = tangent;
+    leftNormals[i] = halfWidth * glsl::vec2(tangent.y, -tangent.x);
+    lengths[i] = glsl::length(dir);
+  }
+}
+
+#if defined(DF_LINE_SSE2)
+
+size_t CalculateSimd(glsl::vec2 const * points, size_t segmentsCount, float halfWidth,
+                     glsl::vec2 * tangents, glsl::vec2 * leftNormals, float * lengths)
+{
+  __m128 const hw = _mm_set1_ps(halfWidth);
+  __m128 const one = _mm_set1_ps(1.0f);
+  __m128 const signMask = _mm_set1_ps(-0.0f);
+
+  size_t i = 0;
+  for (; i + kLanesCount <= segmentsCount; i += kLanesCount)
+  {
+    float const * p = &points[i].x;
+
+    // x0 y0 x1 y1 | x2 y2 x3 y3 for start and end points of 4 segments.
+    __m128 const s01 = _mm_loadu_ps(p);
+    __m128 const s23 = _mm_loadu_ps(p + 4);
+    __m128 const e01 = _mm_loadu_ps(p + 2);
+    __m128 const e23 = _mm_loadu_ps(p + 6);
+
+    __m128 const dx = _mm_sub_ps(_mm_shuffle_ps(e01, e23, _MM_SHUFFLE(2, 0, 2, 0)),
+                                 _mm_shuffle_ps(s01, s23, _MM_SHUFFLE(2, 0, 2, 0)));
+    __m128 const dy = _mm_sub_ps(_mm_shuffle_ps(e01, e23, _MM_SHUFFLE(3, 1, 3, 1)),
+                                 _mm_shuffle_ps(s01, s23, _MM_SHUFFLE(3, 1, 3, 1)));
+
+    __m128 const len = _mm_sqrt_ps(_mm_add_ps(_mm_mul_ps(dx, dx), _mm_mul_ps(dy, dy)));
+    __m128 const invLen = _mm_div_ps(one, len);
+    __m128 const tx = _mm_mul_ps(dx, invLen);
+    __m128 const ty = _mm_mul_ps(dy, invLen);
+    __m128 const nx = _mm_mul_ps(hw, ty);
+    __m128 const ny = _mm_xor_ps(_mm_mul_ps(hw, tx), signMask);
+
+    float * t = &tangents[i].x;
+    _mm_storeu_ps(t, _mm_unpacklo_ps(tx, ty));
+    _mm_storeu_ps(t + 4, _mm_unpackhi_ps(tx, ty));
+
+    float * n = &leftNormals[i].x;
+    _mm_storeu_ps(n, _mm_unpacklo_ps(nx, ny));
+    _mm_storeu_ps(n + 4, _mm_unpackhi_ps(nx, ny));
+
+    _mm_storeu_ps(lengths + i, len);
+  }
+
+  return i;
+}
+
+#elif defined(DF_LINE_NEON)
+
+size_t CalculateSimd(glsl::vec2 const * points, size_t segmentsCount, float halfWidth,
+                     glsl::vec2 * tangents, glsl::vec2 * leftNormals, float * lengths)
+{
+  float32x4_t const hw = vdupq_n_f32(halfWidth);
+
+  size_t i = 0;
+  for (; i + kLanesCount <= segmentsCount; i += kLanesCount)
+  {
+    float const * p = &points[i].x;
+    float32x4x2_t const s = vld2q_f32(p);
+    float32x4x2_t const e = vld2q_f32(p + 2);
+
+    float32x4_t const dx = vsubq_f32(e.val[0], s.val[0]);
+    float32x4_t const dy = vsubq_f32(e.val[1], s.val[1]);
+    float32x4_t const lenSq = vaddq_f32(vmulq_f32(dx, dx), vmulq_f32(dy, dy));
+
+#if defined(__aarch64__)
+    float32x4_t const len = vsqrtq_f32(lenSq);
+    float32x4_t const invLen = vdivq_f32(vdupq_n_f32(1.0f), len);
+#else
+    // ARMv7 has no vector sqrt and division, refine the estimation of 1 / sqrt twice.
+    float32x4_t invLen = vrsqrteq_f32(lenSq);
+    invLen = vmulq_f32(invLen, vrsqrtsq_f32(vmulq_f32(lenSq, invLen), invLen));
+    invLen = vmulq_f32(invLen, vrsqrtsq_f32(vmulq_f32(lenSq, invLen), invLen));
+    // The estimation of 1 / sqrt(0) is infinity, length of a degenerate segment must be 0.
+    float32x4_t const len = vbslq_f32(vceqq_f32(lenSq, vdupq_n_f32(0.0f)), lenSq,
+                                      vmulq_f32(lenSq, invLen));
+#endif
+
+    float32x4x2_t t;
+    t.val[0] = vmulq_f32(dx, invLen);
+    t.val[1] = vmulq_f32(dy, invLen);
+    vst2q_f32(&tangents[i].x, t);
+
+    float32x4x2_t n;
+    n.val[0] = vmulq_f32(hw, t.val[1]);
+    n.val[1] = vnegq_f32(vmulq_f32(hw, t.val[0]));
+    vst2q_f32(&leftNormals[i].x, n);
+
+    vst1q_f32(lengths + i, len);
+  }
+
+  return i;
+}
+
+#else
+
+size_t CalculateSimd(glsl::vec2 const *, size_t, float, glsl::vec2 *, glsl::vec2 *, float *)
+{
+  return 0;
+}
+
+#endif
+
+} // namespace
+
+void CalculateLineSegments(glsl::vec2 const * points, size_t pointsCount, float halfWidth,
+                           glsl::vec2 * tangents, glsl::vec2 * leftNormals, float * lengths)
+{
+  ASSERT_GREATER(pointsCount, 1, ());
+  size_t const segmentsCount = pointsCount - 1;
+  size_t const processed = CalculateSimd(points, segmentsCount, halfWidth,
+                                         tangents, leftNormals, lengths);
+  CalculateScalar(points, processed, segmentsCount, halfWidth, tangents, leftNormals, lengths);
+}
+
+void CalculateLineSegmentsScalar(glsl::vec2 const * points, size_t pointsCount, float halfWidth,
+                                 glsl::vec2 * tangents, glsl::vec2 * leftNormals, float * lengths)
+{
+  ASSERT_GREATER(pointsCount, 1, ());
+  CalculateScalar(points, 0, pointsCount - 1, halfWidth, tangents, leftNormals, lengths);
+}
+
+void TessellateLine(vector<m2::PointD> const & path, LineViewParams const & params,
+                    glsl::vec2 const & colorCoord, LineStipple const & stipple,
+                    dp::GeometryArena & arena, dp::ArenaVector<gpu::LineVertex> & geometry,
+                    TCalculateLineSegmentsFn calculateSegments)
+{
+  typedef gpu::LineVertex LV;
+  ASSERT_GREATER(path.size(), 1, ());
+
+  TextureCoordGenerator texCoordGen(params.m_baseGtoPScale, stipple);
+  float const halfWidth = params.m_width / 2.0f;
+  float const glbHalfWidth = halfWidth / params.m_baseGtoPScale;
+  bool generateCap = params.m_cap != dp::ButtCap;
+
+  // Tangents, normals and lengths of all segments are calculated at once before the
+  // sequential part with joins and stipple texture coordinates.
+  size_t const segmentsCount = path.size() - 1;
+  dp::ArenaVector<glsl::vec2> points(arena, path.size());
+  points.resize(path.size());
+  for (size_t i = 0; i < path.size(); ++i)
+    points[i] = glsl::ToVec2(path[i]);
+
+  dp::ArenaVector<glsl::vec2> tangents(arena, segmentsCount);
+  dp::ArenaVector<glsl::vec2> leftNormals(arena, segmentsCount);
+  dp::ArenaVector<float> lengths(arena, segmentsCount);
+  tangents.resize(segmentsCount);
+  leftNormals.resize(segmentsCount);
+  lengths.resize(segmentsCount);
+  calculateSegments(points.data(), points.size(), halfWidth,
+                    tangents.data(), leftNormals.data(), lengths.data());
+
+  float capType = params.m_cap == dp::RoundCap ? CAP : SEGMENT;
+
+  glsl::vec2 leftSegment(SEGMENT, LEFT_WIDTH);
+  glsl::vec2 rightSegment(SEGMENT, RIGHT_WIDTH);
+
+  TexDescription texCoords[2];
+
+  if (generateCap)
+  {
+    glsl::vec2 startPoint = points[0];
+    glsl::vec2 leftNormal = leftNormals[0];
+    glsl::vec2 rightNormal = -leftNormal;
+    glsl::vec2 tangent = -halfWidth * tangents[0];
+
+    glsl::vec3 pivot = glsl::vec3(startPoint, params.m_depth);
+    glsl::vec2 leftCap(capType, LEFT_WIDTH);
+    glsl::vec2 rightCap(capType, RIGHT_WIDTH);
+
+    texCoords[TEX_BEG_IDX].m_globalLength = 0.0;
+    texCoords[TEX_END_IDX].m_globalLength = glbHalfWidth;
+
+    VERIFY(texCoordGen.GetTexCoords(texCoords[TEX_BEG_IDX]), ());
+    VERIFY(texCoordGen.GetTexCoords(texCoords[TEX_END_IDX]), ());
+
+    geometry.push_back(LV(pivot, leftNormal + tangent, colorCoord, texCoords[TEX_BEG_IDX].m_texCoord, leftCap));
+    geometry.push_back(LV(pivot, rightNormal + tangent, colorCoord, texCoords[TEX_BEG_IDX].m_texCoord, rightCap));
+    geometry.push_back(LV(pivot, leftNormal, colorCoord, texCoords[TEX_END_IDX].m_texCoord, leftSegment));
+    geometry.push_back(LV(pivot, rightNormal, colorCoord, texCoords[TEX_END_IDX].m_texCoord, rightSegment));
+  }
+
+  glsl::vec2 prevPoint;
+  glsl::vec2 prevLeftNormal;
+  glsl::vec2 prevRightNormal;
+
+  for (size_t i = 1; i < path.size(); ++i)
+  {
+    glsl::vec2 startPoint = points[i - 1];
+    glsl::vec2 endPoint = points[i];
+    glsl::vec2 tangent = tangents[i - 1];
+    glsl::vec2 leftNormal = leftNormals[i - 1];
+    glsl::vec2 rightNormal = -leftNormal;
+
+    glsl::vec3 startPivot = glsl::vec3(startPoint, params.m_depth);
+    glsl::vec3 endPivot = glsl::vec3(endPoint, params.m_depth);
+
+    // Create join beetween current segment and previous
+    if (i > 1)
+    {
+      glsl::vec2 zeroNormal(0.0, 0.0);
+      glsl::vec2 prevForming, nextForming;
+      if (glsl::dot(prevLeftNormal, tangent) < 0)
+      {
+        prevForming = prevLeftNormal;
+        nextForming = leftNormal;
+      }
+      else
+      {
+        prevForming = prevRightNormal;
+        nextForming = rightNormal;
+      }
+
+      if (params.m_join == dp::BevelJoin)
+      {
+        texCoords[TEX_BEG_IDX].m_globalLength = 0.0f;
+        texCoords[TEX_END_IDX].m_globalLength = glsl::length(nextForming - prevForming) / params.m_baseGtoPScale;
+        VERIFY(texCoordGen.GetTexCoords(texCoords[TEX_BEG_IDX]), ());
+        VERIFY(texCoordGen.GetTexCoords(texCoords[TEX_END_IDX]), ());
+
+        geometry.push_back(LV(startPivot, prevForming, colorCoord, texCoords[TEX_BEG_IDX].m_texCoord, leftSegment));
+        geometry.push_back(LV(startPivot, zeroNormal, colorCoord, texCoords[TEX_BEG_IDX].m_texCoord, leftSegment));
+        geometry.push_back(LV(startPivot, nextForming, colorCoord, texCoords[TEX_END_IDX].m_texCoord, leftSegment));
+        geometry.push_back(LV(startPivot, nextForming, colorCoord, texCoords[TEX_END_IDX].m_texCoord, leftSegment));
+      }
+      else
+      {
+        glsl::vec2 middleForming = glsl::normalize(prevForming + nextForming);
+        glsl::vec2 zeroDxDy(0.0, 0.0);
+
+        texCoords[TEX_BEG_IDX].m_globalLength = 0.0f;
+        texCoords[TEX_END_IDX].m_globalLength = glsl::length(nextForming - prevForming) / params.m_baseGtoPScale;
+        TexDescription middle;
+        middle.m_globalLength = texCoords[TEX_END_IDX].m_globalLength / 2.0f;
+        VERIFY(texCoordGen.GetTexCoords(texCoords[TEX_BEG_IDX]), ());
+        VERIFY(texCoordGen.GetTexCoords(middle), ());
+        VERIFY(texCoordGen.GetTexCoords(texCoords[TEX_END_IDX]), ());
+
+        if (params.m_join == dp::MiterJoin)
+        {
+          float const b = glsl::length(prevForming - nextForming) / 2.0;
+          float const a = glsl::length(prevForming);
+          middleForming *= static_cast<float>(sqrt(a * a + b * b));
+
+          geometry.push_back(LV(startPivot, prevForming, colorCoord, texCoords[TEX_BEG_IDX].m_texCoord, zeroDxDy));
+          geometry.push_back(LV(startPivot, zeroNormal, colorCoord, texCoords[TEX_BEG_IDX].m_texCoord, zeroDxDy));
+          geometry.push_back(LV(startPivot, middleForming, colorCoord, middle.m_texCoord, zeroDxDy));
+          geometry.push_back(LV(startPivot, nextForming, colorCoord, texCoords[TEX_END_IDX].m_texCoord, zeroDxDy));
+        }
+        else
+        {
+          middleForming *= glsl::length(prevForming);
+
+          glsl::vec2 dxdyLeft(0.0, -1.0);
+          glsl::vec2 dxdyRight(0.0, -1.0);
+          glsl::vec2 dxdyMiddle(1.0, 1.0);
+          geometry.push_back(LV(startPivot, zeroNormal, colorCoord, texCoords[TEX_BEG_IDX].m_texCoord, zeroDxDy));
+          geometry.push_back(LV(startPivot, prevForming, colorCoord, texCoords[TEX_BEG_IDX].m_texCoord, dxdyLeft));
+          geometry.push_back(LV(startPivot, nextForming, colorCoord, texCoords[TEX_END_IDX].m_texCoord, dxdyRight));
+          geometry.push_back(LV(startPivot, middleForming, colorCoord, middle.m_texCoord, dxdyMiddle));
+        }
+      }
+    }
+
+    texCoords[TEX_BEG_IDX].m_globalLength = 0.0;
+    texCoords[TEX_END_IDX].m_globalLength = lengths[i - 1];
+    VERIFY(texCoordGen.GetTexCoords(texCoords[TEX_BEG_IDX]), ());
+    while (!texCoordGen.GetTexCoords(texCoords[TEX_END_IDX]))
+    {
+      glsl::vec2 newEndPoint = startPoint + tangent * texCoords[TEX_END_IDX].m_globalLength;
+      glsl::vec3 newEndPivot = glsl::vec3(newEndPoint, params.m_depth);
+
+      geometry.push_back(LV(startPivot, leftNormal, colorCoord, texCoords[TEX_BEG_IDX].m_texCoord, leftSegment));
+      geometry.push_back(LV(startPivot, rightNormal, colorCoord, texCoords[TEX_BEG_IDX].m_texCoord, rightSegment));
+      geometry.push_back(LV(newEndPivot, leftNormal, colorCoord, texCoords[TEX_END_IDX].m_texCoord, leftSegment));
+      geometry.push_back(LV(newEndPivot, rightNormal, colorCoord, texCoords[TEX_END_IDX].m_texCoord, rightSegment));
+
+      startPoint = newEndPoint;
+      startPivot = newEndPivot;
+
+      VERIFY(texCoordGen.GetTexCoords(texCoords[TEX_BEG_IDX]), ());
+      texCoords[TEX_END_IDX].m_globalLength = glsl::length(endPoint - startPoint);
+    }
+
+    geometry.push_back(LV(startPivot, leftNormal, colorCoord, texCoords[TEX_BEG_IDX].m_texCoord, leftSegment));
+    geometry.push_back(LV(startPivot, rightNormal, colorCoord, texCoords[TEX_BEG_IDX].m_texCoord, rightSegment));
+    geometry.push_back(LV(endPivot, leftNormal, colorCoord, texCoords[TEX_END_IDX].m_texCoord, leftSegment));
+    geometry.push_back(LV(endPivot, rightNormal, colorCoord, texCoords[TEX_END_IDX].m_texCoord, rightSegment));
+
+    prevPoint = startPoint;
+    prevLeftNormal = leftNormal;
+    prevRightNormal = rightNormal;
+  }
+
+  if (generateCap)
+  {
+    glsl::vec2 endPoint = points[segmentsCount];
+    glsl::vec2 leftNormal = leftNormals[segmentsCount - 1];
+    glsl::vec2 rightNormal = -leftNormal;
+    glsl::vec2 tangent = halfWidth * tangents[segmentsCount - 1];
+
+    glsl::vec3 pivot = glsl::vec3(endPoint, params.m_depth);
+    glsl::vec2 leftCap(capType, LEFT_WIDTH);
+    glsl::vec2 rightCap(capType, RIGHT_WIDTH);
+
+    texCoords[TEX_BEG_IDX].m_globalLength = 0.0;
+    texCoords[TEX_END_IDX].m_globalLength = glbHalfWidth;
+
+    VERIFY(texCoordGen.GetTexCoords(texCoords[TEX_BEG_IDX]), ());
+    VERIFY(texCoordGen.GetTexCoords(texCoords[TEX_END_IDX]), ());
+
+    geometry.push_back(LV(pivot, leftNormal, colorCoord, texCoords[TEX_BEG_IDX].m_texCoord, leftSegment));
+    geometry.push_back(LV(pivot, rightNormal, colorCoord, texCoords[TEX_BEG_IDX].m_texCoord, rightSegment));
+    geometry.push_back(LV(pivot, leftNormal + tangent, colorCoord, texCoords[TEX_END_IDX].m_texCoord, leftCap));
+    geometry.push_back(LV(pivot, rightNormal + tangent, colorCoord, texCoords[TEX_END_IDX].m_texCoord, rightCap));
+  }
+}
+
+} // namespace df
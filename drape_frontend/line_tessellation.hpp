@@ -0,0 +1,49 @@
+#pragma once
+
+#include "drape_frontend/shape_view_params.hpp"
+
+#include "drape/geometry_arena.hpp"
+#include "drape/glsl_types.hpp"
+#include "drape/utils/vertex_decl.hpp"
+
+#include "geometry/point2d.hpp"
+#include "geometry/rect2d.hpp"
+
+#include "std/vector.hpp"
+
+namespace df
+{
+
+/// Per-segment geometry of a polyline for LineShape. Segment i goes from points[i] to points[i + 1],
+/// so all output arrays have (pointsCount - 1) elements. Left normal is scaled by halfWidth,
+/// right normal is the negated left one.
+/// Segments are independent from each other, so they are processed in SIMD lanes by 4
+/// (SSE2 or NEON), tail and platforms without SIMD go through the scalar path.
+void CalculateLineSegments(glsl::vec2 const * points, size_t pointsCount, float halfWidth,
+                           glsl::vec2 * tangents, glsl::vec2 * leftNormals, float * lengths);
+
+/// Reference implementation, the same math as glsl::normalize and glsl::length.
+void CalculateLineSegmentsScalar(glsl::vec2 const * points, size_t pointsCount, float halfWidth,
+                                 glsl::vec2 * tangents, glsl::vec2 * leftNormals, float * lengths);
+
+using TCalculateLineSegmentsFn = decltype(&CalculateLineSegments);
+
+/// Stipple mask of a line in the texture. Solid lines take the center of m_texRect.
+struct LineStipple
+{
+  m2::RectF m_texRect;
+  float m_maskLength = 0.0f;
+  float m_patternLength = 0.0f;
+  bool m_isSolid = true;
+};
+
+/// Vertexes of LineShape in strips of 4 vertexes: caps, joins and pieces of segments between
+/// repeats of the stipple mask. Only the per-segment math goes through calculateSegments,
+/// joins, caps and texture coordinates depend on the previous segment and stay scalar.
+/// Temporary arrays are allocated in the arena.
+void TessellateLine(vector<m2::PointD> const & path, LineViewParams const & params,
+                    glsl::vec2 const & colorCoord, LineStipple const & stipple,
+                    dp::GeometryArena & arena, dp::ArenaVector<gpu::LineVertex> & geometry,
+                    TCalculateLineSegmentsFn calculateSegments = &CalculateLineSegments);
+
+} // namespace df
@@ -1,37 +1,70 @@
 #include "drape_frontend/memory_feature_index.hpp"
 
+#include "base/assert.hpp"
+
+#include "std/algorithm.hpp"
+#include "std/cstdint.hpp"
+
 namespace df
 {
 
-void MemoryFeatureIndex::ReadFeaturesRequest(vector<FeatureInfo> & features, vector<size_t> & indexes)
+// static
+size_t MemoryFeatureIndex::GetShardIndex(FeatureID const & id)
 {
-  threads::MutexGuard lock(m_mutex);
+  // Features of one tile have close indexes, they are spread over all shards.
+  uint64_t const mwm = reinterpret_cast<uintptr_t>(id.m_mwmId.GetInfo().get()) >> 4;
+  uint64_t const hash = (id.m_index ^ mwm) * 0x9E3779B97F4A7C15ULL;
+  return static_cast<size_t>(hash >> 58) % kShardsCount;
+}
 
+template <typename TFn>
+void MemoryFeatureIndex::ForEachByShards(vector<FeatureInfo> const & features, TFn && fn)
+{
+  vector<pair<size_t, size_t>> order;
+  order.reserve(features.size());
   for (size_t i = 0; i < features.size(); ++i)
+    order.emplace_back(GetShardIndex(features[i].m_id), i);
+  sort(order.begin(), order.end());
+
+  for (size_t begin = 0; begin < order.size();)
+  {
+    Shard & shard = m_shards[order[begin].first];
+    lock_guard<mutex> lock(shard.m_mutex);
+
+    size_t end = begin;
+    for (; end < order.size() && order[end].first == order[begin].first; ++end)
+      fn(shard, order[end].second);
+    begin = end;
+  }
+}
+
+void MemoryFeatureIndex::ReadFeaturesRequest(vector<FeatureInfo> & features, vector<size_t> & indexes)
+{
+  size_t const firstIndex = indexes.size();
+  ForEachByShards(features, [&features, &indexes](Shard & shard, size_t i)
   {
     FeatureInfo & info = features[i];
-    ASSERT(m_features.find(info.m_id) != m_features.end() || !info.m_isOwner,());
-    if (!info.m_isOwner && m_features.insert(info.m_id).second)
+    ASSERT(shard.m_features.find(info.m_id) != shard.m_features.end() || !info.m_isOwner,());
+    if (!info.m_isOwner && shard.m_features.insert(info.m_id).second)
     {
       indexes.push_back(i);
       info.m_isOwner = true;
     }
-  }
+  });
+  sort(indexes.begin() + firstIndex, indexes.end());
 }
 
 void MemoryFeatureIndex::RemoveFeatures(vector<FeatureInfo> & features)
 {
-  threads::MutexGuard lock(m_mutex);
-
-  for (size_t i = 0; i < features.size(); ++i)
+  ForEachByShards(features, [&features](Shard & shard, size_t i)
   {
     FeatureInfo & info = features[i];
     if (info.m_isOwner)
     {
-      VERIFY(m_features.erase(info.m_id) == 1, ());
+      VERIFY(shard.m_features.erase(info.m_id) == 1, ());
       info.m_isOwner = false;
     }
-  }
+  });
 }
 
 } // namespace df
@@ -1,10 +1,9 @@
 #pragma once
 
 #include "indexer/feature_decl.hpp"
-#include "base/mutex.hpp"
 
+#include "std/mutex.hpp"
 #include "std/set.hpp"
-#include "std/utility.hpp"
 #include "std/vector.hpp"
 #include "std/noncopyable.hpp"
 
@@ -28,15 +27,34 @@ struct FeatureInfo
   bool m_isOwner;
 };
 
+/// Set of features which are read by tiles. It's split into shards by feature ids with own locks,
+/// so reading threads don't wait for each other while they take different features.
 class MemoryFeatureIndex : private noncopyable
 {
 public:
+  /// Marks features which are not read by other tiles as owned by the caller.
+  /// @param indexes Ascending indexes of the newly owned features.
   void ReadFeaturesRequest(vector<FeatureInfo> & features, vector<size_t> & indexes);
   void RemoveFeatures(vector<FeatureInfo> & features);
 
 private:
-  threads::Mutex m_mutex;
-  set<FeatureID> m_features;
+  static size_t const kShardsCount = 64;
+
+  /// Stored ids keep their mwm infos alive, so the shard of an id doesn't change
+  /// and an info isn't reused by other mwm while its features are in the index.
+  struct Shard
+  {
+    mutex m_mutex;
+    set<FeatureID> m_features;
+  };
+
+  static size_t GetShardIndex(FeatureID const & id);
+
+  /// Calls fn(shard, featureIndex) for features grouped by shards, every shard is locked once.
+  template <typename TFn>
+  void ForEachByShards(vector<FeatureInfo> const & features, TFn && fn);
+
+  Shard m_shards[kShardsCount];
 };
 
 } // namespace df
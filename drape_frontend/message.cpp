@@ -2,9 +2,95 @@
 
 #include "base/assert.hpp"
 
+#include "std/mutex.hpp"
+#include "std/vector.hpp"
+
 namespace df
 {
 
+namespace
+{
+
+class MessagePool
+{
+public:
+  void * Allocate(size_t size)
+  {
+    size_t const sizeClass = GetSizeClass(size);
+    if (sizeClass >= kClassesCount)
+      return ::operator new(size);
+
+    FreeList & list = m_lists[sizeClass];
+    {
+      lock_guard<mutex> lock(list.m_mutex);
+      if (!list.m_blocks.empty())
+      {
+        void * p = list.m_blocks.back();
+        list.m_blocks.pop_back();
+        return p;
+      }
+    }
+    return ::operator new((sizeClass + 1) * kGranularity);
+  }
+
+  void Deallocate(void * p, size_t size)
+  {
+    size_t const sizeClass = GetSizeClass(size);
+    if (sizeClass < kClassesCount)
+    {
+      FreeList & list = m_lists[sizeClass];
+      lock_guard<mutex> lock(list.m_mutex);
+      if (list.m_blocks.size() < kMaxFreeBlocks)
+      {
+        list.m_blocks.push_back(p);
+        return;
+      }
+    }
+    ::operator delete(p);
+  }
+
+private:
+  static size_t const kGranularity = 32;
+  static size_t const kClassesCount = 16;
+  static size_t const kMaxFreeBlocks = 1024;
+
+  struct FreeList
+  {
+    mutex m_mutex;
+    vector<void *> m_blocks;
+  };
+
+  static size_t GetSizeClass(size_t size)
+  {
+    ASSERT_GREATER(size, 0, ());
+    return (size - 1) / kGranularity;
+  }
+
+  FreeList m_lists[kClassesCount];
+};
+
+/// The pool is never destroyed: messages can be deleted at exit after static destructors.
+MessagePool & GetMessagePool()
+{
+  static MessagePool * pool = new MessagePool();
+  return *pool;
+}
+
+} // namespace
+
+// static
+void * Message::operator new(size_t size)
+{
+  return GetMessagePool().Allocate(size);
+}
+
+// static
+void Message::operator delete(void * p, size_t size)
+{
+  if (p != nullptr)
+    GetMessagePool().Deallocate(p, size);
+}
+
 Message::Message()
   : m_type(Unknown) {}
 
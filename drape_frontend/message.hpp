@@ -1,5 +1,7 @@
 #pragma once
 
+#include "std/cstdint.hpp"
+
 namespace df
 {
 
@@ -27,6 +29,11 @@ public:
   virtual ~Message() {}
   Type GetType() const;
 
+  /// Messages are created and destroyed on different threads for every flushed bucket,
+  /// so their memory is reused from free lists of small blocks.
+  static void * operator new(size_t size);
+  static void operator delete(void * p, size_t size);
+
 protected:
   void SetType(Type t);
 
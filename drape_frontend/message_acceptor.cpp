@@ -16,6 +16,17 @@ void MessageAcceptor::ProcessSingleMessage(unsigned maxTimeWait)
   message.Destroy();
 }
 
+void MessageAcceptor::ProcessMessages(unsigned maxTimeWait, size_t maxCount)
+{
+  MessageQueue::TMessages messages;
+  m_messageQueue.PopMessages(maxTimeWait, maxCount, messages);
+  for (dp::MasterPointer<Message> & message : messages)
+  {
+    AcceptMessage(message.GetRefPointer());
+    message.Destroy();
+  }
+}
+
 void MessageAcceptor::PostMessage(dp::TransferPointer<Message> message)
 {
   m_messageQueue.PushMessage(message);
@@ -19,9 +19,13 @@ protected:
 
   /// Must be called by subclass on message target thread
   void ProcessSingleMessage(unsigned maxTimeWait = -1);
+  /// Accepts up to maxCount messages popped from the queue at once.
+  void ProcessMessages(unsigned maxTimeWait = -1, size_t maxCount = kMessagesBatchSize);
   void CloseQueue();
 
 private:
+  static size_t const kMessagesBatchSize = 64;
+
   friend class ThreadsCommutator;
 
   void PostMessage(dp::TransferPointer<Message> message);
@@ -1,11 +1,43 @@
 #include "drape_frontend/message_queue.hpp"
 
 #include "base/assert.hpp"
-#include "base/stl_add.hpp"
+
+#include "std/chrono.hpp"
+#include "std/cstdint.hpp"
 
 namespace df
 {
 
+namespace
+{
+
+size_t RoundUpToPowerOfTwo(size_t value)
+{
+  size_t result = 1;
+  while (result < value)
+    result <<= 1;
+  return result;
+}
+
+} // namespace
+
+MessageQueue::MessageQueue(size_t capacity)
+  : m_cells(new Cell[RoundUpToPowerOfTwo(capacity)])
+  , m_mask(RoundUpToPowerOfTwo(capacity) - 1)
+  , m_tail(0)
+  , m_head(0)
+  , m_hasOverflow(false)
+  , m_isWaiting(false)
+  , m_wakeUp(false)
+{
+  CHECK_GREATER(capacity, 0, ());
+  for (size_t i = 0; i <= m_mask; ++i)
+  {
+    m_cells[i].m_sequence.store(i, memory_order_relaxed);
+    m_cells[i].m_message = nullptr;
+  }
+}
+
 MessageQueue::~MessageQueue()
 {
   CancelWait();
@@ -14,45 +46,149 @@ MessageQueue::~MessageQueue()
 
 dp::TransferPointer<Message> MessageQueue::PopMessage(unsigned maxTimeWait)
 {
-  threads::ConditionGuard guard(m_condition);
-
-  WaitMessage(maxTimeWait);
-
-  /// even waitNonEmpty == true m_messages can be empty after WaitMessage call
+  TMessages messages;
+  /// even if messages are waited the queue can be empty after WaitMessage call
   /// if application preparing to close and CancelWait been called
-  if (m_messages.empty())
+  if (PopMessages(maxTimeWait, 1, messages) == 0)
     return dp::MovePointer<Message>(NULL);
 
-  dp::MasterPointer<Message> msg = m_messages.front();
-  m_messages.pop_front();
-  return msg.Move();
+  return messages.front().Move();
+}
+
+size_t MessageQueue::PopMessages(unsigned maxTimeWait, size_t maxCount, TMessages & messages)
+{
+  WaitMessage(maxTimeWait);
+
+  lock_guard<mutex> lock(m_popMutex);
+  size_t count = 0;
+  for (; count < maxCount; ++count)
+  {
+    Message * message = TryPop();
+    if (message == nullptr)
+      break;
+    messages.push_back(dp::MasterPointer<Message>(message));
+  }
+  return count;
 }
 
 void MessageQueue::PushMessage(dp::TransferPointer<Message> message)
 {
-  threads::ConditionGuard guard(m_condition);
+  Message * rawMessage = dp::MasterPointer<Message>(message).GetRaw();
+  ASSERT(rawMessage != nullptr, ());
+
+  if (m_hasOverflow.load(memory_order_acquire) || !TryPushToRing(rawMessage))
+  {
+    lock_guard<mutex> lock(m_overflowMutex);
+    m_overflow.push_back(rawMessage);
+    m_hasOverflow.store(true, memory_order_release);
+  }
+
+  // Pairs with the fence in WaitMessage: either the consumer sees the message
+  // or the producer sees that the consumer sleeps.
+  atomic_thread_fence(memory_order_seq_cst);
+  if (m_isWaiting.load(memory_order_relaxed))
+  {
+    lock_guard<mutex> lock(m_waitMutex);
+    m_condition.notify_one();
+  }
+}
+
+bool MessageQueue::TryPushToRing(Message * message)
+{
+  size_t pos = m_tail.load(memory_order_relaxed);
+  Cell * cell;
+  for (;;)
+  {
+    cell = &m_cells[pos & m_mask];
+    size_t const sequence = cell->m_sequence.load(memory_order_acquire);
+    intptr_t const diff = static_cast<intptr_t>(sequence) - static_cast<intptr_t>(pos);
+    if (diff == 0)
+    {
+      if (m_tail.compare_exchange_weak(pos, pos + 1, memory_order_relaxed))
+        break;
+    }
+    else if (diff < 0)
+    {
+      // The cell is not popped yet, the ring is full.
+      return false;
+    }
+    else
+    {
+      pos = m_tail.load(memory_order_relaxed);
+    }
+  }
+
+  cell->m_message = message;
+  cell->m_sequence.store(pos + 1, memory_order_release);
+  return true;
+}
+
+Message * MessageQueue::TryPop()
+{
+  size_t const head = m_head.load(memory_order_relaxed);
+  Cell & cell = m_cells[head & m_mask];
+  if (cell.m_sequence.load(memory_order_acquire) == head + 1)
+  {
+    Message * message = cell.m_message;
+    cell.m_message = nullptr;
+    cell.m_sequence.store(head + m_mask + 1, memory_order_release);
+    m_head.store(head + 1, memory_order_relaxed);
+    return message;
+  }
+
+  if (!m_hasOverflow.load(memory_order_acquire))
+    return nullptr;
+
+  // Overflowed messages were pushed after messages of the ring by the same threads.
+  lock_guard<mutex> lock(m_overflowMutex);
+  if (m_overflow.empty())
+    return nullptr;
 
-  bool wasEmpty = m_messages.empty();
-  m_messages.push_back(dp::MasterPointer<Message>(message));
+  Message * message = m_overflow.front();
+  m_overflow.pop_front();
+  if (m_overflow.empty())
+    m_hasOverflow.store(false, memory_order_release);
+  return message;
+}
 
-  if (wasEmpty)
-    guard.Signal();
+bool MessageQueue::IsEmpty() const
+{
+  size_t const head = m_head.load(memory_order_relaxed);
+  return m_cells[head & m_mask].m_sequence.load(memory_order_acquire) != head + 1 &&
+         !m_hasOverflow.load(memory_order_acquire);
 }
 
 void MessageQueue::WaitMessage(unsigned maxTimeWait)
 {
-  if (m_messages.empty())
-    m_condition.Wait(maxTimeWait);
+  unique_lock<mutex> lock(m_waitMutex);
+  m_isWaiting.store(true, memory_order_relaxed);
+  atomic_thread_fence(memory_order_seq_cst);
+
+  auto const isReady = [this]() { return m_wakeUp || !IsEmpty(); };
+  if (maxTimeWait == static_cast<unsigned>(-1))
+    m_condition.wait(lock, isReady);
+  else
+    m_condition.wait_for(lock, milliseconds(maxTimeWait), isReady);
+
+  m_isWaiting.store(false, memory_order_relaxed);
+  m_wakeUp = false;
 }
 
 void MessageQueue::CancelWait()
 {
-  m_condition.Signal();
+  lock_guard<mutex> lock(m_waitMutex);
+  m_wakeUp = true;
+  m_condition.notify_all();
 }
 
 void MessageQueue::ClearQuery()
 {
-  DeleteRange(m_messages, dp::MasterPointerDeleter());
+  lock_guard<mutex> lock(m_popMutex);
+  for (Message * message = TryPop(); message != nullptr; message = TryPop())
+  {
+    dp::MasterPointer<Message> p(message);
+    p.Destroy();
+  }
 }
 
 } // namespace df
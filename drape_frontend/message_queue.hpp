@@ -4,30 +4,73 @@
 
 #include "drape/pointers.hpp"
 
-#include "base/condition.hpp"
-
+#include "std/atomic.hpp"
+#include "std/condition_variable.hpp"
 #include "std/list.hpp"
+#include "std/mutex.hpp"
+#include "std/unique_ptr.hpp"
+#include "std/vector.hpp"
 
 namespace df
 {
 
+/// Queue of messages from many threads to one render thread. Messages are pushed to a bounded
+/// lock-free ring, producers take a lock only when the ring is full or the consumer sleeps.
 class MessageQueue
 {
 public:
+  typedef vector<dp::MasterPointer<Message> > TMessages;
+
+  static size_t const kDefaultCapacity = 4096;
+
+  /// @param capacity Size of the ring, rounded up to a power of two.
+  explicit MessageQueue(size_t capacity = kDefaultCapacity);
   ~MessageQueue();
 
   /// if queue is empty than return NULL
   dp::TransferPointer<Message> PopMessage(unsigned maxTimeWait);
+  /// Appends up to maxCount messages to messages, waits for maxTimeWait ms if queue is empty.
+  /// @return Number of popped messages.
+  size_t PopMessages(unsigned maxTimeWait, size_t maxCount, TMessages & messages);
   void PushMessage(dp::TransferPointer<Message> message);
   void CancelWait();
   void ClearQuery();
 
 private:
+  struct Cell
+  {
+    /// Equals to the position for a free cell and to the position + 1 for a filled one.
+    atomic<size_t> m_sequence;
+    Message * m_message;
+  };
+
+  bool TryPushToRing(Message * message);
+  Message * TryPop();
+  bool IsEmpty() const;
   void WaitMessage(unsigned maxTimeWait);
 
 private:
-  threads::Condition m_condition;
-  list<dp::MasterPointer<Message> > m_messages;
+  unique_ptr<Cell[]> m_cells;
+  size_t const m_mask;
+
+  /// Position of the next push, shared by producers.
+  atomic<size_t> m_tail;
+
+  /// Guards the consumer side, ClearQuery can be called from another thread.
+  mutex m_popMutex;
+  /// Position of the next pop. It's atomic because waiting checks it without m_popMutex.
+  atomic<size_t> m_head;
+
+  /// Messages pushed while the ring was full. Producers push here until the consumer drains it,
+  /// so messages of one thread keep their order.
+  mutex m_overflowMutex;
+  list<Message *> m_overflow;
+  atomic<bool> m_hasOverflow;
+
+  mutex m_waitMutex;
+  condition_variable m_condition;
+  atomic<bool> m_isWaiting;
+  bool m_wakeUp;
 };
 
 } // namespace df
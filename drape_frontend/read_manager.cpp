@@ -35,7 +35,7 @@ ReadManager::ReadManager(EngineContext & context, MapDataProvider & model)
   , m_model(model)
   , myPool(64, ReadMWMTaskFactory(m_memIndex, m_model, m_context))
 {
-  m_pool.Reset(new threads::ThreadPool(ReadCount(), bind(&ReadManager::OnTaskFinished, this, _1)));
+  m_pool.Reset(new ReadScheduler(ReadCount(), bind(&ReadManager::OnTaskFinished, this, _1)));
 }
 
 void ReadManager::OnTaskFinished(threads::IRoutine * task)
@@ -51,12 +51,16 @@ void ReadManager::UpdateCoverage(ScreenBase const & screen, set<TileKey> const &
   if (screen == m_currentViewport)
     return;
 
+  // Queued tasks are reordered by the new viewport.
+  m_pool->SetViewport(screen.GetOrg(), df::GetTileScaleBase(screen));
+
   if (MustDropAllTiles(screen))
   {
     for_each(m_tileInfos.begin(), m_tileInfos.end(), bind(&ReadManager::CancelTileInfo, this, _1));
     m_tileInfos.clear();
+    m_pool->CancelAll();
 
-    for_each(tiles.begin(), tiles.end(), bind(&ReadManager::PushTaskBackForTileKey, this, _1));
+    for_each(tiles.begin(), tiles.end(), bind(&ReadManager::PushTaskForTileKey, this, _1));
   }
   else
   {
@@ -78,9 +82,17 @@ void ReadManager::UpdateCoverage(ScreenBase const & screen, set<TileKey> const &
                    m_tileInfos.begin(), m_tileInfos.end(),
                    back_inserter(inputRects), LessCoverageCell());
 
+    set<TileKey> outdatedKeys;
+    for (tileinfo_ptr const & tile : outdatedTiles)
+      outdatedKeys.insert(tile->GetTileKey());
+    m_pool->Cancel([&outdatedKeys](TileKey const & key)
+    {
+      return outdatedKeys.find(key) != outdatedKeys.end();
+    });
+
     for_each(outdatedTiles.begin(), outdatedTiles.end(), bind(&ReadManager::ClearTileInfo, this, _1));
-    for_each(m_tileInfos.begin(), m_tileInfos.end(), bind(&ReadManager::PushTaskFront, this, _1));
-    for_each(inputRects.begin(),  inputRects.end(),  bind(&ReadManager::PushTaskBackForTileKey, this, _1));
+    for_each(m_tileInfos.begin(), m_tileInfos.end(), bind(&ReadManager::PushTaskForTileInfo, this, _1));
+    for_each(inputRects.begin(),  inputRects.end(),  bind(&ReadManager::PushTaskForTileKey, this, _1));
   }
   m_currentViewport = screen;
 }
@@ -93,7 +105,7 @@ void ReadManager::Invalidate(set<TileKey> const & keyStorage)
     if (keyStorage.find((*it)->GetTileKey()) != keyStorage.end())
     {
       CancelTileInfo(*it);
-      PushTaskFront(*it);
+      PushTaskForTileInfo(*it);
     }
   }
 }
@@ -112,6 +124,11 @@ size_t ReadManager::ReadCount()
   return max(GetPlatform().CpuCores() - 2, 1);
 }
 
+ReadScheduler::Metrics ReadManager::GetReadMetrics() const
+{
+  return m_pool->GetMetrics();
+}
+
 bool ReadManager::MustDropAllTiles(ScreenBase const & screen) const
 {
   int const oldScale = df::GetTileScaleBase(m_currentViewport);
@@ -119,20 +136,20 @@ bool ReadManager::MustDropAllTiles(ScreenBase const & screen) const
   return (oldScale != newScale) || !m_currentViewport.GlobalRect().IsIntersect(screen.GlobalRect());
 }
 
-void ReadManager::PushTaskBackForTileKey(TileKey const & tileKey)
+void ReadManager::PushTaskForTileKey(TileKey const & tileKey)
 {
   tileinfo_ptr tileInfo(new TileInfo(tileKey));
   m_tileInfos.insert(tileInfo);
   ReadMWMTask * task = myPool.Get();
   task->Init(tileInfo);
-  m_pool->PushBack(task);
+  m_pool->Push(tileKey, task);
 }
 
-void ReadManager::PushTaskFront(tileinfo_ptr const & tileToReread)
+void ReadManager::PushTaskForTileInfo(tileinfo_ptr const & tileToReread)
 {
   ReadMWMTask * task = myPool.Get();
   task->Init(tileToReread);
-  m_pool->PushFront(task);
+  m_pool->Push(tileToReread->GetTileKey(), task);
 }
 
 void ReadManager::CancelTileInfo(tileinfo_ptr const & tileToCancel)
@@ -4,14 +4,13 @@
 #include "drape_frontend/engine_context.hpp"
 #include "drape_frontend/tile_info.hpp"
 #include "drape_frontend/read_mwm_task.hpp"
+#include "drape_frontend/read_scheduler.hpp"
 
 #include "geometry/screenbase.hpp"
 
 #include "drape/pointers.hpp"
 #include "drape/object_pool.hpp"
 
-#include "base/thread_pool.hpp"
-
 #include "std/set.hpp"
 #include "std/shared_ptr.hpp"
 
@@ -34,12 +33,15 @@ public:
 
   static size_t ReadCount();
 
+  /// Queue and read times of tasks since the start.
+  ReadScheduler::Metrics GetReadMetrics() const;
+
 private:
   void OnTaskFinished(threads::IRoutine * task);
   bool MustDropAllTiles(ScreenBase const & screen) const;
 
-  void PushTaskBackForTileKey(TileKey const & tileKey);
-  void PushTaskFront(tileinfo_ptr const & tileToReread);
+  void PushTaskForTileKey(TileKey const & tileKey);
+  void PushTaskForTileInfo(tileinfo_ptr const & tileToReread);
 
 private:
   MemoryFeatureIndex m_memIndex;
@@ -47,7 +49,7 @@ private:
 
   MapDataProvider & m_model;
 
-  dp::MasterPointer<threads::ThreadPool> m_pool;
+  dp::MasterPointer<ReadScheduler> m_pool;
 
   ScreenBase m_currentViewport;
 
@@ -25,6 +25,8 @@ void ReadMWMTask::Init(weak_ptr<TileInfo> const & tileInfo)
 
 void ReadMWMTask::Reset()
 {
+  // Tasks are reused from the pool, so cancellation by the scheduler is reset too.
+  IRoutine::Reset();
 #ifdef DEBUG
   m_checker = false;
 #endif
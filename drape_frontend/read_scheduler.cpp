@@ -0,0 +1,237 @@
+#include "drape_frontend/read_scheduler.hpp"
+
+#include "base/assert.hpp"
+
+#include "std/algorithm.hpp"
+#include "std/cstdlib.hpp"
+
+namespace df
+{
+
+namespace
+{
+
+/// Tasks of the viewport zoom level go first, then tasks of tiles closer to the viewport centre.
+bool IsBetter(TileKey const & l, TileKey const & r, m2::PointD const & center, int zoomLevel)
+{
+  int const lZoomDiff = abs(l.m_zoomLevel - zoomLevel);
+  int const rZoomDiff = abs(r.m_zoomLevel - zoomLevel);
+  if (lZoomDiff != rZoomDiff)
+    return lZoomDiff < rZoomDiff;
+
+  return center.SquareLength(l.GetGlobalRect().Center()) <
+         center.SquareLength(r.GetGlobalRect().Center());
+}
+
+double ToSeconds(steady_clock::duration const & d)
+{
+  return duration_cast<duration<double>>(d).count();
+}
+
+} // namespace
+
+ReadScheduler::ReadScheduler(size_t workersCount, TFinishFn const & finishFn)
+  : m_finishFn(finishFn)
+  , m_nextQueue(0)
+  , m_tasksCount(0)
+  , m_stopped(false)
+  , m_center(0.0, 0.0)
+  , m_zoomLevel(-1)
+{
+  CHECK_GREATER(workersCount, 0, ());
+  for (size_t i = 0; i < workersCount; ++i)
+    m_queues.emplace_back(new Queue());
+  for (size_t i = 0; i < workersCount; ++i)
+    m_workers.emplace_back(&ReadScheduler::Work, this, i);
+}
+
+ReadScheduler::~ReadScheduler()
+{
+  Stop();
+}
+
+void ReadScheduler::SetViewport(m2::PointD const & center, int zoomLevel)
+{
+  lock_guard<mutex> lock(m_mutex);
+  m_center = center;
+  m_zoomLevel = zoomLevel;
+}
+
+void ReadScheduler::Push(TileKey const & tileKey, threads::IRoutine * task)
+{
+  {
+    lock_guard<mutex> lock(m_mutex);
+    if (!m_stopped)
+    {
+      // Tasks are pushed and counted under the lock, so a worker which has taken the count
+      // always finds a task in some queue.
+      Queue & queue = *m_queues[m_nextQueue++ % m_queues.size()];
+      lock_guard<mutex> queueLock(queue.m_mutex);
+      queue.m_tasks.push_back({tileKey, task, TClock::now()});
+      ++m_tasksCount;
+      task = nullptr;
+    }
+  }
+
+  if (task == nullptr)
+  {
+    m_cv.notify_one();
+    return;
+  }
+
+  task->Cancel();
+  m_finishFn(task);
+}
+
+void ReadScheduler::Cancel(TTileFilterFn const & filter)
+{
+  for (auto & queue : m_queues)
+  {
+    lock_guard<mutex> lock(queue->m_mutex);
+    for (Task const & task : queue->m_tasks)
+    {
+      if (filter(task.m_tileKey))
+        task.m_routine->Cancel();
+    }
+  }
+}
+
+void ReadScheduler::CancelAll()
+{
+  Cancel([](TileKey const &) { return true; });
+}
+
+ReadScheduler::Metrics ReadScheduler::GetMetrics() const
+{
+  lock_guard<mutex> lock(m_mutex);
+  return m_metrics;
+}
+
+void ReadScheduler::Stop()
+{
+  {
+    lock_guard<mutex> lock(m_mutex);
+    m_stopped = true;
+  }
+  m_cv.notify_all();
+
+  for (auto & worker : m_workers)
+  {
+    if (worker.joinable())
+      worker.join();
+  }
+  m_workers.clear();
+
+  for (auto & queue : m_queues)
+    FinishTasks(*queue);
+}
+
+void ReadScheduler::Work(size_t workerIndex)
+{
+  Task task;
+  bool stolen = false;
+  while (PopTask(workerIndex, task, stolen))
+    RunTask(task, stolen);
+}
+
+bool ReadScheduler::PopTask(size_t workerIndex, Task & task, bool & stolen)
+{
+  m2::PointD center;
+  int zoomLevel;
+  {
+    unique_lock<mutex> lock(m_mutex);
+    m_cv.wait(lock, [this]() { return m_stopped || m_tasksCount > 0; });
+    if (m_stopped)
+      return false;
+
+    --m_tasksCount;
+    center = m_center;
+    zoomLevel = m_zoomLevel;
+  }
+
+  // The own queue goes first, then tasks are stolen from other queues.
+  for (;;)
+  {
+    for (size_t i = 0; i < m_queues.size(); ++i)
+    {
+      if (PopBestTask(*m_queues[(workerIndex + i) % m_queues.size()], center, zoomLevel, task))
+      {
+        stolen = (i != 0);
+        return true;
+      }
+    }
+  }
+}
+
+// static
+bool ReadScheduler::PopBestTask(Queue & queue, m2::PointD const & center, int zoomLevel,
+                                Task & task)
+{
+  lock_guard<mutex> lock(queue.m_mutex);
+  vector<Task> & tasks = queue.m_tasks;
+  if (tasks.empty())
+    return false;
+
+  size_t best = 0;
+  for (size_t i = 0; i < tasks.size(); ++i)
+  {
+    if (tasks[i].m_routine->IsCancelled())
+    {
+      best = i;
+      break;
+    }
+    if (IsBetter(tasks[i].m_tileKey, tasks[best].m_tileKey, center, zoomLevel))
+      best = i;
+  }
+
+  task = tasks[best];
+  tasks[best] = tasks.back();
+  tasks.pop_back();
+  return true;
+}
+
+void ReadScheduler::RunTask(Task const & task, bool stolen)
+{
+  TClock::time_point const startTime = TClock::now();
+
+  TaskMetrics taskMetrics;
+  taskMetrics.m_tileKey = task.m_tileKey;
+  taskMetrics.m_queueSeconds = ToSeconds(startTime - task.m_pushTime);
+  taskMetrics.m_stolen = stolen;
+  taskMetrics.m_cancelled = task.m_routine->IsCancelled();
+  if (!taskMetrics.m_cancelled)
+  {
+    task.m_routine->Do();
+    taskMetrics.m_readSeconds = ToSeconds(TClock::now() - startTime);
+  }
+
+  {
+    lock_guard<mutex> lock(m_mutex);
+    ++m_metrics.m_tasksCount;
+    if (taskMetrics.m_cancelled)
+      ++m_metrics.m_cancelledCount;
+    if (stolen)
+      ++m_metrics.m_stolenCount;
+    m_metrics.m_totalQueueSeconds += taskMetrics.m_queueSeconds;
+    m_metrics.m_maxQueueSeconds = max(m_metrics.m_maxQueueSeconds, taskMetrics.m_queueSeconds);
+    m_metrics.m_totalReadSeconds += taskMetrics.m_readSeconds;
+    m_metrics.m_maxReadSeconds = max(m_metrics.m_maxReadSeconds, taskMetrics.m_readSeconds);
+  }
+
+  if (m_metricsFn)
+    m_metricsFn(taskMetrics);
+  m_finishFn(task.m_routine);
+}
+
+void ReadScheduler::FinishTasks(Queue & queue)
+{
+  lock_guard<mutex> lock(queue.m_mutex);
+  for (Task const & task : queue.m_tasks)
+  {
+    task.m_routine->Cancel();
+    m_finishFn(task.m_routine);
+  }
+  queue.m_tasks.clear();
+}
+
+} // namespace df
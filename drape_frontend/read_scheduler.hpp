@@ -0,0 +1,117 @@
+#pragma once
+
+#include "drape_frontend/tile_key.hpp"
+
+#include "geometry/point2d.hpp"
+
+#include "base/thread.hpp"
+
+#include "std/atomic.hpp"
+#include "std/chrono.hpp"
+#include "std/condition_variable.hpp"
+#include "std/function.hpp"
+#include "std/mutex.hpp"
+#include "std/unique_ptr.hpp"
+#include "std/vector.hpp"
+
+namespace df
+{
+
+/// Pool of threads for reading tasks of tiles. Tasks of the viewport zoom level which are closer
+/// to the viewport centre go first, the order follows the viewport without re-pushing tasks.
+/// Every worker has its own queue and steals the best task from other queues when it's idle.
+class ReadScheduler
+{
+public:
+  struct TaskMetrics
+  {
+    TileKey m_tileKey;
+    /// Time from pushing of the task to its start.
+    double m_queueSeconds = 0.0;
+    /// Time of the task execution, zero for cancelled tasks.
+    double m_readSeconds = 0.0;
+    bool m_cancelled = false;
+    bool m_stolen = false;
+  };
+
+  struct Metrics
+  {
+    size_t m_tasksCount = 0;
+    size_t m_cancelledCount = 0;
+    size_t m_stolenCount = 0;
+    double m_totalQueueSeconds = 0.0;
+    double m_maxQueueSeconds = 0.0;
+    double m_totalReadSeconds = 0.0;
+    double m_maxReadSeconds = 0.0;
+  };
+
+  /// Called from worker threads for every task, even for cancelled or not executed on Stop.
+  using TFinishFn = function<void(threads::IRoutine *)>;
+  using TMetricsFn = function<void(TaskMetrics const &)>;
+  using TTileFilterFn = function<bool(TileKey const &)>;
+
+  ReadScheduler(size_t workersCount, TFinishFn const & finishFn);
+  ~ReadScheduler();
+
+  /// Sets the point and zoom level which tasks are ordered by.
+  void SetViewport(m2::PointD const & center, int zoomLevel);
+
+  void Push(TileKey const & tileKey, threads::IRoutine * task);
+
+  /// Cancels queued tasks of tiles, they are finished without execution.
+  void Cancel(TTileFilterFn const & filter);
+  void CancelAll();
+
+  /// Callback is called from worker threads, set it before pushing of tasks.
+  void SetMetricsFn(TMetricsFn const & fn) { m_metricsFn = fn; }
+  Metrics GetMetrics() const;
+
+  /// Finishes not executed tasks and joins workers.
+  void Stop();
+
+private:
+  using TClock = steady_clock;
+
+  struct Task
+  {
+    TileKey m_tileKey;
+    threads::IRoutine * m_routine;
+    TClock::time_point m_pushTime;
+  };
+
+  struct Queue
+  {
+    mutex m_mutex;
+    vector<Task> m_tasks;
+  };
+
+  void Work(size_t workerIndex);
+
+  /// @return False if the scheduler is stopped.
+  bool PopTask(size_t workerIndex, Task & task, bool & stolen);
+  /// Cancelled tasks are popped first to drop them quickly.
+  static bool PopBestTask(Queue & queue, m2::PointD const & center, int zoomLevel, Task & task);
+
+  void RunTask(Task const & task, bool stolen);
+  void FinishTasks(Queue & queue);
+
+  TFinishFn m_finishFn;
+  TMetricsFn m_metricsFn;
+
+  vector<unique_ptr<Queue>> m_queues;
+  vector<threads::SimpleThread> m_workers;
+  atomic<size_t> m_nextQueue;
+
+  /// Guards waiting of idle workers, the viewport and metrics.
+  mutable mutex m_mutex;
+  condition_variable m_cv;
+  size_t m_tasksCount;
+  bool m_stopped;
+
+  m2::PointD m_center;
+  int m_zoomLevel;
+
+  Metrics m_metrics;
+};
+
+} // namespace df
@@ -0,0 +1,115 @@
+#include "drape_frontend/shaped_text_cache.hpp"
+
+#include "base/assert.hpp"
+
+#include "std/sstream.hpp"
+
+namespace df
+{
+
+double ShapedTextCache::Stats::GetHitRate() const
+{
+  uint64_t const requestsCount = m_hitsCount + m_missesCount;
+  return requestsCount == 0 ? 0.0 : static_cast<double>(m_hitsCount) / requestsCount;
+}
+
+double ShapedTextCache::Stats::GetSavedSeconds() const
+{
+  return m_missesCount == 0 ? 0.0 : m_hitsCount * m_shapingSeconds / m_missesCount;
+}
+
+ShapedTextCache & ShapedTextCache::Instance()
+{
+  static ShapedTextCache cache;
+  return cache;
+}
+
+ShapedTextCache::ShapedTextCache(size_t capacity)
+  : m_capacity(capacity)
+{
+  ASSERT_GREATER(m_capacity, 0, ());
+}
+
+void ShapedTextCache::Clear()
+{
+  lock_guard<mutex> lock(m_mutex);
+  m_index.clear();
+  m_entries.clear();
+}
+
+size_t ShapedTextCache::GetSize() const
+{
+  lock_guard<mutex> lock(m_mutex);
+  return m_entries.size();
+}
+
+ShapedTextCache::Stats ShapedTextCache::GetStats() const
+{
+  lock_guard<mutex> lock(m_mutex);
+  return m_stats;
+}
+
+void ShapedTextCache::ResetStats()
+{
+  lock_guard<mutex> lock(m_mutex);
+  m_stats = Stats();
+}
+
+bool ShapedTextCache::Find(ShapedTextKey const & key, ShapedText & shapedText)
+{
+  lock_guard<mutex> lock(m_mutex);
+  auto const it = m_index.find(key);
+  if (it == m_index.end())
+    return false;
+
+  m_entries.splice(m_entries.begin(), m_entries, it->second);
+  shapedText = it->second->second;
+  ++m_stats.m_hitsCount;
+  return true;
+}
+
+void ShapedTextCache::Insert(ShapedTextKey const & key, ShapedText const & shapedText,
+                             double shapingSeconds)
+{
+  lock_guard<mutex> lock(m_mutex);
+  ++m_stats.m_missesCount;
+  m_stats.m_shapingSeconds += shapingSeconds;
+
+  // Another thread has shaped the same text meanwhile.
+  if (m_index.find(key) != m_index.end())
+    return;
+
+  if (m_entries.size() == m_capacity)
+  {
+    m_index.erase(m_entries.back().first);
+    m_entries.pop_back();
+  }
+
+  m_entries.push_front(TEntry(key, shapedText));
+  m_index.insert(make_pair(key, m_entries.begin()));
+}
+
+size_t ShapedTextCache::KeyHash::operator()(ShapedTextKey const & key) const
+{
+  // FNV-1a over characters.
+  uint64_t hash = 14695981039346656037ULL;
+  for (strings::UniChar const c : key.m_text)
+  {
+    hash ^= c;
+    hash *= 1099511628211ULL;
+  }
+  return static_cast<size_t>(hash ^ static_cast<uint64_t>(key.m_splitLines));
+}
+
+string DebugPrint(ShapedTextCache::Stats const & stats)
+{
+  ostringstream out;
+  out << "ShapedTextCache::Stats [ hits: " << stats.m_hitsCount
+      << ", misses: " << stats.m_missesCount
+      << ", hit rate: " << stats.GetHitRate()
+      << ", shaping seconds: " << stats.m_shapingSeconds
+      << ", saved seconds: " << stats.GetSavedSeconds() << " ]";
+  return out.str();
+}
+
+} // namespace df
@@ -0,0 +1,108 @@
+#pragma once
+
+#include "drape/texture_manager.hpp"
+
+#include "base/buffer_vector.hpp"
+#include "base/string_utils.hpp"
+#include "base/timer.hpp"
+
+#include "std/list.hpp"
+#include "std/mutex.hpp"
+#include "std/noncopyable.hpp"
+#include "std/string.hpp"
+#include "std/unordered_map.hpp"
+
+namespace df
+{
+
+/// Result of text shaping: glyphs in visual (bidi) order with base metrics and ends of lines.
+/// It doesn't depend on font size, layouts scale base metrics by the size ratio.
+struct ShapedText
+{
+  dp::TextureManager::TGlyphsBuffer m_glyphs;
+  buffer_vector<size_t, 2> m_delimIndexes;
+};
+
+struct ShapedTextKey
+{
+  ShapedTextKey(strings::UniString const & text, bool splitLines)
+    : m_text(text), m_splitLines(splitLines) {}
+
+  bool operator==(ShapedTextKey const & other) const
+  {
+    return m_splitLines == other.m_splitLines && m_text == other.m_text;
+  }
+
+  strings::UniString m_text;
+  bool m_splitLines;
+};
+
+/// Process-wide LRU cache of shaped texts, shared by all threads which build tiles.
+/// The same street and place names are shaped again and again on every tile of a city,
+/// the cache keeps them between tiles.
+/// Glyph regions point to textures of the texture manager, so the cache must be cleared
+/// before the textures are released.
+class ShapedTextCache : private noncopyable
+{
+public:
+  struct Stats
+  {
+    uint64_t m_hitsCount = 0;
+    uint64_t m_missesCount = 0;
+    /// Time spent on shaping of missed texts.
+    double m_shapingSeconds = 0.0;
+
+    double GetHitRate() const;
+    /// Estimation of time saved by hits, with the average shaping time of missed texts.
+    double GetSavedSeconds() const;
+  };
+
+  static size_t const kDefaultCapacity = 4096;
+
+  static ShapedTextCache & Instance();
+
+  explicit ShapedTextCache(size_t capacity = kDefaultCapacity);
+
+  /// Copies the cached result to shapedText or calls shapeFn(shapedText) and caches it.
+  /// Shaping runs without the lock, so a text may be shaped by several threads at once.
+  template <typename TShapeFn>
+  void Get(ShapedTextKey const & key, TShapeFn const & shapeFn, ShapedText & shapedText)
+  {
+    if (Find(key, shapedText))
+      return;
+
+    my::Timer timer;
+    shapeFn(shapedText);
+    Insert(key, shapedText, timer.ElapsedSeconds());
+  }
+
+  void Clear();
+
+  size_t GetSize() const;
+  Stats GetStats() const;
+  void ResetStats();
+
+private:
+  bool Find(ShapedTextKey const & key, ShapedText & shapedText);
+  void Insert(ShapedTextKey const & key, ShapedText const & shapedText, double shapingSeconds);
+
+  struct KeyHash
+  {
+    size_t operator()(ShapedTextKey const & key) const;
+  };
+
+  typedef pair<ShapedTextKey, ShapedText> TEntry;
+  typedef list<TEntry> TEntries;
+
+  size_t const m_capacity;
+
+  mutable mutex m_mutex;
+  /// Most recently used entries go first.
+  TEntries m_entries;
+  unordered_map<ShapedTextKey, TEntries::iterator, KeyHash> m_index;
+  Stats m_stats;
+};
+
+string DebugPrint(ShapedTextCache::Stats const & stats);
+
+} // namespace df
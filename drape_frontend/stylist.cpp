@@ -100,8 +100,9 @@ public:
     Init();
   }
 
-  void ProcessKey(drule::Key const & key)
+  void ProcessRule(drule::TableRule const & rule)
   {
+    drule::Key const & key = rule.m_key;
     double depth = key.m_priority;
     if (IsMiddleTunnel(m_depthLayer, depth) &&
         IsTypeOf(key, Line | Area | Waymarker))
@@ -119,13 +120,12 @@ public:
     else if (IsTypeOf(key, Area))
       depth -= m_priorityModifier;
 
-    drule::BaseRule const * dRule = drule::rules().Find(key);
-    m_rules.push_back(make_pair(dRule, depth));
+    m_rules.push_back(make_pair(rule.m_rule, depth));
 
     bool isNonEmptyCaption = IsTypeOf(key, Caption) && m_isNameExists;
     m_pointStyleFinded |= (IsTypeOf(key, Symbol | Circle) || isNonEmptyCaption);
     m_lineStyleFinded  |= IsTypeOf(key, Line);
-    m_auxCaptionFinded |= (dRule->GetCaption(1) != 0);
+    m_auxCaptionFinded |= rule.m_hasAuxCaption;
   }
 
   bool m_pointStyleFinded;
@@ -329,7 +329,7 @@ bool InitStylist(FeatureType const & f,
                  int const zoomLevel,
                  Stylist & s)
 {
-  drule::KeysT keys;
+  drule::TableRulesT keys;
   pair<int, bool> geomType = feature::GetDrawRule(f, zoomLevel, keys);
 
   if (keys.empty())
@@ -360,7 +360,7 @@ bool InitStylist(FeatureType const & f,
   descr.Init(f, zoomLevel);
 
   KeyFunctor keyFunctor(f, mainGeomType, zoomLevel, keys.size(), descr.IsNameExists());
-  for_each(keys.begin(), keys.end(), bind(&KeyFunctor::ProcessKey, &keyFunctor, _1));
+  for_each(keys.begin(), keys.end(), bind(&KeyFunctor::ProcessRule, &keyFunctor, _1));
 
   if (keyFunctor.m_pointStyleFinded)
     s.RaisePointStyleFlag();
@@ -1,5 +1,6 @@
 #include "drape_frontend/text_layout.hpp"
 #include "drape_frontend/fribidi.hpp"
+#include "drape_frontend/shaped_text_cache.hpp"
 
 #include "drape/glsl_func.hpp"
 
@@ -248,13 +249,33 @@ void CalculateOffsets(dp::Anchor anchor,
   pixelSize = m2::PointU(maxLength, summaryHeight);
 }
 
+void ShapeText(strings::UniString const & text, bool splitLines,
+               dp::RefPointer<dp::TextureManager> textures, ShapedText & result)
+{
+  strings::UniString visibleText = fribidi::log2vis(text);
+  if (splitLines && visibleText == text)
+    SplitText(visibleText, result.m_delimIndexes);
+  else
+    result.m_delimIndexes.push_back(visibleText.size());
+
+  textures->GetGlyphRegions(visibleText, result.m_glyphs);
+}
+
 } // namespace
 
-void TextLayout::Init(strings::UniString const & text, float fontSize,
-                      dp::RefPointer<dp::TextureManager> textures)
+void TextLayout::Init(strings::UniString const & text, float fontSize, bool splitLines,
+                      dp::RefPointer<dp::TextureManager> textures,
+                      buffer_vector<size_t, 2> & delimIndexes)
 {
   m_textSizeRatio = fontSize / BASE_HEIGHT;
-  textures->GetGlyphRegions(text, m_metrics);
+
+  ShapedText shapedText;
+  ShapedTextCache::Instance().Get(ShapedTextKey(text, splitLines), [&](ShapedText & result)
+  {
+    ShapeText(text, splitLines, textures, result);
+  }, shapedText);
+  m_metrics.swap(shapedText.m_glyphs);
+  delimIndexes.swap(shapedText.m_delimIndexes);
 }
 
 dp::RefPointer<dp::Texture> TextLayout::GetMaskTexture() const
@@ -290,14 +311,8 @@ float TextLayout::GetPixelHeight() const
 StraightTextLayout::StraightTextLayout(strings::UniString const & text, float fontSize,
                                        dp::RefPointer<dp::TextureManager> textures, dp::Anchor anchor)
 {
-  strings::UniString visibleText = fribidi::log2vis(text);
   buffer_vector<size_t, 2> delimIndexes;
-  if (visibleText == text)
-    SplitText(visibleText, delimIndexes);
-  else
-    delimIndexes.push_back(visibleText.size());
-
-  TBase::Init(visibleText, fontSize, textures);
+  TBase::Init(text, fontSize, true /* splitLines */, textures, delimIndexes);
   CalculateOffsets(anchor, m_textSizeRatio, m_metrics, delimIndexes, m_offsets, m_pixelSize);
 }
 
@@ -323,7 +338,8 @@ void StraightTextLayout::Cache(glm::vec3 const & pivot, glm::vec2 const & pixelO
 PathTextLayout::PathTextLayout(strings::UniString const & text, float fontSize,
                                dp::RefPointer<dp::TextureManager> textures)
 {
-  Init(fribidi::log2vis(text), fontSize, textures);
+  buffer_vector<size_t, 2> delimIndexes;
+  Init(text, fontSize, false /* splitLines */, textures, delimIndexes);
 }
 
 void PathTextLayout::CacheStaticGeometry(glm::vec3 const & pivot,
@@ -39,9 +39,12 @@ public:
   float GetPixelHeight() const;
 
 protected:
+  /// Shaped text is taken from ShapedTextCache, delimIndexes gets ends of lines.
   void Init(strings::UniString const & text,
             float fontSize,
-            dp::RefPointer<dp::TextureManager> textures);
+            bool splitLines,
+            dp::RefPointer<dp::TextureManager> textures,
+            buffer_vector<size_t, 2> & delimIndexes);
 
 protected:
   typedef dp::TextureManager::GlyphRegion GlyphRegion;
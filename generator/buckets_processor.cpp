@@ -0,0 +1,139 @@
+#include "generator/buckets_processor.hpp"
+
+#include "base/assert.hpp"
+#include "base/logging.hpp"
+#include "base/thread.hpp"
+#include "base/timer.hpp"
+
+#include "std/algorithm.hpp"
+#include "std/numeric.hpp"
+
+namespace
+{
+// Intermediate data of passes is several times bigger than features data.
+uint64_t constexpr kMemoryPerDataByte = 4;
+uint64_t constexpr kBaseMemory = 64 * 1024 * 1024;
+}  // namespace
+
+namespace feature
+{
+BucketsProcessor::BucketsProcessor(size_t threadsCount, uint64_t memoryBudget)
+  : m_threadsCount(threadsCount), m_memoryBudget(memoryBudget)
+{
+  CHECK_GREATER(m_threadsCount, 0, ());
+}
+
+// static
+uint64_t BucketsProcessor::EstimateMemory(uint64_t dataFileSize)
+{
+  return kBaseMemory + dataFileSize * kMemoryPerDataByte;
+}
+
+vector<string> BucketsProcessor::Run(vector<Bucket> const & buckets, TProcessFn const & fn)
+{
+  // The biggest buckets go first, so the last processed buckets are small and
+  // threads finish at close times.
+  vector<size_t> order(buckets.size());
+  iota(order.begin(), order.end(), 0);
+  stable_sort(order.begin(), order.end(), [&buckets](size_t i1, size_t i2)
+  {
+    return buckets[i1].m_memory > buckets[i2].m_memory;
+  });
+
+  m_buckets.clear();
+  for (size_t i : order)
+    m_buckets.push_back(buckets[i]);
+  m_taken.assign(m_buckets.size(), false);
+  m_failed.assign(m_buckets.size(), false);
+  m_takenCount = m_inProgressCount = 0;
+  m_usedMemory = 0;
+
+  my::Timer timer;
+  size_t const threadsCount = min(m_threadsCount, m_buckets.size());
+  LOG(LINFO, ("Processing of", m_buckets.size(), "buckets in", threadsCount, "threads"));
+  {
+    vector<threads::SimpleThread> threads;
+    for (size_t i = 0; i < threadsCount; ++i)
+      threads.emplace_back([this, &fn]() { ProcessBuckets(fn); });
+    for (auto & thread : threads)
+      thread.join();
+  }
+  LOG(LINFO, ("Processing of buckets is finished in", timer.ElapsedSeconds(), "seconds"));
+
+  vector<bool> failed(buckets.size());
+  for (size_t i = 0; i < order.size(); ++i)
+    failed[order[i]] = m_failed[i];
+
+  vector<string> failedNames;
+  for (size_t i = 0; i < buckets.size(); ++i)
+  {
+    if (failed[i])
+      failedNames.push_back(buckets[i].m_name);
+  }
+  return failedNames;
+}
+
+bool BucketsProcessor::TakeBucket(size_t & index)
+{
+  unique_lock<mutex> lock(m_mutex);
+  while (true)
+  {
+    if (m_takenCount == m_buckets.size())
+      return false;
+
+    // The biggest bucket which fits the budget, or the first not taken one
+    // when nothing is processed.
+    index = m_buckets.size();
+    size_t first = m_buckets.size();
+    for (size_t i = 0; i < m_buckets.size(); ++i)
+    {
+      if (m_taken[i])
+        continue;
+      if (first == m_buckets.size())
+        first = i;
+      if (m_memoryBudget == 0 || m_usedMemory + m_buckets[i].m_memory <= m_memoryBudget)
+      {
+        index = i;
+        break;
+      }
+    }
+    if (index == m_buckets.size() && m_inProgressCount == 0)
+      index = first;
+
+    if (index != m_buckets.size())
+    {
+      m_taken[index] = true;
+      ++m_takenCount;
+      ++m_inProgressCount;
+      m_usedMemory += m_buckets[index].m_memory;
+      return true;
+    }
+
+    m_memoryFreed.wait(lock);
+  }
+}
+
+void BucketsProcessor::ProcessBuckets(TProcessFn const & fn)
+{
+  while (true)
+  {
+    size_t index;
+    if (!TakeBucket(index))
+      return;
+
+    Bucket const & bucket = m_buckets[index];
+    my::Timer timer;
+    bool const ok = fn(bucket.m_name);
+    LOG(LINFO, ("Bucket", bucket.m_name, ok ? "is processed in" : "is failed in",
+                timer.ElapsedSeconds(), "seconds"));
+
+    {
+      lock_guard<mutex> lock(m_mutex);
+      m_failed[index] = !ok;
+      --m_inProgressCount;
+      m_usedMemory -= bucket.m_memory;
+    }
+    m_memoryFreed.notify_all();
+  }
+}
+}  // namespace feature
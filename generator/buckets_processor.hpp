@@ -0,0 +1,55 @@
+#pragma once
+
+#include "std/condition_variable.hpp"
+#include "std/function.hpp"
+#include "std/mutex.hpp"
+#include "std/string.hpp"
+#include "std/vector.hpp"
+
+namespace feature
+{
+/// Runs per-bucket generation passes (geometry, index, search index, routing) for several
+/// buckets at the same time. Buckets are processed by a pool of threadsCount threads, the
+/// biggest ones go first. The sum of memory estimations of processed buckets doesn't exceed
+/// memoryBudget, except a bucket which doesn't fit the budget alone: it's processed when
+/// no other bucket is processed.
+class BucketsProcessor
+{
+public:
+  struct Bucket
+  {
+    string m_name;
+    uint64_t m_memory;
+  };
+
+  /// @return false if passes for the bucket are failed.
+  using TProcessFn = function<bool(string const & name)>;
+
+  /// @param memoryBudget  Budget in bytes, 0 means no limit.
+  BucketsProcessor(size_t threadsCount, uint64_t memoryBudget);
+
+  /// @return names of failed buckets in the order of buckets.
+  vector<string> Run(vector<Bucket> const & buckets, TProcessFn const & fn);
+
+  /// Estimates memory for processing of the bucket by the size of its data file.
+  static uint64_t EstimateMemory(uint64_t dataFileSize);
+
+private:
+  /// @return false if all buckets are taken.
+  bool TakeBucket(size_t & index);
+  void ProcessBuckets(TProcessFn const & fn);
+
+  size_t const m_threadsCount;
+  uint64_t const m_memoryBudget;
+
+  mutex m_mutex;
+  condition_variable m_memoryFreed;
+  // Buckets sorted by memory, and flags of taken ones.
+  vector<Bucket> m_buckets;
+  vector<bool> m_taken;
+  vector<bool> m_failed;
+  size_t m_takenCount = 0;
+  size_t m_inProgressCount = 0;
+  uint64_t m_usedMemory = 0;
+};
+}  // namespace feature
@@ -1,12 +1,16 @@
 #include "generator/coastlines_generator.hpp"
 #include "generator/feature_builder.hpp"
 
+#include "indexer/mercator.hpp"
 #include "indexer/point_to_int64.hpp"
 
+#include "geometry/rect_intersect.hpp"
 #include "geometry/region2d/binary_operators.hpp"
 
+#include "base/math.hpp"
 #include "base/string_utils.hpp"
 #include "base/logging.hpp"
+#include "base/thread.hpp"
 
 #include "std/bind.hpp"
 #include "std/condition_variable.hpp"
@@ -19,8 +23,10 @@ typedef m2::PointI PointT;
 typedef m2::RectI RectT;
 
 CoastlineFeaturesGenerator::CoastlineFeaturesGenerator(uint32_t coastType)
-  : m_merger(POINT_COORD_BITS), m_coastType(coastType)
+  : m_coastType(coastType)
 {
+  for (size_t i = 0; i < kPartitionsCount * kPartitionsCount; ++i)
+    m_mergers.emplace_back(new FeatureMergeProcessor(POINT_COORD_BITS));
 }
 
 namespace
@@ -37,6 +43,18 @@ namespace
     return PointT(static_cast<int32_t>(pu.x), static_cast<int32_t>(pu.y));
   }
 
+  /// @return index of the partition of count x count grid which contains the point.
+  size_t GetPartition(m2::PointD const & pt, size_t count)
+  {
+    auto const index = [count](double v, double minV, double maxV)
+    {
+      double const i = (v - minV) / (maxV - minV) * count;
+      return static_cast<size_t>(my::clamp(i, 0.0, count - 1.0));
+    };
+    return index(pt.y, MercatorBounds::minY, MercatorBounds::maxY) * count +
+           index(pt.x, MercatorBounds::minX, MercatorBounds::maxX);
+  }
+
   template <class TreeT> class DoCreateRegion
   {
     TreeT & m_tree;
@@ -88,7 +106,7 @@ void CoastlineFeaturesGenerator::operator()(FeatureBuilder1 const & fb)
   if (fb.IsGeometryClosed())
     AddRegionToTree(fb);
   else
-    m_merger(fb);
+    (*m_mergers[GetPartition(fb.GetOuterGeometry().front(), kPartitionsCount)])(fb);
 }
 
 namespace
@@ -130,12 +148,62 @@ namespace
       return m_totalNotMergedCoastsPoints;
     }
   };
+
+  /// Collects coasts merged in a partition: closed ones are converted to regions
+  /// and not closed ones are merged with coasts of other partitions.
+  class DoCollectMerged : public FeatureEmitterIFace
+  {
+  public:
+    vector<pair<RegionT, m2::RectD>> m_regions;
+    vector<FeatureBuilder1> m_notClosed;
+
+    void Add(RegionT const & rgn, m2::RectD const & rect) { m_regions.emplace_back(rgn, rect); }
+
+    virtual void operator() (FeatureBuilder1 const & fb)
+    {
+      if (fb.IsGeometryClosed())
+      {
+        DoCreateRegion<DoCollectMerged> createRgn(*this);
+        fb.ForEachGeometryPointEx(createRgn);
+      }
+      else
+      {
+        m_notClosed.push_back(fb);
+      }
+    }
+  };
 }
 
 bool CoastlineFeaturesGenerator::Finish()
 {
+  // Coasts of partitions are merged in parallel.
+  vector<DoCollectMerged> merged(m_mergers.size());
+  threads::RunInThreads(m_mergers.size(), thread::hardware_concurrency(), [this, &merged]()
+  {
+    return [this, &merged](size_t i)
+    {
+      m_mergers[i]->DoMerge(merged[i]);
+      m_mergers[i].reset();
+    };
+  });
+  m_mergers.clear();
+
+  // Coasts which cross partitions are merged at last.
+  FeatureMergeProcessor merger(POINT_COORD_BITS);
+  size_t crossingCount = 0;
+  for (DoCollectMerged & partition : merged)
+  {
+    for (auto const & rgn : partition.m_regions)
+      m_tree.Add(rgn.first, rgn.second);
+    for (FeatureBuilder1 const & fb : partition.m_notClosed)
+      merger(fb);
+    crossingCount += partition.m_notClosed.size();
+    partition = DoCollectMerged();
+  }
+  LOG(LINFO, ("Coasts crossing merging partitions:", crossingCount));
+
   DoAddToTree doAdd(*this);
-  m_merger.DoMerge(doAdd);
+  merger.DoMerge(doAdd);
 
   if (doAdd.HasNotMergedCoasts())
   {
@@ -154,6 +222,46 @@ class DoDifference
   RectT m_src;
   vector<RegionT> m_res;
   vector<m2::PointD> m_points;
+  // Count of regions which contain the source rect.
+  size_t m_coveringCount = 0;
+
+  /// Checks if a region's boundary has common points with the source rect.
+  class BoundaryChecker
+  {
+    m2::RectD m_rect;
+    m2::PointD m_first;
+    m2::PointD m_prev;
+    bool m_started = false;
+
+  public:
+    bool m_crosses = false;
+
+    explicit BoundaryChecker(RectT const & r) : m_rect(r.minX(), r.minY(), r.maxX(), r.maxY()) {}
+
+    void operator()(PointT const & p)
+    {
+      m2::PointD const pt(p.x, p.y);
+      if (m_started)
+        CheckSegment(m_prev, pt);
+      else
+        m_first = pt;
+      m_started = true;
+      m_prev = pt;
+    }
+
+    void CheckSegment(m2::PointD p1, m2::PointD p2)
+    {
+      if (!m_crosses)
+        m_crosses = m2::Intersect(m_rect, p1, p2);
+    }
+
+    bool Crosses()
+    {
+      if (m_started)
+        CheckSegment(m_prev, m_first);
+      return m_crosses;
+    }
+  };
 
 public:
   DoDifference(RegionT const & rgn)
@@ -167,11 +275,37 @@ public:
     // if r is fully inside source rect region,
     // put it to the result vector without any intersection
     if (m_src.IsRectInside(r.GetRect()))
+    {
       m_res.push_back(r);
-    else
-      m2::IntersectRegions(m_res.front(), r, m_res);
+      return;
+    }
+
+    // Fast path: if the boundary of r doesn't touch the rect, the rect is inside r or outside of it,
+    // and the intersection is the whole rect or nothing.
+    BoundaryChecker checker(m_src);
+    r.ForEachPoint(ref(checker));
+    if (!checker.Crosses())
+    {
+      if (r.Contains(m_src.LeftBottom()))
+        ++m_coveringCount;
+      return;
+    }
+
+    m2::IntersectRegions(m_res.front(), r, m_res);
   }
 
+  /// Should be called after all regions.
+  /// Every region covering the source rect gives one more copy of the rect, and two copies
+  /// cancel each other in 'odd' filling, so the rect is left if the count of copies is odd.
+  void Finish()
+  {
+    if (m_coveringCount % 2 == 1)
+      m_res.erase(m_res.begin());
+  }
+
+  /// @return true if the whole rect is land.
+  bool IsEmpty() const { return m_res.empty(); }
+
   void operator()(PointT const & p)
   {
     m_points.push_back(PointU2PointD(
@@ -268,6 +402,11 @@ public:
     // In 'odd' parts we will have an ocean.
     DoDifference doDiff(rectR);
     m_index.ForEachInRect(GetLimitRect(rectR), bind<void>(ref(doDiff), _1));
+    doDiff.Finish();
+
+    // There is no water in the cell.
+    if (doDiff.IsEmpty())
+      return true;
 
     // Check if too many points for feature.
     if (cell.Level() < kHighLevel && doDiff.GetPointsCount() >= kMaxPoints)
@@ -307,7 +446,7 @@ public:
   }
 };
 
-void CoastlineFeaturesGenerator::GetFeatures(vector<FeatureBuilder1> & features)
+void CoastlineFeaturesGenerator::EmitFeatures(TEmitFn const & emitFn)
 {
   size_t const maxThreads = thread::hardware_concurrency();
   CHECK_GREATER(maxThreads, 0, ("Not supported platform"));
@@ -315,7 +454,7 @@ void CoastlineFeaturesGenerator::GetFeatures(vector<FeatureBuilder1> & features)
   mutex featuresMutex;
   RegionInCellSplitter::Process(
       maxThreads, RegionInCellSplitter::kStartLevel, m_tree,
-      [&features, &featuresMutex, this](RegionInCellSplitter::TCell const & cell, DoDifference & cellData)
+      [&emitFn, &featuresMutex, this](RegionInCellSplitter::TCell const & cell, DoDifference & cellData)
       {
         FeatureBuilder1 fb;
         fb.SetCoastCell(cell.ToInt64(RegionInCellSplitter::kHighLevel + 1), cell.ToString());
@@ -328,8 +467,8 @@ void CoastlineFeaturesGenerator::GetFeatures(vector<FeatureBuilder1> & features)
         CHECK_GREATER(fb.GetPolygonsCount(), 0, ());
         CHECK_GREATER_OR_EQUAL(fb.GetPointsCount(), 3, ());
 
-        // save result
+        // emit result
         lock_guard<mutex> lock(featuresMutex);
-        features.emplace_back(move(fb));
+        emitFn(fb);
       });
 }
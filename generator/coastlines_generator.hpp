@@ -8,11 +8,19 @@
 #include "geometry/region2d.hpp"
 
 
+#include "std/function.hpp"
+#include "std/unique_ptr.hpp"
+#include "std/vector.hpp"
+
+
 class FeatureBuilder1;
 
 class CoastlineFeaturesGenerator
 {
-  FeatureMergeProcessor m_merger;
+  /// Not closed coasts are merged in the partitions of kPartitionsCount x kPartitionsCount grid
+  /// by their first points in parallel, then coasts crossing the partitions are merged together.
+  static size_t constexpr kPartitionsCount = 8;
+  vector<unique_ptr<FeatureMergeProcessor>> m_mergers;
 
   using TTree = m4::Tree<m2::RegionI>;
   TTree m_tree;
@@ -20,6 +28,8 @@ class CoastlineFeaturesGenerator
   uint32_t m_coastType;
 
 public:
+  using TEmitFn = function<void(FeatureBuilder1 const &)>;
+
   CoastlineFeaturesGenerator(uint32_t coastType);
 
   void AddRegionToTree(FeatureBuilder1 const & fb);
@@ -28,5 +38,7 @@ public:
   /// @return false if coasts are not merged and FLAG_fail_on_coasts is set
   bool Finish();
 
-  void GetFeatures(vector<FeatureBuilder1> & vecFb);
+  /// Emits features of water cells as soon as they are made by splitting threads.
+  /// Calls of emitFn are serialized.
+  void EmitFeatures(TEmitFn const & emitFn);
 };
@@ -17,6 +17,7 @@
 
 #include "geometry/polygon.hpp"
 
+#include "coding/external_sort.hpp"
 #include "coding/internal/file_data.hpp"
 #include "coding/file_container.hpp"
 #include "coding/file_name_utils.hpp"
@@ -28,20 +29,26 @@ namespace
 {
   typedef pair<uint64_t, uint64_t> CellAndOffsetT;
 
+  struct CellAndOffsetKey
+  {
+    uint64_t operator() (CellAndOffsetT const & c) const { return c.first; }
+  };
+
+  template <class TSorter>
   class CalculateMidPoints
   {
     m2::PointD m_midLoc, m_midAll;
     size_t m_locCount, m_allCount;
     uint32_t m_coordBits;
+    TSorter & m_sorter;
 
   public:
-    CalculateMidPoints() :
-      m_midAll(0, 0), m_allCount(0), m_coordBits(serial::CodingParams().GetCoordBits())
+    explicit CalculateMidPoints(TSorter & sorter) :
+      m_midAll(0, 0), m_allCount(0), m_coordBits(serial::CodingParams().GetCoordBits()),
+      m_sorter(sorter)
     {
     }
 
-    vector<CellAndOffsetT> m_vec;
-
     void operator() (FeatureBuilder1 const & ft, uint64_t pos)
     {
       // reset state
@@ -59,7 +66,7 @@ namespace
       if (minScale != -1)
       {
         uint64_t const order = (static_cast<uint64_t>(minScale) << 59) | (pointAsInt64 >> 5);
-        m_vec.push_back(make_pair(order, pos));
+        m_sorter.Add(make_pair(order, pos));
       }
     }
 
@@ -74,11 +81,6 @@ namespace
 
     m2::PointD GetCenter() const { return m_midAll / m_allCount; }
   };
-
-  bool SortMidPointsFunc(CellAndOffsetT const & c1, CellAndOffsetT const & c2)
-  {
-    return c1.first < c2.first;
-  }
 }
 
 namespace feature
@@ -521,6 +523,34 @@ namespace feature
     return static_cast<FeatureBuilder2 &>(fb);
   }
 
+  /// Writes features in the sorted order of their middle points.
+  class SortedFeaturesEmitter
+  {
+    FileReader const & m_reader;
+    FeaturesCollector2 * m_collector = nullptr;
+
+  public:
+    explicit SortedFeaturesEmitter(FileReader const & reader) : m_reader(reader) {}
+
+    void SetCollector(FeaturesCollector2 * collector) { m_collector = collector; }
+
+    void operator() (CellAndOffsetT const & c)
+    {
+      // Features aren't written if the collector isn't created.
+      if (!m_collector)
+        return;
+
+      ReaderSource<FileReader> src(m_reader);
+      src.Skip(c.second);
+
+      FeatureBuilder1 f;
+      ReadFromSourceRowFormat(src, f);
+
+      // emit the feature
+      (*m_collector)(GetFeatureBuilder2(f));
+    }
+  };
+
   class DoStoreLanguages
   {
     DataHeader & m_header;
@@ -542,17 +572,21 @@ namespace feature
     string const srcFilePath = info.GetTmpFileName(name);
     string const datFilePath = info.GetTargetFileName(name);
 
-    // stores cellIds for middle points
-    CalculateMidPoints midPoints;
-    ForEachFromDatRawFormat(srcFilePath, midPoints);
-
-    // sort features by their middle point
-    sort(midPoints.m_vec.begin(), midPoints.m_vec.end(), &SortMidPointsFunc);
-
     // store sorted features
     {
       FileReader reader(srcFilePath);
 
+      // sort features by cellIds of their middle points
+      SortedFeaturesEmitter emitter(reader);
+      using TSorter = ExternalSorter<CellAndOffsetT, SortedFeaturesEmitter, less<CellAndOffsetT>,
+                                     CellAndOffsetKey>;
+      TSorter sorter(static_cast<size_t>(info.m_sortMemorySize),
+                     info.GetTmpFileName(name, SORTED_MID_POINTS_TMP_EXT), emitter,
+                     info.m_sortThreadsCount);
+
+      CalculateMidPoints<TSorter> midPoints(sorter);
+      ForEachFromDatRawFormat(srcFilePath, midPoints);
+
       bool const isWorld = (mapType != DataHeader::country);
 
       // Fill mwm header.
@@ -591,18 +625,8 @@ namespace feature
       try
       {
         FeaturesCollector2 collector(datFilePath, header, info.m_versionDate);
-
-        for (size_t i = 0; i < midPoints.m_vec.size(); ++i)
-        {
-          ReaderSource<FileReader> src(reader);
-          src.Skip(midPoints.m_vec[i].second);
-
-          FeatureBuilder1 f;
-          ReadFromSourceRowFormat(src, f);
-
-          // emit the feature
-          collector(GetFeatureBuilder2(f));
-        }
+        emitter.SetCollector(&collector);
+        sorter.SortAndFinish();
       }
       catch (Writer::Exception const & ex)
       {
@@ -18,13 +18,15 @@ struct GenerateInfo
   {
     Memory,
     Index,
-    File
+    File,
+    Sparse
   };
 
   enum class OsmSourceType
   {
     XML,
-    O5M
+    O5M,
+    PBF
   };
 
 
@@ -45,6 +47,9 @@ struct GenerateInfo
   uint32_t m_versionDate = 0;
 
   vector<string> m_bucketNames;
+  // If not empty, features are split to these countries only and .mwm.tmp files
+  // of other countries are left as is. Used to regenerate countries affected by OsmChange files.
+  vector<string> m_changedCountries;
 
   bool m_createWorld = false;
   bool m_splitByPolygons = false;
@@ -52,7 +57,16 @@ struct GenerateInfo
   bool m_emitCoasts = false;
   bool m_genAddresses = false;
   bool m_failOnCoasts = false;
-  bool m_preloadCache = false;
+  // Memory budget in bytes for preloading of ways and relations.
+  uint64_t m_preloadCacheSize = 0;
+
+  // Count of threads translating OSM elements to features, 1 means translation
+  // in the reading thread.
+  size_t m_translatorThreadsCount = 1;
+
+  // Memory in bytes and count of threads for external sorting of features and cells.
+  uint64_t m_sortMemorySize = 64 << 20;
+  size_t m_sortThreadsCount = 1;
 
 
   GenerateInfo() = default;
@@ -63,6 +77,8 @@ struct GenerateInfo
       m_osmFileType = OsmSourceType::XML;
     else if (type == "o5m")
       m_osmFileType = OsmSourceType::O5M;
+    else if (type == "pbf")
+      m_osmFileType = OsmSourceType::PBF;
     else
       LOG(LCRITICAL, ("Unknown source type:", type));
   }
@@ -75,6 +91,8 @@ struct GenerateInfo
       m_nodeStorageType = NodeStorageType::Index;
     else if (type == "mem")
       m_nodeStorageType = NodeStorageType::Memory;
+    else if (type == "sparse")
+      m_nodeStorageType = NodeStorageType::Sparse;
     else
       LOG(LCRITICAL, ("Incorrect node_storage type:", type));
   }
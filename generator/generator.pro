@@ -16,6 +16,7 @@ QT *= core
 SOURCES += \
     borders_generator.cpp \
     borders_loader.cpp \
+    buckets_processor.cpp \
     check_model.cpp \
     coastlines_generator.cpp \
     dumper.cpp \
@@ -24,11 +25,14 @@ SOURCES += \
     feature_merger.cpp \
     feature_sorter.cpp \
     osm2type.cpp \
+    osm_change.cpp \
     osm_id.cpp \
+    osm_pbf_source.cpp \
     osm_source.cpp \
     routing_generator.cpp \
     statistics.cpp \
     tesselator.cpp \
+    translator_pipeline.cpp \
     unpack_mwm.cpp \
     update_generator.cpp \
     osm_element.cpp \
@@ -36,6 +40,7 @@ SOURCES += \
 HEADERS += \
     borders_generator.hpp \
     borders_loader.hpp \
+    buckets_processor.hpp \
     check_model.hpp \
     coastlines_generator.hpp \
     dumper.hpp \
@@ -51,14 +56,17 @@ HEADERS += \
     osm2meta.hpp \
     osm2type.hpp \
     osm2meta.hpp \
+    osm_change.hpp \
     osm_element.hpp \
     osm_id.hpp \
     osm_o5m_source.hpp \
+    osm_pbf_source.hpp \
     osm_xml_source.hpp \
     polygonizer.hpp \
     routing_generator.hpp \
     statistics.hpp \
     tesselator.hpp \
+    translator_pipeline.hpp \
     unpack_mwm.hpp \
     update_generator.hpp \
     ways_merger.hpp \
@@ -0,0 +1,87 @@
+#include "testing/testing.hpp"
+
+#include "generator/buckets_processor.hpp"
+
+#include "base/string_utils.hpp"
+
+#include "std/algorithm.hpp"
+#include "std/chrono.hpp"
+#include "std/mutex.hpp"
+#include "std/set.hpp"
+#include "std/thread.hpp"
+
+using feature::BucketsProcessor;
+
+UNIT_TEST(BucketsProcessor_MemoryBudget)
+{
+  uint64_t const kBudget = 100;
+  vector<BucketsProcessor::Bucket> buckets;
+  for (uint64_t i = 0; i < 20; ++i)
+    buckets.push_back({strings::to_string(i), i * 7 % 50 + 1});
+  // The bucket which doesn't fit the budget.
+  buckets.push_back({"big", 2 * kBudget});
+
+  mutex mu;
+  set<string> processed;
+  uint64_t usedMemory = 0;
+  uint64_t maxUsedMemory = 0;
+  size_t inProgress = 0;
+  bool bigWithOthers = false;
+
+  BucketsProcessor processor(4 /* threadsCount */, kBudget);
+  vector<string> const failed = processor.Run(buckets, [&](string const & name)
+  {
+    auto const it = find_if(buckets.begin(), buckets.end(),
+                            [&name](BucketsProcessor::Bucket const & b) { return b.m_name == name; });
+    TEST(it != buckets.end(), (name));
+    {
+      lock_guard<mutex> lock(mu);
+      TEST(processed.insert(name).second, (name));
+      usedMemory += it->m_memory;
+      ++inProgress;
+      if (name != "big")
+        maxUsedMemory = max(maxUsedMemory, usedMemory);
+      if (name == "big" && inProgress != 1)
+        bigWithOthers = true;
+    }
+
+    this_thread::sleep_for(milliseconds(1));
+
+    lock_guard<mutex> lock(mu);
+    usedMemory -= it->m_memory;
+    --inProgress;
+    if (name == "big" && inProgress != 0)
+      bigWithOthers = true;
+    return name != "3" && name != "11";
+  });
+
+  TEST_EQUAL(processed.size(), buckets.size(), ());
+  TEST_LESS_OR_EQUAL(maxUsedMemory, kBudget, ());
+  TEST(!bigWithOthers, ());
+  TEST_EQUAL(failed, vector<string>({"3", "11"}), ());
+}
+
+UNIT_TEST(BucketsProcessor_NoBudget)
+{
+  vector<BucketsProcessor::Bucket> buckets;
+  for (uint64_t i = 0; i < 10; ++i)
+    buckets.push_back({strings::to_string(i), i});
+
+  mutex mu;
+  vector<string> processed;
+  BucketsProcessor processor(1 /* threadsCount */, 0 /* memoryBudget */);
+  TEST(processor.Run(buckets, [&](string const & name)
+  {
+    lock_guard<mutex> lock(mu);
+    processed.push_back(name);
+    return true;
+  }).empty(), ());
+
+  // The biggest buckets go first.
+  vector<string> expected;
+  for (int i = 9; i >= 0; --i)
+    expected.push_back(strings::to_string(i));
+  TEST_EQUAL(processed, expected, ());
+
+  TEST(processor.Run({}, [](string const &) { return true; }).empty(), ());
+}
@@ -1,11 +1,14 @@
 #include "testing/testing.hpp"
 
+#include "generator/coastlines_generator.hpp"
 #include "generator/feature_builder.hpp"
 #include "generator/feature_sorter.hpp"
 #include "generator/feature_generator.hpp"
 
 #include "indexer/mercator.hpp"
 #include "indexer/cell_id.hpp"
+#include "indexer/classificator.hpp"
+#include "indexer/classificator_loader.hpp"
 #include "indexer/scales.hpp"
 
 #include "geometry/cellid.hpp"
@@ -176,6 +179,61 @@ namespace
   };
 }
 
+namespace
+{
+  FeatureBuilder1 MakeCoast(vector<m2::PointD> const & points)
+  {
+    FeatureBuilder1 fb;
+    for (m2::PointD const & p : points)
+      fb.AddPoint(p);
+    fb.SetLinear();
+    fb.AddType(classif().GetCoastType());
+    return fb;
+  }
+}
+
+UNIT_TEST(CoastlineFeaturesGenerator_LandSquare)
+{
+  classificator::Load();
+
+  // The square of land which sides start in different merging partitions.
+  double const kSide = 100.0;
+  m2::PointD const corners[] = {m2::PointD(-kSide, -kSide), m2::PointD(-kSide, kSide),
+                                m2::PointD(kSide, kSide), m2::PointD(kSide, -kSide)};
+
+  CoastlineFeaturesGenerator generator(classif().GetCoastType());
+  for (size_t i = 0; i < ARRAY_SIZE(corners); ++i)
+  {
+    m2::PointD const & p1 = corners[i];
+    m2::PointD const & p2 = corners[(i + 1) % ARRAY_SIZE(corners)];
+    generator(MakeCoast({p1, (p1 + p2) / 2, p2}));
+  }
+  TEST(generator.Finish(), ());
+
+  vector<FeatureBuilder1> features;
+  generator.EmitFeatures([&features](FeatureBuilder1 const & fb) { features.push_back(fb); });
+
+  // Cells of level 4 are 22.5 wide, 8 x 8 cells inside the square are land and have no features.
+  m2::RectD const land(-kSide, -kSide, kSide, kSide);
+  TEST_EQUAL(features.size(), 256 - 64, ());
+  for (FeatureBuilder1 const & fb : features)
+  {
+    TEST(fb.IsCoastCell(), ());
+    TEST(!land.IsRectInside(fb.GetLimitRect()), (fb.GetName()));
+    TEST_GREATER(fb.GetPolygonsCount(), 0, ());
+  }
+}
+
+UNIT_TEST(CoastlineFeaturesGenerator_NotMerged)
+{
+  classificator::Load();
+
+  CoastlineFeaturesGenerator generator(classif().GetCoastType());
+  generator(MakeCoast({m2::PointD(0, 0), m2::PointD(10, 0), m2::PointD(10, 10)}));
+  generator(MakeCoast({m2::PointD(10, 10), m2::PointD(100, 100)}));
+  TEST(!generator.Finish(), ());
+}
+
 /*
 UNIT_TEST(WorldCoasts_CheckBounds)
 {
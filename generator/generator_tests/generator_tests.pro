@@ -18,16 +18,22 @@ HEADERS += \
 
 SOURCES += \
     ../../testing/testingmain.cpp \
+    buckets_processor_test.cpp \
     check_mwms.cpp \
     classificator_tests.cpp \
     coasts_test.cpp \
     feature_builder_test.cpp \
     feature_merger_test.cpp \
+    intermediate_cache_test.cpp \
     metadata_test.cpp \
+    node_storage_test.cpp \
+    osm_change_test.cpp \
     osm_id_test.cpp \
     osm_o5m_source_test.cpp \
     osm_type_test.cpp \
+    polygonizer_test.cpp \
     tesselator_test.cpp \
+    translator_pipeline_test.cpp \
     triangles_tree_coding_test.cpp \
     source_to_element_test.cpp \
     source_data.cpp \
@@ -0,0 +1,155 @@
+#include "testing/testing.hpp"
+
+#include "generator/intermediate_data.hpp"
+
+#include "platform/platform.hpp"
+
+#include "coding/file_writer.hpp"
+#include "coding/internal/file_data.hpp"
+
+#include "base/logging.hpp"
+#include "base/scope_guard.hpp"
+
+#include "std/algorithm.hpp"
+#include "std/bind.hpp"
+#include "std/map.hpp"
+#include "std/random.hpp"
+
+using namespace cache;
+
+namespace
+{
+using TIndexWriter = detail::IndexFile<EMode::Write, uint64_t>;
+using TIndexReader = detail::IndexFile<EMode::Read, uint64_t>;
+
+vector<uint64_t> GetValues(TIndexReader const & index, uint64_t key)
+{
+  vector<uint64_t> values;
+  index.ForEachByKey(key, [&values](uint64_t value)
+  {
+    values.push_back(value);
+    return false;
+  });
+  return values;
+}
+
+WayElement MakeWay(uint64_t id)
+{
+  WayElement way(id);
+  for (uint64_t i = 0; i < id % 7 + 2; ++i)
+    way.nodes.push_back(id * 10 + i);
+  return way;
+}
+}  // namespace
+
+UNIT_TEST(IndexFile_SortedRuns)
+{
+  string const name = GetPlatform().WritablePathForFile("index_file_test");
+  MY_SCOPE_GUARD(deleteFile, bind(&FileWriter::DeleteFileX, cref(name)));
+
+  // Keys with duplicates which span several pages, written by several runs.
+  mt19937 rnd(0);
+  uniform_int_distribution<uint64_t> keys(1, 3000);
+  multimap<uint64_t, uint64_t> expected;
+  {
+    TIndexWriter index(name, 1000 /* runSize */);
+    for (uint64_t i = 0; i < 10000; ++i)
+    {
+      uint64_t const key = (i < 1000 ? 1500 : keys(rnd) * 2);
+      index.Add(key, i);
+      expected.emplace(key, i);
+    }
+    index.WriteAll();
+  }
+  uint64_t runsSize;
+  TEST(!my::GetFileSize(name + ".runs", runsSize), ());
+
+  TIndexReader index(name);
+  index.ReadAll();
+  for (uint64_t key = 0; key <= 6002; ++key)
+  {
+    vector<uint64_t> expectedValues;
+    auto const range = expected.equal_range(key);
+    for (auto it = range.first; it != range.second; ++it)
+      expectedValues.push_back(it->second);
+    sort(expectedValues.begin(), expectedValues.end());
+
+    TEST_EQUAL(GetValues(index, key), expectedValues, (key));
+
+    uint64_t value;
+    TEST_EQUAL(index.GetValueByKey(key, value), !expectedValues.empty(), (key));
+    if (!expectedValues.empty())
+      TEST_EQUAL(value, expectedValues.front(), (key));
+  }
+}
+
+UNIT_TEST(IndexFile_Empty)
+{
+  string const name = GetPlatform().WritablePathForFile("index_file_test");
+  MY_SCOPE_GUARD(deleteFile, bind(&FileWriter::DeleteFileX, cref(name)));
+
+  TIndexWriter(name).WriteAll();
+
+  TIndexReader index(name);
+  index.ReadAll();
+  uint64_t value;
+  TEST(!index.GetValueByKey(1, value), ());
+  TEST(GetValues(index, 0).empty(), ());
+}
+
+UNIT_TEST(OSMElementCache_ReadBatch)
+{
+  string const name = GetPlatform().WritablePathForFile("element_cache_test");
+  string const offsetsName = name + OFFSET_EXT;
+  MY_SCOPE_GUARD(deleteFile, bind(&FileWriter::DeleteFileX, cref(name)));
+  MY_SCOPE_GUARD(deleteOffsets, bind(&FileWriter::DeleteFileX, cref(offsetsName)));
+
+  // Ways are written in descending order of ids, as the index has to be sorted.
+  uint64_t const kWaysCount = 3000;
+  {
+    OSMElementCache<EMode::Write> cache(name);
+    for (uint64_t id = kWaysCount; id > 0; --id)
+      cache.Write(id * 3, MakeWay(id * 3));
+    cache.SaveOffsets();
+  }
+
+  // Every fifth way, missing ways and duplicates.
+  vector<uint64_t> ids;
+  for (uint64_t id = 1; id <= kWaysCount * 3; id += 5)
+    ids.push_back(id);
+  shuffle(ids.begin(), ids.end(), mt19937(0));
+  ids.push_back(ids.front());
+
+  my::LogLevel const oldLevel = my::g_LogAbortLevel;
+  my::g_LogAbortLevel = LCRITICAL;
+  MY_SCOPE_GUARD(restoreLevel, [oldLevel]() { my::g_LogAbortLevel = oldLevel; });
+
+  // Without preloading, with the preloaded half of the file and with the whole file.
+  for (uint64_t preloadSize : {uint64_t(0), uint64_t(30000), numeric_limits<uint64_t>::max()})
+  {
+    OSMElementCache<EMode::Read> cache(name, preloadSize);
+    cache.LoadOffsets();
+
+    vector<WayElement> ways;
+    for (uint64_t id : ids)
+      ways.emplace_back(id);
+    vector<bool> found;
+    size_t const count = cache.ReadBatch(ids, ways, found);
+
+    size_t expectedCount = 0;
+    for (size_t i = 0; i < ids.size(); ++i)
+    {
+      WayElement way(ids[i]);
+      bool const expectedFound = (ids[i] % 3 == 0);
+      TEST_EQUAL(cache.Read(ids[i], way), expectedFound, (ids[i], preloadSize));
+      TEST_EQUAL(found[i], expectedFound, (ids[i], preloadSize));
+      if (!expectedFound)
+        continue;
+
+      ++expectedCount;
+      TEST_EQUAL(way.nodes, MakeWay(ids[i]).nodes, (ids[i], preloadSize));
+      TEST_EQUAL(ways[i].nodes, way.nodes, (ids[i], preloadSize));
+    }
+    TEST_EQUAL(count, expectedCount, (preloadSize));
+  }
+}
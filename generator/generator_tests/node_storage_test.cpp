@@ -0,0 +1,242 @@
+#include "testing/benchmark.hpp"
+#include "testing/testing.hpp"
+
+#include "generator/intermediate_data.hpp"
+
+#include "platform/platform.hpp"
+
+#include "coding/file_reader.hpp"
+#include "coding/file_writer.hpp"
+
+#include "base/logging.hpp"
+#include "base/math.hpp"
+#include "base/scope_guard.hpp"
+#include "base/timer.hpp"
+
+#include "std/algorithm.hpp"
+#include "std/bind.hpp"
+#include "std/random.hpp"
+
+using namespace cache;
+
+namespace
+{
+struct TestNode
+{
+  uint64_t m_id;
+  double m_lat;
+  double m_lon;
+};
+
+// Nodes with ascending ids and gaps between them as in real data.
+vector<TestNode> MakeNodes(size_t count)
+{
+  mt19937 rnd(0);
+  uniform_int_distribution<uint64_t> gap(1, 30);
+  uniform_int_distribution<int32_t> step(-1000, 1000);
+
+  vector<TestNode> nodes(count);
+  uint64_t id = 1000;
+  int32_t lat = 557500000, lon = 376200000;
+  for (auto & node : nodes)
+  {
+    id += gap(rnd);
+    lat += step(rnd);
+    lon += step(rnd);
+    node = {id, lat / 1E+7, lon / 1E+7};
+  }
+  return nodes;
+}
+
+template <class TWriteStorage>
+void WriteNodes(string const & name, vector<TestNode> const & nodes)
+{
+  TWriteStorage storage(name);
+  for (auto const & node : nodes)
+    storage.AddPoint(node.m_id, node.m_lat, node.m_lon);
+  TEST_EQUAL(storage.GetProcessedPoint(), nodes.size(), ());
+}
+
+template <class TReadStorage>
+void TestReadNodes(TReadStorage const & storage, vector<TestNode> const & nodes)
+{
+  for (auto const & node : nodes)
+  {
+    double lat, lon;
+    TEST(storage.GetPoint(node.m_id, lat, lon), (node.m_id));
+    // Coordinates are stored with 1E-7 precision.
+    TEST(my::AlmostEqualAbs(lat, node.m_lat, 2E-7), (node.m_id, lat, node.m_lat));
+    TEST(my::AlmostEqualAbs(lon, node.m_lon, 2E-7), (node.m_id, lon, node.m_lon));
+  }
+}
+
+template <class TReadStorage>
+double LookupNodesPerSecond(TReadStorage const & storage, vector<uint64_t> const & ids)
+{
+  my::Timer timer;
+  double sum = 0;
+  for (uint64_t id : ids)
+  {
+    double lat, lon;
+    if (storage.GetPoint(id, lat, lon))
+      sum += lat;
+  }
+  TEST_GREATER(sum, 0, ());
+  return ids.size() / timer.ElapsedSeconds();
+}
+}  // namespace
+
+UNIT_TEST(SparsePointStorage_Smoke)
+{
+  string const name = GetPlatform().WritablePathForFile("sparse_nodes_test");
+  string const fileName = name + ".sparse";
+  MY_SCOPE_GUARD(deleteFile, bind(&FileWriter::DeleteFileX, cref(fileName)));
+
+  vector<TestNode> const nodes = MakeNodes(10000);
+  WriteNodes<SparsePointStorage<EMode::Write>>(name, nodes);
+
+  SparsePointStorage<EMode::Read> const storage(name);
+  TestReadNodes(storage, nodes);
+
+  // Missing nodes are logged as errors.
+  my::LogLevel const oldLevel = my::g_LogAbortLevel;
+  my::g_LogAbortLevel = LCRITICAL;
+  MY_SCOPE_GUARD(restoreLevel, [oldLevel]() { my::g_LogAbortLevel = oldLevel; });
+
+  // Ids between nodes and outside of the range.
+  double lat, lon;
+  TEST(!storage.GetPoint(nodes.front().m_id - 1, lat, lon), ());
+  TEST(!storage.GetPoint(nodes.back().m_id + 1, lat, lon), ());
+  TEST(!storage.GetPoint(nodes.back().m_id + (1 << 20), lat, lon), ());
+  for (size_t i = 1; i < nodes.size(); ++i)
+  {
+    if (nodes[i].m_id - nodes[i - 1].m_id > 1)
+      TEST(!storage.GetPoint(nodes[i].m_id - 1, lat, lon), (nodes[i].m_id - 1));
+  }
+}
+
+UNIT_TEST(SparsePointStorage_Batch)
+{
+  string const name = GetPlatform().WritablePathForFile("sparse_nodes_test");
+  string const fileName = name + ".sparse";
+  MY_SCOPE_GUARD(deleteFile, bind(&FileWriter::DeleteFileX, cref(fileName)));
+
+  vector<TestNode> const nodes = MakeNodes(5000);
+  WriteNodes<SparsePointStorage<EMode::Write>>(name, nodes);
+  SparsePointStorage<EMode::Read> const storage(name);
+
+  // Every third node, missing ids and duplicates.
+  vector<uint64_t> ids;
+  for (size_t i = 0; i < nodes.size(); i += 3)
+  {
+    ids.push_back(nodes[i].m_id);
+    ids.push_back(nodes[i].m_id);
+    ids.push_back(nodes[i].m_id + 1);
+  }
+  sort(ids.begin(), ids.end());
+
+  size_t calls = 0;
+  size_t const found = storage.ForEachPoint(ids, [&](size_t i, double lat, double lon)
+  {
+    ++calls;
+    double expectedLat, expectedLon;
+    TEST(storage.GetPoint(ids[i], expectedLat, expectedLon), (ids[i]));
+    TEST_EQUAL(lat, expectedLat, ());
+    TEST_EQUAL(lon, expectedLon, ());
+  });
+  TEST_EQUAL(found, calls, ());
+  TEST_GREATER_OR_EQUAL(found, 2 * ((nodes.size() + 2) / 3), ());
+}
+
+UNIT_TEST(PointStorages_ForEachPoint)
+{
+  string const name = GetPlatform().WritablePathForFile("batch_nodes_test");
+  string const mapFileName = name + ".short";
+  string const sparseFileName = name + ".sparse";
+  MY_SCOPE_GUARD(deleteMap, bind(&FileWriter::DeleteFileX, cref(mapFileName)));
+  MY_SCOPE_GUARD(deleteSparse, bind(&FileWriter::DeleteFileX, cref(sparseFileName)));
+
+  vector<TestNode> const nodes = MakeNodes(3000);
+  WriteNodes<MapFilePointStorage<EMode::Write>>(name, nodes);
+  WriteNodes<SparsePointStorage<EMode::Write>>(name, nodes);
+
+  vector<uint64_t> ids;
+  for (size_t i = 0; i < nodes.size(); i += 2)
+    ids.push_back(nodes[i].m_id);
+
+  // The map storage is read by GetPoint() and the sparse one by blocks.
+  MapFilePointStorage<EMode::Read> const map(name);
+  SparsePointStorage<EMode::Read> const sparse(name);
+  vector<pair<double, double>> mapPoints(ids.size()), sparsePoints(ids.size());
+  TEST_EQUAL(ForEachPoint(map, ids, [&](size_t i, double lat, double lon)
+  {
+    mapPoints[i] = make_pair(lat, lon);
+  }), ids.size(), ());
+  TEST_EQUAL(ForEachPoint(sparse, ids, [&](size_t i, double lat, double lon)
+  {
+    sparsePoints[i] = make_pair(lat, lon);
+  }), ids.size(), ());
+
+  for (size_t i = 0; i < ids.size(); ++i)
+  {
+    TEST(my::AlmostEqualAbs(mapPoints[i].first, sparsePoints[i].first, 2E-7), (ids[i]));
+    TEST(my::AlmostEqualAbs(mapPoints[i].second, sparsePoints[i].second, 2E-7), (ids[i]));
+  }
+}
+
+UNIT_TEST(SparsePointStorage_Empty)
+{
+  string const name = GetPlatform().WritablePathForFile("sparse_nodes_test");
+  string const fileName = name + ".sparse";
+  MY_SCOPE_GUARD(deleteFile, bind(&FileWriter::DeleteFileX, cref(fileName)));
+
+  WriteNodes<SparsePointStorage<EMode::Write>>(name, {});
+  SparsePointStorage<EMode::Read> const storage(name);
+
+  my::LogLevel const oldLevel = my::g_LogAbortLevel;
+  my::g_LogAbortLevel = LCRITICAL;
+  MY_SCOPE_GUARD(restoreLevel, [oldLevel]() { my::g_LogAbortLevel = oldLevel; });
+
+  double lat, lon;
+  TEST(!storage.GetPoint(1, lat, lon), ());
+}
+
+// RawMemPointStorage isn't compared: it allocates the array for all 32bit ids.
+BENCHMARK_TEST(NodeStorages)
+{
+  string const name = GetPlatform().WritablePathForFile("node_storages_benchmark");
+  string const mapFileName = name + ".short";
+  string const sparseFileName = name + ".sparse";
+  MY_SCOPE_GUARD(deleteRaw, bind(&FileWriter::DeleteFileX, cref(name)));
+  MY_SCOPE_GUARD(deleteMap, bind(&FileWriter::DeleteFileX, cref(mapFileName)));
+  MY_SCOPE_GUARD(deleteSparse, bind(&FileWriter::DeleteFileX, cref(sparseFileName)));
+
+  vector<TestNode> const nodes = MakeNodes(1000000);
+  WriteNodes<RawFilePointStorage<EMode::Write>>(name, nodes);
+  WriteNodes<MapFilePointStorage<EMode::Write>>(name, nodes);
+  WriteNodes<SparsePointStorage<EMode::Write>>(name, nodes);
+
+  uint64_t const rawSize = FileReader(name).Size();
+  uint64_t const mapSize = FileReader(mapFileName).Size();
+  uint64_t const sparseSize = FileReader(sparseFileName).Size();
+  LOG(LINFO, ("Bytes per node, raw:", double(rawSize) / nodes.size(), "map:",
+              double(mapSize) / nodes.size(), "sparse:", double(sparseSize) / nodes.size()));
+
+  // Random lookups as for nodes of ways.
+  vector<uint64_t> ids;
+  for (auto const & node : nodes)
+    ids.push_back(node.m_id);
+  shuffle(ids.begin(), ids.end(), mt19937(0));
+
+  RawFilePointStorage<EMode::Read> const raw(name);
+  MapFilePointStorage<EMode::Read> const map(name);
+  SparsePointStorage<EMode::Read> const sparse(name);
+  LOG(LINFO, ("Lookups per second, raw:", LookupNodesPerSecond(raw, ids), "map:",
+              LookupNodesPerSecond(map, ids), "sparse:", LookupNodesPerSecond(sparse, ids)));
+
+  sort(ids.begin(), ids.end());
+  my::Timer timer;
+  size_t const found = sparse.ForEachPoint(ids, [](size_t, double, double) {});
+  TEST_EQUAL(found, ids.size(), ());
+  LOG(LINFO, ("Sorted batch lookups per second, sparse:", ids.size() / timer.ElapsedSeconds()));
+}
@@ -0,0 +1,199 @@
+#include "testing/testing.hpp"
+
+#include "generator/intermediate_data.hpp"
+#include "generator/osm_change.hpp"
+
+#include "indexer/mercator.hpp"
+
+#include "platform/platform.hpp"
+
+#include "coding/file_writer.hpp"
+
+#include "base/logging.hpp"
+#include "base/scope_guard.hpp"
+
+#include "std/sstream.hpp"
+
+#include "defines.hpp"
+
+using namespace cache;
+
+namespace
+{
+char const kOsmChange[] =
+    "<?xml version='1.0' encoding='UTF-8'?>"
+    "<osmChange version='0.6'>"
+    "  <modify>"
+    "    <node id='4' lat='10' lon='100'/>"
+    "  </modify>"
+    "  <delete>"
+    "    <way id='10'/>"
+    "  </delete>"
+    "  <create>"
+    "    <node id='7' lat='10' lon='120'/>"
+    "    <way id='12'>"
+    "      <nd ref='7'/>"
+    "      <nd ref='6'/>"
+    "      <tag k='highway' v='primary'/>"
+    "    </way>"
+    "  </create>"
+    "  <modify>"
+    "    <relation id='20'>"
+    "      <member type='way' ref='12' role='outer'/>"
+    "      <tag k='type' v='multipolygon'/>"
+    "    </relation>"
+    "  </modify>"
+    "</osmChange>";
+
+void AddCountry(borders::CountriesContainerT & countries, string const & name,
+                double minLon, double minLat, double maxLon, double maxLat)
+{
+  m2::RectD const rect(MercatorBounds::FromLatLon(minLat, minLon),
+                       MercatorBounds::FromLatLon(maxLat, maxLon));
+  m2::PointD const points[] = {rect.LeftBottom(), rect.LeftTop(), rect.RightTop(),
+                               rect.RightBottom()};
+
+  borders::CountryPolygons country(name);
+  country.m_regions.Add(m2::RegionD(points, points + ARRAY_SIZE(points)), rect);
+  countries.Add(country, rect);
+}
+
+template <class TNodesWriter>
+void WriteIntermediateData(feature::GenerateInfo const & info)
+{
+  {
+    TNodesWriter nodes(info.GetIntermediateFileName(NODES_FILE, ""));
+    double const lons[] = {-10, -20, 10, 20, 30, 40};
+    for (size_t i = 0; i < ARRAY_SIZE(lons); ++i)
+    {
+      auto const pt = MercatorBounds::FromLatLon(10, lons[i]);
+      nodes.AddPoint(i + 1, pt.y, pt.x);
+    }
+  }
+
+  OSMElementCache<EMode::Write> ways(info.GetIntermediateFileName(WAYS_FILE, ""));
+  WayElement way10(10);
+  way10.nodes = {1, 2};
+  ways.Write(10, way10);
+  WayElement way11(11);
+  way11.nodes = {3, 4};
+  ways.Write(11, way11);
+  ways.SaveOffsets();
+
+  OSMElementCache<EMode::Write> relations(info.GetIntermediateFileName(RELATIONS_FILE, ""));
+  RelationElement relation;
+  relation.ways.emplace_back(11, "outer");
+  relation.tags.emplace("type", "multipolygon");
+  relations.Write(20, relation);
+  relations.SaveOffsets();
+
+  cache::detail::IndexFile<EMode::Write, uint64_t> nodeToRelations(
+      info.GetIntermediateFileName(NODES_FILE, ID2REL_EXT));
+  nodeToRelations.WriteAll();
+  cache::detail::IndexFile<EMode::Write, uint64_t> wayToRelations(
+      info.GetIntermediateFileName(WAYS_FILE, ID2REL_EXT));
+  wayToRelations.Add(11, 20);
+  wayToRelations.WriteAll();
+}
+
+template <class TNodesWriter, class TNodesReader>
+void TestApplyOsmChange(feature::GenerateInfo::NodeStorageType storageType)
+{
+  feature::GenerateInfo info;
+  info.m_intermediateDir = GetPlatform().WritableDir();
+  info.m_nodeStorageType = storageType;
+
+  vector<string> files = {
+      info.GetIntermediateFileName(NODES_FILE, ""),
+      info.GetIntermediateFileName(NODES_FILE, ".short"),
+      info.GetIntermediateFileName(NODES_FILE, ID2REL_EXT),
+      info.GetIntermediateFileName(WAYS_FILE, ""),
+      info.GetIntermediateFileName(WAYS_FILE, OFFSET_EXT),
+      info.GetIntermediateFileName(WAYS_FILE, ID2REL_EXT),
+      info.GetIntermediateFileName(RELATIONS_FILE, ""),
+      info.GetIntermediateFileName(RELATIONS_FILE, OFFSET_EXT)};
+  MY_SCOPE_GUARD(deleteFiles, [&files]()
+  {
+    for (string const & file : files)
+      FileWriter::DeleteFileX(file);
+  });
+
+  WriteIntermediateData<TNodesWriter>(info);
+
+  borders::CountriesContainerT countries;
+  AddCountry(countries, "West", -90, -60, 0, 60);
+  AddCountry(countries, "East", 0, -60, 90, 60);
+  AddCountry(countries, "Far", 90, -60, 180, 60);
+  AddCountry(countries, "North", -180, 60, 180, 80);
+
+  istringstream stream(kOsmChange);
+  SourceReader reader(stream);
+  vector<string> affected;
+  TEST(ApplyOsmChange(info, reader, countries, affected), ());
+
+  // East and Far for the moved node, West for nodes of the deleted way, Far and East
+  // for the created way and the relation.
+  TEST_EQUAL(affected, vector<string>({"East", "Far", "West"}), ());
+
+  TNodesReader nodes(info.GetIntermediateFileName(NODES_FILE, ""));
+  auto const testNode = [&nodes](uint64_t id, double lon)
+  {
+    double lat, lng;
+    TEST(nodes.GetPoint(id, lat, lng), (id));
+    TEST(m2::PointD(lng, lat).EqualDxDy(MercatorBounds::FromLatLon(10, lon), 1E-6), (id));
+  };
+  testNode(4, 100);
+  testNode(7, 120);
+  testNode(1, -10);
+
+  OSMElementCache<EMode::Read> ways(info.GetIntermediateFileName(WAYS_FILE, ""));
+  ways.LoadOffsets();
+  WayElement way(0);
+  TEST(!ways.Read(10, way), ());
+  TEST(ways.Read(11, way), ());
+  TEST_EQUAL(way.nodes, vector<uint64_t>({3, 4}), ());
+  TEST(ways.Read(12, way), ());
+  TEST_EQUAL(way.nodes, vector<uint64_t>({7, 6}), ());
+
+  OSMElementCache<EMode::Read> relations(info.GetIntermediateFileName(RELATIONS_FILE, ""));
+  relations.LoadOffsets();
+  RelationElement relation;
+  TEST(relations.Read(20, relation), ());
+  TEST_EQUAL(relation.ways.size(), 1, ());
+  TEST_EQUAL(relation.ways[0].first, 12, ());
+
+  cache::detail::IndexFile<EMode::Read, uint64_t> wayToRelations(
+      info.GetIntermediateFileName(WAYS_FILE, ID2REL_EXT));
+  wayToRelations.ReadAll();
+  uint64_t relationId;
+  TEST(!wayToRelations.GetValueByKey(11, relationId), ());
+  TEST(wayToRelations.GetValueByKey(12, relationId), ());
+  TEST_EQUAL(relationId, 20, ());
+}
+}  // namespace
+
+UNIT_TEST(ApplyOsmChange_MapStorage)
+{
+  TestApplyOsmChange<MapFilePointStorage<EMode::Write>, MapFilePointStorage<EMode::Read>>(
+      feature::GenerateInfo::NodeStorageType::Index);
+}
+
+UNIT_TEST(ApplyOsmChange_RawStorage)
+{
+  TestApplyOsmChange<RawFilePointStorage<EMode::Write>, RawFilePointStorage<EMode::Read>>(
+      feature::GenerateInfo::NodeStorageType::File);
+}
+
+UNIT_TEST(ApplyOsmChange_SparseStorage)
+{
+  my::LogLevel const oldLevel = my::g_LogAbortLevel;
+  my::g_LogAbortLevel = LCRITICAL;
+  MY_SCOPE_GUARD(restoreLevel, [oldLevel]() { my::g_LogAbortLevel = oldLevel; });
+
+  feature::GenerateInfo info;
+  info.m_nodeStorageType = feature::GenerateInfo::NodeStorageType::Sparse;
+  istringstream stream(kOsmChange);
+  SourceReader reader(stream);
+  vector<string> affected;
+  TEST(!ApplyOsmChange(info, reader, borders::CountriesContainerT(), affected), ());
+}
@@ -0,0 +1,168 @@
+#include "testing/testing.hpp"
+
+#include "generator/borders_loader.hpp"
+#include "generator/osm_id.hpp"
+#include "generator/polygonizer.hpp"
+
+#include "indexer/mercator.hpp"
+
+#include "platform/platform.hpp"
+
+#include "coding/file_writer.hpp"
+
+#include "base/scope_guard.hpp"
+
+#include "std/fstream.hpp"
+#include "std/map.hpp"
+
+namespace
+{
+map<string, vector<string>> g_features;
+
+// Collects ids of features by output files.
+class FeaturesRecorder
+{
+  vector<string> & m_ids;
+
+public:
+  explicit FeaturesRecorder(string const & fileName) : m_ids(g_features[fileName])
+  {
+    TEST(m_ids.empty(), (fileName));
+  }
+
+  void operator()(FeatureBuilder1 const & fb) { m_ids.push_back(fb.GetOsmIdsString()); }
+};
+
+FeatureBuilder1 MakeFeature(uint64_t id)
+{
+  FeatureBuilder1 fb;
+  fb.SetOsmId(osm::Id::Node(id));
+  fb.SetCenter(m2::PointD(static_cast<double>(id % 359) - 179.0, static_cast<double>(id % 169) - 84.0));
+  return fb;
+}
+
+FeatureBuilder1 MakeFeature(uint64_t id, vector<m2::PointD> const & points)
+{
+  FeatureBuilder1 fb;
+  fb.SetOsmId(osm::Id::Way(id));
+  if (points.size() == 1)
+  {
+    fb.SetCenter(MercatorBounds::FromLatLon(points[0].y, points[0].x));
+    return fb;
+  }
+  for (m2::PointD const & p : points)
+    fb.AddPoint(MercatorBounds::FromLatLon(p.y, p.x));
+  fb.SetLinear();
+  return fb;
+}
+
+// Writes a country polygon in the osmosis format, points are (lon, lat).
+void WritePolygon(string const & fileName, vector<m2::PointD> const & points)
+{
+  ofstream stream(fileName);
+  stream << "polygon" << endl << "1" << endl;
+  for (m2::PointD const & p : points)
+    stream << p.x << " " << p.y << endl;
+  stream << "END" << endl << "END" << endl;
+}
+}  // namespace
+
+UNIT_TEST(Polygonizer_WholeWorld)
+{
+  feature::GenerateInfo info;
+  info.m_fileName = "polygonizer_test";
+
+  size_t const kFeaturesCount = 10 * feature::Polygonizer<FeaturesRecorder>::kBatchSize + 3;
+  vector<string> expected;
+  for (uint64_t id = 0; id < kFeaturesCount; ++id)
+    expected.push_back(MakeFeature(id).GetOsmIdsString());
+
+  for (size_t threadsCount : {0, 1, 3, 8})
+  {
+    g_features.clear();
+    {
+      feature::Polygonizer<FeaturesRecorder> polygonizer(info, threadsCount);
+      for (uint64_t id = 0; id < kFeaturesCount; ++id)
+        polygonizer(MakeFeature(id));
+      polygonizer.Finish();
+
+      TEST_EQUAL(polygonizer.Names(), vector<string>{info.m_fileName}, (threadsCount));
+    }
+
+    // All features are written in the order of emitting.
+    TEST_EQUAL(g_features.size(), 1, (threadsCount));
+    TEST(g_features[info.GetTmpFileName(info.m_fileName)] == expected, (threadsCount));
+  }
+}
+
+UNIT_TEST(Polygonizer_Empty)
+{
+  feature::GenerateInfo info;
+  info.m_fileName = "polygonizer_test";
+
+  g_features.clear();
+  {
+    feature::Polygonizer<FeaturesRecorder> polygonizer(info, 2 /* threadsCount */);
+    polygonizer.Finish();
+    TEST(polygonizer.Names().empty(), ());
+  }
+  TEST(g_features.empty(), ());
+}
+
+UNIT_TEST(Polygonizer_AdjacentCountries)
+{
+  feature::GenerateInfo info;
+  info.m_targetDir = GetPlatform().WritableDir() + "polygonizer_test/";
+  info.m_splitByPolygons = true;
+
+  // Countries are triangles of the same square, so both bounding rects contain every
+  // feature of the square and features are checked by polygons.
+  string const bordersDir = info.m_targetDir + BORDERS_DIR;
+  Platform & platform = GetPlatform();
+  TEST_EQUAL(platform.MkDir(info.m_targetDir), Platform::ERR_OK, ());
+  TEST_EQUAL(platform.MkDir(bordersDir), Platform::ERR_OK, ());
+  string const westFile = bordersDir + "West" BORDERS_EXTENSION;
+  string const eastFile = bordersDir + "East" BORDERS_EXTENSION;
+  MY_SCOPE_GUARD(deleteFiles, [&]()
+  {
+    FileWriter::DeleteFileX(westFile);
+    FileWriter::DeleteFileX(eastFile);
+    Platform::RmDir(bordersDir);
+    Platform::RmDir(info.m_targetDir);
+  });
+  WritePolygon(westFile, {{0, 0}, {0, 10}, {10, 10}, {0, 0}});
+  WritePolygon(eastFile, {{0, 0}, {10, 10}, {10, 0}, {0, 0}});
+
+  // Points of the west and east countries, a line across the border and a point outside.
+  vector<vector<m2::PointD>> const geometries = {
+      {{2, 8}}, {{8, 2}}, {{2, 8}, {8, 2}}, {{20, 20}}};
+
+  size_t const kFeaturesCount = 3 * feature::Polygonizer<FeaturesRecorder>::kBatchSize + 1;
+  vector<string> expectedWest;
+  vector<string> expectedEast;
+  for (uint64_t id = 0; id < kFeaturesCount; ++id)
+  {
+    string const osmId = MakeFeature(id, geometries[id % geometries.size()]).GetOsmIdsString();
+    if (id % geometries.size() == 0 || id % geometries.size() == 2)
+      expectedWest.push_back(osmId);
+    if (id % geometries.size() == 1 || id % geometries.size() == 2)
+      expectedEast.push_back(osmId);
+  }
+
+  for (size_t threadsCount : {0, 1, 3})
+  {
+    g_features.clear();
+    {
+      feature::Polygonizer<FeaturesRecorder> polygonizer(info, threadsCount);
+      for (uint64_t id = 0; id < kFeaturesCount; ++id)
+        polygonizer(MakeFeature(id, geometries[id % geometries.size()]));
+      polygonizer.Finish();
+
+      TEST_EQUAL(polygonizer.Names(), vector<string>({"West", "East"}), (threadsCount));
+    }
+
+    TEST_EQUAL(g_features.size(), 2, (threadsCount));
+    TEST(g_features[info.GetTmpFileName("West")] == expectedWest, (threadsCount));
+    TEST(g_features[info.GetTmpFileName("East")] == expectedEast, (threadsCount));
+  }
+}
@@ -1,11 +1,32 @@
+#include "testing/benchmark.hpp"
 #include "testing/testing.hpp"
 
 #include "coding/parse_xml.hpp"
 #include "generator/osm_source.hpp"
 #include "generator/osm_element.hpp"
 
+#include "base/logging.hpp"
+#include "base/timer.hpp"
+
 #include "source_data.hpp"
 
+namespace
+{
+// Fills the element like decoders do for a relation with long (not small string optimized) tags.
+void FillRelation(uint64_t id, OsmElement & e)
+{
+  e.type = OsmElement::EntityType::Relation;
+  e.id = id;
+  for (uint64_t i = 0; i < 4; ++i)
+    e.AddMember(id + i, OsmElement::EntityType::Way, i % 2 == 0 ? "outer" : "inner_way_role_name");
+  e.AddTag("type", "multipolygon");
+  e.AddTag("name:international_language", "Whitehorse, the capital city of Yukon");
+  e.AddTag("addr:street_with_long_key", "Main Street of the Whitehorse city");
+  e.AddTag("source", "skipped");
+  e.AddTag("wikipedia", "en:Whitehorse, Yukon (this is a long value)");
+}
+}  // namespace
+
 UNIT_TEST(Source_To_Element_create_from_xml_test)
 {
   istringstream ss(way_xml_data);
@@ -64,3 +85,167 @@ UNIT_TEST(Source_To_Element_check_equivalence)
     TEST_EQUAL(elementsXML[i], elementsO5M[i], ());
   }
 }
+
+UNIT_TEST(Source_To_Element_pbf_equivalence)
+{
+  istringstream ss1(relation_xml_data);
+  SourceReader readerXML(ss1);
+
+  vector<OsmElement> elementsXML;
+  BuildFeaturesFromXML(readerXML, [&elementsXML](OsmElement * e)
+  {
+    elementsXML.push_back(*e);
+  });
+
+  for (size_t threadsCount : {1, 4})
+  {
+    string src(begin(relation_pbf_data), end(relation_pbf_data));
+    istringstream ss2(src);
+    SourceReader readerPBF(ss2);
+
+    vector<OsmElement> elementsPBF;
+    BuildFeaturesFromPBF(readerPBF, [&elementsPBF](OsmElement * e)
+    {
+      elementsPBF.push_back(*e);
+    }, threadsCount);
+
+    TEST_EQUAL(elementsXML.size(), elementsPBF.size(), (threadsCount));
+    for (size_t i = 0; i < elementsPBF.size(); ++i)
+      TEST_EQUAL(elementsXML[i], elementsPBF[i], (threadsCount));
+  }
+}
+
+UNIT_TEST(Source_To_Element_pbf_order)
+{
+  // Many small blocks are decoded in parallel, but elements must come in the file order.
+  size_t constexpr kCopiesCount = 100;
+  string src;
+  for (size_t i = 0; i < kCopiesCount; ++i)
+    src.append(begin(relation_pbf_data), end(relation_pbf_data));
+
+  vector<vector<OsmElement>> results;
+  for (size_t threadsCount : {1, 3, 8})
+  {
+    istringstream ss(src);
+    SourceReader reader(ss);
+
+    results.emplace_back();
+    vector<OsmElement> & elements = results.back();
+    BuildFeaturesFromPBF(reader, [&elements](OsmElement * e)
+    {
+      elements.push_back(*e);
+    }, threadsCount);
+    TEST_EQUAL(elements.size(), 11 * kCopiesCount, (threadsCount));
+  }
+
+  for (size_t i = 1; i < results.size(); ++i)
+    TEST_EQUAL(results[i], results.front(), (i));
+}
+
+UNIT_TEST(Source_To_Element_reused_element)
+{
+  OsmElement reused;
+  for (uint64_t id = 1; id <= 10; ++id)
+  {
+    OsmElement fresh;
+    FillRelation(id, fresh);
+
+    reused.Clear();
+    if (id % 3 == 0)
+      reused.AddTag("one", "tag");
+    else
+      FillRelation(id, reused);
+
+    if (id % 3 == 0)
+    {
+      TEST_EQUAL(reused.m_tags.size(), 1, ());
+      TEST(reused.m_tags.front() == OsmElement::Tag("one", "tag"), ());
+      TEST(reused.m_members.empty(), ());
+    }
+    else
+    {
+      TEST_EQUAL(reused, fresh, ());
+    }
+  }
+
+  // Skipped tags aren't added.
+  TEST_EQUAL(reused.m_tags.size(), 4, ());
+
+  OsmElement const copy = reused;
+  TEST_EQUAL(copy, reused, ());
+}
+
+BENCHMARK_TEST(OsmElementReuse)
+{
+  size_t constexpr kCount = 1000000;
+
+  my::Timer timer;
+  size_t tagsCount = 0;
+  for (size_t i = 0; i < kCount; ++i)
+  {
+    OsmElement e;
+    FillRelation(i, e);
+    tagsCount += e.m_tags.size();
+  }
+  double const freshSec = timer.ElapsedSeconds();
+
+  timer.Reset();
+  OsmElement e;
+  for (size_t i = 0; i < kCount; ++i)
+  {
+    e.Clear();
+    FillRelation(i, e);
+    tagsCount -= e.m_tags.size();
+  }
+  double const reusedSec = timer.ElapsedSeconds();
+
+  TEST_EQUAL(tagsCount, 0, ());
+  LOG(LINFO, ("Elements per second, fresh:", kCount / max(freshSec, 1e-9),
+              "reused:", kCount / max(reusedSec, 1e-9)));
+}
+
+BENCHMARK_TEST(OsmSourcesParsing)
+{
+  // The test data is repeated to get a source of a few megabytes.
+  size_t constexpr kCopiesCount = 5000;
+  size_t constexpr kElementsCount = 11 * kCopiesCount;
+
+  string const xmlData = relation_xml_data;
+  size_t const bodyBegin = xmlData.find('>', xmlData.find("<osm ")) + 1;
+  size_t const bodyEnd = xmlData.rfind("</osm>");
+  string xml = xmlData.substr(0, bodyBegin);
+  for (size_t i = 0; i < kCopiesCount; ++i)
+    xml.append(xmlData, bodyBegin, bodyEnd - bodyBegin);
+  xml.append("</osm>");
+
+  string pbf;
+  for (size_t i = 0; i < kCopiesCount; ++i)
+    pbf.append(begin(relation_pbf_data), end(relation_pbf_data));
+
+  size_t count = 0;
+  auto const counter = [&count](OsmElement *) { ++count; };
+
+  my::Timer timer;
+  {
+    istringstream ss(xml);
+    SourceReader reader(ss);
+    BuildFeaturesFromXML(reader, counter);
+  }
+  double const xmlSec = timer.ElapsedSeconds();
+  TEST_EQUAL(count, kElementsCount, ());
+
+  count = 0;
+  timer.Reset();
+  {
+    istringstream ss(pbf);
+    SourceReader reader(ss);
+    BuildFeaturesFromPBF(reader, counter, 1 /* threadsCount */);
+  }
+  double const pbfSec = timer.ElapsedSeconds();
+  TEST_EQUAL(count, kElementsCount, ());
+
+  LOG(LINFO, ("Elements per second, XML:", kElementsCount / max(xmlSec, 1e-9),
+              "PBF:", kElementsCount / max(pbfSec, 1e-9)));
+  LOG(LINFO, ("Megabytes per second, XML:", xml.size() / max(xmlSec, 1e-9) / 1e6,
+              "PBF:", pbf.size() / max(pbfSec, 1e-9) / 1e6));
+}
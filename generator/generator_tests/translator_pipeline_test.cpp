@@ -0,0 +1,87 @@
+#include "testing/testing.hpp"
+
+#include "generator/osm_id.hpp"
+#include "generator/translator_pipeline.hpp"
+
+#include "std/atomic.hpp"
+
+namespace
+{
+size_t constexpr kElementsCount = 10 * TranslatorPipeline::kBatchSize + 17;
+
+void ReadElements(TranslatorPipeline::TElementFn const & fn)
+{
+  OsmElement e;
+  for (uint64_t id = 1; id <= kElementsCount; ++id)
+  {
+    e.Clear();
+    e.type = OsmElement::EntityType::Node;
+    e.id = id;
+    e.AddTag("name", strings::to_string(id));
+    fn(&e);
+  }
+}
+
+// Emits id % 3 features for every element.
+void Translate(OsmElement * e, TranslatorPipeline::TFeatureFn const & emitFn)
+{
+  TEST_EQUAL(e->m_tags.size(), 1, ());
+  TEST_EQUAL(e->m_tags.front().value, strings::to_string(e->id), ());
+
+  for (uint64_t i = 0; i < e->id % 3; ++i)
+  {
+    FeatureBuilder1 ft;
+    ft.SetOsmId(osm::Id::Node(e->id));
+    ft.AddOsmId(osm::Id::Node(i));
+    emitFn(ft);
+  }
+}
+
+vector<string> RunPipeline(size_t threadsCount, size_t & translatorsCount)
+{
+  atomic<size_t> translators(0);
+  auto const factory = [&translators](TranslatorPipeline::TFeatureFn const & emitFn)
+  {
+    ++translators;
+    return TranslatorPipeline::TElementFn([&emitFn](OsmElement * e) { Translate(e, emitFn); });
+  };
+
+  vector<string> ids;
+  TranslatorPipeline pipeline(factory, threadsCount);
+  pipeline.Run(ReadElements, [&ids](FeatureBuilder1 & ft) { ids.push_back(ft.GetOsmIdsString()); });
+
+  translatorsCount = translators;
+  return ids;
+}
+}  // namespace
+
+UNIT_TEST(TranslatorPipeline_Order)
+{
+  vector<string> expected;
+  ReadElements([&expected](OsmElement * e)
+  {
+    Translate(e, [&expected](FeatureBuilder1 & ft) { expected.push_back(ft.GetOsmIdsString()); });
+  });
+  TEST_GREATER(expected.size(), kElementsCount / 2, ());
+
+  for (size_t threadsCount : {1, 2, 4, 7})
+  {
+    size_t translatorsCount = 0;
+    vector<string> const ids = RunPipeline(threadsCount, translatorsCount);
+    TEST_EQUAL(translatorsCount, threadsCount, ());
+    TEST(ids == expected, (threadsCount));
+  }
+}
+
+UNIT_TEST(TranslatorPipeline_Empty)
+{
+  TranslatorPipeline pipeline([](TranslatorPipeline::TFeatureFn const &)
+  {
+    return TranslatorPipeline::TElementFn([](OsmElement *) { TEST(false, ()); });
+  }, 3 /* threadsCount */);
+
+  size_t featuresCount = 0;
+  pipeline.Run([](TranslatorPipeline::TElementFn const &) {},
+               [&featuresCount](FeatureBuilder1 &) { ++featuresCount; });
+  TEST_EQUAL(featuresCount, 0, ());
+}
@@ -1,3 +1,4 @@
+#include "generator/buckets_processor.hpp"
 #include "generator/feature_generator.hpp"
 #include "generator/feature_sorter.hpp"
 #include "generator/update_generator.hpp"
@@ -9,8 +10,10 @@
 #include "generator/generate_info.hpp"
 #include "generator/check_model.hpp"
 #include "generator/routing_generator.hpp"
+#include "generator/osm_change.hpp"
 #include "generator/osm_source.hpp"
 
+#include "indexer/categories_holder.hpp"
 #include "indexer/drawing_rules.hpp"
 #include "indexer/classificator_loader.hpp"
 #include "indexer/classificator.hpp"
@@ -21,7 +24,10 @@
 #include "indexer/search_index_builder.hpp"
 
 #include "coding/file_name_utils.hpp"
+#include "coding/internal/file_data.hpp"
 
+#include "base/stl_add.hpp"
+#include "base/string_utils.hpp"
 #include "base/timer.hpp"
 
 #include "defines.hpp"
@@ -33,7 +39,9 @@
 #include "std/iostream.hpp"
 #include "std/fstream.hpp"
 #include "std/iomanip.hpp"
+#include "std/limits.hpp"
 #include "std/numeric.hpp"
+#include "std/unique_ptr.hpp"
 
 
 DEFINE_bool(generate_update, false,
@@ -52,9 +60,16 @@ DEFINE_bool(generate_search_index, false, "5th pass - generate search index");
 DEFINE_bool(calc_statistics, false, "Calculate feature statistics for specified mwm bucket files");
 DEFINE_bool(type_statistics, false, "Calculate statistics by type for specified mwm bucket files");
 DEFINE_bool(preload_cache, false, "Preload all ways and relations cache");
-DEFINE_string(node_storage, "map", "Type of storage for intermediate points representation. Available: raw, map, mem");
+DEFINE_uint64(preload_cache_mb, 0, "Memory budget in MB for preloading of ways and relations cache, relations go first");
+DEFINE_uint64(translator_threads, 1, "Count of threads translating OSM elements to features in the 2nd pass");
+DEFINE_uint64(sort_memory_mb, 64, "Memory in MB for sorting of features and index cells of one mwm");
+DEFINE_uint64(sort_threads, 1, "Count of threads sorting runs of features and index cells of one mwm, 0 - sort in the main thread");
+DEFINE_string(node_storage, "map", "Type of storage for intermediate points representation. Available: raw, map, mem, sparse (needs nodes sorted by id)");
 DEFINE_string(data_path, "", "Working directory, 'path_to_exe/../../data' if empty.");
 DEFINE_string(output, "", "File name for process (without 'mwm' ext).");
+DEFINE_string(countries, "", "Comma separated list of file names (without 'mwm' ext) for per-mwm passes.");
+DEFINE_uint64(mwm_threads, 1, "Count of mwms processed at the same time by per-mwm passes");
+DEFINE_uint64(mwm_memory_mb, 0, "Memory budget in MB of mwms processed at the same time, 0 means no limit");
 DEFINE_string(intermediate_data_path, "", "Path to stored nodes, ways, relations.");
 DEFINE_bool(generate_world, false, "Generate separate world file");
 DEFINE_bool(split_by_polygons, false, "Use countries borders to split planet by regions and countries");
@@ -68,10 +83,13 @@ DEFINE_string(delete_section, "", "Delete specified section (defines.hpp) from c
 DEFINE_bool(fail_on_coasts, false, "Stop and exit with '255' code if some coastlines are not merged.");
 DEFINE_bool(generate_addresses_file, false, "Generate .addr file (for '--output' option) with full addresses list.");
 DEFINE_string(osrm_file_name, "", "Input osrm file to generate routing info");
+DEFINE_string(osrm_data_path, "", "Path to <country>.osrm files to make routing info for all mwms of per-mwm passes");
 DEFINE_bool(make_routing, false, "Make routing info based on osrm file");
 DEFINE_bool(make_cross_section, false, "Make corss section in routing file for cross mwm routing");
+DEFINE_bool(make_cross_mwm_overlay, false, "Make overlay graph over cross sections of all routing files in data_path");
 DEFINE_string(osm_file_name, "", "Input osm area file");
-DEFINE_string(osm_file_type, "xml", "Input osm area file type [xml, o5m]");
+DEFINE_string(osm_file_type, "xml", "Input osm area file type [xml, o5m, pbf]");
+DEFINE_string(osc_file_name, "", "OsmChange file to apply to the intermediate data, the features pass splits features to the changed countries only");
 DEFINE_string(user_resource_path, "", "User defined resource path for classificator.txt and etc.");
 DEFINE_uint64(planet_version, my::TodayAsYYMMDD(), "Version as YYMMDD, by default - today");
 
@@ -105,7 +123,11 @@ int main(int argc, char ** argv)
 
   genInfo.m_osmFileName = FLAGS_osm_file_name;
   genInfo.m_failOnCoasts = FLAGS_fail_on_coasts;
-  genInfo.m_preloadCache = FLAGS_preload_cache;
+  genInfo.m_preloadCacheSize = FLAGS_preload_cache ? numeric_limits<uint64_t>::max()
+                                                   : FLAGS_preload_cache_mb << 20;
+  genInfo.m_translatorThreadsCount = static_cast<size_t>(FLAGS_translator_threads);
+  genInfo.m_sortMemorySize = FLAGS_sort_memory_mb << 20;
+  genInfo.m_sortThreadsCount = static_cast<size_t>(FLAGS_sort_threads);
 
   genInfo.m_versionDate = static_cast<uint32_t>(FLAGS_planet_version);
 
@@ -124,11 +146,24 @@ int main(int argc, char ** argv)
     }
   }
 
+  // Applying changes to intermediate files
+  if (!FLAGS_osc_file_name.empty())
+  {
+    LOG(LINFO, ("Applying changes to intermediate data ...."));
+    borders::CountriesContainerT borders;
+    CHECK(borders::LoadCountriesList(path, borders), ("Error loading country polygons files"));
+
+    SourceReader reader(FLAGS_osc_file_name);
+    if (!ApplyOsmChange(genInfo, reader, borders, genInfo.m_changedCountries))
+      return -1;
+    LOG(LINFO, ("Changed countries:", genInfo.m_changedCountries));
+  }
+
   // load classificator only if necessary
   if (FLAGS_make_coasts || FLAGS_generate_features || FLAGS_generate_geometry ||
       FLAGS_generate_index || FLAGS_generate_search_index ||
       FLAGS_calc_statistics || FLAGS_type_statistics || FLAGS_dump_types || FLAGS_dump_prefixes ||
-      FLAGS_check_mwm)
+      FLAGS_check_mwm || (!FLAGS_osrm_data_path.empty() && FLAGS_make_routing))
   {
     classificator::Load();
     classif().SortClassificator();
@@ -139,15 +174,25 @@ int main(int argc, char ** argv)
   {
     LOG(LINFO, ("Generating final data ..."));
 
-    genInfo.m_splitByPolygons = FLAGS_split_by_polygons;
+    // Countries aren't split again if the OsmChange file doesn't change any of them.
+    bool const noChangedCountries =
+        !FLAGS_osc_file_name.empty() && genInfo.m_changedCountries.empty();
+    genInfo.m_splitByPolygons = FLAGS_split_by_polygons && !noChangedCountries;
     genInfo.m_createWorld = FLAGS_generate_world;
     genInfo.m_makeCoasts = FLAGS_make_coasts;
     genInfo.m_emitCoasts = FLAGS_emit_coasts;
     genInfo.m_fileName = FLAGS_output;
     genInfo.m_genAddresses = FLAGS_generate_addresses_file;
 
-    if (!GenerateFeatures(genInfo))
+    if (noChangedCountries && !genInfo.m_createWorld && !genInfo.m_makeCoasts &&
+        !genInfo.m_emitCoasts && genInfo.m_fileName.empty())
+    {
+      LOG(LINFO, ("No countries are changed, features generation is skipped."));
+    }
+    else if (!GenerateFeatures(genInfo))
+    {
       return -1;
+    }
 
     if (FLAGS_generate_world)
     {
@@ -161,11 +206,24 @@ int main(int argc, char ** argv)
       genInfo.m_bucketNames.push_back(FLAGS_output);
   }
 
-  // Enumerate over all dat files that were created.
-  size_t const count = genInfo.m_bucketNames.size();
-  for (size_t i = 0; i < count; ++i)
+  if (!FLAGS_countries.empty())
+    strings::Tokenize(FLAGS_countries, ",", MakeBackInsertFunctor(genInfo.m_bucketNames));
+
+  // Resources shared by passes of all buckets.
+  unique_ptr<CategoriesHolder> categories;
+  if (FLAGS_generate_search_index && !genInfo.m_bucketNames.empty())
+    categories.reset(new CategoriesHolder(pl.GetReader(SEARCH_CATEGORIES_FILE_NAME)));
+
+  bool const makeRoutingSections = !FLAGS_osrm_data_path.empty() && FLAGS_make_routing;
+  bool const makeCrossSections = !FLAGS_osrm_data_path.empty() && FLAGS_make_cross_section;
+  borders::CountriesContainerT countries;
+  if (makeCrossSections)
+  {
+    CHECK(borders::LoadCountriesList(path, countries), ("Error loading country polygons files"));
+  }
+
+  auto const processBucket = [&](string const & country)
   {
-    string const & country = genInfo.m_bucketNames[i];
     string const datFile = my::JoinFoldersToPath(path, country + DATA_FILE_EXTENSION);
 
     if (FLAGS_generate_geometry)
@@ -180,18 +238,19 @@ int main(int argc, char ** argv)
 
       LOG(LINFO, ("Generating result features for", country));
       if (!feature::GenerateFinalFeatures(genInfo, country, mapType))
-        continue;
+        return false;
 
       LOG(LINFO, ("Generating offsets table for", datFile));
       if (!feature::BuildOffsetsTable(datFile))
-        continue;
+        return false;
     }
 
     if (FLAGS_generate_index)
     {
       LOG(LINFO, ("Generating index for", datFile));
 
-      if (!indexer::BuildIndexFromDatFile(datFile, FLAGS_intermediate_data_path + country))
+      if (!indexer::BuildIndexFromDatFile(datFile, FLAGS_intermediate_data_path + country,
+                                          genInfo.m_sortMemorySize, genInfo.m_sortThreadsCount))
         LOG(LCRITICAL, ("Error generating index."));
     }
 
@@ -199,11 +258,34 @@ int main(int argc, char ** argv)
     {
       LOG(LINFO, ("Generating search index for ", datFile));
 
-      if (!indexer::BuildSearchIndexFromDatFile(datFile, true))
+      if (!indexer::BuildSearchIndexFromDatFile(datFile, *categories, true))
         LOG(LCRITICAL, ("Error generating search index."));
     }
+
+    string const osrmFile = my::JoinFoldersToPath(FLAGS_osrm_data_path, country + ".osrm");
+    if (makeRoutingSections)
+      routing::BuildRoutingSection(path, country, osrmFile);
+    if (makeCrossSections)
+      routing::BuildCrossRoutingIndex(path, country, osrmFile, countries);
+    return true;
+  };
+
+  // Enumerate over all dat files that were created.
+  vector<feature::BucketsProcessor::Bucket> buckets;
+  for (string const & country : genInfo.m_bucketNames)
+  {
+    uint64_t size = 0;
+    if (!my::GetFileSize(genInfo.GetTmpFileName(country), size))
+      my::GetFileSize(my::JoinFoldersToPath(path, country + DATA_FILE_EXTENSION), size);
+    buckets.push_back({country, feature::BucketsProcessor::EstimateMemory(size)});
   }
 
+  feature::BucketsProcessor processor(max(static_cast<size_t>(FLAGS_mwm_threads), size_t(1)),
+                                      FLAGS_mwm_memory_mb << 20);
+  vector<string> const failed = processor.Run(buckets, processBucket);
+  if (!failed.empty())
+    LOG(LWARNING, ("Per-mwm passes are failed for", failed));
+
   // Create http update list for countries and corresponding files
   if (FLAGS_generate_update)
   {
@@ -261,5 +343,8 @@ int main(int argc, char ** argv)
   if (!FLAGS_osrm_file_name.empty() && FLAGS_make_cross_section)
     routing::BuildCrossRoutingIndex(path, FLAGS_output, FLAGS_osrm_file_name);
 
+  if (FLAGS_make_cross_mwm_overlay)
+    routing::BuildCrossMwmOverlay(path);
+
   return 0;
 }
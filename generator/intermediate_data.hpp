@@ -2,10 +2,13 @@
 
 #include "generator/intermediate_elements.hpp"
 
+#include "coding/byte_stream.hpp"
 #include "coding/file_name_utils.hpp"
 #include "coding/file_reader.hpp"
 #include "coding/file_writer.hpp"
+#include "coding/internal/file_data.hpp"
 #include "coding/mmap_reader.hpp"
+#include "coding/varint.hpp"
 
 #include "base/logging.hpp"
 
@@ -13,6 +16,9 @@
 #include "std/deque.hpp"
 #include "std/exception.hpp"
 #include "std/limits.hpp"
+#include "std/mutex.hpp"
+#include "std/queue.hpp"
+#include "std/unique_ptr.hpp"
 #include "std/utility.hpp"
 #include "std/vector.hpp"
 
@@ -29,7 +35,37 @@ enum class EMode { Write = true, Read = false };
 
 namespace detail
 {
-template <class TFile, class TValue>
+#ifdef OMIM_OS_WINDOWS
+/// FileReader seeks and then reads, so reads of threads which share the intermediate data
+/// are serialized.
+class LockedFileReader
+{
+  FileReader m_reader;
+  mutable mutex m_mutex;
+
+public:
+  explicit LockedFileReader(string const & name) : m_reader(name) {}
+
+  uint64_t Size() const { return m_reader.Size(); }
+
+  void Read(uint64_t pos, void * p, size_t size) const
+  {
+    lock_guard<mutex> lock(m_mutex);
+    m_reader.Read(pos, p, size);
+  }
+};
+
+using TFileReader = LockedFileReader;
+#else
+using TFileReader = MmapReader;
+#endif
+
+/// Sorted index of (key, value) pairs on disk.
+/// Added pairs are sorted in memory by runs of kRunSize pairs and written to the temporary
+/// file, WriteAll() merges the runs to the index file. The index file is read by pages of
+/// kPageSize pairs and only the first keys of pages are kept in memory, so a lookup
+/// reads one page usually.
+template <EMode TMode, class TValue>
 class IndexFile
 {
   using TKey = uint64_t;
@@ -37,10 +73,9 @@ class IndexFile
   using TElement = pair<TKey, TValue>;
   using TContainer = vector<TElement>;
 
-  TContainer m_elements;
-  TFile m_file;
-
-  static size_t constexpr kFlushCount = 1024;
+  static size_t constexpr kRunSize = 1 << 22;
+  static size_t constexpr kPageSize = 256;
+  static size_t constexpr kMergeBufferSize = 4096;
 
   struct ElementComparator
   {
@@ -52,106 +87,330 @@ class IndexFile
     bool operator()(TKey r1, TElement const & r2) const { return (r1 < r2.first); }
   };
 
-  static size_t CheckedCast(uint64_t v)
+  /// Reads a sorted run of the temporary file by chunks.
+  class RunReader
   {
-    ASSERT_LESS(v, numeric_limits<size_t>::max(), ("Value too long for memory address : ", v));
-    return static_cast<size_t>(v);
-  }
+    FileReader const & m_reader;
+    uint64_t m_pos;
+    uint64_t m_end;
+    TContainer m_buffer;
+    size_t m_bufferPos = 0;
+
+  public:
+    RunReader(FileReader const & reader, uint64_t beg, uint64_t end)
+      : m_reader(reader), m_pos(beg), m_end(end)
+    {
+    }
 
-public:
-  explicit IndexFile(string const & name) : m_file(name.c_str()) {}
+    bool Next(TElement & e)
+    {
+      if (m_bufferPos == m_buffer.size())
+      {
+        if (m_pos == m_end)
+          return false;
+        m_buffer.resize(static_cast<size_t>(min(static_cast<uint64_t>(kMergeBufferSize), m_end - m_pos)));
+        m_reader.Read(m_pos * sizeof(TElement), m_buffer.data(), m_buffer.size() * sizeof(TElement));
+        m_pos += m_buffer.size();
+        m_bufferPos = 0;
+      }
+      e = m_buffer[m_bufferPos++];
+      return true;
+    }
+  };
+
+  string m_name;
 
-  string GetFileName() const { return m_file.GetName(); }
+  // Write mode: the current run and the file of runs.
+  size_t m_runSize;
+  TContainer m_elements;
+  unique_ptr<FileWriter> m_runs;
+
+  // Read mode: the index file and the first keys of its pages.
+  unique_ptr<TFileReader> m_file;
+  vector<TKey> m_pageKeys;
+  uint64_t m_count = 0;
+
+  string GetRunsFileName() const { return m_name + ".runs"; }
 
-  void WriteAll()
+  void WriteRun()
   {
     if (m_elements.empty())
       return;
 
-    m_file.Write(&m_elements[0], m_elements.size() * sizeof(TElement));
+    sort(m_elements.begin(), m_elements.end(), ElementComparator());
+    m_runs->Write(m_elements.data(), m_elements.size() * sizeof(TElement));
     m_elements.clear();
   }
 
-  void ReadAll()
+  void MergeRuns()
   {
-    m_elements.clear();
-    size_t fileSize = m_file.Size();
-    if (fileSize == 0)
+    uint64_t const count = m_runs->Size() / sizeof(TElement);
+    m_runs.reset();
+
+    FileWriter writer(m_name);
+    if (count == 0)
       return;
 
-    LOG_SHORT(LINFO, ("Offsets reading is started for file ", GetFileName()));
-    CHECK_EQUAL(0, fileSize % sizeof(TElement), ("Damaged file."));
+    LOG_SHORT(LINFO, ("Merging of sorted runs is started for file", m_name));
+    FileReader const runs(GetRunsFileName());
+    vector<RunReader> readers;
+    for (uint64_t beg = 0; beg < count; beg += m_runSize)
+      readers.emplace_back(runs, beg, min(beg + m_runSize, count));
 
-    try
+    // Min-heap of the current elements of runs.
+    using TItem = pair<TElement, size_t>;
+    auto const greater = [](TItem const & r1, TItem const & r2)
+    {
+      return ElementComparator()(r2.first, r1.first);
+    };
+    priority_queue<TItem, vector<TItem>, decltype(greater)> heap(greater);
+    TElement e;
+    for (size_t i = 0; i < readers.size(); ++i)
     {
-      m_elements.resize(CheckedCast(fileSize / sizeof(TElement)));
+      if (readers[i].Next(e))
+        heap.emplace(e, i);
     }
-    catch (exception const &)  // bad_alloc
+
+    TContainer buffer;
+    buffer.reserve(kMergeBufferSize);
+    while (!heap.empty())
     {
-      LOG(LCRITICAL, ("Insufficient memory for required offset map"));
+      TItem const item = heap.top();
+      heap.pop();
+      buffer.push_back(item.first);
+      if (buffer.size() == kMergeBufferSize)
+      {
+        writer.Write(buffer.data(), buffer.size() * sizeof(TElement));
+        buffer.clear();
+      }
+      if (readers[item.second].Next(e))
+        heap.emplace(e, item.second);
     }
+    writer.Write(buffer.data(), buffer.size() * sizeof(TElement));
+    LOG_SHORT(LINFO, ("Merging of sorted runs is finished"));
+  }
 
-    m_file.Read(0, &m_elements[0], CheckedCast(fileSize));
+  /// @return count of elements in the page.
+  size_t ReadPage(size_t page, TElement * elements) const
+  {
+    uint64_t const beg = static_cast<uint64_t>(page) * kPageSize;
+    size_t const count = static_cast<size_t>(min(static_cast<uint64_t>(kPageSize), m_count - beg));
+    m_file->Read(beg * sizeof(TElement), elements, count * sizeof(TElement));
+    return count;
+  }
 
-    sort(m_elements.begin(), m_elements.end(), ElementComparator());
+public:
+  explicit IndexFile(string const & name, size_t runSize = kRunSize)
+    : m_name(name), m_runSize(runSize)
+  {
+    InitFile<TMode>();
+  }
+
+  ~IndexFile() { DoneFile<TMode>(); }
+
+  template <EMode T>
+  typename enable_if<T == EMode::Write, void>::type InitFile()
+  {
+    m_runs.reset(new FileWriter(GetRunsFileName()));
+  }
+
+  template <EMode T>
+  typename enable_if<T == EMode::Read, void>::type InitFile() {}
+
+  template <EMode T>
+  typename enable_if<T == EMode::Write, void>::type DoneFile()
+  {
+    if (m_runs)
+    {
+      m_runs.reset();
+      FileWriter::DeleteFileX(GetRunsFileName());
+    }
+  }
+
+  template <EMode T>
+  typename enable_if<T == EMode::Read, void>::type DoneFile() {}
+
+  string GetFileName() const { return m_name; }
 
-    LOG_SHORT(LINFO, ("Offsets reading is finished"));
+  /// Writes the sorted index file.
+  template <EMode T = TMode>
+  typename enable_if<T == EMode::Write, void>::type WriteAll()
+  {
+    WriteRun();
+    MergeRuns();
+    FileWriter::DeleteFileX(GetRunsFileName());
   }
 
-  void Add(TKey k, TValue const & v)
+  template <EMode T = TMode>
+  typename enable_if<T == EMode::Read, void>::type ReadAll()
   {
-    if (m_elements.size() > kFlushCount)
-      WriteAll();
+    m_file.reset();
+    m_pageKeys.clear();
+    m_count = 0;
+
+    uint64_t fileSize = 0;
+    if (!my::GetFileSize(m_name, fileSize) || fileSize == 0)
+      return;
+    CHECK_EQUAL(0, fileSize % sizeof(TElement), ("Damaged file."));
+
+    m_file.reset(new TFileReader(m_name));
+    m_count = fileSize / sizeof(TElement);
+    m_pageKeys.reserve(static_cast<size_t>((m_count + kPageSize - 1) / kPageSize));
+    for (uint64_t i = 0; i < m_count; i += kPageSize)
+    {
+      TKey key;
+      m_file->Read(i * sizeof(TElement), &key, sizeof(key));
+      CHECK(m_pageKeys.empty() || m_pageKeys.back() <= key, ("Index file isn't sorted:", m_name));
+      m_pageKeys.push_back(key);
+    }
+  }
+
+  template <EMode T = TMode>
+  typename enable_if<T == EMode::Write, void>::type Add(TKey k, TValue const & v)
+  {
+    if (m_elements.size() == m_runSize)
+      WriteRun();
 
     m_elements.push_back(make_pair(k, v));
   }
 
   bool GetValueByKey(TKey key, TValue & value) const
   {
-    auto it = lower_bound(m_elements.begin(), m_elements.end(), key, ElementComparator());
-    if ((it != m_elements.end()) && ((*it).first == key))
+    bool found = false;
+    ForEachByKey(key, [&](TValue const & v)
     {
-      value = (*it).second;
+      value = v;
+      found = true;
       return true;
-    }
-    return false;
+    });
+    return found;
   }
 
   template <class ToDo>
   void ForEachByKey(TKey k, ToDo && toDo) const
   {
-    auto range = equal_range(m_elements.begin(), m_elements.end(), k, ElementComparator());
-    for (; range.first != range.second; ++range.first)
+    // Pairs with the key start in the page before the first page which starts with
+    // a not less key.
+    auto const it = lower_bound(m_pageKeys.begin(), m_pageKeys.end(), k);
+    size_t page = (it == m_pageKeys.begin() ? 0 : static_cast<size_t>(it - m_pageKeys.begin()) - 1);
+
+    TElement elements[kPageSize];
+    for (; page < m_pageKeys.size(); ++page)
     {
-      if (toDo((*range.first).second))
+      TElement const * end = elements + ReadPage(page, elements);
+      auto range = equal_range(static_cast<TElement const *>(elements), end, k, ElementComparator());
+      for (; range.first != range.second; ++range.first)
+      {
+        if (toDo((*range.first).second))
+          return;
+      }
+      if (range.second != end)
         return;
     }
   }
 };
+/// Rewrites the sorted index file of (key, value) pairs: removes pairs for which isRemoved(pair)
+/// is true and merges the rest with added pairs. Used to update indexes by OsmChange files.
+template <class TValue, class TRemoved>
+void UpdateIndexFile(string const & name, vector<pair<uint64_t, TValue>> added, TRemoved && isRemoved)
+{
+  using TElement = pair<uint64_t, TValue>;
+  size_t constexpr kBufferSize = 4096;
+
+  sort(added.begin(), added.end());
+  auto addedIt = added.begin();
+
+  string const tmpName = name + ".update";
+  {
+    uint64_t fileSize = 0;
+    my::GetFileSize(name, fileSize);
+    CHECK_EQUAL(0, fileSize % sizeof(TElement), ("Damaged file."));
+    uint64_t const count = fileSize / sizeof(TElement);
+
+    FileWriter writer(tmpName);
+    vector<TElement> buffer;
+    buffer.reserve(kBufferSize);
+    auto const write = [&writer, &buffer](TElement const & e)
+    {
+      buffer.push_back(e);
+      if (buffer.size() == kBufferSize)
+      {
+        writer.Write(buffer.data(), buffer.size() * sizeof(TElement));
+        buffer.clear();
+      }
+    };
+
+    vector<TElement> chunk;
+    unique_ptr<FileReader> reader(count == 0 ? nullptr : new FileReader(name));
+    for (uint64_t beg = 0; beg < count; beg += chunk.size())
+    {
+      chunk.resize(static_cast<size_t>(min(static_cast<uint64_t>(kBufferSize), count - beg)));
+      reader->Read(beg * sizeof(TElement), chunk.data(), chunk.size() * sizeof(TElement));
+      for (TElement const & e : chunk)
+      {
+        if (isRemoved(e))
+          continue;
+        for (; addedIt != added.end() && *addedIt < e; ++addedIt)
+          write(*addedIt);
+        write(e);
+      }
+    }
+    for (; addedIt != added.end(); ++addedIt)
+      write(*addedIt);
+    writer.Write(buffer.data(), buffer.size() * sizeof(TElement));
+  }
+
+  CHECK(my::RenameFileX(tmpName, name), ("Can't rename", tmpName, "to", name));
+}
 } // namespace detail
 
+/// File of elements with the index of their offsets.
+/// In the Read mode, up to preloadSize bytes from the beginning of the file are preloaded
+/// to memory, other elements are read from the file.
 template <EMode TMode>
 class OSMElementCache
 {
 public:
   using TKey = uint64_t;
   using TStorage = typename conditional<TMode == EMode::Write, FileWriter, FileReader>::type;
-  using TOffsetFile = typename conditional<TMode == EMode::Write, FileWriter, FileReader>::type;
+
+  /// Values with gaps between them up to this size are read by one read in ReadBatch().
+  static uint64_t constexpr kMaxReadGap = 64 * 1024;
 
 protected:
   using TBuffer = vector<uint8_t>;
   TStorage m_storage;
-  detail::IndexFile<TOffsetFile, uint64_t> m_offsets;
+  detail::IndexFile<TMode, uint64_t> m_offsets;
   string m_name;
   TBuffer m_data;
-  bool m_preload = false;
+  uint64_t m_preloadSize = 0;
+  mutable mutex m_storageMutex;
+
+  template <class TValue>
+  static void ReadValue(uint8_t const * p, TValue & value)
+  {
+    uint32_t valueSize;
+    memcpy(&valueSize, p, sizeof(valueSize));
+    MemReader reader(p + sizeof(valueSize), valueSize);
+    value.Read(reader);
+  }
+
+  /// @return true if the value at pos is preloaded.
+  bool IsPreloaded(uint64_t pos) const
+  {
+    if (pos + sizeof(uint32_t) > m_data.size())
+      return false;
+    uint32_t valueSize;
+    memcpy(&valueSize, m_data.data() + pos, sizeof(valueSize));
+    return pos + sizeof(valueSize) + valueSize <= m_data.size();
+  }
 
 public:
-  OSMElementCache(string const & name, bool preload = false)
+  OSMElementCache(string const & name, uint64_t preloadSize = 0)
   : m_storage(name)
   , m_offsets(name + OFFSET_EXT)
   , m_name(name)
-  , m_preload(preload)
+  , m_preloadSize(preloadSize)
   {
     InitStorage<TMode>();
   }
@@ -162,9 +421,10 @@ public:
   template <EMode T>
   typename enable_if<T == EMode::Read, void>::type InitStorage()
   {
-    if (!m_preload)
+    size_t const sz = static_cast<size_t>(min(m_preloadSize, m_storage.Size()));
+    if (sz == 0)
       return;
-    size_t sz = m_storage.Size();
+    LOG_SHORT(LINFO, ("Preloading", sz, "bytes of", m_storage.Size(), "from", m_name));
     m_data.resize(sz);
     m_storage.Read(0, m_data.data(), sz);
   }
@@ -185,8 +445,10 @@ public:
     m_storage.Write(m_data.data(), sz * sizeof(TBuffer::value_type));
   }
 
+  /// Reading is thread safe: preloaded data isn't changed and reading from the file
+  /// is serialized, so several threads can share the cache.
   template <class TValue, EMode T = TMode>
-  typename enable_if<T == EMode::Read, bool>::type Read(TKey id, TValue & value)
+  typename enable_if<T == EMode::Read, bool>::type Read(TKey id, TValue & value) const
   {
     uint64_t pos = 0;
     if (!m_offsets.GetValueByKey(id, pos))
@@ -195,27 +457,163 @@ public:
       return false;
     }
 
-    uint32_t valueSize = m_preload ? *(reinterpret_cast<uint32_t *>(m_data.data() + pos)) : 0;
-    size_t offset = pos + sizeof(uint32_t);
+    if (IsPreloaded(pos))
+    {
+      ReadValue(m_data.data() + pos, value);
+      return true;
+    }
 
-    if (!m_preload)
+    // in case not-in-memory work we read buffer
+    uint32_t valueSize = 0;
+    TBuffer data;
     {
-      // in case not-in-memory work we read buffer
+      lock_guard<mutex> lock(m_storageMutex);
       m_storage.Read(pos, &valueSize, sizeof(valueSize));
-      m_data.resize(valueSize);
-      m_storage.Read(pos + sizeof(valueSize), m_data.data(), valueSize);
-      offset = 0;
+      data.resize(valueSize);
+      m_storage.Read(pos + sizeof(valueSize), data.data(), valueSize);
     }
 
-    MemReader reader(m_data.data() + offset, valueSize);
+    MemReader reader(data.data(), valueSize);
     value.Read(reader);
     return true;
   }
 
+  /// Reads values of ids in the order of their offsets, close values are read at once.
+  /// @param values  Initialized values of ids, found ones are read.
+  /// @param found  found[i] is true if values[i] is read.
+  /// @return count of read values.
+  template <class TValue, EMode T = TMode>
+  typename enable_if<T == EMode::Read, size_t>::type ReadBatch(vector<TKey> const & ids,
+                                                               vector<TValue> & values,
+                                                               vector<bool> & found) const
+  {
+    ASSERT_EQUAL(ids.size(), values.size(), ());
+    found.assign(ids.size(), false);
+
+    // Offsets of not preloaded values and indexes of ids.
+    vector<pair<uint64_t, size_t>> offsets;
+    size_t count = 0;
+    for (size_t i = 0; i < ids.size(); ++i)
+    {
+      uint64_t pos = 0;
+      if (!m_offsets.GetValueByKey(ids[i], pos))
+      {
+        LOG_SHORT(LWARNING, ("Can't find offset in file", m_offsets.GetFileName(), "by id", ids[i]));
+        continue;
+      }
+
+      if (IsPreloaded(pos))
+      {
+        ReadValue(m_data.data() + pos, values[i]);
+        found[i] = true;
+        ++count;
+      }
+      else
+      {
+        offsets.emplace_back(pos, i);
+      }
+    }
+    sort(offsets.begin(), offsets.end());
+
+    TBuffer data;
+    for (size_t beg = 0; beg < offsets.size();)
+    {
+      size_t end = beg + 1;
+      while (end < offsets.size() && offsets[end].first - offsets[end - 1].first <= kMaxReadGap)
+        ++end;
+
+      // Reads values from the first one to the size of the last one, then the last value.
+      uint64_t const first = offsets[beg].first;
+      uint64_t const last = offsets[end - 1].first;
+      {
+        lock_guard<mutex> lock(m_storageMutex);
+        data.resize(static_cast<size_t>(last - first + sizeof(uint32_t)));
+        m_storage.Read(first, data.data(), data.size());
+        uint32_t valueSize;
+        memcpy(&valueSize, data.data() + data.size() - sizeof(valueSize), sizeof(valueSize));
+        data.resize(data.size() + valueSize);
+        m_storage.Read(last + sizeof(valueSize), data.data() + data.size() - valueSize, valueSize);
+      }
+
+      for (; beg < end; ++beg)
+      {
+        size_t const i = offsets[beg].second;
+        ReadValue(data.data() + (offsets[beg].first - first), values[i]);
+        found[i] = true;
+        ++count;
+      }
+    }
+    return count;
+  }
+
   inline void SaveOffsets() { m_offsets.WriteAll(); }
   inline void LoadOffsets() { m_offsets.ReadAll(); }
 };
 
+/// Changes elements of existing OSMElementCache files. New values are appended to the data file
+/// and SaveOffsets() merges their offsets to the index, so values of modified and deleted elements
+/// stay in the data file until the intermediate data is generated from scratch.
+class OSMElementCacheUpdater
+{
+public:
+  using TKey = uint64_t;
+
+private:
+  using TBuffer = vector<uint8_t>;
+
+  string m_name;
+  uint64_t m_pos;
+  FileWriter m_storage;
+  vector<pair<TKey, uint64_t>> m_offsets;
+  vector<TKey> m_removed;
+  TBuffer m_data;
+
+  static uint64_t GetSize(string const & name)
+  {
+    uint64_t size = 0;
+    CHECK(my::GetFileSize(name, size), ("Can't find file", name));
+    return size;
+  }
+
+public:
+  explicit OSMElementCacheUpdater(string const & name)
+  : m_name(name), m_pos(GetSize(name)), m_storage(name, FileWriter::OP_APPEND)
+  {
+  }
+
+  /// Adds a new element or replaces an existing one.
+  template <class TValue>
+  void Write(TKey id, TValue const & value)
+  {
+    m_removed.push_back(id);
+    m_offsets.emplace_back(id, m_pos);
+
+    m_data.clear();
+    MemWriter<TBuffer> w(m_data);
+    value.Write(w);
+
+    ASSERT_LESS(m_data.size(), numeric_limits<uint32_t>::max(), ());
+    uint32_t sz = static_cast<uint32_t>(m_data.size());
+    m_storage.Write(&sz, sizeof(sz));
+    m_storage.Write(m_data.data(), sz * sizeof(TBuffer::value_type));
+    m_pos += sizeof(sz) + sz;
+  }
+
+  void Remove(TKey id) { m_removed.push_back(id); }
+
+  /// Should be called once after all changes.
+  void SaveOffsets()
+  {
+    m_storage.Flush();
+    sort(m_removed.begin(), m_removed.end());
+    detail::UpdateIndexFile(m_name + OFFSET_EXT, move(m_offsets),
+                            [this](pair<TKey, uint64_t> const & e)
+    {
+      return binary_search(m_removed.begin(), m_removed.end(), e.first);
+    });
+  }
+};
+
 /// Used to store all world nodes inside temporary index file.
 /// To find node by id, just calculate offset inside index file:
 /// offset_in_file = sizeof(LatLon) * node_ID
@@ -241,18 +639,27 @@ public:
 
   inline size_t GetProcessedPoint() const { return m_processedPoint; }
   inline void IncProcessedPoint() { ++m_processedPoint; }
+
+protected:
+  static LatLon ToLatLon(double lat, double lng)
+  {
+    double constexpr kValueOrder = 1E+7;
+    int64_t const lat64 = lat * kValueOrder;
+    int64_t const lng64 = lng * kValueOrder;
+
+    LatLon ll;
+    ll.lat = static_cast<int32_t>(lat64);
+    ll.lon = static_cast<int32_t>(lng64);
+    CHECK_EQUAL(static_cast<int64_t>(ll.lat), lat64, ("Latitude is out of 32bit boundary!"));
+    CHECK_EQUAL(static_cast<int64_t>(ll.lon), lng64, ("Longtitude is out of 32bit boundary!"));
+    return ll;
+  }
 };
 
 template <EMode TMode>
 class RawFilePointStorage : public PointStorage
 {
-#ifdef OMIM_OS_WINDOWS
-  using TFileReader = FileReader;
-#else
-  using TFileReader = MmapReader;
-#endif
-
-  typename conditional<TMode == EMode::Write, FileWriter, TFileReader>::type m_file;
+  typename conditional<TMode == EMode::Write, FileWriter, detail::TFileReader>::type m_file;
 
   constexpr static double const kValueOrder = 1E+7;
 
@@ -262,14 +669,7 @@ public:
   template <EMode T = TMode>
   typename enable_if<T == EMode::Write, void>::type AddPoint(uint64_t id, double lat, double lng)
   {
-    int64_t const lat64 = lat * kValueOrder;
-    int64_t const lng64 = lng * kValueOrder;
-
-    LatLon ll;
-    ll.lat = static_cast<int32_t>(lat64);
-    ll.lon = static_cast<int32_t>(lng64);
-    CHECK_EQUAL(static_cast<int64_t>(ll.lat), lat64, ("Latitude is out of 32bit boundary!"));
-    CHECK_EQUAL(static_cast<int64_t>(ll.lon), lng64, ("Longtitude is out of 32bit boundary!"));
+    LatLon const ll = ToLatLon(lat, lng);
 
     m_file.Seek(id * sizeof(ll));
     m_file.Write(&ll, sizeof(ll));
@@ -334,14 +734,7 @@ public:
   template <EMode T = TMode>
   typename enable_if<T == EMode::Write, void>::type AddPoint(uint64_t id, double lat, double lng)
   {
-    int64_t const lat64 = lat * kValueOrder;
-    int64_t const lng64 = lng * kValueOrder;
-
-    LatLon & ll = m_data[id];
-    ll.lat = static_cast<int32_t>(lat64);
-    ll.lon = static_cast<int32_t>(lng64);
-    CHECK_EQUAL(static_cast<int64_t>(ll.lat), lat64, ("Latitude is out of 32bit boundary!"));
-    CHECK_EQUAL(static_cast<int64_t>(ll.lon), lng64, ("Longtitude is out of 32bit boundary!"));
+    m_data[id] = ToLatLon(lat, lng);
 
     IncProcessedPoint();
   }
@@ -390,7 +783,11 @@ public:
       LatLonPos ll;
       m_file.Read(pos, &ll, sizeof(ll));
 
-      m_map.emplace(make_pair(ll.pos, make_pair(ll.lat, ll.lon)));
+      // The last position of a node wins, see MapPointStorageUpdater.
+      if (ll.lat == 0 && ll.lon == 0)
+        m_map.erase(ll.pos);
+      else
+        m_map[ll.pos] = make_pair(ll.lat, ll.lon);
 
       pos += sizeof(ll);
     }
@@ -400,16 +797,12 @@ public:
 
   void AddPoint(uint64_t id, double lat, double lng)
   {
-    int64_t const lat64 = lat * kValueOrder;
-    int64_t const lng64 = lng * kValueOrder;
-
-    LatLonPos ll;
-    ll.pos = id;
-    ll.lat = static_cast<int32_t>(lat64);
-    ll.lon = static_cast<int32_t>(lng64);
-    CHECK_EQUAL(static_cast<int64_t>(ll.lat), lat64, ("Latitude is out of 32bit boundary!"));
-    CHECK_EQUAL(static_cast<int64_t>(ll.lon), lng64, ("Longtitude is out of 32bit boundary!"));
-    m_file.Write(&ll, sizeof(ll));
+    LatLon const ll = ToLatLon(lat, lng);
+    LatLonPos llp;
+    llp.pos = id;
+    llp.lat = ll.lat;
+    llp.lon = ll.lon;
+    m_file.Write(&llp, sizeof(llp));
 
     IncProcessedPoint();
   }
@@ -425,4 +818,335 @@ public:
   }
 };
 
+/// Changes nodes of existing RawFilePointStorage files in place.
+/// RawMemPointStorage files have the same format and are changed by this class too.
+class RawPointStorageUpdater : public PointStorage
+{
+  FileWriter m_file;
+
+public:
+  explicit RawPointStorageUpdater(string const & name)
+  : m_file(name, FileWriter::OP_WRITE_EXISTING)
+  {
+  }
+
+  void AddPoint(uint64_t id, double lat, double lng)
+  {
+    LatLon const ll = ToLatLon(lat, lng);
+    m_file.Seek(id * sizeof(ll));
+    m_file.Write(&ll, sizeof(ll));
+    IncProcessedPoint();
+  }
+
+  /// Zero coordinates mean a missing node in raw storages.
+  void RemovePoint(uint64_t id)
+  {
+    LatLon const ll = {0, 0};
+    m_file.Seek(id * sizeof(ll));
+    m_file.Write(&ll, sizeof(ll));
+  }
+};
+
+/// Appends changed nodes to the existing MapFilePointStorage file,
+/// the last position of a node is used on reading.
+class MapPointStorageUpdater : public PointStorage
+{
+  FileWriter m_file;
+
+  void Write(uint64_t id, LatLon const & ll)
+  {
+    LatLonPos llp;
+    llp.pos = id;
+    llp.lat = ll.lat;
+    llp.lon = ll.lon;
+    m_file.Write(&llp, sizeof(llp));
+  }
+
+public:
+  explicit MapPointStorageUpdater(string const & name)
+  : m_file(name + ".short", FileWriter::OP_APPEND)
+  {
+  }
+
+  void AddPoint(uint64_t id, double lat, double lng)
+  {
+    Write(id, ToLatLon(lat, lng));
+    IncProcessedPoint();
+  }
+
+  /// Zero coordinates remove the node on reading.
+  void RemovePoint(uint64_t id) { Write(id, {0, 0}); }
+};
+
+/// Stores nodes in blocks of kBlockSize nodes with ascending ids. Ids and coordinates of a block
+/// are delta encoded varints, so the file size depends on the count of nodes only, unlike
+/// RawFilePointStorage where it depends on the maximal id. The index of first ids and offsets
+/// of blocks is kept in memory and saved at the end of the file.
+/// A block with an id is found by the table of the first block of every 2^kBucketBits ids and
+/// a binary search of the blocks inside the bucket, then the block is decoded up to the id.
+/// @note Nodes should be added in ascending order of ids as they go in OSM files.
+template <EMode TMode>
+class SparsePointStorage : public PointStorage
+{
+  struct BlockInfo
+  {
+    uint64_t m_firstId;
+    uint64_t m_offset;
+  };
+  static_assert(sizeof(BlockInfo) == 16, "Invalid structure size");
+
+  /// Decodes nodes of a block one by one.
+  class BlockDecoder
+  {
+    ArrayByteSource m_src;
+    uint8_t const * m_end;
+    uint64_t m_id;
+    int64_t m_lat = 0;
+    int64_t m_lon = 0;
+    bool m_decoded = false;
+
+  public:
+    BlockDecoder(uint8_t const * beg, uint8_t const * end, uint64_t firstId)
+      : m_src(beg), m_end(end), m_id(firstId)
+    {
+    }
+
+    /// Decodes nodes up to id, ids of consecutive calls should not decrease.
+    bool Find(uint64_t id, double & lat, double & lng)
+    {
+      while (!m_decoded || m_id < id)
+      {
+        if (m_src.PtrUC() == m_end)
+          return false;
+        m_id += ReadVarUint<uint64_t>(m_src);
+        m_lat += ReadVarInt<int64_t>(m_src);
+        m_lon += ReadVarInt<int64_t>(m_src);
+        m_decoded = true;
+      }
+      if (m_id != id)
+        return false;
+      lat = static_cast<double>(m_lat) / kValueOrder;
+      lng = static_cast<double>(m_lon) / kValueOrder;
+      return true;
+    }
+  };
+
+  typename conditional<TMode == EMode::Write, FileWriter, detail::TFileReader>::type m_file;
+
+  constexpr static double const kValueOrder = 1E+7;
+  static size_t constexpr kBlockSize = 64;
+  // An id delta and two coordinate deltas take at most 10 bytes each.
+  static size_t constexpr kMaxBlockBytes = kBlockSize * 30;
+  static uint32_t constexpr kBucketBits = 16;
+
+  vector<BlockInfo> m_blocks;
+
+  // Write mode: the current block.
+  vector<uint8_t> m_block;
+  size_t m_blockNodes = 0;
+  uint64_t m_lastId = 0;
+  LatLon m_last;
+
+  // Read mode: m_buckets[i] is the first block with the first id not less than i << kBucketBits.
+  vector<uint32_t> m_buckets;
+  uint64_t m_dataSize = 0;
+
+  void FlushBlock()
+  {
+    m_file.Write(m_block.data(), m_block.size());
+    m_block.clear();
+    m_blockNodes = 0;
+  }
+
+  /// @return false if id is less than the first id.
+  bool FindBlock(uint64_t id, size_t & block) const
+  {
+    if (m_blocks.empty() || id < m_blocks.front().m_firstId)
+      return false;
+
+    uint64_t const bucket = id >> kBucketBits;
+    if (bucket + 1 >= m_buckets.size())
+    {
+      block = m_blocks.size() - 1;
+      return true;
+    }
+
+    auto const beg = m_blocks.begin() + m_buckets[bucket];
+    auto const it = upper_bound(beg, m_blocks.begin() + m_buckets[bucket + 1], id,
+                                [](uint64_t value, BlockInfo const & b) { return value < b.m_firstId; });
+    // Blocks of the bucket start after id, so it's in the last block of previous buckets.
+    block = static_cast<size_t>(it - m_blocks.begin()) - 1;
+    return true;
+  }
+
+  /// Reads the block to buffer and returns its end.
+  uint8_t const * ReadBlock(size_t block, uint8_t * buffer) const
+  {
+    uint64_t const beg = m_blocks[block].m_offset;
+    uint64_t const end = block + 1 < m_blocks.size() ? m_blocks[block + 1].m_offset : m_dataSize;
+    ASSERT_LESS_OR_EQUAL(end - beg, static_cast<uint64_t>(kMaxBlockBytes), ());
+    m_file.Read(beg, buffer, static_cast<size_t>(end - beg));
+    return buffer + (end - beg);
+  }
+
+public:
+  explicit SparsePointStorage(string const & name) : m_file(name + ".sparse")
+  {
+    InitStorage<TMode>();
+  }
+
+  ~SparsePointStorage() { DoneStorage<TMode>(); }
+
+  template <EMode T>
+  typename enable_if<T == EMode::Write, void>::type InitStorage() {}
+
+  template <EMode T>
+  typename enable_if<T == EMode::Read, void>::type InitStorage()
+  {
+    uint64_t const fileSize = m_file.Size();
+    uint64_t count = 0;
+    CHECK_GREATER_OR_EQUAL(fileSize, sizeof(count), ("Damaged file."));
+    m_file.Read(fileSize - sizeof(count), &count, sizeof(count));
+    CHECK_GREATER_OR_EQUAL(fileSize, sizeof(count) + count * sizeof(BlockInfo), ("Damaged file."));
+
+    m_dataSize = fileSize - sizeof(count) - count * sizeof(BlockInfo);
+    m_blocks.resize(static_cast<size_t>(count));
+    if (count != 0)
+      m_file.Read(m_dataSize, m_blocks.data(), m_blocks.size() * sizeof(BlockInfo));
+
+    if (m_blocks.empty())
+      return;
+    CHECK_LESS(m_blocks.size(), numeric_limits<uint32_t>::max(), ());
+    size_t const bucketsCount = static_cast<size_t>(m_blocks.back().m_firstId >> kBucketBits) + 2;
+    m_buckets.resize(bucketsCount);
+    uint32_t block = 0;
+    for (size_t bucket = 0; bucket < bucketsCount; ++bucket)
+    {
+      while (block < m_blocks.size() && (m_blocks[block].m_firstId >> kBucketBits) < bucket)
+        ++block;
+      m_buckets[bucket] = block;
+    }
+  }
+
+  template <EMode T>
+  typename enable_if<T == EMode::Write, void>::type DoneStorage()
+  {
+    FlushBlock();
+    uint64_t const count = m_blocks.size();
+    if (count != 0)
+      m_file.Write(m_blocks.data(), m_blocks.size() * sizeof(BlockInfo));
+    m_file.Write(&count, sizeof(count));
+  }
+
+  template <EMode T>
+  typename enable_if<T == EMode::Read, void>::type DoneStorage() {}
+
+  template <EMode T = TMode>
+  typename enable_if<T == EMode::Write, void>::type AddPoint(uint64_t id, double lat, double lng)
+  {
+    LatLon const ll = ToLatLon(lat, lng);
+
+    if (!m_blocks.empty())
+      CHECK_GREATER(id, m_lastId, ("Nodes should be sorted by id for the sparse storage."));
+
+    if (m_blockNodes == kBlockSize)
+      FlushBlock();
+
+    if (m_blockNodes == 0)
+    {
+      m_blocks.push_back({id, static_cast<uint64_t>(m_file.Pos())});
+      m_lastId = id;
+      m_last.lat = m_last.lon = 0;
+    }
+
+    PushBackByteSink<vector<uint8_t>> sink(m_block);
+    WriteVarUint(sink, id - m_lastId);
+    WriteVarInt(sink, static_cast<int64_t>(ll.lat) - m_last.lat);
+    WriteVarInt(sink, static_cast<int64_t>(ll.lon) - m_last.lon);
+
+    m_lastId = id;
+    m_last = ll;
+    ++m_blockNodes;
+
+    IncProcessedPoint();
+  }
+
+  template <EMode T = TMode>
+  typename enable_if<T == EMode::Read, bool>::type GetPoint(uint64_t id, double & lat,
+                                                            double & lng) const
+  {
+    size_t block = 0;
+    if (FindBlock(id, block))
+    {
+      uint8_t buffer[kMaxBlockBytes];
+      BlockDecoder decoder(buffer, ReadBlock(block, buffer), m_blocks[block].m_firstId);
+      if (decoder.Find(id, lat, lng))
+        return true;
+    }
+    LOG(LERROR, ("Node with id = ", id, " not found!"));
+    return false;
+  }
+
+  /// Batched lookup of nodes with ascending ids, every block is decoded at most once.
+  /// Calls toDo(i, lat, lng) for every found ids[i].
+  /// @return count of found nodes.
+  template <class ToDo, EMode T = TMode>
+  typename enable_if<T == EMode::Read, size_t>::type ForEachPoint(vector<uint64_t> const & ids,
+                                                                  ToDo && toDo) const
+  {
+    ASSERT(is_sorted(ids.begin(), ids.end()), ());
+
+    uint8_t buffer[kMaxBlockBytes];
+    BlockDecoder decoder(buffer, buffer, 0);
+    size_t currentBlock = m_blocks.size();
+    size_t found = 0;
+    for (size_t i = 0; i < ids.size(); ++i)
+    {
+      size_t block = 0;
+      if (!FindBlock(ids[i], block))
+        continue;
+
+      if (block != currentBlock)
+      {
+        currentBlock = block;
+        decoder = BlockDecoder(buffer, ReadBlock(block, buffer), m_blocks[block].m_firstId);
+      }
+
+      double lat, lng;
+      if (decoder.Find(ids[i], lat, lng))
+      {
+        toDo(i, lat, lng);
+        ++found;
+      }
+    }
+    return found;
+  }
+};
+
+/// Batched lookup of nodes with ascending ids by GetPoint() for storages without blocks.
+/// Calls toDo(i, lat, lng) for every found ids[i].
+/// @return count of found nodes.
+template <class TNodesHolder, class ToDo>
+size_t ForEachPoint(TNodesHolder const & nodes, vector<uint64_t> const & ids, ToDo && toDo)
+{
+  size_t found = 0;
+  for (size_t i = 0; i < ids.size(); ++i)
+  {
+    double lat, lng;
+    if (nodes.GetPoint(ids[i], lat, lng))
+    {
+      toDo(i, lat, lng);
+      ++found;
+    }
+  }
+  return found;
+}
+
+template <class ToDo>
+size_t ForEachPoint(SparsePointStorage<EMode::Read> const & nodes, vector<uint64_t> const & ids,
+                    ToDo && toDo)
+{
+  return nodes.ForEachPoint(ids, forward<ToDo>(toDo));
+}
+
 }  // namespace cache
@@ -0,0 +1,345 @@
+#include "generator/osm_change.hpp"
+
+#include "generator/intermediate_data.hpp"
+#include "generator/intermediate_elements.hpp"
+
+#include "indexer/mercator.hpp"
+
+#include "coding/parse_xml.hpp"
+
+#include "base/logging.hpp"
+
+#include "std/map.hpp"
+#include "std/set.hpp"
+
+#include "defines.hpp"
+
+namespace
+{
+struct Change
+{
+  OsmChangeAction m_action = OsmChangeAction::Modify;
+  OsmElement m_element;
+
+  bool IsCreated() const { return m_action == OsmChangeAction::Create; }
+  bool IsDeleted() const { return m_action == OsmChangeAction::Delete; }
+};
+
+/// Changes by ids, the last change of an element in the file wins.
+using TChanges = map<uint64_t, Change>;
+
+struct OsmChange
+{
+  TChanges m_nodes;
+  TChanges m_ways;
+  TChanges m_relations;
+};
+
+WayElement ToWay(OsmElement const & e)
+{
+  WayElement way(e.id);
+  way.nodes = e.Nodes();
+  return way;
+}
+
+RelationElement ToRelation(OsmElement const & e)
+{
+  RelationElement relation;
+  for (auto const & member : e.Members())
+  {
+    if (member.type == OsmElement::EntityType::Node)
+      relation.nodes.emplace_back(member.ref, member.role);
+    else if (member.type == OsmElement::EntityType::Way)
+      relation.ways.emplace_back(member.ref, member.role);
+  }
+  for (auto const & tag : e.Tags())
+    relation.tags.emplace(tag.key, tag.value);
+  return relation;
+}
+
+/// The same relations as in the preprocessing pass are cached.
+bool IsCachedRelation(RelationElement const & relation)
+{
+  if (!relation.IsValid())
+    return false;
+  string const type = relation.GetType();
+  return type == "multipolygon" || type == "route" || type == "boundary";
+}
+
+/// Collects names of countries which contain points.
+class CountriesCollector
+{
+  borders::CountriesContainerT const & m_countries;
+  set<string> m_names;
+
+public:
+  explicit CountriesCollector(borders::CountriesContainerT const & countries)
+    : m_countries(countries)
+  {
+  }
+
+  void operator()(m2::PointD const & pt)
+  {
+    m2::RectD const rect(pt, pt);
+    m_countries.ForEachInRect(rect, [&](borders::CountryPolygons const & country)
+    {
+      if (m_names.count(country.m_name) != 0)
+        return;
+
+      bool contains = false;
+      country.m_regions.ForEachInRect(rect, [&](borders::Region const & region)
+      {
+        if (!contains)
+          contains = region.Contains(pt);
+      });
+      if (contains)
+        m_names.insert(country.m_name);
+    });
+  }
+
+  vector<string> GetNames() const { return vector<string>(m_names.begin(), m_names.end()); }
+};
+
+template <class TNodesReader>
+void CollectAffectedCountries(feature::GenerateInfo const & info, OsmChange const & change,
+                              CountriesCollector & collector)
+{
+  using TReader = cache::OSMElementCache<cache::EMode::Read>;
+
+  TNodesReader nodes(info.GetIntermediateFileName(NODES_FILE, ""));
+  TReader ways(info.GetIntermediateFileName(WAYS_FILE, ""));
+  TReader relations(info.GetIntermediateFileName(RELATIONS_FILE, ""));
+  ways.LoadOffsets();
+  relations.LoadOffsets();
+
+  // Nodes and ways which old and new positions are collected.
+  set<uint64_t> nodeIds;
+  set<uint64_t> wayIds;
+
+  auto const addMembers = [&nodeIds, &wayIds](RelationElement const & relation)
+  {
+    for (auto const & member : relation.nodes)
+      nodeIds.insert(member.first);
+    for (auto const & member : relation.ways)
+      wayIds.insert(member.first);
+  };
+
+  for (auto const & p : change.m_relations)
+  {
+    RelationElement relation;
+    if (!p.second.IsCreated() && relations.Read(p.first, relation))
+      addMembers(relation);
+    if (!p.second.IsDeleted())
+      addMembers(ToRelation(p.second.m_element));
+  }
+
+  for (auto const & p : change.m_ways)
+  {
+    wayIds.insert(p.first);
+    if (!p.second.IsDeleted())
+      nodeIds.insert(p.second.m_element.Nodes().begin(), p.second.m_element.Nodes().end());
+  }
+
+  // Old ways are read in the order of the file.
+  vector<uint64_t> oldWayIds;
+  for (uint64_t id : wayIds)
+  {
+    auto const it = change.m_ways.find(id);
+    if (it == change.m_ways.end() || !it->second.IsCreated())
+      oldWayIds.push_back(id);
+  }
+  vector<WayElement> oldWays;
+  for (uint64_t id : oldWayIds)
+    oldWays.emplace_back(id);
+  vector<bool> found;
+  ways.ReadBatch(oldWayIds, oldWays, found);
+  for (size_t i = 0; i < oldWays.size(); ++i)
+  {
+    if (found[i])
+      nodeIds.insert(oldWays[i].nodes.begin(), oldWays[i].nodes.end());
+  }
+
+  for (uint64_t id : nodeIds)
+  {
+    auto const it = change.m_nodes.find(id);
+    if (it != change.m_nodes.end() && !it->second.IsDeleted())
+      collector(MercatorBounds::FromLatLon(it->second.m_element.lat, it->second.m_element.lon));
+
+    double lat, lng;
+    if ((it == change.m_nodes.end() || !it->second.IsCreated()) && nodes.GetPoint(id, lat, lng))
+      collector(m2::PointD(lng, lat));
+  }
+}
+
+template <class TNodesUpdater>
+void ApplyChange(feature::GenerateInfo const & info, OsmChange const & change)
+{
+  {
+    TNodesUpdater nodes(info.GetIntermediateFileName(NODES_FILE, ""));
+    for (auto const & p : change.m_nodes)
+    {
+      if (p.second.IsDeleted())
+      {
+        nodes.RemovePoint(p.first);
+        continue;
+      }
+      auto const pt = MercatorBounds::FromLatLon(p.second.m_element.lat, p.second.m_element.lon);
+      nodes.AddPoint(p.first, pt.y, pt.x);
+    }
+  }
+
+  {
+    cache::OSMElementCacheUpdater ways(info.GetIntermediateFileName(WAYS_FILE, ""));
+    for (auto const & p : change.m_ways)
+    {
+      WayElement const way = ToWay(p.second.m_element);
+      if (p.second.IsDeleted() || !way.IsValid())
+        ways.Remove(p.first);
+      else
+        ways.Write(p.first, way);
+    }
+    ways.SaveOffsets();
+  }
+
+  using TIndex = vector<pair<uint64_t, uint64_t>>;
+  TIndex nodeToRelations;
+  TIndex wayToRelations;
+  cache::OSMElementCacheUpdater relations(info.GetIntermediateFileName(RELATIONS_FILE, ""));
+  for (auto const & p : change.m_relations)
+  {
+    RelationElement const relation = ToRelation(p.second.m_element);
+    if (p.second.IsDeleted() || !IsCachedRelation(relation))
+    {
+      relations.Remove(p.first);
+      continue;
+    }
+
+    relations.Write(p.first, relation);
+    for (auto const & member : relation.nodes)
+      nodeToRelations.emplace_back(member.first, p.first);
+    for (auto const & member : relation.ways)
+      wayToRelations.emplace_back(member.first, p.first);
+  }
+  relations.SaveOffsets();
+
+  // Members of all changed relations are replaced.
+  auto const isChanged = [&change](pair<uint64_t, uint64_t> const & e)
+  {
+    return change.m_relations.count(e.second) != 0;
+  };
+  cache::detail::UpdateIndexFile(info.GetIntermediateFileName(NODES_FILE, ID2REL_EXT),
+                                 move(nodeToRelations), isChanged);
+  cache::detail::UpdateIndexFile(info.GetIntermediateFileName(WAYS_FILE, ID2REL_EXT),
+                                 move(wayToRelations), isChanged);
+}
+
+template <class TNodesReader, class TNodesUpdater>
+bool ApplyOsmChangeImpl(feature::GenerateInfo const & info, OsmChange const & change,
+                        borders::CountriesContainerT const & countries,
+                        vector<string> & affectedCountries)
+{
+  try
+  {
+    CountriesCollector collector(countries);
+    CollectAffectedCountries<TNodesReader>(info, change, collector);
+    ApplyChange<TNodesUpdater>(info, change);
+    affectedCountries = collector.GetNames();
+  }
+  catch (RootException const & e)
+  {
+    LOG(LERROR, ("Can't apply the change:", e.Msg()));
+    return false;
+  }
+  return true;
+}
+}  // namespace
+
+OsmChangeSource::OsmChangeSource(TEmitterFn const & fn)
+  : m_source([this](OsmElement * e) { m_emitterFn(m_action, e); }), m_emitterFn(fn)
+{
+}
+
+void OsmChangeSource::AddAttr(string const & key, string const & value)
+{
+  if (m_depth > 2)
+    m_source.AddAttr(key, value);
+}
+
+bool OsmChangeSource::Push(string const & tagName)
+{
+  // The root <osmChange> tag isn't passed to XMLSource.
+  if (++m_depth == 1)
+    return true;
+
+  if (m_depth == 2)
+  {
+    if (tagName == "create")
+    {
+      m_action = OsmChangeAction::Create;
+    }
+    else if (tagName == "delete")
+    {
+      m_action = OsmChangeAction::Delete;
+    }
+    else
+    {
+      if (tagName != "modify")
+        LOG(LWARNING, ("Unknown change action", tagName));
+      m_action = OsmChangeAction::Modify;
+    }
+  }
+  return m_source.Push(tagName);
+}
+
+void OsmChangeSource::Pop(string const & v)
+{
+  if (m_depth-- > 1)
+    m_source.Pop(v);
+}
+
+void ReadOsmChange(SourceReader & stream, OsmChangeSource::TEmitterFn const & fn)
+{
+  OsmChangeSource parser(fn);
+  ParseXMLSequence(stream, parser);
+}
+
+bool ApplyOsmChange(feature::GenerateInfo const & info, SourceReader & stream,
+                    borders::CountriesContainerT const & countries,
+                    vector<string> & affectedCountries)
+{
+  OsmChange change;
+  ReadOsmChange(stream, [&change](OsmChangeAction action, OsmElement * e)
+  {
+    TChanges * changes = nullptr;
+    switch (e->type)
+    {
+      case OsmElement::EntityType::Node: changes = &change.m_nodes; break;
+      case OsmElement::EntityType::Way: changes = &change.m_ways; break;
+      case OsmElement::EntityType::Relation: changes = &change.m_relations; break;
+      default: return;
+    }
+    Change & c = (*changes)[e->id];
+    c.m_action = action;
+    c.m_element = *e;
+  });
+  LOG(LINFO, ("Changed nodes:", change.m_nodes.size(), "ways:", change.m_ways.size(),
+              "relations:", change.m_relations.size()));
+
+  // Files of RawMemPointStorage have the same format as RawFilePointStorage ones.
+  switch (info.m_nodeStorageType)
+  {
+    case feature::GenerateInfo::NodeStorageType::File:
+    case feature::GenerateInfo::NodeStorageType::Memory:
+      return ApplyOsmChangeImpl<cache::RawFilePointStorage<cache::EMode::Read>,
+                                cache::RawPointStorageUpdater>(info, change, countries,
+                                                               affectedCountries);
+    case feature::GenerateInfo::NodeStorageType::Index:
+      return ApplyOsmChangeImpl<cache::MapFilePointStorage<cache::EMode::Read>,
+                                cache::MapPointStorageUpdater>(info, change, countries,
+                                                               affectedCountries);
+    case feature::GenerateInfo::NodeStorageType::Sparse:
+      LOG(LERROR, ("Sparse node storage can't be changed, generate intermediate data again."));
+      return false;
+  }
+  return false;
+}
@@ -0,0 +1,54 @@
+#pragma once
+
+#include "generator/borders_loader.hpp"
+#include "generator/generate_info.hpp"
+#include "generator/osm_element.hpp"
+#include "generator/osm_source.hpp"
+#include "generator/osm_xml_source.hpp"
+
+#include "std/function.hpp"
+#include "std/string.hpp"
+#include "std/vector.hpp"
+
+enum class OsmChangeAction
+{
+  Create,
+  Modify,
+  Delete
+};
+
+/// Parser of OsmChange files (.osc). Elements are nested into <create>, <modify> and <delete>
+/// tags, so they are parsed by XMLSource one level deeper than in OSM files.
+class OsmChangeSource
+{
+public:
+  using TEmitterFn = function<void(OsmChangeAction, OsmElement *)>;
+
+private:
+  XMLSource m_source;
+  TEmitterFn m_emitterFn;
+  OsmChangeAction m_action = OsmChangeAction::Modify;
+  size_t m_depth = 0;
+
+public:
+  explicit OsmChangeSource(TEmitterFn const & fn);
+
+  void CharData(string const &) {}
+  void AddAttr(string const & key, string const & value);
+  bool Push(string const & tagName);
+  void Pop(string const & v);
+};
+
+void ReadOsmChange(SourceReader & stream, OsmChangeSource::TEmitterFn const & fn);
+
+/// Applies the OsmChange file to the intermediate nodes, ways and relations, so the features pass
+/// for the changed planet doesn't need the preprocessing pass.
+/// @param countries  Country borders to find countries affected by the change.
+/// @param affectedCountries  Names of countries at old and new positions of changed nodes,
+///                           nodes of changed ways and members of changed relations. Only these
+///                           countries should be generated again.
+/// @note Changes of nodes move segments to neighbouring nodes too, so a country crossed by
+///       such segment without nodes in it is missed.
+bool ApplyOsmChange(feature::GenerateInfo const & info, SourceReader & stream,
+                    borders::CountriesContainerT const & countries,
+                    vector<string> & affectedCountries);
@@ -30,9 +30,17 @@ string DebugPrint(OsmElement::EntityType e)
 }
 
 
-void OsmElement::AddTag(string const & k, string const & v)
+void OsmElement::AddMember(uint64_t ref, EntityType type, char const * role, size_t roleSize)
 {
-#define SKIP_KEY(key) if (strncmp(k.data(), key, sizeof(key)-1) == 0) return;
+  Member & member = m_spareMembers.Give(m_members);
+  member.ref = ref;
+  member.type = type;
+  member.role.assign(role, roleSize);
+}
+
+void OsmElement::AddTag(char const * k, size_t kSize, char const * v, size_t vSize)
+{
+#define SKIP_KEY(key) if (kSize >= sizeof(key)-1 && strncmp(k, key, sizeof(key)-1) == 0) return;
   // OSM technical info tags
   SKIP_KEY("created_by");
   SKIP_KEY("source");
@@ -59,7 +67,9 @@ void OsmElement::AddTag(string const & k, string const & v)
   SKIP_KEY("official_name");
 #undef SKIP_KEY
 
-  m_tags.emplace_back(k, v);
+  Tag & tag = m_spareTags.Give(m_tags);
+  tag.key.assign(k, kSize);
+  tag.value.assign(v, vSize);
 }
 
 
@@ -3,6 +3,7 @@
 #include "base/math.hpp"
 #include "base/string_utils.hpp"
 
+#include "std/cstring.hpp"
 #include "std/exception.hpp"
 #include "std/function.hpp"
 #include "std/iomanip.hpp"
@@ -83,8 +84,8 @@ struct OsmElement
     role.clear();
 
     m_nds.clear();
-    m_members.clear();
-    m_tags.clear();
+    m_spareMembers.Take(m_members);
+    m_spareTags.Take(m_tags);
   }
 
   string ToString(string const & shift = string()) const;
@@ -126,9 +127,61 @@ struct OsmElement
   void AddNd(uint64_t ref) { m_nds.emplace_back(ref); }
   void AddMember(uint64_t ref, EntityType type, string const & role)
   {
-    m_members.emplace_back(ref, type, role);
+    AddMember(ref, type, role.data(), role.size());
   }
-  void AddTag(string const & k, string const & v);
+  void AddMember(uint64_t ref, EntityType type, char const * role)
+  {
+    AddMember(ref, type, role, strlen(role));
+  }
+  void AddMember(uint64_t ref, EntityType type, char const * role, size_t roleSize);
+
+  void AddTag(string const & k, string const & v)
+  {
+    AddTag(k.data(), k.size(), v.data(), v.size());
+  }
+  void AddTag(char const * k, char const * v) { AddTag(k, strlen(k), v, strlen(v)); }
+  void AddTag(char const * k, size_t kSize, char const * v, size_t vSize);
+
+private:
+  /// Tags and members removed by Clear() are kept here with their strings, and new ones
+  /// reuse the strings' memory. So an element reused for many entities doesn't allocate
+  /// memory for them when the pool is warmed up. The pool isn't copied with the element.
+  template <class T>
+  class SparePool
+  {
+  public:
+    SparePool() = default;
+    SparePool(SparePool const &) {}
+    SparePool & operator=(SparePool const &) { return *this; }
+
+    void Take(vector<T> & items)
+    {
+      for (auto & item : items)
+        m_items.push_back(move(item));
+      items.clear();
+    }
+
+    /// Appends an item to items, reusing a spare one if any.
+    T & Give(vector<T> & items)
+    {
+      if (m_items.empty())
+      {
+        items.emplace_back();
+      }
+      else
+      {
+        items.push_back(move(m_items.back()));
+        m_items.pop_back();
+      }
+      return items.back();
+    }
+
+  private:
+    vector<T> m_items;
+  };
+
+  SparePool<Member> m_spareMembers;
+  SparePool<Tag> m_spareTags;
 };
 
 string DebugPrint(OsmElement const & e);
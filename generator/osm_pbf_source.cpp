@@ -0,0 +1,626 @@
+#include "generator/osm_pbf_source.hpp"
+
+#include "base/assert.hpp"
+#include "base/logging.hpp"
+#include "base/thread.hpp"
+
+#include "std/algorithm.hpp"
+#include "std/utility.hpp"
+
+#include <zlib.h>
+
+namespace
+{
+// Limits from the format specification.
+uint32_t constexpr kMaxBlobHeaderSize = 64 * 1024;
+uint32_t constexpr kMaxUncompressedBlobSize = 32 * 1024 * 1024;
+
+char const kHeaderBlockType[] = "OSMHeader";
+char const kDataBlockType[] = "OSMData";
+
+enum WireType
+{
+  VARINT = 0,
+  FIXED64 = 1,
+  LENGTH_DELIMITED = 2,
+  FIXED32 = 5
+};
+
+/// Minimal reader of protocol buffers wire format. The generated code isn't used because
+/// OSM PBF needs a few messages only and the generic parser is much slower on dense nodes.
+class ProtoReader
+{
+public:
+  ProtoReader(uint8_t const * data, size_t size) : m_pos(data), m_end(data + size) {}
+
+  /// Reads the key of the next field. \return false at the end of the message.
+  bool Next()
+  {
+    if (m_pos == m_end)
+      return false;
+    uint64_t const key = ReadVarint();
+    m_field = static_cast<uint32_t>(key >> 3);
+    m_wireType = static_cast<uint32_t>(key & 0x7);
+    return true;
+  }
+
+  uint32_t Field() const { return m_field; }
+
+  uint64_t ReadVarint()
+  {
+    uint64_t result = 0;
+    for (uint32_t shift = 0; shift < 64; shift += 7)
+    {
+      CHECK(m_pos != m_end, ("Unexpected end of PBF message."));
+      uint8_t const byte = *m_pos++;
+      result |= static_cast<uint64_t>(byte & 0x7F) << shift;
+      if ((byte & 0x80) == 0)
+        return result;
+    }
+    CHECK(false, ("Too long varint in PBF message."));
+    return result;
+  }
+
+  int64_t ReadSVarint() { return DecodeZigzag(ReadVarint()); }
+
+  ProtoReader ReadMessage()
+  {
+    CHECK_EQUAL(m_wireType, LENGTH_DELIMITED, (m_field));
+    size_t const size = ReadVarint();
+    CHECK_LESS_OR_EQUAL(size, static_cast<size_t>(m_end - m_pos), ("Broken PBF message."));
+    ProtoReader message(m_pos, size);
+    m_pos += size;
+    return message;
+  }
+
+  string ReadString()
+  {
+    ProtoReader const message = ReadMessage();
+    return string(message.m_pos, message.m_end);
+  }
+
+  pair<uint8_t const *, size_t> ReadBytes()
+  {
+    ProtoReader const message = ReadMessage();
+    return make_pair(message.m_pos, static_cast<size_t>(message.m_end - message.m_pos));
+  }
+
+  /// Calls toDo for every value of a repeated varint field, packed or not.
+  template <class ToDo>
+  void ForEachVarint(ToDo && toDo)
+  {
+    if (m_wireType == VARINT)
+    {
+      toDo(ReadVarint());
+      return;
+    }
+    ProtoReader packed = ReadMessage();
+    while (packed.m_pos != packed.m_end)
+      toDo(packed.ReadVarint());
+  }
+
+  void Skip()
+  {
+    switch (m_wireType)
+    {
+      case VARINT: ReadVarint(); break;
+      case FIXED64: Advance(8); break;
+      case LENGTH_DELIMITED: ReadMessage(); break;
+      case FIXED32: Advance(4); break;
+      default: CHECK(false, ("Unsupported PBF wire type", m_wireType));
+    }
+  }
+
+  static int64_t DecodeZigzag(uint64_t value)
+  {
+    return static_cast<int64_t>(value >> 1) ^ -static_cast<int64_t>(value & 1);
+  }
+
+private:
+  void Advance(size_t size)
+  {
+    CHECK_LESS_OR_EQUAL(size, static_cast<size_t>(m_end - m_pos), ("Broken PBF message."));
+    m_pos += size;
+  }
+
+  uint8_t const * m_pos;
+  uint8_t const * m_end;
+  uint32_t m_field = 0;
+  uint32_t m_wireType = 0;
+};
+
+/// Decodes PrimitiveBlock message.
+class PrimitiveBlockDecoder
+{
+public:
+  PrimitiveBlockDecoder(vector<OsmElement> & elements, size_t & elementsCount)
+    : m_elements(elements), m_elementsCount(elementsCount)
+  {
+  }
+
+  void Decode(uint8_t const * data, size_t size)
+  {
+    // Coordinates parameters may follow primitive groups, so groups are decoded after the block.
+    vector<ProtoReader> groups;
+    ProtoReader block(data, size);
+    while (block.Next())
+    {
+      switch (block.Field())
+      {
+        case 1:
+        {
+          ProtoReader table = block.ReadMessage();
+          while (table.Next())
+          {
+            if (table.Field() == 1)
+              m_strings.push_back(table.ReadString());
+            else
+              table.Skip();
+          }
+          break;
+        }
+        case 2: groups.push_back(block.ReadMessage()); break;
+        case 17: m_granularity = static_cast<int64_t>(block.ReadVarint()); break;
+        case 19: m_latOffset = static_cast<int64_t>(block.ReadVarint()); break;
+        case 20: m_lonOffset = static_cast<int64_t>(block.ReadVarint()); break;
+        default: block.Skip(); break;
+      }
+    }
+
+    for (ProtoReader & group : groups)
+    {
+      while (group.Next())
+      {
+        switch (group.Field())
+        {
+          case 1: DecodeNode(group.ReadMessage()); break;
+          case 2: DecodeDenseNodes(group.ReadMessage()); break;
+          case 3: DecodeWay(group.ReadMessage()); break;
+          case 4: DecodeRelation(group.ReadMessage()); break;
+          default: group.Skip(); break;
+        }
+      }
+    }
+  }
+
+private:
+  string const & GetString(uint64_t index) const
+  {
+    CHECK_LESS(index, m_strings.size(), ("Broken PBF string table index."));
+    return m_strings[index];
+  }
+
+  double ToDegrees(int64_t value, int64_t offset) const
+  {
+    return 1e-9 * (offset + m_granularity * value);
+  }
+
+  OsmElement & AddElement(OsmElement::EntityType type, int64_t id)
+  {
+    if (m_elementsCount == m_elements.size())
+      m_elements.emplace_back();
+    OsmElement & e = m_elements[m_elementsCount++];
+    e.Clear();
+    e.type = type;
+    e.id = static_cast<uint64_t>(id);
+    return e;
+  }
+
+  static void AddTags(vector<uint32_t> const & keys, vector<uint32_t> const & values,
+                      vector<string> const & strings, OsmElement & e)
+  {
+    CHECK_EQUAL(keys.size(), values.size(), ("Broken PBF tags."));
+    for (size_t i = 0; i < keys.size(); ++i)
+    {
+      CHECK(keys[i] < strings.size() && values[i] < strings.size(), ("Broken PBF tags."));
+      e.AddTag(strings[keys[i]], strings[values[i]]);
+    }
+  }
+
+  void ReadIndices(ProtoReader & message, vector<uint32_t> & indices)
+  {
+    message.ForEachVarint([&indices](uint64_t v) { indices.push_back(static_cast<uint32_t>(v)); });
+  }
+
+  void DecodeNode(ProtoReader message)
+  {
+    int64_t id = 0, lat = 0, lon = 0;
+    m_keys.clear();
+    m_values.clear();
+    while (message.Next())
+    {
+      switch (message.Field())
+      {
+        case 1: id = message.ReadSVarint(); break;
+        case 2: ReadIndices(message, m_keys); break;
+        case 3: ReadIndices(message, m_values); break;
+        case 8: lat = message.ReadSVarint(); break;
+        case 9: lon = message.ReadSVarint(); break;
+        default: message.Skip(); break;
+      }
+    }
+
+    OsmElement & e = AddElement(OsmElement::EntityType::Node, id);
+    e.lat = ToDegrees(lat, m_latOffset);
+    e.lon = ToDegrees(lon, m_lonOffset);
+    AddTags(m_keys, m_values, m_strings, e);
+  }
+
+  void DecodeDenseNodes(ProtoReader message)
+  {
+    vector<int64_t> ids, lats, lons;
+    vector<uint32_t> keysValues;
+    auto const readDeltas = [&message](vector<int64_t> & values)
+    {
+      int64_t value = 0;
+      message.ForEachVarint([&](uint64_t delta)
+      {
+        value += ProtoReader::DecodeZigzag(delta);
+        values.push_back(value);
+      });
+    };
+    while (message.Next())
+    {
+      switch (message.Field())
+      {
+        case 1: readDeltas(ids); break;
+        case 8: readDeltas(lats); break;
+        case 9: readDeltas(lons); break;
+        case 10: ReadIndices(message, keysValues); break;
+        default: message.Skip(); break;
+      }
+    }
+    CHECK(ids.size() == lats.size() && ids.size() == lons.size(), ("Broken PBF dense nodes."));
+
+    // keys_vals are pairs of string indices for every node, the node's tags end with zero.
+    size_t kv = 0;
+    for (size_t i = 0; i < ids.size(); ++i)
+    {
+      OsmElement & e = AddElement(OsmElement::EntityType::Node, ids[i]);
+      e.lat = ToDegrees(lats[i], m_latOffset);
+      e.lon = ToDegrees(lons[i], m_lonOffset);
+      while (kv < keysValues.size() && keysValues[kv] != 0)
+      {
+        CHECK_LESS(kv + 1, keysValues.size(), ("Broken PBF dense nodes tags."));
+        e.AddTag(GetString(keysValues[kv]), GetString(keysValues[kv + 1]));
+        kv += 2;
+      }
+      ++kv;
+    }
+  }
+
+  void DecodeWay(ProtoReader message)
+  {
+    int64_t id = 0;
+    m_keys.clear();
+    m_values.clear();
+    m_refs.clear();
+    while (message.Next())
+    {
+      switch (message.Field())
+      {
+        case 1: id = static_cast<int64_t>(message.ReadVarint()); break;
+        case 2: ReadIndices(message, m_keys); break;
+        case 3: ReadIndices(message, m_values); break;
+        case 8:
+        {
+          int64_t ref = 0;
+          message.ForEachVarint([this, &ref](uint64_t delta)
+          {
+            ref += ProtoReader::DecodeZigzag(delta);
+            m_refs.push_back(ref);
+          });
+          break;
+        }
+        default: message.Skip(); break;
+      }
+    }
+
+    OsmElement & e = AddElement(OsmElement::EntityType::Way, id);
+    for (int64_t ref : m_refs)
+      e.AddNd(static_cast<uint64_t>(ref));
+    AddTags(m_keys, m_values, m_strings, e);
+  }
+
+  void DecodeRelation(ProtoReader message)
+  {
+    int64_t id = 0;
+    m_keys.clear();
+    m_values.clear();
+    m_refs.clear();
+    vector<uint32_t> roles;
+    vector<OsmElement::EntityType> types;
+    while (message.Next())
+    {
+      switch (message.Field())
+      {
+        case 1: id = static_cast<int64_t>(message.ReadVarint()); break;
+        case 2: ReadIndices(message, m_keys); break;
+        case 3: ReadIndices(message, m_values); break;
+        case 8: ReadIndices(message, roles); break;
+        case 9:
+        {
+          int64_t ref = 0;
+          message.ForEachVarint([this, &ref](uint64_t delta)
+          {
+            ref += ProtoReader::DecodeZigzag(delta);
+            m_refs.push_back(ref);
+          });
+          break;
+        }
+        case 10:
+        {
+          message.ForEachVarint([&types](uint64_t type)
+          {
+            switch (type)
+            {
+              case 0: types.push_back(OsmElement::EntityType::Node); break;
+              case 1: types.push_back(OsmElement::EntityType::Way); break;
+              case 2: types.push_back(OsmElement::EntityType::Relation); break;
+              default: types.push_back(OsmElement::EntityType::Unknown); break;
+            }
+          });
+          break;
+        }
+        default: message.Skip(); break;
+      }
+    }
+    CHECK(roles.size() == m_refs.size() && types.size() == m_refs.size(),
+          ("Broken PBF relation members", id));
+
+    OsmElement & e = AddElement(OsmElement::EntityType::Relation, id);
+    for (size_t i = 0; i < m_refs.size(); ++i)
+      e.AddMember(static_cast<uint64_t>(m_refs[i]), types[i], GetString(roles[i]));
+    AddTags(m_keys, m_values, m_strings, e);
+  }
+
+  vector<OsmElement> & m_elements;
+  size_t & m_elementsCount;
+
+  vector<string> m_strings;
+  int64_t m_granularity = 100;
+  int64_t m_latOffset = 0;
+  int64_t m_lonOffset = 0;
+
+  // Buffers reused between elements.
+  vector<uint32_t> m_keys;
+  vector<uint32_t> m_values;
+  vector<int64_t> m_refs;
+};
+
+void CheckHeaderBlock(uint8_t const * data, size_t size)
+{
+  ProtoReader header(data, size);
+  while (header.Next())
+  {
+    if (header.Field() != 4)
+    {
+      header.Skip();
+      continue;
+    }
+    string const feature = header.ReadString();
+    CHECK(feature == "OsmSchema-V0.6" || feature == "DenseNodes",
+          ("Unsupported PBF required feature:", feature));
+  }
+}
+}  // namespace
+
+namespace osm
+{
+PBFSource::PBFSource(TReadFunc const & reader, size_t threadsCount)
+  : m_reader(reader), m_threadsCount(max(threadsCount, static_cast<size_t>(1)))
+{
+}
+
+void PBFSource::ReadExactly(uint8_t * buffer, size_t size)
+{
+  while (size != 0)
+  {
+    size_t const readBytes = m_reader(buffer, size);
+    CHECK_NOT_EQUAL(readBytes, 0, ("Unexpected end of PBF stream."));
+    buffer += readBytes;
+    size -= readBytes;
+  }
+}
+
+bool PBFSource::ReadBlock(Block & block)
+{
+  // Every file block is the size of BlobHeader in network byte order, BlobHeader and Blob.
+  uint8_t sizeBuffer[4];
+  size_t const readBytes = m_reader(sizeBuffer, sizeof(sizeBuffer));
+  if (readBytes == 0)
+    return false;
+  if (readBytes < sizeof(sizeBuffer))
+    ReadExactly(sizeBuffer + readBytes, sizeof(sizeBuffer) - readBytes);
+
+  uint32_t const headerSize = (static_cast<uint32_t>(sizeBuffer[0]) << 24) |
+                              (static_cast<uint32_t>(sizeBuffer[1]) << 16) |
+                              (static_cast<uint32_t>(sizeBuffer[2]) << 8) |
+                              static_cast<uint32_t>(sizeBuffer[3]);
+  CHECK_LESS_OR_EQUAL(headerSize, kMaxBlobHeaderSize, ("Broken PBF blob header."));
+
+  vector<uint8_t> header(headerSize);
+  ReadExactly(header.data(), header.size());
+
+  uint64_t blobSize = 0;
+  block.m_type.clear();
+  ProtoReader reader(header.data(), header.size());
+  while (reader.Next())
+  {
+    switch (reader.Field())
+    {
+      case 1: block.m_type = reader.ReadString(); break;
+      case 3: blobSize = reader.ReadVarint(); break;
+      default: reader.Skip(); break;
+    }
+  }
+  CHECK_LESS_OR_EQUAL(blobSize, kMaxUncompressedBlobSize, ("Too big PBF blob."));
+
+  block.m_blob.resize(blobSize);
+  ReadExactly(block.m_blob.data(), block.m_blob.size());
+  return true;
+}
+
+// static
+void PBFSource::DecodeBlock(Block & block, vector<uint8_t> & uncompressed)
+{
+  block.m_elementsCount = 0;
+  bool const isHeader = block.m_type == kHeaderBlockType;
+  if (!isHeader && block.m_type != kDataBlockType)
+  {
+    // Unknown blocks must be skipped.
+    LOG(LWARNING, ("Skipped PBF block of unknown type", block.m_type));
+    vector<uint8_t>().swap(block.m_blob);
+    return;
+  }
+
+  pair<uint8_t const *, size_t> raw(nullptr, 0);
+  pair<uint8_t const *, size_t> compressed(nullptr, 0);
+  uint64_t rawSize = 0;
+  ProtoReader blob(block.m_blob.data(), block.m_blob.size());
+  while (blob.Next())
+  {
+    switch (blob.Field())
+    {
+      case 1: raw = blob.ReadBytes(); break;
+      case 2: rawSize = blob.ReadVarint(); break;
+      case 3: compressed = blob.ReadBytes(); break;
+      case 4:
+      case 5: CHECK(false, ("Only zlib compression of PBF blobs is supported.")); break;
+      default: blob.Skip(); break;
+    }
+  }
+
+  if (compressed.first != nullptr)
+  {
+    CHECK_LESS_OR_EQUAL(rawSize, kMaxUncompressedBlobSize, ("Too big PBF blob."));
+    uncompressed.resize(rawSize);
+    uLongf size = static_cast<uLongf>(rawSize);
+    int const res = uncompress(uncompressed.data(), &size, compressed.first,
+                               static_cast<uLong>(compressed.second));
+    CHECK(res == Z_OK && size == rawSize, ("Can't uncompress PBF blob, zlib error:", res));
+    raw = make_pair(uncompressed.data(), uncompressed.size());
+  }
+
+  if (isHeader)
+    CheckHeaderBlock(raw.first, raw.second);
+  else
+    PrimitiveBlockDecoder(block.m_elements, block.m_elementsCount).Decode(raw.first, raw.second);
+
+  // Elements own their data, so the blob isn't needed while the block waits in the window.
+  vector<uint8_t>().swap(block.m_blob);
+}
+
+void PBFSource::DecodeBlocks()
+{
+  vector<uint8_t> uncompressed;
+  while (true)
+  {
+    Block * block = nullptr;
+    {
+      unique_lock<mutex> lock(m_mutex);
+      m_blockRead.wait(lock, [this]()
+      {
+        return m_finished || m_nextToDecode < m_firstBlock + m_window.size();
+      });
+      if (m_nextToDecode == m_firstBlock + m_window.size())
+        return;
+      block = m_window[m_nextToDecode - m_firstBlock].get();
+      ++m_nextToDecode;
+    }
+
+    DecodeBlock(*block, uncompressed);
+
+    {
+      lock_guard<mutex> lock(m_mutex);
+      block->m_decoded = true;
+    }
+    m_blockDecoded.notify_one();
+  }
+}
+
+void PBFSource::ForEachElement(TElementFn const & toDo)
+{
+  if (m_threadsCount == 1)
+  {
+    Block block;
+    vector<uint8_t> uncompressed;
+    while (ReadBlock(block))
+    {
+      DecodeBlock(block, uncompressed);
+      for (size_t i = 0; i < block.m_elementsCount; ++i)
+        toDo(block.m_elements[i]);
+    }
+    return;
+  }
+
+  m_window.clear();
+  m_spareBlocks.clear();
+  m_firstBlock = m_nextToDecode = 0;
+  m_finished = false;
+
+  vector<threads::SimpleThread> workers;
+  for (size_t i = 1; i < m_threadsCount; ++i)
+    workers.emplace_back([this]() { DecodeBlocks(); });
+
+  size_t const maxBlocks = kMaxBlocksPerThread * m_threadsCount;
+  bool eof = false;
+  while (true)
+  {
+    // Reads blocks while the window isn't full, decoders take them immediately.
+    while (!eof)
+    {
+      {
+        lock_guard<mutex> lock(m_mutex);
+        if (m_window.size() >= maxBlocks)
+          break;
+      }
+
+      unique_ptr<Block> block;
+      {
+        lock_guard<mutex> lock(m_mutex);
+        if (!m_spareBlocks.empty())
+        {
+          block = move(m_spareBlocks.back());
+          m_spareBlocks.pop_back();
+        }
+      }
+      if (!block)
+        block.reset(new Block());
+      block->m_decoded = false;
+      eof = !ReadBlock(*block);
+      {
+        lock_guard<mutex> lock(m_mutex);
+        if (eof)
+          m_finished = true;
+        else
+          m_window.push_back(move(block));
+      }
+      if (eof)
+        m_blockRead.notify_all();
+      else
+        m_blockRead.notify_one();
+    }
+
+    unique_ptr<Block> block;
+    {
+      unique_lock<mutex> lock(m_mutex);
+      if (m_window.empty())
+        break;
+      m_blockDecoded.wait(lock, [this]() { return m_window.front()->m_decoded; });
+      block = move(m_window.front());
+      m_window.pop_front();
+      ++m_firstBlock;
+    }
+
+    for (size_t i = 0; i < block->m_elementsCount; ++i)
+      toDo(block->m_elements[i]);
+
+    lock_guard<mutex> lock(m_mutex);
+    m_spareBlocks.push_back(move(block));
+  }
+
+  for (auto & worker : workers)
+    worker.join();
+}
+}  // namespace osm
@@ -0,0 +1,73 @@
+// See PBF Format definition at http://wiki.openstreetmap.org/wiki/PBF_Format
+#pragma once
+
+#include "generator/osm_element.hpp"
+
+#include "std/condition_variable.hpp"
+#include "std/cstdint.hpp"
+#include "std/deque.hpp"
+#include "std/function.hpp"
+#include "std/mutex.hpp"
+#include "std/string.hpp"
+#include "std/unique_ptr.hpp"
+#include "std/vector.hpp"
+
+namespace osm
+{
+/*!
+ * \brief Reads OSM PBF files.
+ * File blocks are read sequentially by the calling thread, decompressed and decoded
+ * by threadsCount - 1 worker threads and emitted in the file order by the calling thread,
+ * so the elements order is the same as in single threaded reading.
+ * At most kMaxBlocksPerThread blocks per thread are kept in memory at the same time.
+ */
+class PBFSource
+{
+public:
+  using TReadFunc = function<size_t(uint8_t *, size_t)>;
+  using TElementFn = function<void(OsmElement &)>;
+
+  static size_t constexpr kMaxBlocksPerThread = 4;
+
+  PBFSource(TReadFunc const & reader, size_t threadsCount);
+
+  /// Calls toDo for every node, way and relation of the file in the file order.
+  void ForEachElement(TElementFn const & toDo);
+
+private:
+  /// Blocks are reused with their elements, so the steady state of reading doesn't allocate
+  /// memory for them. The blob is released after decoding, so blocks of the window keep
+  /// decoded elements only.
+  struct Block
+  {
+    string m_type;
+    vector<uint8_t> m_blob;
+    // Only the first m_elementsCount elements belong to the block, the rest are spare.
+    vector<OsmElement> m_elements;
+    size_t m_elementsCount = 0;
+    bool m_decoded = false;
+  };
+
+  /// \return false at the end of the file.
+  bool ReadBlock(Block & block);
+  void ReadExactly(uint8_t * buffer, size_t size);
+  /// @param uncompressed  Buffer of the decoding thread for the inflated blob.
+  static void DecodeBlock(Block & block, vector<uint8_t> & uncompressed);
+
+  void DecodeBlocks();
+
+  TReadFunc m_reader;
+  size_t const m_threadsCount;
+
+  // Window of blocks between the last emitted and the last read ones.
+  mutex m_mutex;
+  condition_variable m_blockRead;
+  condition_variable m_blockDecoded;
+  deque<unique_ptr<Block>> m_window;
+  vector<unique_ptr<Block>> m_spareBlocks;
+  // Number of the first block of the window and of the next block to decode.
+  size_t m_firstBlock = 0;
+  size_t m_nextToDecode = 0;
+  bool m_finished = false;
+};
+}  // namespace osm
@@ -4,18 +4,23 @@
 #include "generator/intermediate_elements.hpp"
 #include "generator/osm_translator.hpp"
 #include "generator/osm_o5m_source.hpp"
+#include "generator/osm_pbf_source.hpp"
 #include "generator/osm_xml_source.hpp"
 #include "generator/osm_source.hpp"
 #include "generator/polygonizer.hpp"
+#include "generator/translator_pipeline.hpp"
 #include "generator/world_map_generator.hpp"
 #include "generator/osm_element.hpp"
 
 #include "indexer/classificator.hpp"
 #include "indexer/mercator.hpp"
 
+#include "coding/internal/file_data.hpp"
 #include "coding/parse_xml.hpp"
 
 #include "std/fstream.hpp"
+#include "std/shared_ptr.hpp"
+#include "std/thread.hpp"
 
 #include "defines.hpp"
 
@@ -47,17 +52,17 @@ uint64_t SourceReader::Read(char * buffer, uint64_t bufferSize)
 
 namespace
 {
+/// Holder of nodes, ways and relations. In the Read mode it isn't changed after LoadIndex()
+/// and reading is thread safe, so it is shared by parallel translators.
 template <class TNodesHolder, cache::EMode TMode>
 class IntermediateData
 {
   using TReader = cache::OSMElementCache<TMode>;
 
-  using TFile = typename conditional<TMode == cache::EMode::Write, FileWriter, FileReader>::type;
-
   using TKey = uint64_t;
   static_assert(is_integral<TKey>::value, "TKey is not integral type");
 
-  using TIndex = cache::detail::IndexFile<TFile, TKey>;
+  using TIndex = cache::detail::IndexFile<TMode, TKey>;
 
   TNodesHolder & m_nodes;
 
@@ -71,11 +76,11 @@ class IntermediateData
   struct ElementProcessorBase
   {
   protected:
-    TReader & m_reader;
+    TReader const & m_reader;
     ToDo & m_toDo;
 
   public:
-    ElementProcessorBase(TReader & reader, ToDo & toDo) : m_reader(reader), m_toDo(toDo) {}
+    ElementProcessorBase(TReader const & reader, ToDo & toDo) : m_reader(reader), m_toDo(toDo) {}
 
     bool operator()(uint64_t id)
     {
@@ -89,7 +94,7 @@ class IntermediateData
   {
     using TBase = ElementProcessorBase<RelationElement, ToDo>;
 
-    RelationProcessor(TReader & reader, ToDo & toDo) : TBase(reader, toDo) {}
+    RelationProcessor(TReader const & reader, ToDo & toDo) : TBase(reader, toDo) {}
   };
 
   template <class ToDo>
@@ -97,7 +102,7 @@ class IntermediateData
   {
     using TBase = RelationProcessor<ToDo>;
 
-    CachedRelationProcessor(TReader & rels, ToDo & toDo) : TBase(rels, toDo) {}
+    CachedRelationProcessor(TReader const & rels, ToDo & toDo) : TBase(rels, toDo) {}
     bool operator()(uint64_t id) { return this->m_toDo(id, this->m_reader); }
   };
 
@@ -109,20 +114,63 @@ class IntermediateData
   }
 
 public:
+  /// Relations are read for the most of elements, so they are preloaded first and
+  /// ways get the rest of the budget.
+  static uint64_t GetWaysPreloadSize(feature::GenerateInfo const & info)
+  {
+    uint64_t relationsSize = 0;
+    my::GetFileSize(info.GetIntermediateFileName(RELATIONS_FILE, ""), relationsSize);
+    return info.m_preloadCacheSize - min(info.m_preloadCacheSize, relationsSize);
+  }
+
   IntermediateData(TNodesHolder & nodes, feature::GenerateInfo & info)
   : m_nodes(nodes)
-  , m_ways(info.GetIntermediateFileName(WAYS_FILE, ""), info.m_preloadCache)
-  , m_relations(info.GetIntermediateFileName(RELATIONS_FILE, ""), info.m_preloadCache)
+  , m_ways(info.GetIntermediateFileName(WAYS_FILE, ""), GetWaysPreloadSize(info))
+  , m_relations(info.GetIntermediateFileName(RELATIONS_FILE, ""), info.m_preloadCacheSize)
   , m_nodeToRelations(info.GetIntermediateFileName(NODES_FILE, ID2REL_EXT))
   , m_wayToRelations(info.GetIntermediateFileName(WAYS_FILE,ID2REL_EXT))
   {
   }
 
   void AddNode(TKey id, double lat, double lng) { m_nodes.AddPoint(id, lat, lng); }
-  bool GetNode(TKey id, double & lat, double & lng) { return m_nodes.GetPoint(id, lat, lng); }
+  /// Points of nodes in the order of ids, blocks of the sparse storage are read once for all ids.
+  /// @return count of found nodes.
+  size_t GetNodes(vector<TKey> const & ids, vector<m2::PointD> & points, vector<bool> & found) const
+  {
+    vector<TKey> sortedIds(ids);
+    sort(sortedIds.begin(), sortedIds.end());
+    sortedIds.erase(unique(sortedIds.begin(), sortedIds.end()), sortedIds.end());
+
+    vector<m2::PointD> sortedPoints(sortedIds.size());
+    vector<bool> sortedFound(sortedIds.size(), false);
+    cache::ForEachPoint(m_nodes, sortedIds, [&](size_t i, double lat, double lng)
+    {
+      sortedPoints[i] = m2::PointD(lng, lat);
+      sortedFound[i] = true;
+    });
+
+    points.resize(ids.size());
+    found.assign(ids.size(), false);
+    size_t count = 0;
+    for (size_t i = 0; i < ids.size(); ++i)
+    {
+      size_t const j = lower_bound(sortedIds.begin(), sortedIds.end(), ids[i]) - sortedIds.begin();
+      if (!sortedFound[j])
+        continue;
+      points[i] = sortedPoints[j];
+      found[i] = true;
+      ++count;
+    }
+    return count;
+  }
 
   void AddWay(TKey id, WayElement const & e) { m_ways.Write(id, e); }
-  bool GetWay(TKey id, WayElement & e) { return m_ways.Read(id, e); }
+  bool GetWay(TKey id, WayElement & e) const { return m_ways.Read(id, e); }
+  /// Reads ways in the order of the file, see OSMElementCache::ReadBatch().
+  size_t GetWays(vector<TKey> const & ids, vector<WayElement> & ways, vector<bool> & found) const
+  {
+    return m_ways.ReadBatch(ids, ways, found);
+  }
 
   void AddRelation(TKey id, RelationElement const & e)
   {
@@ -136,21 +184,21 @@ public:
   }
 
   template <class ToDo>
-  void ForEachRelationByWay(TKey id, ToDo && toDo)
+  void ForEachRelationByWay(TKey id, ToDo && toDo) const
   {
     RelationProcessor<ToDo> processor(m_relations, toDo);
     m_wayToRelations.ForEachByKey(id, processor);
   }
 
   template <class ToDo>
-  void ForEachRelationByNodeCached(TKey id, ToDo && toDo)
+  void ForEachRelationByNodeCached(TKey id, ToDo && toDo) const
   {
     CachedRelationProcessor<ToDo> processor(m_relations, toDo);
     m_nodeToRelations.ForEachByKey(id, processor);
   }
 
   template <class ToDo>
-  void ForEachRelationByWayCached(TKey id, ToDo && toDo)
+  void ForEachRelationByWayCached(TKey id, ToDo && toDo) const
   {
     CachedRelationProcessor<ToDo> processor(m_relations, toDo);
     m_wayToRelations.ForEachByKey(id, processor);
@@ -296,17 +344,14 @@ public:
       size_t totalPoints = 0;
       size_t totalPolygons = 0;
 
-      vector<FeatureBuilder1> vecFb;
-      m_coasts->GetFeatures(vecFb);
-
-      for (auto & fb : vecFb)
+      m_coasts->EmitFeatures([&](FeatureBuilder1 const & fb)
       {
         (*m_coastsHolder)(fb);
 
         ++totalFeatures;
         totalPoints += fb.GetPointsCount();
         totalPolygons += fb.GetPolygonsCount();
-      }
+      });
       LOG(LINFO, ("Total features:", totalFeatures, "total polygons:", totalPolygons,
                   "total points:", totalPoints));
     }
@@ -320,6 +365,9 @@ public:
           (*m_countries)(fb);
       });
     }
+
+    if (m_countries)
+      m_countries->Finish();
     return true;
   }
 
@@ -331,6 +379,74 @@ public:
       names.clear();
   }
 };
+
+/// Passes only elements which may have features in the changed countries, so the features pass
+/// for an OsmChange file doesn't translate elements of the other countries. Ways are checked by
+/// the rect of their nodes, relations are rare and always passed.
+template <class TDataCache>
+class ChangedCountriesFilter
+{
+  TDataCache const & m_cache;
+  vector<m2::RectD> m_rects;
+  size_t m_skipped = 0;
+
+  bool IsChanged(m2::RectD const & rect) const
+  {
+    for (auto const & r : m_rects)
+    {
+      if (r.IsIntersect(rect))
+        return true;
+    }
+    return false;
+  }
+
+public:
+  ChangedCountriesFilter(TDataCache const & cache, feature::GenerateInfo const & info)
+  : m_cache(cache)
+  {
+    borders::CountriesContainerT countries;
+    CHECK(borders::LoadCountriesList(info.m_targetDir, countries),
+          ("Error loading country polygons files"));
+    auto const & names = info.m_changedCountries;
+    countries.ForEachWithRect([&](m2::RectD const & rect, borders::CountryPolygons const & country)
+    {
+      if (find(names.begin(), names.end(), country.m_name) != names.end())
+        m_rects.push_back(rect);
+    });
+  }
+
+  bool operator()(OsmElement const & e)
+  {
+    m2::RectD rect;
+    switch (e.type)
+    {
+      case OsmElement::EntityType::Node:
+        rect.Add(MercatorBounds::FromLatLon(e.lat, e.lon));
+        break;
+      case OsmElement::EntityType::Way:
+      {
+        vector<m2::PointD> points;
+        vector<bool> found;
+        m_cache.GetNodes(e.Nodes(), points, found);
+        for (size_t i = 0; i < points.size(); ++i)
+        {
+          if (found[i])
+            rect.Add(points[i]);
+        }
+        break;
+      }
+      default:
+        return true;
+    }
+
+    if (rect.IsValid() && IsChanged(rect))
+      return true;
+    ++m_skipped;
+    return false;
+  }
+
+  size_t GetSkippedCount() const { return m_skipped; }
+};
 }  // anonymous namespace
 
 
@@ -429,9 +545,11 @@ void BuildFeaturesFromO5M(SourceReader & stream, function<void(OsmElement *)> pr
     }
   };
 
+  // The element is reused to avoid memory allocations for every entity.
+  OsmElement p;
   for (auto const & em : dataset)
   {
-    OsmElement p;
+    p.Clear();
     p.id = em.id;
 
     switch (em.type)
@@ -467,6 +585,41 @@ void BuildFeaturesFromO5M(SourceReader & stream, function<void(OsmElement *)> pr
   }
 }
 
+namespace
+{
+size_t GetPbfDecodingThreadsCount()
+{
+  return max(thread::hardware_concurrency(), 1u);
+}
+}  // namespace
+
+template <typename TCache>
+void BuildIntermediateDataFromPBF(SourceReader & stream, TCache & cache)
+{
+  osm::PBFSource source([&stream](uint8_t * buffer, size_t size)
+  {
+    return stream.Read(reinterpret_cast<char *>(buffer), size);
+  }, GetPbfDecodingThreadsCount());
+
+  source.ForEachElement([&cache](OsmElement & e) { AddElementToCache(cache, e); });
+}
+
+void BuildFeaturesFromPBF(SourceReader & stream, function<void(OsmElement *)> processor)
+{
+  BuildFeaturesFromPBF(stream, processor, GetPbfDecodingThreadsCount());
+}
+
+void BuildFeaturesFromPBF(SourceReader & stream, function<void(OsmElement *)> processor,
+                          size_t threadsCount)
+{
+  osm::PBFSource source([&stream](uint8_t * buffer, size_t size)
+  {
+    return stream.Read(reinterpret_cast<char *>(buffer), size);
+  }, threadsCount);
+
+  source.ForEachElement([&processor](OsmElement & e) { processor(&e); });
+}
+
 ///////////////////////////////////////////////////////////////////////////////////////////////////
 // Generate functions implementations.
 ///////////////////////////////////////////////////////////////////////////////////////////////////
@@ -483,26 +636,69 @@ bool GenerateFeaturesImpl(feature::GenerateInfo & info)
     cache.LoadIndex();
 
     MainFeaturesEmitter bucketer(info);
-    OsmToFeatureTranslator<MainFeaturesEmitter, TDataCache> parser(
-        bucketer, cache, info.m_makeCoasts ? classif().GetCoastType() : 0,
-        info.GetAddressesFileName());
+    PlacesAndAddressesEmitter<MainFeaturesEmitter> emitter(bucketer, info.GetAddressesFileName());
+    uint32_t const coastType = info.m_makeCoasts ? classif().GetCoastType() : 0;
 
-    auto fn = [&parser](OsmElement * e) { parser.EmitElement(e); };
+    // The world needs features of all countries.
+    unique_ptr<ChangedCountriesFilter<TDataCache>> filter;
+    if (!info.m_changedCountries.empty() && !info.m_createWorld && !info.m_makeCoasts)
+      filter.reset(new ChangedCountriesFilter<TDataCache>(cache, info));
 
     SourceReader reader = info.m_osmFileName.empty() ? SourceReader() : SourceReader(info.m_osmFileName);
-    switch (info.m_osmFileType)
+    auto const readFn = [&info, &reader, &filter](TranslatorPipeline::TElementFn const & fn)
     {
-      case feature::GenerateInfo::OsmSourceType::XML:
-        BuildFeaturesFromXML(reader, fn);
-        break;
-      case feature::GenerateInfo::OsmSourceType::O5M:
-        BuildFeaturesFromO5M(reader, fn);
-        break;
+      TranslatorPipeline::TElementFn filteredFn = fn;
+      if (filter)
+      {
+        filteredFn = [&filter, &fn](OsmElement * e)
+        {
+          if ((*filter)(*e))
+            fn(e);
+        };
+      }
+
+      switch (info.m_osmFileType)
+      {
+        case feature::GenerateInfo::OsmSourceType::XML:
+          BuildFeaturesFromXML(reader, filteredFn);
+          break;
+        case feature::GenerateInfo::OsmSourceType::O5M:
+          BuildFeaturesFromO5M(reader, filteredFn);
+          break;
+        case feature::GenerateInfo::OsmSourceType::PBF:
+          BuildFeaturesFromPBF(reader, filteredFn);
+          break;
+      }
+    };
+
+    if (info.m_translatorThreadsCount <= 1)
+    {
+      OsmToFeatureTranslator<PlacesAndAddressesEmitter<MainFeaturesEmitter>, TDataCache const>
+          translator(emitter, cache, coastType);
+      readFn([&translator](OsmElement * e) { translator.EmitElement(e); });
+    }
+    else
+    {
+      // Every translator thread has its own translator, the cache is shared.
+      using TTranslator = OsmToFeatureTranslator<TranslatorPipeline::TFeatureFn const, TDataCache const>;
+      auto const factory = [&cache, coastType](TranslatorPipeline::TFeatureFn const & emitFn)
+      {
+        shared_ptr<TTranslator> translator = make_shared<TTranslator>(emitFn, cache, coastType);
+        return TranslatorPipeline::TElementFn([translator](OsmElement * e)
+        {
+          translator->EmitElement(e);
+        });
+      };
+
+      TranslatorPipeline pipeline(factory, info.m_translatorThreadsCount);
+      pipeline.Run(readFn, [&emitter](FeatureBuilder1 & ft) { emitter(ft); });
     }
 
     LOG(LINFO, ("Processing", info.m_osmFileName, "done."));
+    if (filter)
+      LOG(LINFO, ("Elements outside of changed countries:", filter->GetSkippedCount()));
 
-    parser.Finish();
+    emitter.Finish();
 
     // Stop if coasts are not merged and FLAG_fail_on_coasts is set
     if (!bucketer.Finish())
@@ -539,6 +735,9 @@ bool GenerateIntermediateDataImpl(feature::GenerateInfo & info)
       case feature::GenerateInfo::OsmSourceType::O5M:
         BuildIntermediateDataFromO5M(reader, cache);
         break;
+      case feature::GenerateInfo::OsmSourceType::PBF:
+        BuildIntermediateDataFromPBF(reader, cache);
+        break;
     }
 
     cache.SaveIndex();
@@ -561,6 +760,8 @@ bool GenerateFeatures(feature::GenerateInfo & info)
       return GenerateFeaturesImpl<cache::MapFilePointStorage<cache::EMode::Read>>(info);
     case feature::GenerateInfo::NodeStorageType::Memory:
       return GenerateFeaturesImpl<cache::RawMemPointStorage<cache::EMode::Read>>(info);
+    case feature::GenerateInfo::NodeStorageType::Sparse:
+      return GenerateFeaturesImpl<cache::SparsePointStorage<cache::EMode::Read>>(info);
   }
   return false;
 }
@@ -575,6 +776,8 @@ bool GenerateIntermediateData(feature::GenerateInfo & info)
       return GenerateIntermediateDataImpl<cache::MapFilePointStorage<cache::EMode::Write>>(info);
     case feature::GenerateInfo::NodeStorageType::Memory:
       return GenerateIntermediateDataImpl<cache::RawMemPointStorage<cache::EMode::Write>>(info);
+    case feature::GenerateInfo::NodeStorageType::Sparse:
+      return GenerateIntermediateDataImpl<cache::SparsePointStorage<cache::EMode::Write>>(info);
   }
   return false;
 }
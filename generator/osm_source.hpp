@@ -37,4 +37,9 @@ bool GenerateIntermediateData(feature::GenerateInfo & info);
 
 void BuildFeaturesFromO5M(SourceReader & stream, function<void(OsmElement *)> processor);
 void BuildFeaturesFromXML(SourceReader & stream, function<void(OsmElement *)> processor);
+/// PBF blocks are decoded in threadsCount threads, processor is called in the calling thread
+/// in the file order. The overload without threadsCount uses all hardware threads.
+void BuildFeaturesFromPBF(SourceReader & stream, function<void(OsmElement *)> processor);
+void BuildFeaturesFromPBF(SourceReader & stream, function<void(OsmElement *)> processor,
+                          size_t threadsCount);
 
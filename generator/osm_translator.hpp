@@ -209,7 +209,60 @@ protected:
 
 }  // namespace
 
+/// Final stage of features translation: writes addresses of buildings, merges equal places
+/// and passes other features to the emitter. The result depends on the order of features,
+/// so they should come in the order of OSM elements.
 /// @param  TEmitter  Feature accumulating policy
+template <class TEmitter>
+class PlacesAndAddressesEmitter
+{
+  TEmitter & m_emitter;
+  unique_ptr<FileWriter> m_addrWriter;
+  m4::Tree<Place> m_places;
+
+public:
+  PlacesAndAddressesEmitter(TEmitter & emitter, string const & addrFilePath) : m_emitter(emitter)
+  {
+    if (!addrFilePath.empty())
+      m_addrWriter.reset(new FileWriter(addrFilePath));
+  }
+
+  /// @param  ft  Feature after FeatureBuilder1::PreSerialize().
+  void operator() (FeatureBuilder1 const & ft)
+  {
+    FeatureParams const & params = ft.GetParams();
+
+    string addr;
+    if (m_addrWriter && ftypes::IsBuildingChecker::Instance()(params.m_Types) && ft.FormatFullAddress(addr))
+      m_addrWriter->Write(addr.c_str(), addr.size());
+
+    static uint32_t const placeType = classif().GetTypeByPath({"place"});
+    uint32_t const type = params.FindType(placeType, 1);
+
+    if (type != ftype::GetEmptyValue() && !ft.GetName().empty())
+    {
+      m_places.ReplaceEqualInRect(Place(ft, type),
+          [](Place const & p1, Place const & p2) { return p1.IsEqual(p2); },
+          [](Place const & p1, Place const & p2) { return p1.IsBetterThan(p2); });
+    }
+    else
+      m_emitter(ft);
+  }
+
+  void Finish()
+  {
+    m_places.ForEach([this] (Place const & p)
+    {
+      m_emitter(p.GetFeature());
+    });
+  }
+};
+
+/// Translates OSM elements to features. Translators don't change the holder and don't share
+/// any other data, so several translators with the same holder can work in parallel
+/// if reading of the holder is thread safe.
+/// @param  TEmitter  Gets translated features after FeatureBuilder1::PreSerialize(),
+///                   e.g. PlacesAndAddressesEmitter.
 /// @param  TCache   Nodes, ways, relations holder
 template <class TEmitter, class TCache>
 class OsmToFeatureTranslator
@@ -217,24 +270,25 @@ class OsmToFeatureTranslator
   TEmitter & m_emitter;
   TCache & m_holder;
   uint32_t m_coastType;
-  unique_ptr<FileWriter> m_addrWriter;
-  m4::Tree<Place> m_places;
   RelationTagsNode m_nodeRelations;
   RelationTagsWay m_wayRelations;
 
   class HolesAccumulator
   {
     AreaWayMerger<TCache> m_merger;
+    vector<uint64_t> m_ids;
     FeatureBuilder1::TGeometry m_holes;
 
   public:
     HolesAccumulator(OsmToFeatureTranslator * pMain) : m_merger(pMain->m_holder) {}
 
-    void operator() (uint64_t id) { m_merger.AddWay(id); }
+    /// Ways are read by one batch in GetHoles().
+    void operator() (uint64_t id) { m_ids.push_back(id); }
 
     FeatureBuilder1::TGeometry & GetHoles()
     {
       ASSERT(m_holes.empty(), ("Can call only once"));
+      m_merger.AddWays(m_ids);
       m_merger.ForEachArea(false, [this](FeatureBuilder1::TPointSeq & v, vector<uint64_t> const &)
       {
         m_holes.push_back(FeatureBuilder1::TPointSeq());
@@ -301,23 +355,7 @@ class OsmToFeatureTranslator
   {
     ft.SetParams(params);
     if (ft.PreSerialize())
-    {
-      string addr;
-      if (m_addrWriter && ftypes::IsBuildingChecker::Instance()(params.m_Types) && ft.FormatFullAddress(addr))
-        m_addrWriter->Write(addr.c_str(), addr.size());
-
-      static uint32_t const placeType = classif().GetTypeByPath({"place"});
-      uint32_t const type = params.FindType(placeType, 1);
-
-      if (type != ftype::GetEmptyValue() && !ft.GetName().empty())
-      {
-        m_places.ReplaceEqualInRect(Place(ft, type),
-            [](Place const & p1, Place const & p2) { return p1.IsEqual(p2); },
-            [](Place const & p1, Place const & p2) { return p1.IsBetterThan(p2); });
-      }
-      else
-        m_emitter(ft);
-    }
+      m_emitter(ft);
   }
 
   /// @param[in]  params  Pass by value because it can be modified.
@@ -407,19 +445,15 @@ public:
         FeatureBuilder1 ft;
 
         // Parse geometry.
-        for (uint64_t ref : p->Nodes())
+        vector<m2::PointD> points;
+        vector<bool> found;
+        if (m_holder.GetNodes(p->Nodes(), points, found) != points.size())
         {
-          m2::PointD pt;
-          if (!m_holder.GetNode(ref, pt.y, pt.x))
-          {
-            state = FeatureState::BrokenRef;
-            break;
-          }
-          ft.AddPoint(pt);
-        }
-
-        if (state == FeatureState::BrokenRef)
+          state = FeatureState::BrokenRef;
           break;
+        }
+        for (m2::PointD const & pt : points)
+          ft.AddPoint(pt);
 
         if (ft.GetPointsCount() < 2)
         {
@@ -477,16 +511,18 @@ public:
         AreaWayMerger<TCache> outer(m_holder);
 
         // 3. Iterate ways to get 'outer' and 'inner' geometries
+        vector<uint64_t> outerIds;
         for (auto const & e : p->Members())
         {
           if (e.type != OsmElement::EntityType::Way)
             continue;
 
           if (e.role == "outer")
-            outer.AddWay(e.ref);
+            outerIds.push_back(e.ref);
           else if (e.role == "inner")
             holes(e.ref);
         }
+        outer.AddWays(outerIds);
 
         auto const & holesGeometry = holes.GetHoles();
         outer.ForEachArea(true, [&] (FeatureBuilder1::TPointSeq const & pts, vector<uint64_t> const & ids)
@@ -527,19 +563,8 @@ public:
   }
 
 public:
-  OsmToFeatureTranslator(TEmitter & emitter, TCache & holder,
-                   uint32_t coastType, string const & addrFilePath)
+  OsmToFeatureTranslator(TEmitter & emitter, TCache & holder, uint32_t coastType)
     : m_emitter(emitter), m_holder(holder), m_coastType(coastType)
   {
-    if (!addrFilePath.empty())
-      m_addrWriter.reset(new FileWriter(addrFilePath));
-  }
-
-  void Finish()
-  {
-    m_places.ForEach([this] (Place const & p)
-    {
-      m_emitter(p.GetFeature());
-    });
   }
 };
@@ -13,55 +13,116 @@
 
 #include "base/base.hpp"
 #include "base/buffer_vector.hpp"
+#include "base/logging.hpp"
 #include "base/macros.hpp"
+#include "base/thread.hpp"
+#include "base/timer.hpp"
 
+#include "std/algorithm.hpp"
+#include "std/condition_variable.hpp"
+#include "std/deque.hpp"
+#include "std/mutex.hpp"
 #include "std/string.hpp"
+#include "std/thread.hpp"
+#include "std/unique_ptr.hpp"
+#include "std/unordered_map.hpp"
+#include "std/vector.hpp"
 
 
 #ifndef PARALLEL_POLYGONIZER
 #define PARALLEL_POLYGONIZER 1
 #endif
 
-#if PARALLEL_POLYGONIZER
-#include <QtCore/QSemaphore>
-#include <QtCore/QThreadPool>
-#include <QtCore/QMutex>
-#include <QtCore/QMutexLocker>
-#endif
-
 
 namespace feature
 {
-  // Groups features according to country polygons
+  /// Groups features according to country polygons.
+  /// Features are packed to batches of kBatchSize, worker threads split batches by countries.
+  /// Every worker has its own queue of batches and steals batches from the tails of other
+  /// queues when its queue is empty. Features of a batch are grouped to per-country buffers
+  /// by the worker, and the calling thread writes buffers of batches in the order of batches,
+  /// so country files are the same as with a single thread.
   template <class FeatureOutT>
   class Polygonizer
   {
+  public:
+    static size_t constexpr kBatchSize = 256;
+    static size_t constexpr kMaxBatchesPerThread = 8;
+
+  private:
+    using TCountriesVector = buffer_vector<borders::CountryPolygons const *, 32>;
+
+    struct CountryBuffer
+    {
+      borders::CountryPolygons const * m_country;
+      // Indexes of batch features which belong to the country.
+      vector<uint32_t> m_features;
+    };
+
+    struct Batch
+    {
+      // Only the first m_count features belong to the batch, the rest are spare.
+      vector<FeatureBuilder1> m_features;
+      size_t m_count = 0;
+      // Buffers in the order of the first features of countries.
+      vector<CountryBuffer> m_buffers;
+      size_t m_buffersCount = 0;
+      bool m_done = false;
+    };
+
+    struct WorkerQueue
+    {
+      mutex m_mutex;
+      deque<Batch *> m_batches;
+    };
+
     feature::GenerateInfo const & m_info;
 
     vector<FeatureOutT*> m_Buckets;
     vector<string> m_Names;
     borders::CountriesContainerT m_countries;
 
-#if PARALLEL_POLYGONIZER
-    QThreadPool m_ThreadPool;
-    QSemaphore m_ThreadPoolSemaphore;
-    QMutex m_EmitFeatureMutex;
-#endif
+    vector<unique_ptr<WorkerQueue>> m_queues;
+    vector<threads::SimpleThread> m_threads;
+
+    // Batches between the last written and the current ones, guarded by m_mutex.
+    mutex m_mutex;
+    condition_variable m_batchQueued;
+    condition_variable m_batchDone;
+    deque<unique_ptr<Batch>> m_window;
+    vector<unique_ptr<Batch>> m_spareBatches;
+    // Count of queued batches which are not reserved by workers yet.
+    size_t m_queuedCount = 0;
+    bool m_finished = false;
+
+    unique_ptr<Batch> m_batch;
+    size_t m_nextQueue = 0;
+
+    my::Timer m_timer;
+    uint64_t m_featuresCount = 0;
+    uint64_t m_emittedCount = 0;
 
   public:
-    explicit Polygonizer(feature::GenerateInfo const & info) : m_info(info)
-#if PARALLEL_POLYGONIZER
-    , m_ThreadPoolSemaphore(m_ThreadPool.maxThreadCount() * 8)
-#endif
+    static size_t GetDefaultThreadsCount()
     {
 #if PARALLEL_POLYGONIZER
-      LOG(LINFO, ("Polygonizer thread pool threads:", m_ThreadPool.maxThreadCount()));
+      return thread::hardware_concurrency();
+#else
+      return 0;
 #endif
+    }
 
+    /// @param threadsCount  Count of worker threads, 0 means splitting in the calling thread.
+    explicit Polygonizer(feature::GenerateInfo const & info,
+                         size_t threadsCount = GetDefaultThreadsCount())
+      : m_info(info)
+    {
       if (info.m_splitByPolygons)
       {
         CHECK(borders::LoadCountriesList(info.m_targetDir, m_countries),
             ("Error loading country polygons files"));
+        if (!info.m_changedCountries.empty())
+          LeaveChangedCountries(info.m_changedCountries);
       }
       else
       {
@@ -69,7 +130,26 @@ namespace feature
         // create only one output file which contains all features
         m_countries.Add(borders::CountryPolygons(info.m_fileName), MercatorBounds::FullRect());
       }
+
+      LOG(LINFO, ("Polygonizer threads:", threadsCount));
+
+      for (size_t i = 0; i < threadsCount; ++i)
+        m_queues.emplace_back(new WorkerQueue());
+      for (size_t i = 0; i < threadsCount; ++i)
+        m_threads.emplace_back([this, i]() { ProcessBatches(i); });
     }
+    void LeaveChangedCountries(vector<string> const & names)
+    {
+      borders::CountriesContainerT countries;
+      m_countries.ForEachWithRect([&](m2::RectD const & rect, borders::CountryPolygons const & country)
+      {
+        if (find(names.begin(), names.end(), country.m_name) != names.end())
+          countries.Add(country, rect);
+      });
+      m_countries = move(countries);
+      LOG(LINFO, ("Features are split to", m_countries.GetSize(), "changed countries"));
+    }
+
     ~Polygonizer()
     {
       Finish();
@@ -99,7 +179,7 @@ namespace feature
 
     class InsertCountriesPtr
     {
-      typedef buffer_vector<borders::CountryPolygons const *, 32> vec_type;
+      typedef TCountriesVector vec_type;
       vec_type & m_vec;
 
     public:
@@ -112,42 +192,46 @@ namespace feature
 
     void operator () (FeatureBuilder1 const & fb)
     {
-      buffer_vector<borders::CountryPolygons const *, 32> vec;
-      m_countries.ForEachInRect(fb.GetLimitRect(), InsertCountriesPtr(vec));
+      if (!m_batch)
+        m_batch = GetSpareBatch();
 
-      switch (vec.size())
-      {
-      case 0:
-        break;
-      case 1:
-        EmitFeature(vec[0], fb);
-        break;
-      default:
-        {
-#if PARALLEL_POLYGONIZER
-          m_ThreadPoolSemaphore.acquire();
-          m_ThreadPool.start(new PolygonizerTask(this, vec, fb));
-#else
-          PolygonizerTask task(this, vec, fb);
-          task.RunBase();
-#endif
-        }
-      }
+      if (m_batch->m_count == m_batch->m_features.size())
+        m_batch->m_features.push_back(fb);
+      else
+        m_batch->m_features[m_batch->m_count] = fb;
+      ++m_batch->m_count;
+      ++m_featuresCount;
+
+      if (m_batch->m_count == kBatchSize)
+        PushBatch(move(m_batch));
     }
 
+    /// Writes all features and stops worker threads.
     void Finish()
     {
-#if PARALLEL_POLYGONIZER
-      m_ThreadPool.waitForDone();
-#endif
+      if (m_batch)
+        PushBatch(move(m_batch));
+      while (!m_window.empty())
+        WriteFirstBatch();
+
+      {
+        lock_guard<mutex> lock(m_mutex);
+        if (m_finished)
+          return;
+        m_finished = true;
+      }
+      m_batchQueued.notify_all();
+      for (auto & thread : m_threads)
+        thread.join();
+
+      double const seconds = m_timer.ElapsedSeconds();
+      LOG(LINFO, ("Polygonizer split", m_featuresCount, "features to", m_emittedCount,
+                  "country features in", seconds, "seconds,",
+                  m_featuresCount / max(seconds, 1E-3), "features per second"));
     }
 
     void EmitFeature(borders::CountryPolygons const * country, FeatureBuilder1 const & fb)
     {
-#if PARALLEL_POLYGONIZER
-      QMutexLocker mutexLocker(&m_EmitFeatureMutex);
-      UNUSED_VALUE(mutexLocker);
-#endif
       if (country->m_index == -1)
       {
         m_Names.push_back(country->m_name);
@@ -156,6 +240,7 @@ namespace feature
       }
 
       (*(m_Buckets[country->m_index]))(fb);
+      ++m_emittedCount;
     }
 
     vector<string> const & Names() const
@@ -164,44 +249,159 @@ namespace feature
     }
 
   private:
-    friend class PolygonizerTask;
-
-    class PolygonizerTask
-#if PARALLEL_POLYGONIZER
-      : public QRunnable
-#endif
+    /// Splits features of the batch by countries to its buffers.
+    void ProcessBatch(Batch & batch, unordered_map<borders::CountryPolygons const *, size_t> & buffers)
     {
-    public:
-      PolygonizerTask(Polygonizer * pPolygonizer,
-                      buffer_vector<borders::CountryPolygons const *, 32> const & countries,
-                      FeatureBuilder1 const & fb)
-        : m_pPolygonizer(pPolygonizer), m_Countries(countries), m_FB(fb) {}
+      buffers.clear();
+      batch.m_buffersCount = 0;
+      auto const addFeature = [&](borders::CountryPolygons const * country, size_t i)
+      {
+        auto const res = buffers.emplace(country, batch.m_buffersCount);
+        if (res.second)
+        {
+          if (batch.m_buffersCount == batch.m_buffers.size())
+            batch.m_buffers.emplace_back();
+          CountryBuffer & buffer = batch.m_buffers[batch.m_buffersCount++];
+          buffer.m_country = country;
+          buffer.m_features.clear();
+        }
+        batch.m_buffers[res.first->second].m_features.push_back(static_cast<uint32_t>(i));
+      };
 
-      void RunBase()
+      TCountriesVector vec;
+      for (size_t i = 0; i < batch.m_count; ++i)
       {
-        for (size_t i = 0; i < m_Countries.size(); ++i)
+        FeatureBuilder1 const & fb = batch.m_features[i];
+        vec.clear();
+        m_countries.ForEachInRect(fb.GetLimitRect(), InsertCountriesPtr(vec));
+
+        if (vec.size() == 1)
         {
-          PointChecker doCheck(m_Countries[i]->m_regions);
-          m_FB.ForEachGeometryPoint(doCheck);
+          addFeature(vec[0], i);
+          continue;
+        }
+
+        for (size_t j = 0; j < vec.size(); ++j)
+        {
+          PointChecker doCheck(vec[j]->m_regions);
+          fb.ForEachGeometryPoint(doCheck);
 
           if (doCheck.m_belongs)
-            m_pPolygonizer->EmitFeature(m_Countries[i], m_FB);
+            addFeature(vec[j], i);
         }
       }
+    }
 
-#if PARALLEL_POLYGONIZER
-      void run()
+    void ProcessBatches(size_t queueIndex)
+    {
+      unordered_map<borders::CountryPolygons const *, size_t> buffers;
+      while (true)
       {
-        RunBase();
+        {
+          unique_lock<mutex> lock(m_mutex);
+          m_batchQueued.wait(lock, [this]() { return m_queuedCount != 0 || m_finished; });
+          if (m_queuedCount == 0)
+            return;
+          // Queued batches aren't less than reserved ones, so the reserved batch is found below.
+          --m_queuedCount;
+        }
+
+        Batch * batch = nullptr;
+        for (size_t i = 0; !batch; i = (i + 1) % m_queues.size())
+        {
+          // Takes the oldest batch of the own queue or steals the newest one of other queue.
+          WorkerQueue & queue = *m_queues[(queueIndex + i) % m_queues.size()];
+          lock_guard<mutex> lock(queue.m_mutex);
+          if (queue.m_batches.empty())
+            continue;
+          if (i == 0)
+          {
+            batch = queue.m_batches.front();
+            queue.m_batches.pop_front();
+          }
+          else
+          {
+            batch = queue.m_batches.back();
+            queue.m_batches.pop_back();
+          }
+        }
+
+        ProcessBatch(*batch, buffers);
 
-        m_pPolygonizer->m_ThreadPoolSemaphore.release();
+        {
+          lock_guard<mutex> lock(m_mutex);
+          batch->m_done = true;
+        }
+        m_batchDone.notify_one();
       }
-#endif
+    }
 
-    private:
-      Polygonizer * m_pPolygonizer;
-      buffer_vector<borders::CountryPolygons const *, 32> m_Countries;
-      FeatureBuilder1 m_FB;
-    };
+    unique_ptr<Batch> GetSpareBatch()
+    {
+      unique_ptr<Batch> batch;
+      if (m_spareBatches.empty())
+      {
+        batch.reset(new Batch());
+      }
+      else
+      {
+        batch = move(m_spareBatches.back());
+        m_spareBatches.pop_back();
+      }
+      batch->m_count = 0;
+      batch->m_done = false;
+      return batch;
+    }
+
+    void PushBatch(unique_ptr<Batch> batch)
+    {
+      if (m_threads.empty())
+      {
+        unordered_map<borders::CountryPolygons const *, size_t> buffers;
+        ProcessBatch(*batch, buffers);
+        batch->m_done = true;
+        m_window.push_back(move(batch));
+        WriteFirstBatch();
+        return;
+      }
+
+      if (m_window.size() == kMaxBatchesPerThread * m_threads.size())
+        WriteFirstBatch();
+
+      Batch * p = batch.get();
+      m_window.push_back(move(batch));
+      {
+        WorkerQueue & queue = *m_queues[m_nextQueue];
+        lock_guard<mutex> lock(queue.m_mutex);
+        queue.m_batches.push_back(p);
+      }
+      m_nextQueue = (m_nextQueue + 1) % m_queues.size();
+
+      {
+        lock_guard<mutex> lock(m_mutex);
+        ++m_queuedCount;
+      }
+      m_batchQueued.notify_one();
+    }
+
+    /// Waits for the first batch of the window and writes its buffers.
+    void WriteFirstBatch()
+    {
+      unique_ptr<Batch> batch = move(m_window.front());
+      m_window.pop_front();
+      {
+        unique_lock<mutex> lock(m_mutex);
+        Batch const * p = batch.get();
+        m_batchDone.wait(lock, [p]() { return p->m_done; });
+      }
+
+      for (size_t i = 0; i < batch->m_buffersCount; ++i)
+      {
+        CountryBuffer const & buffer = batch->m_buffers[i];
+        for (uint32_t j : buffer.m_features)
+          EmitFeature(buffer.m_country, batch->m_features[j]);
+      }
+      m_spareBatches.push_back(move(batch));
+    }
   };
 }
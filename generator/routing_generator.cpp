@@ -4,6 +4,7 @@
 #include "generator/borders_loader.hpp"
 #include "generator/gen_mwm_info.hpp"
 
+#include "routing/cross_mwm_overlay.hpp"
 #include "routing/osrm2feature_map.hpp"
 #include "routing/osrm_data_facade.hpp"
 #include "routing/osrm_engine.hpp"
@@ -18,12 +19,17 @@
 
 #include "geometry/distance_on_sphere.hpp"
 
+#include "platform/mwm_version.hpp"
+#include "platform/platform.hpp"
+
 #include "coding/file_container.hpp"
+#include "coding/file_name_utils.hpp"
 #include "coding/read_write_utils.hpp"
 #include "coding/internal/file_data.hpp"
 
 #include "base/logging.hpp"
 
+#include "std/deque.hpp"
 #include "std/fstream.hpp"
 
 #include "3party/osrm/osrm-backend/data_structures/edge_based_node_data.hpp"
@@ -205,6 +211,17 @@ void WriteCrossSection(routing::CrossRoutingContextWriter const & crossContext,
 }
 
 void BuildCrossRoutingIndex(string const & baseDir, string const & countryName, string const & osrmFile)
+{
+  LOG(LINFO, ("Loading countries borders..."));
+  borders::CountriesContainerT countries;
+  CHECK(borders::LoadCountriesList(baseDir, countries),
+        ("Error loading country polygons files"));
+
+  BuildCrossRoutingIndex(baseDir, countryName, osrmFile, countries);
+}
+
+void BuildCrossRoutingIndex(string const & baseDir, string const & countryName, string const & osrmFile,
+                            borders::CountriesContainerT const & countries)
 {
   LOG(LINFO, ("Cross mwm routing section builder"));
 
@@ -218,24 +235,66 @@ void BuildCrossRoutingIndex(string const & baseDir, string const & countryName,
   if (!LoadIndexes(localFile.GetPath(MapOptions::Map), osrmFile, nodeData, osm2ft))
     return;
 
-  LOG(LINFO, ("Loading countries borders..."));
-  borders::CountriesContainerT m_countries;
-  CHECK(borders::LoadCountriesList(baseDir, m_countries),
-        ("Error loading country polygons files"));
-
   LOG(LINFO, ("Finding cross nodes..."));
   routing::CrossRoutingContextWriter crossContext;
-  FindCrossNodes(nodeData, osm2ft, m_countries, countryName, crossContext);
+  FindCrossNodes(nodeData, osm2ft, countries, countryName, crossContext);
 
   string const mwmRoutingPath = localFile.GetPath(MapOptions::CarRouting);
   CalculateCrossAdjacency(mwmRoutingPath, crossContext);
   WriteCrossSection(crossContext, mwmRoutingPath);
 }
 
+void BuildCrossMwmOverlay(string const & baseDir)
+{
+  LOG(LINFO, ("Cross mwm overlay builder"));
+
+  Platform::FilesList files;
+  Platform::GetFilesByExt(baseDir, DATA_FILE_EXTENSION ROUTING_FILE_EXTENSION, files);
+  sort(files.begin(), files.end());
+
+  // Contexts must not be moved while the overlay is being built.
+  deque<CrossRoutingContextReader> contexts;
+  CrossMwmOverlayWriter writer;
+  for (string const & file : files)
+  {
+    string const countryName = file.substr(0, file.size() - strlen(DATA_FILE_EXTENSION ROUTING_FILE_EXTENSION));
+    FilesContainerR routingCont(my::JoinFoldersToPath(baseDir, file));
+    if (!routingCont.IsExist(ROUTING_CROSS_CONTEXT_TAG))
+    {
+      LOG(LWARNING, ("No cross section in", file));
+      continue;
+    }
+
+    version::MwmVersion version;
+    if (!version::ReadVersion(routingCont, version))
+    {
+      LOG(LWARNING, ("Can't read version of", file));
+      continue;
+    }
+
+    contexts.emplace_back();
+    ModelReaderPtr reader = routingCont.GetReader(ROUTING_CROSS_CONTEXT_TAG);
+    contexts.back().Load(*reader.GetPtr());
+    writer.AddMwm(countryName, version.timestamp, contexts.back());
+  }
+
+  CrossMwmOverlayGraph overlay;
+  writer.Build(overlay);
+
+  string const overlayPath = my::JoinFoldersToPath(baseDir, CROSS_MWM_OVERLAY_FILE);
+  FileWriter w(overlayPath);
+  overlay.Save(w);
+  LOG(LINFO, ("Cross mwm overlay for", contexts.size(), "mwms written, bytes:", w.Pos()));
+}
+
 void BuildRoutingIndex(string const & baseDir, string const & countryName, string const & osrmFile)
 {
   classificator::Load();
+  BuildRoutingSection(baseDir, countryName, osrmFile);
+}
 
+void BuildRoutingSection(string const & baseDir, string const & countryName, string const & osrmFile)
+{
   CountryFile countryFile(countryName);
 
   // Correct mwm version doesn't matter here - we just need access to mwm files via Index.
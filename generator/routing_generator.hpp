@@ -1,5 +1,7 @@
 #pragma once
 
+#include "generator/borders_loader.hpp"
+
 #include "std/string.hpp"
 #include "std/vector.hpp"
 #include "std/set.hpp"
@@ -11,8 +13,21 @@ namespace routing
 /// @param[in]  osrmFile  Full path to .osrm file (all prepared osrm files should be there).
 void BuildRoutingIndex(string const & baseDir, string const & countryName, string const & osrmFile);
 
+/// Same as BuildRoutingIndex, but the classificator should be loaded already,
+/// so several mwms can be processed at the same time.
+void BuildRoutingSection(string const & baseDir, string const & countryName, string const & osrmFile);
+
 /// @param[in]  baseDir      Full path to .mwm files directory.
 /// @param[in]  countryName   Country name same with .mwm and .border file name.
 /// @param[in]  osrmFile  Full path to .osrm file (all prepared osrm files should be there).
 void BuildCrossRoutingIndex(string const & baseDir, string const & countryName, string const & osrmFile);
+
+/// Same as BuildCrossRoutingIndex with loaded borders of all countries.
+void BuildCrossRoutingIndex(string const & baseDir, string const & countryName, string const & osrmFile,
+                            borders::CountriesContainerT const & countries);
+
+/// Builds the cross mwm overlay graph over border crossings of all mwms in baseDir
+/// and writes it to baseDir/CROSS_MWM_OVERLAY_FILE. Cross sections must be built already.
+/// @param[in]  baseDir      Full path to .mwm files directory.
+void BuildCrossMwmOverlay(string const & baseDir);
 }
@@ -0,0 +1,143 @@
+#include "generator/translator_pipeline.hpp"
+
+#include "base/assert.hpp"
+#include "base/thread.hpp"
+
+#include "std/utility.hpp"
+
+TranslatorPipeline::TranslatorPipeline(TTranslatorFactory const & factory, size_t threadsCount)
+  : m_factory(factory), m_threadsCount(threadsCount)
+{
+  CHECK_GREATER(m_threadsCount, 0, ());
+}
+
+void TranslatorPipeline::Run(TReadFn const & readFn, TFeatureFn const & emitFn)
+{
+  m_window.clear();
+  m_firstBatch = m_nextToTranslate = 0;
+  m_readFinished = false;
+
+  vector<threads::SimpleThread> threads;
+  threads.emplace_back([this, &readFn]() { ReadBatches(readFn); });
+  for (size_t i = 0; i < m_threadsCount; ++i)
+    threads.emplace_back([this]() { TranslateBatches(); });
+
+  while (true)
+  {
+    unique_ptr<Batch> batch;
+    {
+      unique_lock<mutex> lock(m_mutex);
+      m_batchTranslated.wait(lock, [this]()
+      {
+        return m_window.empty() ? m_readFinished : m_window.front()->m_translated;
+      });
+      if (m_window.empty())
+        break;
+      batch = move(m_window.front());
+      m_window.pop_front();
+      ++m_firstBatch;
+    }
+    m_batchEmitted.notify_one();
+
+    for (FeatureBuilder1 & ft : batch->m_features)
+      emitFn(ft);
+
+    lock_guard<mutex> lock(m_mutex);
+    m_spareBatches.push_back(move(batch));
+  }
+
+  for (auto & thread : threads)
+    thread.join();
+}
+
+void TranslatorPipeline::ReadBatches(TReadFn const & readFn)
+{
+  unique_ptr<Batch> batch;
+  readFn([this, &batch](OsmElement * e)
+  {
+    if (!batch)
+      batch = GetSpareBatch();
+
+    if (batch->m_elementsCount == batch->m_elements.size())
+      batch->m_elements.emplace_back();
+    // Assignment reuses strings of the spare element.
+    batch->m_elements[batch->m_elementsCount++] = *e;
+
+    if (batch->m_elementsCount == kBatchSize)
+      PushBatch(move(batch));
+  });
+
+  if (batch)
+    PushBatch(move(batch));
+
+  {
+    lock_guard<mutex> lock(m_mutex);
+    m_readFinished = true;
+  }
+  m_batchRead.notify_all();
+  m_batchTranslated.notify_one();
+}
+
+void TranslatorPipeline::TranslateBatches()
+{
+  Batch * batch = nullptr;
+  TFeatureFn const emitFn = [&batch](FeatureBuilder1 & ft) { batch->m_features.push_back(ft); };
+  TElementFn const translate = m_factory(emitFn);
+
+  while (true)
+  {
+    {
+      unique_lock<mutex> lock(m_mutex);
+      m_batchRead.wait(lock, [this]()
+      {
+        return m_readFinished || m_nextToTranslate < m_firstBatch + m_window.size();
+      });
+      if (m_nextToTranslate == m_firstBatch + m_window.size())
+        return;
+      batch = m_window[m_nextToTranslate - m_firstBatch].get();
+      ++m_nextToTranslate;
+    }
+
+    for (size_t i = 0; i < batch->m_elementsCount; ++i)
+      translate(&batch->m_elements[i]);
+
+    {
+      lock_guard<mutex> lock(m_mutex);
+      batch->m_translated = true;
+    }
+    m_batchTranslated.notify_one();
+  }
+}
+
+unique_ptr<TranslatorPipeline::Batch> TranslatorPipeline::GetSpareBatch()
+{
+  unique_ptr<Batch> batch;
+  {
+    lock_guard<mutex> lock(m_mutex);
+    if (!m_spareBatches.empty())
+    {
+      batch = move(m_spareBatches.back());
+      m_spareBatches.pop_back();
+    }
+  }
+
+  if (!batch)
+    batch.reset(new Batch());
+  batch->m_elementsCount = 0;
+  batch->m_features.clear();
+  batch->m_translated = false;
+  return batch;
+}
+
+void TranslatorPipeline::PushBatch(unique_ptr<Batch> batch)
+{
+  {
+    unique_lock<mutex> lock(m_mutex);
+    m_batchEmitted.wait(lock, [this]()
+    {
+      return m_window.size() < kMaxBatchesPerThread * m_threadsCount;
+    });
+    m_window.push_back(move(batch));
+  }
+  m_batchRead.notify_one();
+}
@@ -0,0 +1,74 @@
+#pragma once
+
+#include "generator/feature_builder.hpp"
+#include "generator/osm_element.hpp"
+
+#include "std/condition_variable.hpp"
+#include "std/deque.hpp"
+#include "std/function.hpp"
+#include "std/mutex.hpp"
+#include "std/unique_ptr.hpp"
+#include "std/vector.hpp"
+
+/*!
+ * \brief Translates OSM elements to features in several threads.
+ * The parse thread reads elements and packs them to batches, threadsCount translator threads
+ * translate batches and the calling thread emits features of batches in the order of elements,
+ * so the result is the same as of single threaded translation.
+ * At most kMaxBatchesPerThread batches per translator thread are in flight, batches are reused
+ * with their elements.
+ * \warning Translators work at the same time, so the data they share (e.g. the intermediate
+ * data holder) should be safe for concurrent reading.
+ */
+class TranslatorPipeline
+{
+public:
+  using TElementFn = function<void(OsmElement *)>;
+  using TFeatureFn = function<void(FeatureBuilder1 &)>;
+  /// Reads all elements of the source and passes them to the function.
+  using TReadFn = function<void(TElementFn const &)>;
+  /// Makes the translation function of a translator thread, it's called in that thread.
+  /// Translated features should be passed to emitFn, which lives until the end of translation.
+  using TTranslatorFactory = function<TElementFn(TFeatureFn const & emitFn)>;
+
+  static size_t constexpr kBatchSize = 1024;
+  static size_t constexpr kMaxBatchesPerThread = 4;
+
+  TranslatorPipeline(TTranslatorFactory const & factory, size_t threadsCount);
+
+  /// Reads elements by readFn in the parse thread and passes translated features to emitFn
+  /// in the calling thread.
+  void Run(TReadFn const & readFn, TFeatureFn const & emitFn);
+
+private:
+  struct Batch
+  {
+    // Only the first m_elementsCount elements belong to the batch, the rest are spare.
+    vector<OsmElement> m_elements;
+    size_t m_elementsCount = 0;
+    vector<FeatureBuilder1> m_features;
+    bool m_translated = false;
+  };
+
+  void ReadBatches(TReadFn const & readFn);
+  void TranslateBatches();
+
+  unique_ptr<Batch> GetSpareBatch();
+  /// Waits for a free place in the window.
+  void PushBatch(unique_ptr<Batch> batch);
+
+  TTranslatorFactory m_factory;
+  size_t const m_threadsCount;
+
+  // Window of batches between the last emitted and the last read ones.
+  mutex m_mutex;
+  condition_variable m_batchRead;
+  condition_variable m_batchTranslated;
+  condition_variable m_batchEmitted;
+  deque<unique_ptr<Batch>> m_window;
+  vector<unique_ptr<Batch>> m_spareBatches;
+  // Number of the first batch of the window and of the next batch to translate.
+  size_t m_firstBatch = 0;
+  size_t m_nextToTranslate = 0;
+  bool m_readFinished = false;
+};
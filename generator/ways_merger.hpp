@@ -30,6 +30,27 @@ public:
     }
   }
 
+  /// Same as AddWay() for every id, but ways are read from the holder at once.
+  void AddWays(vector<uint64_t> const & ids)
+  {
+    vector<WayElement> ways;
+    ways.reserve(ids.size());
+    for (uint64_t id : ids)
+      ways.emplace_back(id);
+
+    vector<bool> found;
+    m_holder.GetWays(ids, ways, found);
+
+    for (size_t i = 0; i < ways.size(); ++i)
+    {
+      if (!found[i] || !ways[i].IsValid())
+        continue;
+      shared_ptr<WayElement> e(new WayElement(move(ways[i])));
+      m_map.insert(make_pair(e->nodes.front(), e));
+      m_map.insert(make_pair(e->nodes.back(), e));
+    }
+  }
+
   template <class ToDo>
   void ForEachArea(bool collectID, ToDo toDo)
   {
@@ -41,6 +62,8 @@ public:
 
       vector<uint64_t> ids;
       TPointSeq points;
+      TPointSeq wayPoints;
+      vector<bool> found;
 
       do
       {
@@ -49,12 +72,14 @@ public:
         if (collectID)
           ids.push_back(e->m_wayOsmId);
 
-        e->ForEachPointOrdered(id, [this, &points](uint64_t id)
+        m_holder.GetNodes(e->nodes, wayPoints, found);
+        bool const isForward = id == e->nodes.front();
+        for (size_t k = 0; k < wayPoints.size(); ++k)
         {
-          m2::PointD pt;
-          if (m_holder.GetNode(id, pt.y, pt.x))
-            points.push_back(pt);
-        });
+          size_t const j = isForward ? k : wayPoints.size() - 1 - k;
+          if (found[j])
+            points.push_back(wayPoints[j]);
+        }
 
         m_map.erase(i);
 
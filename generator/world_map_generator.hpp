@@ -252,5 +252,7 @@ public:
       m_bucket(fb);
   }
 
+  void Finish() { m_bucket.Finish(); }
+
   inline FeatureOutT const & Parent() const { return m_bucket; }
 };
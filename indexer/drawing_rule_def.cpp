@@ -6,31 +6,22 @@
 
 namespace drule
 {
-  namespace
+  bool less_key::operator() (Key const & r1, Key const & r2) const
   {
-    struct less_key
-    {
-      bool operator() (drule::Key const & r1, drule::Key const & r2) const
-      {
-        // assume that unique algo leaves the first element (with max priority), others - go away
-        if (r1.m_type == r2.m_type)
-          return (r1.m_priority > r2.m_priority);
-        else
-          return (r1.m_type < r2.m_type);
-      }
-    };
+    // assume that unique algo leaves the first element (with max priority), others - go away
+    if (r1.m_type == r2.m_type)
+      return (r1.m_priority > r2.m_priority);
+    else
+      return (r1.m_type < r2.m_type);
+  }
 
-    struct equal_key
-    {
-      bool operator() (drule::Key const & r1, drule::Key const & r2) const
-      {
-        // many line rules - is ok, other rules - one is enough
-        if (r1.m_type == drule::line)
-          return (r1 == r2);
-        else
-          return (r1.m_type == r2.m_type);
-      }
-    };
+  bool equal_key::operator() (Key const & r1, Key const & r2) const
+  {
+    // many line rules - is ok, other rules - one is enough
+    if (r1.m_type == drule::line)
+      return (r1 == r2);
+    else
+      return (r1.m_type == r2.m_type);
   }
 
   void MakeUnique(KeysT & keys)
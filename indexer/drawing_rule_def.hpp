@@ -36,5 +36,18 @@ namespace drule
   double const layer_base_priority = 2000;
 
   typedef buffer_vector<Key, 16> KeysT;
+
+  /// @name Order and equality of keys to leave rules with max priorities in MakeUnique.
+  //@{
+  struct less_key
+  {
+    bool operator() (Key const & r1, Key const & r2) const;
+  };
+  struct equal_key
+  {
+    bool operator() (Key const & r1, Key const & r2) const;
+  };
+  //@}
+
   void MakeUnique(KeysT & keys);
 }
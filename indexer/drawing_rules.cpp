@@ -136,6 +136,7 @@ void RulesHolder::Clean()
   }
 
   m_rules.clear();
+  m_table.Clear();
 }
 
 Key RulesHolder::AddRule(int scale, rule_type_t type, BaseRule * p)
@@ -515,6 +516,8 @@ void RulesHolder::LoadFromBinaryProto(string const & s)
   classif().GetMutableRoot()->ForEachObject(ref(doSet));
 
   InitBackgroundColors(doSet.m_cont);
+
+  m_table.Build(classif(), *this);
 }
 
 void LoadRules()
@@ -2,6 +2,7 @@
 
 #include "indexer/drawing_rule_def.hpp"
 #include "indexer/drules_selector.hpp"
+#include "indexer/drules_table.hpp"
 
 #include "base/base.hpp"
 #include "base/buffer_vector.hpp"
@@ -79,6 +80,9 @@ namespace drule
     /// background color for scales in range [0...scales::UPPER_STYLE_SCALE]
     vector<uint32_t> m_bgColors;
 
+    /// resolved rules of classificator types, built after loading
+    RulesTable m_table;
+
   public:
     RulesHolder();
     ~RulesHolder();
@@ -92,6 +96,8 @@ namespace drule
 
     BaseRule const * Find(Key const & k) const;
 
+    RulesTable const & GetTable() const { return m_table; }
+
     uint32_t GetBgColor(int scale) const;
 
 #ifdef OMIM_OS_DESKTOP
@@ -0,0 +1,108 @@
+#include "indexer/drules_table.hpp"
+
+#include "indexer/classificator.hpp"
+#include "indexer/drawing_rules.hpp"
+#include "indexer/scales.hpp"
+
+#include "base/assert.hpp"
+
+#include "std/algorithm.hpp"
+#include "std/iterator.hpp"
+
+
+namespace drule
+{
+  namespace
+  {
+    size_t const kGeomTypesCount = 3;
+    size_t const kScalesCount = scales::UPPER_STYLE_SCALE + 1;
+  }
+
+  TableRule::TableRule(Key const & key, BaseRule const * rule)
+    : m_key(key), m_rule(rule), m_hasCaption(rule->GetCaption(0) != 0),
+      m_hasAuxCaption(rule->GetCaption(1) != 0)
+  {
+  }
+
+  void MakeUnique(TableRulesT & rules)
+  {
+    sort(rules.begin(), rules.end(), [](TableRule const & r1, TableRule const & r2)
+    {
+      return less_key()(r1.m_key, r2.m_key);
+    });
+    rules.resize(distance(rules.begin(), unique(rules.begin(), rules.end(),
+                                                [](TableRule const & r1, TableRule const & r2)
+    {
+      return equal_key()(r1.m_key, r2.m_key);
+    })));
+  }
+
+  void RulesTable::Build(Classificator const & c, RulesHolder const & holder)
+  {
+    Clear();
+
+    vector<pair<uint32_t, ClassifObject const *>> objects;
+    auto addObject = [&objects](ClassifObject const * p, uint32_t type)
+    {
+      objects.emplace_back(type, p);
+    };
+    c.ForEachTree(addObject);
+
+    m_rows.reserve(objects.size());
+    m_offsets.reserve(objects.size() * kScalesCount * kGeomTypesCount + 1);
+    m_offsets.push_back(0);
+
+    KeysT keys;
+    for (size_t row = 0; row < objects.size(); ++row)
+    {
+      m_rows[objects[row].first] = static_cast<uint32_t>(row);
+      for (int scale = 0; scale <= scales::UPPER_STYLE_SCALE; ++scale)
+      {
+        for (size_t i = 0; i < kGeomTypesCount; ++i)
+        {
+          feature::EGeomType const ft = static_cast<feature::EGeomType>(i);
+          ASSERT_EQUAL(GetCell(row, scale, ft) + 1, m_offsets.size(), ());
+
+          keys.clear();
+          objects[row].second->GetSuitable(scale, ft, keys);
+          for (Key const & k : keys)
+          {
+            BaseRule const * rule = holder.Find(k);
+            ASSERT(rule, (k.m_scale, k.m_type, k.m_index));
+            if (rule)
+              m_rules.emplace_back(k, rule);
+          }
+          m_offsets.push_back(static_cast<uint32_t>(m_rules.size()));
+        }
+      }
+    }
+  }
+
+  void RulesTable::Clear()
+  {
+    m_rows.clear();
+    m_offsets.clear();
+    m_rules.clear();
+  }
+
+  bool RulesTable::GetRules(uint32_t type, int scale, feature::EGeomType ft, SpanT & span) const
+  {
+    ASSERT(ft >= 0 && static_cast<size_t>(ft) < kGeomTypesCount, ());
+    ASSERT(scale >= 0 && scale <= scales::UPPER_STYLE_SCALE, ());
+
+    auto const it = m_rows.find(type);
+    if (it == m_rows.end())
+      return false;
+
+    size_t const cell = GetCell(it->second, scale, ft);
+    span.first = m_rules.data() + m_offsets[cell];
+    span.second = m_rules.data() + m_offsets[cell + 1];
+    return true;
+  }
+
+  // static
+  size_t RulesTable::GetCell(size_t row, int scale, feature::EGeomType ft)
+  {
+    return (row * kScalesCount + scale) * kGeomTypesCount + ft;
+  }
+}
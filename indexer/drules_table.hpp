@@ -0,0 +1,66 @@
+#pragma once
+
+#include "indexer/drawing_rule_def.hpp"
+#include "indexer/feature_decl.hpp"
+
+#include "base/buffer_vector.hpp"
+
+#include "std/unordered_map.hpp"
+#include "std/utility.hpp"
+#include "std/vector.hpp"
+
+
+class Classificator;
+
+namespace drule
+{
+  class BaseRule;
+  class RulesHolder;
+
+  /// Drawing rule of a classificator type resolved to the rules holder.
+  struct TableRule
+  {
+    TableRule() = default;
+    TableRule(Key const & key, BaseRule const * rule);
+
+    /// Key with the priority of the rule.
+    Key m_key;
+    BaseRule const * m_rule = nullptr;
+    /// Rule has a main caption.
+    bool m_hasCaption = false;
+    /// Rule has a secondary caption.
+    bool m_hasAuxCaption = false;
+  };
+
+  typedef buffer_vector<TableRule, 16> TableRulesT;
+
+  /// The same as MakeUnique for keys.
+  void MakeUnique(TableRulesT & rules);
+
+  /// Immutable table of drawing rules by (type, scale, geometry type). It's built once when
+  /// drawing rules are loaded, so styling of a feature doesn't walk the classificator tree for
+  /// every type and doesn't search rules by keys.
+  class RulesTable
+  {
+  public:
+    typedef pair<TableRule const *, TableRule const *> SpanT;
+
+    void Build(Classificator const & c, RulesHolder const & holder);
+    void Clear();
+
+    bool IsEmpty() const { return m_rows.empty(); }
+
+    /// @return Rules of ClassifObject::GetSuitable order for any type of the classificator tree
+    ///         or false if the type is unknown.
+    bool GetRules(uint32_t type, int scale, feature::EGeomType ft, SpanT & span) const;
+
+  private:
+    static size_t GetCell(size_t row, int scale, feature::EGeomType ft);
+
+    /// Type -> row of the table.
+    unordered_map<uint32_t, uint32_t> m_rows;
+    /// Rules of a cell are in [m_offsets[cell], m_offsets[cell + 1]).
+    vector<uint32_t> m_offsets;
+    vector<TableRule> m_rules;
+  };
+}
@@ -1,10 +1,12 @@
 #include "indexer/feature_visibility.hpp"
 #include "indexer/classificator.hpp"
+#include "indexer/drawing_rules.hpp"
 #include "indexer/feature.hpp"
 #include "indexer/scales.hpp"
 
 #include "base/assert.hpp"
 
+#include "std/algorithm.hpp"
 #include "std/array.hpp"
 
 
@@ -88,6 +90,36 @@ namespace
   };
 }
 
+namespace
+{
+  /// Appends rules of types from the rules table.
+  /// @return false if some type isn't in the table.
+  template <class TDoRule>
+  bool ForEachTableRule(uint32_t type, int level, EGeomType ft, TDoRule && doRule)
+  {
+    drule::RulesTable::SpanT span;
+    if (!drule::rules().GetTable().GetRules(type, min(level, scales::GetUpperStyleScale()), ft,
+                                            span))
+    {
+      return false;
+    }
+    for_each(span.first, span.second, doRule);
+    return true;
+  }
+
+  void GetDrawKeys(uint32_t type, int level, EGeomType ft, drule::KeysT & keys)
+  {
+    if (!ForEachTableRule(type, level, ft, [&keys](drule::TableRule const & r)
+        {
+          keys.push_back(r.m_key);
+        }))
+    {
+      DrawRuleGetter doRules(level, ft, keys);
+      (void)classif().ProcessObjects(type, doRules);
+    }
+  }
+}
+
 pair<int, bool> GetDrawRule(FeatureBase const & f, int level,
                             drule::KeysT & keys)
 {
@@ -96,9 +128,35 @@ pair<int, bool> GetDrawRule(FeatureBase const & f, int level,
   ASSERT ( keys.empty(), () );
   Classificator const & c = classif();
 
-  DrawRuleGetter doRules(level, types.GetGeoType(), keys);
   for (uint32_t t : types)
-    (void)c.ProcessObjects(t, doRules);
+    GetDrawKeys(t, level, types.GetGeoType(), keys);
+
+  return make_pair(types.GetGeoType(), types.Has(c.GetCoastType()));
+}
+
+pair<int, bool> GetDrawRule(FeatureBase const & f, int level,
+                            drule::TableRulesT & rules)
+{
+  TypesHolder types(f);
+
+  ASSERT ( rules.empty(), () );
+  Classificator const & c = classif();
+  drule::RulesHolder const & holder = drule::rules();
+
+  for (uint32_t t : types)
+  {
+    if (!ForEachTableRule(t, level, types.GetGeoType(), [&rules](drule::TableRule const & r)
+        {
+          rules.push_back(r);
+        }))
+    {
+      drule::KeysT keys;
+      DrawRuleGetter doRules(level, types.GetGeoType(), keys);
+      (void)c.ProcessObjects(t, doRules);
+      for (drule::Key const & k : keys)
+        rules.push_back(drule::TableRule(k, holder.Find(k)));
+    }
+  }
 
   return make_pair(types.GetGeoType(), types.Has(c.GetCoastType()));
 }
@@ -108,12 +166,9 @@ void GetDrawRule(vector<uint32_t> const & types, int level, int geoType,
 
 {
   ASSERT ( keys.empty(), () );
-  Classificator const & c = classif();
-
-  DrawRuleGetter doRules(level, EGeomType(geoType), keys);
 
   for (uint32_t t : types)
-    (void)c.ProcessObjects(t, doRules);
+    GetDrawKeys(t, level, EGeomType(geoType), keys);
 }
 
 namespace
@@ -1,6 +1,7 @@
 #pragma once
 
 #include "indexer/drawing_rule_def.hpp"
+#include "indexer/drules_table.hpp"
 #include "indexer/feature_decl.hpp"
 
 #include "base/base.hpp"
@@ -58,6 +59,9 @@ namespace feature
   /// @return (geometry type, is coastline)
   pair<int, bool> GetDrawRule(FeatureBase const & f, int level,
                               drule::KeysT & keys);
+  /// The same as above, but rules are resolved and have caption flags.
+  pair<int, bool> GetDrawRule(FeatureBase const & f, int level,
+                              drule::TableRulesT & rules);
   void GetDrawRule(vector<uint32_t> const & types, int level, int geoType,
                    drule::KeysT & keys);
 
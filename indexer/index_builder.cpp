@@ -8,7 +8,8 @@
 
 namespace indexer
 {
-  bool BuildIndexFromDatFile(string const & datFile, string const & tmpFile)
+  bool BuildIndexFromDatFile(string const & datFile, string const & tmpFile,
+                             uint64_t sortMemorySize, size_t sortThreadsCount)
   {
     try
     {
@@ -17,7 +18,8 @@ namespace indexer
         FeaturesVectorTest features(datFile);
         FileWriter writer(idxFileName);
 
-        BuildIndex(features.GetHeader(), features.GetVector(), writer, tmpFile);
+        BuildIndex(features.GetHeader(), features.GetVector(), writer, tmpFile, sortMemorySize,
+                   sortThreadsCount);
       }
 
       FilesContainerW(datFile, FileWriter::OP_WRITE_EXISTING).Write(idxFileName, INDEX_FILE_TAG);
@@ -7,18 +7,24 @@ namespace indexer
 {
 template <class TFeaturesVector, typename TWriter>
 void BuildIndex(feature::DataHeader const & header, TFeaturesVector const & features,
-                TWriter & writer, string const & tmpFilePrefix)
+                TWriter & writer, string const & tmpFilePrefix,
+                uint64_t sortMemorySize = covering::kDefaultSortMemorySize,
+                size_t sortThreadsCount = 1)
   {
     LOG(LINFO, ("Building scale index."));
     uint64_t indexSize;
     {
       SubWriter<TWriter> subWriter(writer);
-      covering::IndexScales(header, features, subWriter, tmpFilePrefix);
+      covering::IndexScales(header, features, subWriter, tmpFilePrefix, sortMemorySize,
+                            sortThreadsCount);
       indexSize = subWriter.Size();
     }
     LOG(LINFO, ("Built scale index. Size =", indexSize));
   }
 
   // doesn't throw exceptions
-  bool BuildIndexFromDatFile(string const & datFile, string const & tmpFile);
+  /// @param sortMemorySize  Memory for sorting of cells, sortThreadsCount threads sort them.
+  bool BuildIndexFromDatFile(string const & datFile, string const & tmpFile,
+                             uint64_t sortMemorySize = covering::kDefaultSortMemorySize,
+                             size_t sortThreadsCount = 1);
 }
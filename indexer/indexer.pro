@@ -20,6 +20,7 @@ SOURCES += \
     drawing_rules.cpp \
     drules_selector.cpp \
     drules_selector_parser.cpp \
+    drules_table.cpp \
     feature.cpp \
     feature_algo.cpp \
     feature_covering.cpp \
@@ -64,6 +65,7 @@ HEADERS += \
     drules_include.hpp \
     drules_selector.cpp \
     drules_selector_parser.cpp \
+    drules_table.hpp \
     feature.hpp \
     feature_algo.hpp \
     feature_covering.hpp \
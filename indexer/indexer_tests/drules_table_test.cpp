@@ -0,0 +1,65 @@
+#include "testing/testing.hpp"
+
+#include "indexer/classificator.hpp"
+#include "indexer/classificator_loader.hpp"
+#include "indexer/drawing_rules.hpp"
+#include "indexer/drules_table.hpp"
+#include "indexer/scales.hpp"
+
+namespace
+{
+class DoCheckTable
+{
+  drule::RulesTable const & m_table;
+  size_t m_rulesCount = 0;
+
+public:
+  explicit DoCheckTable(drule::RulesTable const & table) : m_table(table) {}
+
+  void operator()(ClassifObject const * p, uint32_t type)
+  {
+    for (int scale = 0; scale <= scales::GetUpperStyleScale(); ++scale)
+    {
+      for (int i = 0; i < 3; ++i)
+      {
+        feature::EGeomType const ft = static_cast<feature::EGeomType>(i);
+
+        drule::KeysT keys;
+        p->GetSuitable(scale, ft, keys);
+
+        drule::RulesTable::SpanT span;
+        TEST(m_table.GetRules(type, scale, ft, span), (p->GetName()));
+        TEST_EQUAL(span.second - span.first, keys.size(), (p->GetName(), scale, ft));
+
+        for (size_t j = 0; j < keys.size(); ++j)
+        {
+          drule::TableRule const & rule = span.first[j];
+          TEST(rule.m_key == keys[j], (p->GetName(), scale, ft));
+          TEST_EQUAL(rule.m_key.m_priority, keys[j].m_priority, (p->GetName(), scale, ft));
+          TEST_EQUAL(rule.m_rule, drule::rules().Find(keys[j]), (p->GetName(), scale, ft));
+          TEST_EQUAL(rule.m_hasCaption, rule.m_rule->GetCaption(0) != nullptr, ());
+          TEST_EQUAL(rule.m_hasAuxCaption, rule.m_rule->GetCaption(1) != nullptr, ());
+        }
+        m_rulesCount += keys.size();
+      }
+    }
+  }
+
+  size_t GetRulesCount() const { return m_rulesCount; }
+};
+}  // namespace
+
+UNIT_TEST(RulesTable_MatchesClassificator)
+{
+  classificator::Load();
+
+  drule::RulesTable const & table = drule::rules().GetTable();
+  TEST(!table.IsEmpty(), ());
+
+  DoCheckTable doCheck(table);
+  classif().ForEachTree(doCheck);
+  TEST_GREATER(doCheck.GetRulesCount(), 0, ());
+
+  drule::RulesTable::SpanT span;
+  TEST(!table.GetRules(0 /* type */, 0 /* scale */, feature::GEOM_POINT, span), ());
+}
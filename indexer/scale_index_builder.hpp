@@ -9,7 +9,7 @@
 #include "defines.hpp"
 
 #include "coding/dd_vector.hpp"
-#include "coding/file_sort.hpp"
+#include "coding/external_sort.hpp"
 #include "coding/var_serial_vector.hpp"
 #include "coding/writer.hpp"
 
@@ -82,6 +82,22 @@ static_assert(sizeof(CellFeatureBucketTuple) == 16, "");
 static_assert(is_trivially_copyable<CellFeatureBucketTuple>::value, "");
 #endif
 
+/// Radix key of CellFeatureBucketTuple for ExternalSorter: the bucket and the cell.
+struct CellFeatureBucketTupleKey
+{
+  uint64_t operator()(CellFeatureBucketTuple const & t) const
+  {
+    uint64_t const cell = t.GetCellFeaturePair().GetCell();
+    // Otherwise keys are inconsistent with the order of tuples and cells are sorted wrong.
+    CHECK_LESS(cell, 1ULL << 58, ());
+    CHECK_LESS(t.GetBucket(), 64, ());
+    return (static_cast<uint64_t>(t.GetBucket()) << 58) | cell;
+  }
+};
+
+/// Default memory for sorting of cells.
+uint64_t constexpr kDefaultSortMemorySize = 64 * 1024 * 1024;
+
 template <class TSorter>
 class FeatureCoverer
 {
@@ -194,7 +210,8 @@ private:
 
 template <class TFeaturesVector, class TWriter>
 void IndexScales(feature::DataHeader const & header, TFeaturesVector const & features,
-                 TWriter & writer, string const & tmpFilePrefix)
+                 TWriter & writer, string const & tmpFilePrefix,
+                 uint64_t sortMemorySize = kDefaultSortMemorySize, size_t sortThreadsCount = 1)
 {
   // TODO: Make scale bucketing dynamic.
 
@@ -207,9 +224,11 @@ void IndexScales(feature::DataHeader const & header, TFeaturesVector const & fea
   {
     FileWriter cellsToFeaturesAllBucketsWriter(cellsToFeatureAllBucketsFile);
 
-    using TSorter = FileSorter<CellFeatureBucketTuple, WriterFunctor<FileWriter>>;
+    using TSorter = ExternalSorter<CellFeatureBucketTuple, WriterFunctor<FileWriter>,
+                                   less<CellFeatureBucketTuple>, CellFeatureBucketTupleKey>;
     WriterFunctor<FileWriter> out(cellsToFeaturesAllBucketsWriter);
-    TSorter sorter(1024 * 1024 /* bufferBytes */, tmpFilePrefix + CELL2FEATURE_TMP_EXT, out);
+    TSorter sorter(static_cast<size_t>(sortMemorySize), tmpFilePrefix + CELL2FEATURE_TMP_EXT, out,
+                   sortThreadsCount);
     vector<uint32_t> featuresInBucket(bucketsCount);
     vector<uint32_t> cellsInBucket(bucketsCount);
     features.ForEach(FeatureCoverer<TSorter>(header, sorter, featuresInBucket, cellsInBucket));
@@ -419,12 +419,26 @@ void BuildSearchIndex(FilesContainerR const & cont, CategoriesHolder const & cat
 
 namespace indexer {
 bool BuildSearchIndexFromDatFile(string const & datFile, bool forceRebuild)
+{
+  try
+  {
+    CategoriesHolder catHolder(GetPlatform().GetReader(SEARCH_CATEGORIES_FILE_NAME));
+    return BuildSearchIndexFromDatFile(datFile, catHolder, forceRebuild);
+  }
+  catch (Reader::Exception const & e)
+  {
+    LOG(LERROR, ("Error while reading file: ", e.Msg()));
+    return false;
+  }
+}
+
+bool BuildSearchIndexFromDatFile(string const & datFile, CategoriesHolder const & catHolder,
+                                 bool forceRebuild)
 {
   LOG(LINFO, ("Start building search index. Bits = ", search::kPointCodingBits));
 
   try
   {
-    Platform & pl = GetPlatform();
     string const tmpFile1 = datFile + ".search_index_1.tmp";
     string const tmpFile2 = datFile + ".search_index_2.tmp";
 
@@ -436,8 +450,6 @@ bool BuildSearchIndexFromDatFile(string const & datFile, bool forceRebuild)
 
       FileWriter writer(tmpFile2);
 
-      CategoriesHolder catHolder(pl.GetReader(SEARCH_CATEGORIES_FILE_NAME));
-
       BuildSearchIndex(readCont, catHolder, writer, tmpFile1);
 
       LOG(LINFO, ("Search index size = ", writer.Size()));
@@ -2,6 +2,7 @@
 
 #include "std/string.hpp"
 
+class CategoriesHolder;
 class FilesContainerR;
 class Writer;
 
@@ -9,6 +10,10 @@ namespace indexer
 {
 bool BuildSearchIndexFromDatFile(string const & fName, bool forceRebuild = false);
 
+/// Same as above with loaded categories, which can be shared by several threads.
+bool BuildSearchIndexFromDatFile(string const & fName, CategoriesHolder const & catHolder,
+                                 bool forceRebuild);
+
 bool AddCompresedSearchIndexSection(string const & fName, bool forceRebuild);
 
 void BuildCompressedSearchIndex(FilesContainerR & container, Writer & indexWriter);
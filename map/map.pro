@@ -40,6 +40,7 @@ HEADERS += \
     country_tree.hpp \
     active_maps_layout.hpp \
     navigator_utils.hpp \
+    raster_tile_server.hpp \
 
 SOURCES += \
     feature_vec_model.cpp \
@@ -72,6 +73,7 @@ SOURCES += \
     country_tree.cpp \
     active_maps_layout.cpp \
     navigator_utils.cpp \
+    raster_tile_server.cpp \
 
 !iphone*:!tizen*:!android* {
   HEADERS += qgl_render_context.hpp
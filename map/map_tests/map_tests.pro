@@ -36,6 +36,7 @@ SOURCES += \
   kmz_unarchive_test.cpp \
   mwm_url_tests.cpp \
   navigator_test.cpp \
+  raster_tile_server_test.cpp \
   mwm_set_test.cpp \
 
 !linux* {
@@ -0,0 +1,82 @@
+#include "testing/testing.hpp"
+
+#ifndef USE_DRAPE
+#include "map/raster_tile_server.hpp"
+
+#include "indexer/mercator.hpp"
+
+UNIT_TEST(RasterTileServer_TileRect)
+{
+  TEST_EQUAL(RasterTileServer::GetTileRect(0, 0, 0), MercatorBounds::FullRect(), ());
+
+  TEST_EQUAL(RasterTileServer::GetTileRect(2, 1, 3), m2::RectD(-90, -180, 0, -90), ());
+  TEST_EQUAL(RasterTileServer::GetTileRect(3, 7, 0), m2::RectD(135, 135, 180, 180), ());
+}
+
+UNIT_TEST(RasterTileServer_TileSize)
+{
+  TEST_EQUAL(RasterTileServer::GetTileSize(graphics::EDensityMDPI), 256, ());
+  TEST_EQUAL(RasterTileServer::GetTileSize(graphics::EDensityXHDPI), 512, ());
+}
+
+UNIT_TEST(RasterTileServer_MetatileSize)
+{
+  TEST_EQUAL(RasterTileServer::GetMetatileSize(8, 10, graphics::EDensityMDPI), 8, ());
+  TEST_EQUAL(RasterTileServer::GetMetatileSize(1, 10, graphics::EDensityMDPI), 1, ());
+  // Metatiles aren't bigger than the world.
+  TEST_EQUAL(RasterTileServer::GetMetatileSize(8, 1, graphics::EDensityMDPI), 2, ());
+  // Sizes are rounded down to a power of two, so metatiles are aligned.
+  TEST_EQUAL(RasterTileServer::GetMetatileSize(3, 2, graphics::EDensityMDPI), 2, ());
+  TEST_EQUAL(RasterTileServer::GetMetatileSize(12, 10, graphics::EDensityMDPI), 8, ());
+  // Frames of big tiles are limited.
+  TEST_EQUAL(RasterTileServer::GetMetatileSize(8, 10, graphics::EDensityXHDPI), 8, ());
+  TEST_EQUAL(RasterTileServer::GetMetatileSize(8, 10, graphics::EDensityXXHDPI), 4, ());
+}
+
+UNIT_TEST(RasterTileServer_MetatileLayout)
+{
+  RasterTileServer::MetatileLayout layout;
+  RasterTileServer::GetMetatileLayout(RasterTileKey(3, 5, 6, graphics::EDensityMDPI), 4, layout);
+
+  TEST_EQUAL(layout.m_keys.size(), 16, ());
+  TEST_EQUAL(layout.m_pxRects.size(), layout.m_keys.size(), ());
+  TEST_EQUAL(layout.m_frameSize, 5 * 256, ());
+
+  for (size_t i = 0; i < layout.m_keys.size(); ++i)
+  {
+    RasterTileKey const & key = layout.m_keys[i];
+    TEST_EQUAL(key.m_zoom, 3, ());
+    TEST_EQUAL(key.m_x, 4 + static_cast<int>(i % 4), ());
+    TEST_EQUAL(key.m_y, 4 + static_cast<int>(i / 4), ());
+
+    m2::RectU const & rect = layout.m_pxRects[i];
+    TEST_EQUAL(rect.SizeX(), 256, ());
+    TEST_EQUAL(rect.SizeY(), 256, ());
+    TEST_EQUAL(rect.minX(), 128 + 256 * (i % 4), ());
+    TEST_EQUAL(rect.minY(), 128 + 256 * (i / 4), ());
+    TEST_LESS_OR_EQUAL(rect.maxX(), layout.m_frameSize, ());
+    TEST_LESS_OR_EQUAL(rect.maxY(), layout.m_frameSize, ());
+  }
+
+  // The frame covers the tiles and the half tile margin.
+  m2::RectD const tiles(RasterTileServer::GetTileRect(3, 4, 7).LeftBottom(),
+                        RasterTileServer::GetTileRect(3, 7, 4).RightTop());
+  TEST(layout.m_rect.IsRectInside(tiles), ());
+  TEST_ALMOST_EQUAL_ULPS(layout.m_rect.SizeX(), tiles.SizeX() * 5 / 4, ());
+}
+
+UNIT_TEST(RasterTileServer_MetatileLayoutInWorld)
+{
+  // Non power of two sizes don't make tiles out of the world.
+  RasterTileServer::MetatileLayout layout;
+  RasterTileServer::GetMetatileLayout(RasterTileKey(2, 3, 3, graphics::EDensityMDPI), 3, layout);
+  TEST_EQUAL(layout.m_keys.size(), 4, ());
+  for (RasterTileKey const & key : layout.m_keys)
+  {
+    TEST_GREATER_OR_EQUAL(key.m_x, 2, (key));
+    TEST_LESS(key.m_x, 4, (key));
+    TEST_GREATER_OR_EQUAL(key.m_y, 2, (key));
+    TEST_LESS(key.m_y, 4, (key));
+  }
+}
+#endif // USE_DRAPE
@@ -0,0 +1,285 @@
+#ifndef USE_DRAPE
+#include "map/raster_tile_server.hpp"
+#include "map/feature_vec_model.hpp"
+
+#include "render/cpu_drawer.hpp"
+#include "render/feature_processor.hpp"
+#include "render/proto_to_styles.hpp"
+#include "render/render_policy.hpp"
+#include "render/scales_processor.hpp"
+
+#include "indexer/drawing_rules.hpp"
+#include "indexer/mercator.hpp"
+#include "indexer/scales.hpp"
+
+#include "geometry/screenbase.hpp"
+
+#include "base/assert.hpp"
+#include "base/math.hpp"
+#include "base/scope_guard.hpp"
+#include "base/thread.hpp"
+#include "base/timer.hpp"
+
+#include "std/atomic.hpp"
+#include "std/set.hpp"
+#include "std/sstream.hpp"
+
+bool operator<(RasterTileKey const & l, RasterTileKey const & r)
+{
+  if (l.m_zoom != r.m_zoom)
+    return l.m_zoom < r.m_zoom;
+  if (l.m_x != r.m_x)
+    return l.m_x < r.m_x;
+  if (l.m_y != r.m_y)
+    return l.m_y < r.m_y;
+  return l.m_density < r.m_density;
+}
+
+string DebugPrint(RasterTileKey const & key)
+{
+  ostringstream out;
+  out << key.m_zoom << "/" << key.m_x << "/" << key.m_y << "@" << graphics::convert(key.m_density);
+  return out.str();
+}
+
+RasterTileServer::RasterTileServer(model::FeaturesFetcher const & model) : m_model(model) {}
+
+RasterTileServer::~RasterTileServer() {}
+
+size_t RasterTileServer::Render(RasterTileKey const & key, FrameImage & image)
+{
+  unique_ptr<CPUDrawer> drawer = TakeDrawer(key.m_density);
+  MY_SCOPE_GUARD(returnDrawer, [&]() { ReturnDrawer(key.m_density, move(drawer)); });
+
+  size_t const featuresCount = DrawFrame(*drawer, GetTileRect(key.m_zoom, key.m_x, key.m_y),
+                                         GetTileSize(key.m_density), key.m_density);
+  drawer->EndFrame(image);
+  return featuresCount;
+}
+
+RasterTileServer::Stats RasterTileServer::RenderAll(vector<RasterTileKey> const & keys,
+                                                    size_t threadsCount, TTileFn const & fn)
+{
+  atomic<size_t> bytesCount(0);
+  atomic<size_t> featuresCount(0);
+  Stats stats;
+  my::Timer timer;
+  threads::RunInThreads(keys.size(), threadsCount, [&]()
+  {
+    return [&](size_t i)
+    {
+      FrameImage image;
+      featuresCount += Render(keys[i], image);
+      bytesCount += image.m_data.size();
+      fn(keys[i], image);
+    };
+  });
+  stats.m_seconds = timer.ElapsedSeconds();
+
+  stats.m_tilesCount = keys.size();
+  stats.m_bytesCount = bytesCount;
+  stats.m_featuresCount = featuresCount;
+  return stats;
+}
+
+size_t RasterTileServer::RenderMetatile(RasterTileKey const & key, int metaSize,
+                                        vector<RasterTileKey> & keys, vector<FrameImage> & images)
+{
+  MetatileLayout layout;
+  GetMetatileLayout(key, metaSize, layout);
+
+  unique_ptr<CPUDrawer> drawer = TakeDrawer(key.m_density);
+  MY_SCOPE_GUARD(returnDrawer, [&]() { ReturnDrawer(key.m_density, move(drawer)); });
+
+  size_t const featuresCount =
+      DrawFrame(*drawer, layout.m_rect, layout.m_frameSize, key.m_density);
+  drawer->EndFrame(layout.m_pxRects, images);
+  keys.swap(layout.m_keys);
+  return featuresCount;
+}
+
+RasterTileServer::Stats RasterTileServer::RenderAllMetatiles(vector<RasterTileKey> const & keys,
+                                                             int metaSize, size_t threadsCount,
+                                                             TTileFn const & fn)
+{
+  CHECK_GREATER(metaSize, 0, ());
+
+  set<RasterTileKey> const requested(keys.begin(), keys.end());
+
+  // Metatiles are denoted by their top left tiles.
+  set<RasterTileKey> metatilesSet;
+  for (RasterTileKey const & key : requested)
+  {
+    int const size = GetMetatileSize(metaSize, key.m_zoom, key.m_density);
+    metatilesSet.emplace(key.m_zoom, key.m_x - key.m_x % size, key.m_y - key.m_y % size,
+                         key.m_density);
+  }
+  vector<RasterTileKey> const metatiles(metatilesSet.begin(), metatilesSet.end());
+
+  atomic<size_t> bytesCount(0);
+  atomic<size_t> featuresCount(0);
+  Stats stats;
+  my::Timer timer;
+  threads::RunInThreads(metatiles.size(), threadsCount, [&]()
+  {
+    return [&](size_t i)
+    {
+      vector<RasterTileKey> tiles;
+      vector<FrameImage> images;
+      featuresCount += RenderMetatile(metatiles[i], metaSize, tiles, images);
+      for (size_t j = 0; j < tiles.size(); ++j)
+      {
+        if (requested.count(tiles[j]) == 0)
+          continue;
+        bytesCount += images[j].m_data.size();
+        fn(tiles[j], images[j]);
+      }
+    };
+  });
+  stats.m_seconds = timer.ElapsedSeconds();
+
+  stats.m_tilesCount = requested.size();
+  stats.m_bytesCount = bytesCount;
+  stats.m_featuresCount = featuresCount;
+  return stats;
+}
+
+// static
+m2::RectD RasterTileServer::GetTileRect(int zoom, int x, int y)
+{
+  ASSERT_GREATER_OR_EQUAL(zoom, 0, ());
+  ASSERT_LESS(zoom, 31, ());
+
+  double const size = (MercatorBounds::maxX - MercatorBounds::minX) / (1 << zoom);
+  double const minX = MercatorBounds::minX + x * size;
+  double const maxY = MercatorBounds::maxY - y * size;
+  return m2::RectD(minX, maxY - size, minX + size, maxY);
+}
+
+// static
+uint32_t RasterTileServer::GetTileSize(graphics::EDensity density)
+{
+  return static_cast<uint32_t>(my::rounds(kBaseTileSize * graphics::visualScale(density)));
+}
+
+// static
+int RasterTileServer::GetMetatileSize(int metaSize, int zoom, graphics::EDensity density)
+{
+  CHECK_GREATER(metaSize, 0, ());
+  ASSERT_GREATER_OR_EQUAL(zoom, 0, ());
+  ASSERT_LESS(zoom, 31, ());
+
+  // A frame of size tiles takes (size + 1) tiles with margins.
+  uint32_t const tileSize = GetTileSize(density);
+  int size = 1;
+  while (2 * size <= metaSize && 2 * size <= (1 << zoom) &&
+         (2 * size + 1) * tileSize <= kMaxMetatileFrameSize)
+  {
+    size *= 2;
+  }
+  return size;
+}
+
+// static
+void RasterTileServer::GetMetatileLayout(RasterTileKey const & key, int metaSize,
+                                         MetatileLayout & layout)
+{
+  int const size = GetMetatileSize(metaSize, key.m_zoom, key.m_density);
+  int const minX = key.m_x - key.m_x % size;
+  int const minY = key.m_y - key.m_y % size;
+
+  // Captions near outer borders of the metatile are laid out in the margin,
+  // so they aren't clipped by the frame.
+  uint32_t const tileSize = GetTileSize(key.m_density);
+  uint32_t const margin = tileSize / 2;
+  layout.m_frameSize = size * tileSize + 2 * margin;
+
+  layout.m_rect = GetTileRect(key.m_zoom, minX, minY);
+  layout.m_rect.Add(GetTileRect(key.m_zoom, minX + size - 1, minY + size - 1));
+  double const marginSize = margin * layout.m_rect.SizeX() / (size * tileSize);
+  layout.m_rect.Inflate(marginSize, marginSize);
+
+  layout.m_keys.clear();
+  layout.m_pxRects.clear();
+  for (int y = 0; y < size; ++y)
+  {
+    for (int x = 0; x < size; ++x)
+    {
+      layout.m_keys.emplace_back(key.m_zoom, minX + x, minY + y, key.m_density);
+      layout.m_pxRects.emplace_back(margin + x * tileSize, margin + y * tileSize,
+                                    margin + (x + 1) * tileSize, margin + (y + 1) * tileSize);
+    }
+  }
+}
+
+size_t RasterTileServer::DrawFrame(CPUDrawer & drawer, m2::RectD const & rect, uint32_t frameSize,
+                                   graphics::EDensity density)
+{
+  ScalesProcessor scales;
+  scales.SetParams(graphics::visualScale(density), GetTileSize(density));
+
+  ScreenBase const screen(m2::RectI(0, 0, frameSize, frameSize), m2::AnyRectD(rect));
+
+  // The same rects and scales as in Framework::DrawModel for tiling queries.
+  m2::RectD const renderRect(0, 0, frameSize, frameSize);
+  m2::RectD selectRect;
+  m2::RectD clipRect;
+  double const inflationSize = scales.GetClipRectInflation();
+  screen.PtoG(m2::Inflate(renderRect, inflationSize, inflationSize), clipRect);
+  screen.PtoG(renderRect, selectRect);
+
+  int const upperScale = scales::GetUpperScale();
+  int const drawScale = scales.GetDrawTileScale(scales.GetTileScaleBase(screen));
+
+  drawer.BeginFrame(frameSize, frameSize,
+                    ConvertColor(drule::rules().GetBgColor(min(drawScale, upperScale))));
+
+  shared_ptr<PaintEvent> event = make_shared<PaintEvent>(&drawer);
+  fwork::FeatureProcessor doDraw(clipRect, screen, event, drawScale);
+  size_t featuresCount = 0;
+  auto doCountAndDraw = [&](FeatureType const & f)
+  {
+    ++featuresCount;
+    return doDraw(f);
+  };
+
+  try
+  {
+    if (drawScale <= upperScale)
+      m_model.ForEachFeature_TileDrawing(selectRect, doCountAndDraw, drawScale);
+    else
+      m_model.ForEachFeature(selectRect, doCountAndDraw, upperScale);
+  }
+  catch (redraw_operation_cancelled const &)
+  {}
+
+  drawer.Flush();
+  return featuresCount;
+}
+
+unique_ptr<CPUDrawer> RasterTileServer::TakeDrawer(graphics::EDensity density)
+{
+  {
+    lock_guard<mutex> lock(m_drawersMutex);
+    auto & drawers = m_freeDrawers[density];
+    if (!drawers.empty())
+    {
+      unique_ptr<CPUDrawer> drawer = move(drawers.back());
+      drawers.pop_back();
+      return drawer;
+    }
+  }
+
+  // Drawers are created out of the lock because the glyph cache and the skin are loaded here.
+  CPUDrawer::Params params(GetGlyphCacheParams(density));
+  params.m_visualScale = graphics::visualScale(density);
+  params.m_density = density;
+  return make_unique<CPUDrawer>(params);
+}
+
+void RasterTileServer::ReturnDrawer(graphics::EDensity density, unique_ptr<CPUDrawer> && drawer)
+{
+  lock_guard<mutex> lock(m_drawersMutex);
+  m_freeDrawers[density].push_back(move(drawer));
+}
+#endif // USE_DRAPE
@@ -0,0 +1,127 @@
+#pragma once
+
+#ifndef USE_DRAPE
+#include "render/frame_image.hpp"
+
+#include "graphics/defines.hpp"
+
+#include "geometry/rect2d.hpp"
+
+#include "std/function.hpp"
+#include "std/map.hpp"
+#include "std/mutex.hpp"
+#include "std/string.hpp"
+#include "std/unique_ptr.hpp"
+#include "std/vector.hpp"
+
+class CPUDrawer;
+
+namespace model
+{
+class FeaturesFetcher;
+}
+
+/// Tile of the XYZ (slippy map) tiling scheme, y axis goes from the north to the south.
+struct RasterTileKey
+{
+  RasterTileKey() = default;
+  RasterTileKey(int zoom, int x, int y, graphics::EDensity density)
+    : m_zoom(zoom), m_x(x), m_y(y), m_density(density)
+  {
+  }
+
+  int m_zoom = 0;
+  int m_x = 0;
+  int m_y = 0;
+  graphics::EDensity m_density = graphics::EDensityMDPI;
+};
+
+bool operator<(RasterTileKey const & l, RasterTileKey const & r);
+string DebugPrint(RasterTileKey const & key);
+
+/// Headless renderer of raster tiles on the CPU. Features are read from the shared model and
+/// styled with the global drawing rules, every rendering thread takes its own CPUDrawer (with
+/// its own glyph cache and skin) from the pool, so all methods are thread-safe.
+class RasterTileServer
+{
+public:
+  /// Size of a tile in pixels for the mdpi density, it's scaled by the visual scale for others.
+  static int const kBaseTileSize = 256;
+  /// Default number of tiles along a side of a metatile.
+  static int const kMetatileSize = 8;
+  /// Maximal width and height of a metatile frame in pixels. The frame of 8x8 xhdpi tiles
+  /// with margins takes about 85 MB.
+  static uint32_t const kMaxMetatileFrameSize = 4608;
+
+  using TTileFn = function<void(RasterTileKey const &, FrameImage const &)>;
+
+  struct Stats
+  {
+    size_t m_tilesCount = 0;
+    size_t m_bytesCount = 0;
+    /// Number of features read and styled, a feature is counted once for every frame it's drawn in.
+    size_t m_featuresCount = 0;
+    double m_seconds = 0.0;
+
+    double GetTilesPerSecond() const { return m_seconds > 0.0 ? m_tilesCount / m_seconds : 0.0; }
+  };
+
+  /// Tiles of a metatile and their pixel rects in the metatile frame.
+  struct MetatileLayout
+  {
+    /// Mercator rect of the frame including margins.
+    m2::RectD m_rect;
+    uint32_t m_frameSize = 0;
+    vector<RasterTileKey> m_keys;
+    vector<m2::RectU> m_pxRects;
+  };
+
+  /// @param model Model with registered maps, it must outlive the server.
+  explicit RasterTileServer(model::FeaturesFetcher const & model);
+  ~RasterTileServer();
+
+  /// Renders the tile to PNG in the calling thread.
+  /// @return Number of features drawn.
+  size_t Render(RasterTileKey const & key, FrameImage & image);
+
+  /// Renders tiles in threadsCount threads, fn is called from rendering threads.
+  Stats RenderAll(vector<RasterTileKey> const & keys, size_t threadsCount, TTileFn const & fn);
+
+  /// Renders the aligned block of tiles which contains the tile as one frame, see GetMetatileSize:
+  /// features are read once and captions are laid out once for the whole block, so they aren't
+  /// clipped or duplicated on borders of inner tiles. Then the frame is sliced into tiles.
+  /// @return Number of features drawn.
+  size_t RenderMetatile(RasterTileKey const & key, int metaSize, vector<RasterTileKey> & keys,
+                        vector<FrameImage> & images);
+
+  /// Renders metatiles which contain tiles in threadsCount threads, fn is called only for
+  /// requested tiles.
+  Stats RenderAllMetatiles(vector<RasterTileKey> const & keys, int metaSize, size_t threadsCount,
+                           TTileFn const & fn);
+
+  /// @return Mercator rect of the tile.
+  static m2::RectD GetTileRect(int zoom, int x, int y);
+  static uint32_t GetTileSize(graphics::EDensity density);
+
+  /// @return Number of tiles along a side of metatiles of the zoom. It's metaSize rounded down
+  /// to a power of two, so metatiles are aligned and don't go out of 2^zoom x 2^zoom tiles,
+  /// and reduced to fit frames into kMaxMetatileFrameSize.
+  static int GetMetatileSize(int metaSize, int zoom, graphics::EDensity density);
+  /// Lays out the metatile of GetMetatileSize() tiles which contains the tile.
+  static void GetMetatileLayout(RasterTileKey const & key, int metaSize, MetatileLayout & layout);
+
+private:
+  /// Draws features of the mercator rect to the frame of the drawer.
+  /// @return Number of features drawn.
+  size_t DrawFrame(CPUDrawer & drawer, m2::RectD const & rect, uint32_t frameSize,
+                   graphics::EDensity density);
+
+  unique_ptr<CPUDrawer> TakeDrawer(graphics::EDensity density);
+  void ReturnDrawer(graphics::EDensity density, unique_ptr<CPUDrawer> && drawer);
+
+  model::FeaturesFetcher const & m_model;
+
+  mutex m_drawersMutex;
+  map<graphics::EDensity, vector<unique_ptr<CPUDrawer>>> m_freeDrawers;
+};
+#endif // USE_DRAPE
@@ -0,0 +1,130 @@
+#include "map/feature_vec_model.hpp"
+#include "map/raster_tile_server.hpp"
+
+#include "indexer/classificator_loader.hpp"
+#include "indexer/mercator.hpp"
+
+#include "platform/local_country_file_utils.hpp"
+#include "platform/platform.hpp"
+
+#include "coding/file_name_utils.hpp"
+#include "coding/file_writer.hpp"
+
+#include "base/logging.hpp"
+#include "base/math.hpp"
+
+#include "std/fstream.hpp"
+#include "std/sstream.hpp"
+#include "std/thread.hpp"
+
+#include "3party/gflags/src/gflags/gflags.h"
+
+
+DEFINE_string(data_path, "", "Directory with MWM files, the writable directory if empty.");
+DEFINE_string(user_resource_path, "", "User defined resource path for classificator.txt, skins and fonts.");
+DEFINE_string(tiles, "", "File with tiles to render, one 'zoom x y' triple per line.");
+DEFINE_int32(zoom, -1, "Render all tiles of the zoom level which cover registered maps, if no tiles file.");
+DEFINE_string(density, "mdpi", "Density of tiles: ldpi, mdpi, hdpi, xhdpi, xxhdpi or 6plus.");
+DEFINE_int32(metatile, RasterTileServer::kMetatileSize,
+             "Number of tiles along a side of a metatile rendered in one pass, 1 renders tiles one by one. "
+             "It's rounded down to a power of two and reduced for big tiles.");
+DEFINE_int32(threads, 0, "Number of rendering threads, the number of cores if 0.");
+DEFINE_string(output_path, "", "Directory for zoom_x_y.png tiles, tiles aren't saved if empty.");
+
+namespace
+{
+void ReadTiles(string const & fileName, graphics::EDensity density, vector<RasterTileKey> & keys)
+{
+  ifstream file(fileName);
+  RasterTileKey key;
+  key.m_density = density;
+  while (file >> key.m_zoom >> key.m_x >> key.m_y)
+    keys.push_back(key);
+}
+
+void CoverRect(m2::RectD const & rect, int zoom, graphics::EDensity density,
+               vector<RasterTileKey> & keys)
+{
+  int const maxIndex = (1 << zoom) - 1;
+  double const size = (MercatorBounds::maxX - MercatorBounds::minX) / (1 << zoom);
+  auto const toIndex = [&](double v)
+  {
+    return my::clamp(static_cast<int>(floor(v / size)), 0, maxIndex);
+  };
+
+  int const minX = toIndex(rect.minX() - MercatorBounds::minX);
+  int const maxX = toIndex(rect.maxX() - MercatorBounds::minX);
+  int const minY = toIndex(MercatorBounds::maxY - rect.maxY());
+  int const maxY = toIndex(MercatorBounds::maxY - rect.minY());
+  for (int y = minY; y <= maxY; ++y)
+  {
+    for (int x = minX; x <= maxX; ++x)
+      keys.emplace_back(zoom, x, y, density);
+  }
+}
+}  // namespace
+
+int main(int argc, char ** argv)
+{
+  google::SetUsageMessage("Renders raster PNG tiles of registered maps on the CPU.");
+  google::ParseCommandLineFlags(&argc, &argv, true);
+
+  Platform & pl = GetPlatform();
+  if (!FLAGS_user_resource_path.empty())
+    pl.SetResourceDir(FLAGS_user_resource_path);
+  if (!FLAGS_data_path.empty())
+    pl.SetWritableDirForTests(my::AddSlashIfNeeded(FLAGS_data_path));
+
+  classificator::Load();
+
+  model::FeaturesFetcher model;
+  vector<platform::LocalCountryFile> localFiles;
+  platform::FindAllLocalMaps(localFiles);
+  for (auto & localFile : localFiles)
+  {
+    localFile.SyncWithDisk();
+    model.RegisterMap(localFile);
+  }
+
+  graphics::EDensity density;
+  graphics::convert(FLAGS_density.c_str(), density);
+
+  vector<RasterTileKey> keys;
+  if (!FLAGS_tiles.empty())
+    ReadTiles(FLAGS_tiles, density, keys);
+  else if (FLAGS_zoom >= 0)
+    CoverRect(model.GetWorldRect(), FLAGS_zoom, density, keys);
+
+  if (keys.empty())
+  {
+    LOG(LWARNING, ("No tiles to render, set --tiles or --zoom."));
+    return 1;
+  }
+
+  size_t const threadsCount = FLAGS_threads > 0 ? FLAGS_threads
+                                                : max(1u, thread::hardware_concurrency());
+  LOG(LINFO, ("Rendering", keys.size(), "tiles in", threadsCount, "threads."));
+
+  auto const saveTile = [](RasterTileKey const & key, FrameImage const & image)
+  {
+    if (FLAGS_output_path.empty())
+      return;
+
+    ostringstream name;
+    name << key.m_zoom << "_" << key.m_x << "_" << key.m_y << ".png";
+    FileWriter writer(my::JoinFoldersToPath(FLAGS_output_path, name.str()));
+    writer.Write(image.m_data.data(), image.m_data.size());
+  };
+
+  RasterTileServer server(model);
+  RasterTileServer::Stats const stats =
+      FLAGS_metatile > 1 ? server.RenderAllMetatiles(keys, FLAGS_metatile, threadsCount, saveTile)
+                         : server.RenderAll(keys, threadsCount, saveTile);
+
+  LOG(LINFO, ("Rendered", stats.m_tilesCount, "tiles,", stats.m_bytesCount, "bytes in",
+              stats.m_seconds, "seconds:", stats.GetTilesPerSecond(), "tiles/s,",
+              stats.GetTilesPerSecond() / threadsCount, "tiles/s per thread."));
+  LOG(LINFO, ("Features drawn:", stats.m_featuresCount, "per tile:",
+              static_cast<double>(stats.m_featuresCount) / stats.m_tilesCount));
+  return 0;
+}
@@ -0,0 +1,21 @@
+# Headless raster tile server.
+
+TARGET = tile_server_tool
+CONFIG += console warn_on
+CONFIG -= app_bundle
+TEMPLATE = app
+
+ROOT_DIR = ../..
+DEPENDENCIES = map render gui routing search storage graphics indexer platform anim geometry coding base \
+               freetype fribidi expat protobuf tomcrypt jansson osrm stats_client minizip succinct gflags
+
+include($$ROOT_DIR/common.pri)
+
+INCLUDEPATH *= $$ROOT_DIR/3party/gflags/src
+
+QT *= core
+
+macx-*: LIBS *= "-framework IOKit" "-framework SystemConfiguration"
+
+SOURCES += \
+    main.cpp \
@@ -59,6 +59,10 @@ SUBDIRS += routing
     SUBDIRS += qt
   }
 
+  CONFIG(desktop):!CONFIG(drape) {
+    SUBDIRS += map/tile_server_tool
+  }
+
   CONFIG(map_designer):CONFIG(desktop) {
     SUBDIRS += skin_generator
   }
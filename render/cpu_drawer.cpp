@@ -294,6 +294,17 @@ void CPUDrawer::DrawSearchArrow(double azimut)
 void CPUDrawer::EndFrame(FrameImage & image)
 {
   m_renderer->EndFrame(image);
+  ClearFrame();
+}
+
+void CPUDrawer::EndFrame(vector<m2::RectU> const & rects, vector<FrameImage> & images)
+{
+  m_renderer->EndFrame(rects, images);
+  ClearFrame();
+}
+
+void CPUDrawer::ClearFrame()
+{
   m_stylers.clear();
   m_areasGeometry.clear();
   m_pathGeometry.clear();
@@ -31,6 +31,8 @@ public:
     void DrawSearchResult(m2::PointD const & pxPosition);
     void DrawSearchArrow(double azimut);
   void EndFrame(FrameImage & image);
+  /// Slices the frame into images of pixel rects, overlays are laid out once for the whole frame.
+  void EndFrame(vector<m2::RectU> const & rects, vector<FrameImage> & images);
 
   graphics::GlyphCache * GetGlyphCache() override { return m_renderer->GetGlyphCache(); }
 
@@ -55,6 +57,7 @@ protected:
 
 private:
   void Render();
+  void ClearFrame();
 
 private:
   unique_ptr<SoftwareRenderer> m_renderer;
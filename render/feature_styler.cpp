@@ -31,13 +31,12 @@ namespace
     }
   };
 
-  void FilterRulesByRuntimeSelector(FeatureType const & ft, int zoom, drule::KeysT & keys)
+  void FilterRulesByRuntimeSelector(FeatureType const & ft, int zoom, drule::TableRulesT & rules)
   {
-    keys.erase_if([&ft, zoom](drule::Key const & key)->bool
+    rules.erase_if([&ft, zoom](drule::TableRule const & rule)->bool
     {
-      drule::BaseRule const * const rule = drule::rules().Find(key);
-      ASSERT(rule != nullptr, ());
-      return !rule->TestFeature(ft, zoom);
+      ASSERT(rule.m_rule != nullptr, ());
+      return !rule.m_rule->TestFeature(ft, zoom);
     });
   }
 }
@@ -71,7 +70,7 @@ namespace di
       m_convertor(convertor),
       m_rect(rect)
   {
-    drule::KeysT keys;
+    drule::TableRulesT keys;
     pair<int, bool> type = feature::GetDrawRule(f, zoom, keys);
 
     FilterRulesByRuntimeSelector(f, zoom, keys);
@@ -149,13 +148,13 @@ namespace di
 
     for (size_t i = 0; i < count; ++i)
     {
-      double depth = keys[i].m_priority;
+      double depth = keys[i].m_key.m_priority;
 
       if (layer != 0 && depth < 19000)
       {
-        if (keys[i].m_type == drule::line || keys[i].m_type == drule::waymarker)
+        if (keys[i].m_key.m_type == drule::line || keys[i].m_key.m_type == drule::waymarker)
           depth = (layer * drule::layer_base_priority) + fmod(depth, drule::layer_base_priority);
-        else if (keys[i].m_type == drule::area)
+        else if (keys[i].m_key.m_type == drule::area)
         {
           // Use raw depth adding in area feature layers
           // (avoid overlap linear objects in case of "fmod").
@@ -163,18 +162,18 @@ namespace di
         }
       }
 
-      if (keys[i].m_type == drule::symbol || keys[i].m_type == drule::circle)
+      if (keys[i].m_key.m_type == drule::symbol || keys[i].m_key.m_type == drule::circle)
         hasIcon = true;
 
-      if ((keys[i].m_type == drule::caption && hasName)
-       || (keys[i].m_type == drule::symbol)
-       || (keys[i].m_type == drule::circle))
+      if ((keys[i].m_key.m_type == drule::caption && hasName)
+       || (keys[i].m_key.m_type == drule::symbol)
+       || (keys[i].m_key.m_type == drule::circle))
         m_hasPointStyles = true;
 
-      if (keys[i].m_type == drule::caption
-       || keys[i].m_type == drule::symbol
-       || keys[i].m_type == drule::circle
-       || keys[i].m_type == drule::pathtext)
+      if (keys[i].m_key.m_type == drule::caption
+       || keys[i].m_key.m_type == drule::symbol
+       || keys[i].m_key.m_type == drule::circle
+       || keys[i].m_key.m_type == drule::pathtext)
       {
         // show labels of larger objects first
         depth += priorityModifier;
@@ -182,23 +181,23 @@ namespace di
         if (m_geometryType == feature::GEOM_POINT)
           ++depth;
       }
-      else if (keys[i].m_type == drule::area)
+      else if (keys[i].m_key.m_type == drule::area)
       {
         // show smaller polygons on top
         depth -= priorityModifier;
       }
 
-      if (!m_hasLineStyles && (keys[i].m_type == drule::line))
+      if (!m_hasLineStyles && (keys[i].m_key.m_type == drule::line))
         m_hasLineStyles = true;
 
-      m_rules[i] = di::DrawRule(drule::rules().Find(keys[i]), depth);
+      m_rules[i] = di::DrawRule(keys[i].m_rule, depth);
 
-      if (m_rules[i].m_rule->GetCaption(1) != 0)
+      if (keys[i].m_hasAuxCaption)
         hasSecondaryText = true;
 
-      CaptionDefProto const * pCap0 = m_rules[i].m_rule->GetCaption(0);
-      if (pCap0)
+      if (keys[i].m_hasCaption)
       {
+        CaptionDefProto const * pCap0 = m_rules[i].m_rule->GetCaption(0);
         textType = m_rules[i].m_rule->GetCaptionTextType(0);
 
         if (!m_hasPathText && hasName && (m_geometryType == feature::GEOM_LINE))
@@ -209,7 +208,7 @@ namespace di
             m_fontSize = max(m_fontSize, GetTextFontSize(m_rules[i].m_rule));
         }
 
-        if (keys[i].m_type == drule::caption)
+        if (keys[i].m_key.m_type == drule::caption)
           hasCaptionWithoutOffset = !(pCap0->has_offset_y() || pCap0->has_offset_x());
       }
     }
@@ -268,7 +267,7 @@ namespace di
       // we need to delete symbol style and circle style
       for (size_t i = 0; i < m_rules.size();)
       {
-        if (keys[i].m_type == drule::symbol || keys[i].m_type == drule::circle)
+        if (keys[i].m_key.m_type == drule::symbol || keys[i].m_key.m_type == drule::circle)
         {
           m_rules[i] = m_rules[m_rules.size() - 1];
           m_rules.pop_back();
@@ -577,6 +577,39 @@ void SoftwareRenderer::EndFrame(FrameImage & image)
   m_frameHeight = 0;
 }
 
+void SoftwareRenderer::EndFrame(vector<m2::RectU> const & rects, vector<FrameImage> & images)
+{
+  ASSERT(m_frameWidth > 0 && m_frameHeight > 0, ());
+
+  images.resize(rects.size());
+  vector<uint8_t> buffer;
+  for (size_t i = 0; i < rects.size(); ++i)
+  {
+    m2::RectU const & rect = rects[i];
+    CHECK_LESS_OR_EQUAL(rect.maxX(), m_frameWidth, ("Tile is out of the frame."));
+    CHECK_LESS_OR_EQUAL(rect.maxY(), m_frameHeight, ("Tile is out of the frame."));
+
+    uint32_t const width = rect.SizeX();
+    uint32_t const height = rect.SizeY();
+    uint32_t const rowSize = width * 4;
+    buffer.resize(rowSize * height);
+    for (uint32_t row = 0; row < height; ++row)
+    {
+      auto const src = m_frameBuffer.begin() + ((rect.minY() + row) * m_frameWidth + rect.minX()) * 4;
+      copy(src, src + rowSize, buffer.begin() + row * rowSize);
+    }
+
+    FrameImage & image = images[i];
+    image.m_stride = width;
+    image.m_width = width;
+    image.m_height = height;
+    il::EncodePngToMemory(width, height, buffer, image.m_data);
+  }
+
+  m_frameWidth = 0;
+  m_frameHeight = 0;
+}
+
 m2::RectD SoftwareRenderer::FrameRect() const
 {
   return m2::RectD(0.0, 0.0, m_frameWidth, m_frameHeight);
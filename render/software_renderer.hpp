@@ -6,6 +6,7 @@
 #include "text_engine.h"
 
 #include "geometry/point2d.hpp"
+#include "geometry/rect2d.hpp"
 
 #include "graphics/icon.hpp"
 #include "graphics/circle.hpp"
@@ -24,6 +25,7 @@
 
 #include "std/cstdint.hpp"
 #include "std/unique_ptr.hpp"
+#include "std/vector.hpp"
 
 
 class PathWrapper;
@@ -70,6 +72,8 @@ public:
                              vector<m2::RectD> & rects);
 
   void EndFrame(FrameImage & image);
+  /// Encodes every pixel rect of the frame to its own image, e.g. to slice a metatile into tiles.
+  void EndFrame(vector<m2::RectU> const & rects, vector<FrameImage> & images);
   m2::RectD FrameRect() const;
 
   graphics::GlyphCache * GetGlyphCache() { return m_glyphCache.get(); }
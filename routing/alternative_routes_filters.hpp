@@ -0,0 +1,80 @@
+#pragma once
+
+#include "std/vector.hpp"
+
+#include "3party/osrm/osrm-backend/data_structures/internal_route_result.hpp"
+
+namespace routing
+{
+/// Quality filters for alternative routes. All the values are fractions of the shortest route
+/// weight.
+struct AlternativeRoutesParams
+{
+  /// Maximal count of routes in the result including the shortest one.
+  size_t m_maxCount = 3;
+  /// Bounded stretch: an alternative is at most (1 + m_maxStretch) times longer than
+  /// the shortest route.
+  double m_maxStretch = 0.15;
+  /// Detour stretch: the part of an alternative which isn't shared with the shortest route
+  /// is at most (1 + m_maxDetourStretch) times longer than the part it replaces.
+  double m_maxDetourStretch = 0.1;
+  /// Limited sharing: an alternative shares at most m_maxSharing with already chosen routes.
+  double m_maxSharing = 0.75;
+  /// Local optimality: every subpath around the via node that is shorter than
+  /// m_localOptimality must be a shortest path.
+  double m_localOptimality = 0.1;
+};
+
+/// Bounded stretch of the whole route and of its detour.
+/// @param sharing  Weight of the route part which is shared with the shortest route.
+inline bool PassesStretch(AlternativeRoutesParams const & params, int weight, int sharing,
+                          int shortestWeight)
+{
+  if (weight >= shortestWeight * (1. + params.m_maxStretch))
+    return false;
+  // The detour must not be much longer than the part of the shortest path it replaces.
+  return weight - sharing < (1. + params.m_maxDetourStretch) * (shortestWeight - sharing);
+}
+
+inline bool PassesSharing(AlternativeRoutesParams const & params, int sharing, int shortestWeight)
+{
+  return sharing <= shortestWeight * params.m_maxSharing;
+}
+
+/// T-test: the subpath of the via path which covers m_localOptimality * shortestWeight before
+/// and after the via node must be the shortest path between its ends.
+/// @param getShortestWeight  getShortestWeight(from, to) returns the shortest path weight.
+template <class TGetShortestWeight>
+bool IsLocallyOptimal(AlternativeRoutesParams const & params, vector<PathData> const & path,
+                      NodeID via, int shortestWeight, TGetShortestWeight && getShortestWeight)
+{
+  size_t viaIndex = 0;
+  while (viaIndex < path.size() && path[viaIndex].node != via)
+    ++viaIndex;
+  if (viaIndex == path.size())
+    return false;
+
+  int const threshold = static_cast<int>(params.m_localOptimality * shortestWeight);
+
+  size_t begin = viaIndex;
+  int beforeWeight = 0;
+  while (begin > 0 && beforeWeight < threshold)
+  {
+    beforeWeight += path[begin].segment_duration;
+    --begin;
+  }
+
+  size_t end = viaIndex;
+  int afterWeight = 0;
+  while (end + 1 < path.size() && afterWeight < threshold)
+  {
+    ++end;
+    afterWeight += path[end].segment_duration;
+  }
+
+  if (begin == end)
+    return true;
+
+  return getShortestWeight(path[begin].node, path[end].node) >= beforeWeight + afterWeight;
+}
+}  // namespace routing
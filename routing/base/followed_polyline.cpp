@@ -1,5 +1,21 @@
 #include "followed_polyline.hpp"
 
+#include "base/math.hpp"
+
+#include "std/algorithm.hpp"
+#include "std/cmath.hpp"
+
+namespace
+{
+// Polylines with less segments are matched by the linear scan.
+size_t constexpr kMinSegmentsCountForIndex = 64;
+
+uint64_t GetCellKey(pair<uint32_t, uint32_t> const & cell)
+{
+  return (static_cast<uint64_t>(cell.first) << 32) | cell.second;
+}
+}  // namespace
+
 namespace routing
 {
 
@@ -67,6 +83,12 @@ void FollowedPolyline::Swap(FollowedPolyline & rhs)
   m_segDistance.swap(rhs.m_segDistance);
   m_segProj.swap(rhs.m_segProj);
   swap(m_current, rhs.m_current);
+  swap(m_gridOrigin, rhs.m_gridOrigin);
+  swap(m_cellSize, rhs.m_cellSize);
+  swap(m_gridMaxCell, rhs.m_gridMaxCell);
+  m_cellKeys.swap(rhs.m_cellKeys);
+  m_cellOffsets.swap(rhs.m_cellOffsets);
+  m_cellSegments.swap(rhs.m_cellSegments);
 }
 
 void FollowedPolyline::Update()
@@ -91,23 +113,143 @@ void FollowedPolyline::Update()
   }
 
   m_current = Iter(m_poly.Front(), 0);
+
+  BuildSegmentsIndex();
+}
+
+void FollowedPolyline::BuildSegmentsIndex()
+{
+  m_cellSize = 0.0;
+  m_cellKeys.clear();
+  m_cellOffsets.clear();
+  m_cellSegments.clear();
+
+  size_t const count = m_segProj.size();
+  if (count < kMinSegmentsCountForIndex)
+    return;
+
+  double length = 0.0;
+  for (size_t i = 0; i < count; ++i)
+    length += m_poly.GetPoint(i).Length(m_poly.GetPoint(i + 1));
+  if (length <= 0.0)
+    return;
+
+  // The average segment length is used as the cell size, so a segment usually lies in a few cells
+  // and the grid has no more than count cells along any axis.
+  m2::RectD const limitRect = m_poly.GetLimitRect();
+  m_gridOrigin = limitRect.LeftBottom();
+  m_cellSize = length / count;
+  m_gridMaxCell = make_pair(static_cast<uint32_t>(limitRect.SizeX() / m_cellSize),
+                            static_cast<uint32_t>(limitRect.SizeY() / m_cellSize));
+
+  // Every segment is sampled with the step of a half of the cell, so any point of the segment
+  // lies in a sampled cell or in a neighbour of a sampled cell.
+  vector<pair<uint64_t, uint32_t>> cells;
+  for (size_t i = 0; i < count; ++i)
+  {
+    m2::PointD const & p1 = m_poly.GetPoint(i);
+    m2::PointD const & p2 = m_poly.GetPoint(i + 1);
+    size_t const steps = static_cast<size_t>(2.0 * p1.Length(p2) / m_cellSize) + 1;
+    for (size_t step = 0; step <= steps; ++step)
+    {
+      m2::PointD const pt = p1 + (p2 - p1) * (static_cast<double>(step) / steps);
+      cells.emplace_back(GetCellKey(GetCell(pt)), static_cast<uint32_t>(i));
+    }
+  }
+  sort(cells.begin(), cells.end());
+  cells.erase(unique(cells.begin(), cells.end()), cells.end());
+
+  m_cellSegments.reserve(cells.size());
+  for (auto const & cell : cells)
+  {
+    if (m_cellKeys.empty() || m_cellKeys.back() != cell.first)
+    {
+      m_cellKeys.push_back(cell.first);
+      m_cellOffsets.push_back(static_cast<uint32_t>(m_cellSegments.size()));
+    }
+    m_cellSegments.push_back(cell.second);
+  }
+  m_cellOffsets.push_back(static_cast<uint32_t>(m_cellSegments.size()));
+}
+
+pair<uint32_t, uint32_t> FollowedPolyline::GetCell(m2::PointD const & pt) const
+{
+  ASSERT_GREATER(m_cellSize, 0.0, ());
+  double const x = floor((pt.x - m_gridOrigin.x) / m_cellSize);
+  double const y = floor((pt.y - m_gridOrigin.y) / m_cellSize);
+  return make_pair(static_cast<uint32_t>(my::clamp(x, 0.0, static_cast<double>(m_gridMaxCell.first))),
+                   static_cast<uint32_t>(my::clamp(y, 0.0, static_cast<double>(m_gridMaxCell.second))));
+}
+
+bool FollowedPolyline::GetCandidateSegments(m2::RectD const & rect, size_t begin, size_t end,
+                                            vector<uint32_t> & candidates) const
+{
+  if (m_cellKeys.empty())
+    return false;
+
+  // Neighbour cells are checked too, see BuildSegmentsIndex.
+  pair<uint32_t, uint32_t> minCell = GetCell(rect.LeftBottom());
+  pair<uint32_t, uint32_t> maxCell = GetCell(rect.RightTop());
+  minCell.first = minCell.first > 0 ? minCell.first - 1 : 0;
+  minCell.second = minCell.second > 0 ? minCell.second - 1 : 0;
+  maxCell.first = min(maxCell.first + 1, m_gridMaxCell.first);
+  maxCell.second = min(maxCell.second + 1, m_gridMaxCell.second);
+
+  // It's cheaper to check all segments of the window than to visit a lot of cells.
+  uint64_t const cellsCount = static_cast<uint64_t>(maxCell.first - minCell.first + 1) *
+                              (maxCell.second - minCell.second + 1);
+  if (cellsCount > end - begin)
+    return false;
+
+  candidates.clear();
+  for (uint32_t x = minCell.first; x <= maxCell.first; ++x)
+  {
+    for (uint32_t y = minCell.second; y <= maxCell.second; ++y)
+    {
+      auto const it = lower_bound(m_cellKeys.begin(), m_cellKeys.end(), GetCellKey(make_pair(x, y)));
+      if (it == m_cellKeys.end() || *it != GetCellKey(make_pair(x, y)))
+        continue;
+      size_t const cell = distance(m_cellKeys.begin(), it);
+      for (uint32_t i = m_cellOffsets[cell]; i < m_cellOffsets[cell + 1]; ++i)
+      {
+        uint32_t const segment = m_cellSegments[i];
+        if (segment >= begin && segment < end)
+          candidates.push_back(segment);
+      }
+    }
+  }
+  sort(candidates.begin(), candidates.end());
+  candidates.erase(unique(candidates.begin(), candidates.end()), candidates.end());
+  return true;
+}
+
+size_t FollowedPolyline::GetWindowEnd(double maxDistanceAheadM) const
+{
+  size_t const count = m_poly.GetSize() - 1;
+  if (maxDistanceAheadM >= GetTotalDistanceM())
+    return count;
+
+  // Segment i starts at m_segDistance[i - 1] meters from the beginning.
+  double const limit = GetDistanceFromBeginM() + maxDistanceAheadM;
+  size_t const end = distance(m_segDistance.begin(),
+                              upper_bound(m_segDistance.begin(), m_segDistance.end(), limit)) + 1;
+  return min(end, count);
 }
 
 template <class DistanceFn>
-Iter FollowedPolyline::GetClosestProjection(m2::RectD const & posRect,
+Iter FollowedPolyline::GetClosestProjection(m2::RectD const & posRect, double maxDistanceAheadM,
                                             DistanceFn const & distFn) const
 {
   Iter res;
   double minDist = numeric_limits<double>::max();
 
   m2::PointD const currPos = posRect.Center();
-  size_t const count = m_poly.GetSize() - 1;
-  for (size_t i = m_current.m_ind; i < count; ++i)
+  auto const checkSegment = [&](size_t i)
   {
     m2::PointD const pt = m_segProj[i](currPos);
 
     if (!posRect.IsPointInside(pt))
-      continue;
+      return;
 
     Iter it(pt, i);
     double const dp = distFn(it);
@@ -116,22 +258,39 @@ Iter FollowedPolyline::GetClosestProjection(m2::RectD const & posRect,
       res = it;
       minDist = dp;
     }
+  };
+
+  size_t const begin = m_current.m_ind;
+  size_t const end = GetWindowEnd(maxDistanceAheadM);
+
+  // Candidates are checked in the order of the linear scan, so the result is the same.
+  vector<uint32_t> candidates;
+  if (GetCandidateSegments(posRect, begin, end, candidates))
+  {
+    for (uint32_t const i : candidates)
+      checkSegment(i);
+  }
+  else
+  {
+    for (size_t i = begin; i < end; ++i)
+      checkSegment(i);
   }
 
   return res;
 }
 
 Iter FollowedPolyline::UpdateProjectionByPrediction(m2::RectD const & posRect,
-                                                    double predictDistance) const
+                                                    double predictDistance,
+                                                    double maxDistanceAheadM) const
 {
   ASSERT(m_current.IsValid(), ());
   ASSERT_LESS(m_current.m_ind, m_poly.GetSize() - 1, ());
 
   if (predictDistance <= 0.0)
-    return UpdateProjection(posRect);
+    return UpdateProjection(posRect, maxDistanceAheadM);
 
   Iter res;
-  res = GetClosestProjection(posRect, [&](Iter const & it)
+  res = GetClosestProjection(posRect, maxDistanceAheadM, [&](Iter const & it)
   {
     return fabs(GetDistanceM(m_current, it) - predictDistance);
   });
@@ -141,14 +300,15 @@ Iter FollowedPolyline::UpdateProjectionByPrediction(m2::RectD const & posRect,
   return res;
 }
 
-Iter FollowedPolyline::UpdateProjection(m2::RectD const & posRect) const
+Iter FollowedPolyline::UpdateProjection(m2::RectD const & posRect,
+                                        double maxDistanceAheadM) const
 {
   ASSERT(m_current.IsValid(), ());
   ASSERT_LESS(m_current.m_ind, m_poly.GetSize() - 1, ());
 
   Iter res;
   m2::PointD const currPos = posRect.Center();
-  res = GetClosestProjection(posRect, [&](Iter const & it)
+  res = GetClosestProjection(posRect, maxDistanceAheadM, [&](Iter const & it)
   {
     return MercatorBounds::DistanceOnEarth(it.m_pt, currPos);
   });
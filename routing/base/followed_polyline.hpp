@@ -5,6 +5,10 @@
 #include "geometry/point2d.hpp"
 #include "geometry/polyline2d.hpp"
 
+#include "std/limits.hpp"
+#include "std/utility.hpp"
+#include "std/vector.hpp"
+
 namespace routing
 {
 class FollowedPolyline
@@ -50,8 +54,13 @@ public:
 
   double GetDistanceM(Iter const & it1, Iter const & it2) const;
 
-  Iter UpdateProjectionByPrediction(m2::RectD const & posRect, double predictDistance) const;
-  Iter UpdateProjection(m2::RectD const & posRect) const;
+  /// Projection methods look for the projection not farther than maxDistanceAheadM meters
+  /// along the route from the current position.
+  Iter UpdateProjectionByPrediction(
+      m2::RectD const & posRect, double predictDistance,
+      double maxDistanceAheadM = numeric_limits<double>::max()) const;
+  Iter UpdateProjection(m2::RectD const & posRect,
+                        double maxDistanceAheadM = numeric_limits<double>::max()) const;
 
   Iter Begin() const;
   Iter End() const;
@@ -59,9 +68,22 @@ public:
 
 private:
   template <class DistanceFn>
-  Iter GetClosestProjection(m2::RectD const & posRect, DistanceFn const & distFn) const;
+  Iter GetClosestProjection(m2::RectD const & posRect, double maxDistanceAheadM,
+                            DistanceFn const & distFn) const;
+
+  /// \return index of the segment after the last one which starts not farther
+  /// than maxDistanceAheadM meters from the current position.
+  size_t GetWindowEnd(double maxDistanceAheadM) const;
+
+  /// Fills candidates with sorted indexes of segments from [begin, end) which may intersect rect.
+  /// \return false if the index can't help and all segments should be checked.
+  bool GetCandidateSegments(m2::RectD const & rect, size_t begin, size_t end,
+                            vector<uint32_t> & candidates) const;
+
+  pair<uint32_t, uint32_t> GetCell(m2::PointD const & pt) const;
 
   void Update();
+  void BuildSegmentsIndex();
 
   m2::PolylineD m_poly;
 
@@ -71,6 +93,16 @@ private:
   vector<m2::ProjectionToSection<m2::PointD>> m_segProj;
   /// Accumulated cache of segments length in meters.
   vector<double> m_segDistance;
+
+  /// Grid index of segments. A segment is stored in all cells it crosses.
+  /// Cells are stored in the compressed sparse row format sorted by the cell key.
+  /// The index is empty for short polylines.
+  m2::PointD m_gridOrigin;
+  double m_cellSize = 0.0;
+  pair<uint32_t, uint32_t> m_gridMaxCell;
+  vector<uint64_t> m_cellKeys;
+  vector<uint32_t> m_cellOffsets;
+  vector<uint32_t> m_cellSegments;
 };
 
 }  // namespace routing
@@ -0,0 +1,309 @@
+#include "routing/cross_mwm_overlay.hpp"
+
+#include "indexer/point_to_int64.hpp"
+
+#include "coding/read_write_utils.hpp"
+#include "coding/reader_wrapper.hpp"
+#include "coding/varint.hpp"
+#include "coding/write_to_sink.hpp"
+
+#include "base/assert.hpp"
+#include "base/logging.hpp"
+
+#include "std/algorithm.hpp"
+#include "std/map.hpp"
+
+namespace
+{
+uint32_t constexpr kCoordBits = POINT_COORD_BITS;
+uint8_t constexpr kOverlayFormatVersion = 0;
+}  // namespace
+
+namespace routing
+{
+void CrossMwmOverlayGraph::Load(Reader const & r)
+{
+  Clear();
+  ReaderSource<SubReaderWrapper<Reader const>> src((SubReaderWrapper<Reader const>(&r)));
+
+  uint8_t const version = ReadPrimitiveFromSource<uint8_t>(src);
+  CHECK_EQUAL(version, kOverlayFormatVersion, ("Unknown cross mwm overlay format."));
+
+  rw::Read(src, m_mwmNames);
+  m_mwmTimestamps.resize(m_mwmNames.size());
+  for (auto & timestamp : m_mwmTimestamps)
+    timestamp = ReadPrimitiveFromSource<uint32_t>(src);
+
+  uint32_t const verticesCount = ReadVarUint<uint32_t>(src);
+  m_vertices.resize(verticesCount);
+  for (auto & v : m_vertices)
+  {
+    v.m_fromMwm = ReadVarUint<uint32_t>(src);
+    v.m_fromNode = ReadPrimitiveFromSource<TWrittenNodeId>(src);
+    v.m_toMwm = ReadVarUint<uint32_t>(src);
+    v.m_toNode = ReadPrimitiveFromSource<TWrittenNodeId>(src);
+    m2::PointD const pt = Int64ToPoint(ReadPrimitiveFromSource<uint64_t>(src), kCoordBits);
+    v.m_point = ms::LatLon(pt.y, pt.x);
+  }
+
+  m_edgeOffsets.resize(verticesCount + 1);
+  m_edgeOffsets[0] = 0;
+  for (uint32_t i = 0; i < verticesCount; ++i)
+    m_edgeOffsets[i + 1] = m_edgeOffsets[i] + ReadVarUint<uint32_t>(src);
+
+  m_edges.resize(m_edgeOffsets.back());
+  for (auto & e : m_edges)
+  {
+    e.m_target = ReadVarUint<uint32_t>(src);
+    e.m_weight = ReadVarUint<uint32_t>(src);
+  }
+
+  BuildOutgoingIndex();
+  LOG(LINFO, ("Cross mwm overlay loaded. Mwms:", m_mwmNames.size(), "vertices:",
+              m_vertices.size(), "edges:", m_edges.size()));
+}
+
+void CrossMwmOverlayGraph::Save(Writer & w) const
+{
+  WriteToSink(w, kOverlayFormatVersion);
+
+  rw::Write(w, m_mwmNames);
+  for (uint32_t const timestamp : m_mwmTimestamps)
+    WriteToSink(w, timestamp);
+
+  WriteVarUint(w, static_cast<uint32_t>(m_vertices.size()));
+  for (auto const & v : m_vertices)
+  {
+    WriteVarUint(w, v.m_fromMwm);
+    WriteToSink(w, v.m_fromNode);
+    WriteVarUint(w, v.m_toMwm);
+    WriteToSink(w, v.m_toNode);
+    WriteToSink(w, PointToInt64(m2::PointD(v.m_point.lon, v.m_point.lat), kCoordBits));
+  }
+
+  ASSERT_EQUAL(m_edgeOffsets.size(), m_vertices.size() + 1, ());
+  for (size_t i = 0; i + 1 < m_edgeOffsets.size(); ++i)
+    WriteVarUint(w, m_edgeOffsets[i + 1] - m_edgeOffsets[i]);
+
+  for (auto const & e : m_edges)
+  {
+    WriteVarUint(w, e.m_target);
+    WriteVarUint(w, e.m_weight);
+  }
+}
+
+void CrossMwmOverlayGraph::Clear()
+{
+  m_mwmNames.clear();
+  m_mwmTimestamps.clear();
+  m_vertices.clear();
+  m_edgeOffsets.clear();
+  m_edges.clear();
+  m_outgoingIndex.clear();
+  m_mwmIndexes.clear();
+}
+
+string const & CrossMwmOverlayGraph::GetMwmName(TOverlayMwmIndex mwm) const
+{
+  ASSERT_LESS(mwm, m_mwmNames.size(), ());
+  return m_mwmNames[mwm];
+}
+
+uint32_t CrossMwmOverlayGraph::GetMwmTimestamp(TOverlayMwmIndex mwm) const
+{
+  ASSERT_LESS(mwm, m_mwmTimestamps.size(), ());
+  return m_mwmTimestamps[mwm];
+}
+
+TOverlayMwmIndex CrossMwmOverlayGraph::GetMwmIndex(string const & name) const
+{
+  auto const it = m_mwmIndexes.find(name);
+  return it == m_mwmIndexes.end() ? kInvalidOverlayMwmIndex : it->second;
+}
+
+bool CrossMwmOverlayGraph::IsMwmUpToDate(TOverlayMwmIndex mwm, uint32_t timestamp) const
+{
+  uint32_t const overlayTimestamp = GetMwmTimestamp(mwm);
+  return overlayTimestamp != kAbsentOverlayMwmTimestamp && overlayTimestamp == timestamp;
+}
+
+OverlayVertex const & CrossMwmOverlayGraph::GetVertex(TOverlayVertexIndex v) const
+{
+  ASSERT_LESS(v, m_vertices.size(), ());
+  return m_vertices[v];
+}
+
+TOverlayVertexIndex CrossMwmOverlayGraph::FindVertexByIngoing(TOverlayMwmIndex toMwm,
+                                                              TWrittenNodeId toNode) const
+{
+  auto const it = lower_bound(m_vertices.begin(), m_vertices.end(), make_pair(toMwm, toNode),
+                              [](OverlayVertex const & v, pair<TOverlayMwmIndex, TWrittenNodeId> const & key)
+                              {
+                                return make_pair(v.m_toMwm, v.m_toNode) < key;
+                              });
+  if (it == m_vertices.end() || it->m_toMwm != toMwm || it->m_toNode != toNode)
+    return kInvalidOverlayVertexIndex;
+  return static_cast<TOverlayVertexIndex>(distance(m_vertices.begin(), it));
+}
+
+TOverlayVertexIndex CrossMwmOverlayGraph::FindVertexByOutgoing(TOverlayMwmIndex fromMwm,
+                                                               TWrittenNodeId fromNode,
+                                                               ms::LatLon const & point) const
+{
+  auto const key = make_pair(fromMwm, fromNode);
+  auto const less = [this](TOverlayVertexIndex v, pair<TOverlayMwmIndex, TWrittenNodeId> const & key)
+  {
+    return make_pair(m_vertices[v].m_fromMwm, m_vertices[v].m_fromNode) < key;
+  };
+
+  // One outgoing node may cross the border several times, so we choose the nearest crossing.
+  TOverlayVertexIndex result = kInvalidOverlayVertexIndex;
+  double minDistance = numeric_limits<double>::max();
+  for (auto it = lower_bound(m_outgoingIndex.begin(), m_outgoingIndex.end(), key, less);
+       it != m_outgoingIndex.end(); ++it)
+  {
+    OverlayVertex const & v = m_vertices[*it];
+    if (v.m_fromMwm != fromMwm || v.m_fromNode != fromNode)
+      break;
+    double const d = fabs(v.m_point.lat - point.lat) + fabs(v.m_point.lon - point.lon);
+    if (d < minDistance)
+    {
+      minDistance = d;
+      result = *it;
+    }
+  }
+  return result;
+}
+
+void CrossMwmOverlayGraph::BuildOutgoingIndex()
+{
+  m_outgoingIndex.resize(m_vertices.size());
+  for (size_t i = 0; i < m_vertices.size(); ++i)
+    m_outgoingIndex[i] = static_cast<TOverlayVertexIndex>(i);
+  sort(m_outgoingIndex.begin(), m_outgoingIndex.end(),
+       [this](TOverlayVertexIndex l, TOverlayVertexIndex r)
+       {
+         return make_pair(m_vertices[l].m_fromMwm, m_vertices[l].m_fromNode) <
+                make_pair(m_vertices[r].m_fromMwm, m_vertices[r].m_fromNode);
+       });
+
+  m_mwmIndexes.clear();
+  for (size_t i = 0; i < m_mwmNames.size(); ++i)
+    m_mwmIndexes[m_mwmNames[i]] = static_cast<TOverlayMwmIndex>(i);
+}
+
+void CrossMwmOverlayWriter::AddMwm(string const & name, uint32_t timestamp,
+                                   CrossRoutingContextReader const & context)
+{
+  m_mwms.push_back({name, timestamp, &context});
+}
+
+void CrossMwmOverlayWriter::Build(CrossMwmOverlayGraph & graph) const
+{
+  graph.Clear();
+
+  map<string, TOverlayMwmIndex> mwmIndexes;
+  for (size_t i = 0; i < m_mwms.size(); ++i)
+  {
+    graph.m_mwmNames.push_back(m_mwms[i].m_name);
+    graph.m_mwmTimestamps.push_back(m_mwms[i].m_timestamp);
+    mwmIndexes[m_mwms[i].m_name] = static_cast<TOverlayMwmIndex>(i);
+  }
+
+  // Crossing candidates with the corresponding ingoing node of the neighbour mwm
+  // and the adjacency index of the outgoing node in the source mwm.
+  struct Crossing
+  {
+    OverlayVertex m_vertex;
+    IngoingCrossNode m_ingoing;
+    size_t m_outgoingAdjacencyIndex;
+  };
+  vector<Crossing> crossings;
+
+  size_t unmatched = 0;
+  size_t absent = 0;
+  for (size_t i = 0; i < m_mwms.size(); ++i)
+  {
+    CrossRoutingContextReader const & context = *m_mwms[i].m_context;
+    context.ForEachOutgoingNode([&](OutgoingCrossNode const & node)
+    {
+      string const & nextMwm = context.GetOutgoingMwmName(node);
+      auto it = mwmIndexes.find(nextMwm);
+      if (it == mwmIndexes.end() || it->second >= m_mwms.size())
+      {
+        // The neighbour mwm is unknown, so the crossing is resolved by its cross context
+        // at routing time.
+        if (it == mwmIndexes.end())
+        {
+          auto const absentMwm = static_cast<TOverlayMwmIndex>(graph.m_mwmNames.size());
+          it = mwmIndexes.insert(make_pair(nextMwm, absentMwm)).first;
+          graph.m_mwmNames.push_back(nextMwm);
+          graph.m_mwmTimestamps.push_back(kAbsentOverlayMwmTimestamp);
+        }
+        Crossing c;
+        c.m_vertex = OverlayVertex(static_cast<TOverlayMwmIndex>(i), node.m_nodeId, it->second,
+                                   kInvalidContextEdgeNodeId, node.m_point);
+        c.m_outgoingAdjacencyIndex = node.m_adjacencyIndex;
+        crossings.push_back(c);
+        ++absent;
+        return;
+      }
+
+      IngoingCrossNode ingoing;
+      if (!m_mwms[it->second].m_context->FindIngoingNodeByPoint(node.m_point, ingoing))
+      {
+        ++unmatched;
+        return;
+      }
+      Crossing c;
+      c.m_vertex = OverlayVertex(static_cast<TOverlayMwmIndex>(i), node.m_nodeId, it->second,
+                                 ingoing.m_nodeId, ingoing.m_point);
+      c.m_ingoing = ingoing;
+      c.m_outgoingAdjacencyIndex = node.m_adjacencyIndex;
+      crossings.push_back(c);
+    });
+  }
+
+  sort(crossings.begin(), crossings.end(), [](Crossing const & l, Crossing const & r)
+  {
+    return make_pair(l.m_vertex.m_toMwm, l.m_vertex.m_toNode) <
+           make_pair(r.m_vertex.m_toMwm, r.m_vertex.m_toNode);
+  });
+
+  // Vertexes leaving each mwm by the outgoing node adjacency index.
+  vector<map<size_t, TOverlayVertexIndex>> leaving(m_mwms.size());
+  for (size_t v = 0; v < crossings.size(); ++v)
+  {
+    Crossing const & c = crossings[v];
+    graph.m_vertices.push_back(c.m_vertex);
+    leaving[c.m_vertex.m_fromMwm][c.m_outgoingAdjacencyIndex] = static_cast<TOverlayVertexIndex>(v);
+  }
+
+  graph.m_edgeOffsets.push_back(0);
+  for (Crossing const & c : crossings)
+  {
+    if (c.m_vertex.m_toMwm >= m_mwms.size())
+    {
+      graph.m_edgeOffsets.push_back(static_cast<uint32_t>(graph.m_edges.size()));
+      continue;
+    }
+    CrossRoutingContextReader const & context = *m_mwms[c.m_vertex.m_toMwm].m_context;
+    auto const & targets = leaving[c.m_vertex.m_toMwm];
+    context.ForEachOutgoingNode([&](OutgoingCrossNode const & node)
+    {
+      TWrittenEdgeWeight const weight = context.GetAdjacencyCost(c.m_ingoing, node);
+      if (weight == kInvalidContextEdgeWeight || weight == 0)
+        return;
+      auto const it = targets.find(node.m_adjacencyIndex);
+      if (it != targets.end())
+        graph.m_edges.emplace_back(it->second, weight);
+    });
+    graph.m_edgeOffsets.push_back(static_cast<uint32_t>(graph.m_edges.size()));
+  }
+
+  graph.BuildOutgoingIndex();
+  LOG(LINFO, ("Cross mwm overlay built. Vertices:", graph.m_vertices.size(), "edges:",
+              graph.m_edges.size(), "unmatched outgoing nodes:", unmatched,
+              "crossings to absent mwms:", absent));
+}
+}  // namespace routing
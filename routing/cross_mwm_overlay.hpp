@@ -0,0 +1,154 @@
+#pragma once
+
+#include "routing/cross_routing_context.hpp"
+
+#include "coding/reader.hpp"
+#include "coding/writer.hpp"
+
+#include "geometry/latlon.hpp"
+
+#include "std/limits.hpp"
+#include "std/string.hpp"
+#include "std/unordered_map.hpp"
+#include "std/utility.hpp"
+#include "std/vector.hpp"
+
+namespace routing
+{
+using TOverlayMwmIndex = uint32_t;
+using TOverlayVertexIndex = uint32_t;
+
+TOverlayMwmIndex constexpr kInvalidOverlayMwmIndex = numeric_limits<TOverlayMwmIndex>::max();
+TOverlayVertexIndex constexpr kInvalidOverlayVertexIndex = numeric_limits<TOverlayVertexIndex>::max();
+/// Timestamp of an mwm which is referenced by border crossings but was absent when the overlay
+/// was built. Crossings into such mwm have no ingoing node and must be resolved lazily.
+uint32_t constexpr kAbsentOverlayMwmTimestamp = 0;
+
+/// Border crossing stored in the overlay graph: it leaves mwm m_fromMwm by the outgoing OSRM node
+/// m_fromNode and enters mwm m_toMwm by the ingoing OSRM node m_toNode at the point m_point.
+/// If m_toMwm was absent when the overlay was built m_toNode is kInvalidContextEdgeNodeId
+/// and m_point is the point of the outgoing node.
+struct OverlayVertex
+{
+  TOverlayMwmIndex m_fromMwm;
+  TWrittenNodeId m_fromNode;
+  TOverlayMwmIndex m_toMwm;
+  TWrittenNodeId m_toNode;
+  ms::LatLon m_point;
+
+  OverlayVertex()
+    : m_fromMwm(kInvalidOverlayMwmIndex)
+    , m_fromNode(kInvalidContextEdgeNodeId)
+    , m_toMwm(kInvalidOverlayMwmIndex)
+    , m_toNode(kInvalidContextEdgeNodeId)
+    , m_point(ms::LatLon::Zero())
+  {
+  }
+
+  OverlayVertex(TOverlayMwmIndex fromMwm, TWrittenNodeId fromNode, TOverlayMwmIndex toMwm,
+                TWrittenNodeId toNode, ms::LatLon const & point)
+    : m_fromMwm(fromMwm), m_fromNode(fromNode), m_toMwm(toMwm), m_toNode(toNode), m_point(point)
+  {
+  }
+};
+
+/// Edge between two border crossings through the single mwm OverlayVertex::m_toMwm of the source.
+struct OverlayEdge
+{
+  TOverlayVertexIndex m_target;
+  TWrittenEdgeWeight m_weight;
+
+  OverlayEdge() : m_target(kInvalidOverlayVertexIndex), m_weight(kInvalidContextEdgeWeight) {}
+  OverlayEdge(TOverlayVertexIndex target, TWrittenEdgeWeight weight)
+    : m_target(target), m_weight(weight)
+  {
+  }
+};
+
+/*!
+ * \brief Offline-built overlay graph over the border crossings of all mwms.
+ * It is stored in the CROSS_MWM_OVERLAY_FILE near the maps and is small enough to be kept
+ * in memory, so the cross mwm search doesn't need to load cross contexts of transit mwms.
+ * Vertices are sorted by (m_toMwm, m_toNode) and edges are stored in the compressed
+ * sparse row format.
+ */
+class CrossMwmOverlayGraph
+{
+public:
+  void Load(Reader const & r);
+  void Save(Writer & w) const;
+  void Clear();
+
+  bool IsEmpty() const { return m_vertices.empty(); }
+
+  size_t GetMwmCount() const { return m_mwmNames.size(); }
+  string const & GetMwmName(TOverlayMwmIndex mwm) const;
+  uint32_t GetMwmTimestamp(TOverlayMwmIndex mwm) const;
+  /// \return kInvalidOverlayMwmIndex if there is no mwm with the name in the overlay.
+  TOverlayMwmIndex GetMwmIndex(string const & name) const;
+  /// \return true if the overlay was built from the routing data of the mwm with the timestamp,
+  /// i.e. its ingoing nodes and edges can be used instead of the cross context of the mwm.
+  bool IsMwmUpToDate(TOverlayMwmIndex mwm, uint32_t timestamp) const;
+
+  size_t GetVertexCount() const { return m_vertices.size(); }
+  size_t GetEdgeCount() const { return m_edges.size(); }
+  OverlayVertex const & GetVertex(TOverlayVertexIndex v) const;
+
+  /// Finds a vertex which enters mwm toMwm by the ingoing node toNode.
+  /// \return kInvalidOverlayVertexIndex if there is no such vertex.
+  TOverlayVertexIndex FindVertexByIngoing(TOverlayMwmIndex toMwm, TWrittenNodeId toNode) const;
+
+  /// Finds a vertex which leaves mwm fromMwm by the outgoing node fromNode at point.
+  /// \return kInvalidOverlayVertexIndex if there is no such vertex.
+  TOverlayVertexIndex FindVertexByOutgoing(TOverlayMwmIndex fromMwm, TWrittenNodeId fromNode,
+                                           ms::LatLon const & point) const;
+
+  template <class TFunctor>
+  void ForEachOutgoingEdge(TOverlayVertexIndex v, TFunctor && f) const
+  {
+    ASSERT_LESS(v + 1, m_edgeOffsets.size(), ());
+    for (uint32_t i = m_edgeOffsets[v]; i < m_edgeOffsets[v + 1]; ++i)
+      f(m_edges[i]);
+  }
+
+private:
+  friend class CrossMwmOverlayWriter;
+
+  void BuildOutgoingIndex();
+
+  vector<string> m_mwmNames;
+  vector<uint32_t> m_mwmTimestamps;
+  vector<OverlayVertex> m_vertices;
+  vector<uint32_t> m_edgeOffsets;
+  vector<OverlayEdge> m_edges;
+
+  // Vertex indexes sorted by (m_fromMwm, m_fromNode).
+  vector<TOverlayVertexIndex> m_outgoingIndex;
+  unordered_map<string, TOverlayMwmIndex> m_mwmIndexes;
+};
+
+/// Helper class to build the cross mwm overlay graph from cross contexts of all mwms.
+class CrossMwmOverlayWriter
+{
+public:
+  /// Adds the cross context of the mwm. timestamp is the mwm version timestamp, it is used to
+  /// check consistency of the overlay with routing files.
+  /// \warning The context must be alive until Build is called.
+  void AddMwm(string const & name, uint32_t timestamp, CrossRoutingContextReader const & context);
+
+  /// Matches outgoing nodes with ingoing nodes of neighbour mwms and builds overlay edges.
+  /// Crossings into mwms which were not added are kept as vertices to the mwm with
+  /// the kAbsentOverlayMwmTimestamp timestamp.
+  void Build(CrossMwmOverlayGraph & graph) const;
+
+private:
+  struct MwmData
+  {
+    string m_name;
+    uint32_t m_timestamp;
+    CrossRoutingContextReader const * m_context;
+  };
+
+  vector<MwmData> m_mwms;
+};
+}  // namespace routing
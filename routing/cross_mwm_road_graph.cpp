@@ -135,19 +135,39 @@ BorderCross CrossMwmGraph::ConstructBorderCross(OutgoingCrossNode const & startN
   if (it != m_cachedNextNodes.end())
     return it->second;
 
+  // Try to find the cross in the overlay without loading the next mwm.
+  TOverlayMwmIndex const overlayMwm = GetOverlayMwmIndex(currentMapping->GetMwmId());
+  if (overlayMwm != kInvalidOverlayMwmIndex)
+  {
+    TOverlayVertexIndex const vertex =
+        m_overlay->FindVertexByOutgoing(overlayMwm, startNode.m_nodeId, startNode.m_point);
+    if (vertex != kInvalidOverlayVertexIndex)
+    {
+      BorderCross const cross = ConstructBorderCross(m_overlay->GetVertex(vertex));
+      if (cross.toNode.IsValid())
+      {
+        m_cachedNextNodes.insert(make_pair(key, cross));
+        return cross;
+      }
+    }
+  }
+
   // Cache miss case.
   BorderCross cross;
-  if (!ConstructBorderCrossImpl(startNode, currentMapping, cross))
+  if (!ConstructBorderCrossImpl(startNode.m_nodeId, currentMapping->GetMwmId(), startNode.m_point,
+                                currentMapping->m_crossContext.GetOutgoingMwmName(startNode),
+                                cross))
+  {
     return BorderCross();
+  }
   m_cachedNextNodes.insert(make_pair(key, cross));
   return cross;
 }
 
-bool CrossMwmGraph::ConstructBorderCrossImpl(OutgoingCrossNode const & startNode,
-                                             TRoutingMappingPtr const & currentMapping,
+bool CrossMwmGraph::ConstructBorderCrossImpl(TWrittenNodeId fromNode, Index::MwmId const & fromId,
+                                             ms::LatLon const & point, string const & nextMwm,
                                              BorderCross & cross) const
 {
-  string const & nextMwm = currentMapping->m_crossContext.GetOutgoingMwmName(startNode);
   TRoutingMappingPtr nextMapping = m_indexManager.GetMappingByName(nextMwm);
   // If we haven't this routing file, we skip this path.
   if (!nextMapping->IsValid())
@@ -155,10 +175,10 @@ bool CrossMwmGraph::ConstructBorderCrossImpl(OutgoingCrossNode const & startNode
   nextMapping->LoadCrossContext();
 
   IngoingCrossNode ingoingNode;
-  if (nextMapping->m_crossContext.FindIngoingNodeByPoint(startNode.m_point, ingoingNode))
+  if (nextMapping->m_crossContext.FindIngoingNodeByPoint(point, ingoingNode))
   {
     auto const & targetPoint = ingoingNode.m_point;
-    cross = BorderCross(CrossNode(startNode.m_nodeId, currentMapping->GetMwmId(), targetPoint),
+    cross = BorderCross(CrossNode(fromNode, fromId, targetPoint),
                         CrossNode(ingoingNode.m_nodeId, nextMapping->GetMwmId(), targetPoint));
     return true;
   }
@@ -177,6 +197,24 @@ void CrossMwmGraph::GetOutgoingEdgesList(BorderCross const & v,
     return;
   }
 
+  // Transit mwm expansion through the overlay graph.
+  TOverlayMwmIndex const overlayMwm = GetOverlayMwmIndex(v.toNode.mwmId);
+  if (overlayMwm != kInvalidOverlayMwmIndex)
+  {
+    TOverlayVertexIndex const vertex = m_overlay->FindVertexByIngoing(overlayMwm, v.toNode.node);
+    if (vertex != kInvalidOverlayVertexIndex)
+    {
+      m_overlay->ForEachOutgoingEdge(vertex, [&](OverlayEdge const & edge)
+                                     {
+                                       BorderCross const target =
+                                           ConstructBorderCross(m_overlay->GetVertex(edge.m_target));
+                                       if (target.toNode.IsValid())
+                                         adj.emplace_back(target, edge.m_weight);
+                                     });
+      return;
+    }
+  }
+
   // Loading cross routing section.
   TRoutingMappingPtr currentMapping = m_indexManager.GetMappingById(v.toNode.mwmId);
   ASSERT(currentMapping->IsValid(), ());
@@ -211,6 +249,78 @@ void CrossMwmGraph::GetOutgoingEdgesList(BorderCross const & v,
                                      });
 }
 
+TOverlayMwmIndex CrossMwmGraph::GetOverlayMwmIndex(Index::MwmId const & mwmId) const
+{
+  if (m_overlay == nullptr || !mwmId.IsAlive())
+    return kInvalidOverlayMwmIndex;
+
+  auto const it = m_overlayMwmIndexes.find(mwmId);
+  if (it != m_overlayMwmIndexes.end())
+    return it->second;
+
+  TOverlayMwmIndex mwm = m_overlay->GetMwmIndex(mwmId.GetInfo()->GetCountryName());
+  if (mwm != kInvalidOverlayMwmIndex &&
+      !m_overlay->IsMwmUpToDate(mwm, mwmId.GetInfo()->m_version.timestamp))
+  {
+    if (m_overlay->GetMwmTimestamp(mwm) != kAbsentOverlayMwmTimestamp)
+      LOG(LWARNING, ("Cross mwm overlay is out of date for", mwmId));
+    mwm = kInvalidOverlayMwmIndex;
+  }
+  m_overlayMwmIndexes.insert(make_pair(mwmId, mwm));
+  return mwm;
+}
+
+Index::MwmId const & CrossMwmGraph::GetOverlayMwmId(TOverlayMwmIndex mwm) const
+{
+  ASSERT(m_overlay, ());
+  if (m_overlayMwmIds.empty())
+  {
+    m_overlayMwmIds.resize(m_overlay->GetMwmCount());
+    m_overlayMwmIdsResolved.resize(m_overlay->GetMwmCount(), false);
+  }
+  ASSERT_LESS(mwm, m_overlayMwmIds.size(), ());
+
+  if (!m_overlayMwmIdsResolved[mwm])
+  {
+    m_overlayMwmIdsResolved[mwm] = true;
+    Index::MwmId const id = m_indexManager.GetMwmIdByName(m_overlay->GetMwmName(mwm));
+    if (id.IsAlive() && GetOverlayMwmIndex(id) == mwm)
+      m_overlayMwmIds[mwm] = id;
+  }
+  return m_overlayMwmIds[mwm];
+}
+
+BorderCross CrossMwmGraph::ConstructBorderCross(OverlayVertex const & vertex) const
+{
+  Index::MwmId const & fromId = GetOverlayMwmId(vertex.m_fromMwm);
+  // If we haven't the routing file, we skip this path.
+  if (!fromId.IsAlive())
+    return BorderCross();
+
+  Index::MwmId const & toId = GetOverlayMwmId(vertex.m_toMwm);
+  if (toId.IsAlive())
+  {
+    return BorderCross(CrossNode(vertex.m_fromNode, fromId, vertex.m_point),
+                       CrossNode(vertex.m_toNode, toId, vertex.m_point));
+  }
+
+  // The next mwm was absent when the overlay was built or it has another version,
+  // so we match the crossing by its cross context as without the overlay.
+  auto const key = make_pair(vertex.m_fromNode, fromId);
+  auto const it = m_cachedNextNodes.find(key);
+  if (it != m_cachedNextNodes.end())
+    return it->second;
+
+  BorderCross cross;
+  if (!ConstructBorderCrossImpl(vertex.m_fromNode, fromId, vertex.m_point,
+                                m_overlay->GetMwmName(vertex.m_toMwm), cross))
+  {
+    return BorderCross();
+  }
+  m_cachedNextNodes.insert(make_pair(key, cross));
+  return cross;
+}
+
 double CrossMwmGraph::HeuristicCostEstimate(BorderCross const & v, BorderCross const & w) const
 {
   // Simple travel time heuristic works worse than simple Dijkstra's algorithm, represented by
@@ -1,5 +1,6 @@
 #pragma once
 
+#include "cross_mwm_overlay.hpp"
 #include "osrm_engine.hpp"
 #include "osrm_router.hpp"
 #include "router.hpp"
@@ -106,6 +107,13 @@ public:
 
   explicit CrossMwmGraph(RoutingIndexManager & indexManager) : m_indexManager(indexManager) {}
 
+  /// When overlay is not empty transit mwms are expanded with the overlay graph and
+  /// their cross contexts are not loaded. Mwms absent in the overlay are expanded lazily.
+  CrossMwmGraph(RoutingIndexManager & indexManager, CrossMwmOverlayGraph const & overlay)
+    : m_indexManager(indexManager), m_overlay(overlay.IsEmpty() ? nullptr : &overlay)
+  {
+  }
+
   void GetOutgoingEdgesList(BorderCross const & v, vector<CrossWeightedEdge> & adj) const;
   void GetIngoingEdgesList(BorderCross const & /* v */,
                            vector<CrossWeightedEdge> & /* adj */) const
@@ -123,9 +131,10 @@ private:
   BorderCross ConstructBorderCross(OutgoingCrossNode const & startNode,
                                    TRoutingMappingPtr const & currentMapping) const;
 
-  // Pure function to construct boder cross by outgoing cross node.
-  bool ConstructBorderCrossImpl(OutgoingCrossNode const & startNode,
-                                TRoutingMappingPtr const & currentMapping,
+  // Pure function to construct boder cross by outgoing node fromNode of the mwm fromId
+  // at point which leads to the mwm nextMwm. Loads cross context of nextMwm.
+  bool ConstructBorderCrossImpl(TWrittenNodeId fromNode, Index::MwmId const & fromId,
+                                ms::LatLon const & point, string const & nextMwm,
                                 BorderCross & cross) const;
   /*!
    * Adds a virtual edge to the graph so that it is possible to represent
@@ -136,10 +145,28 @@ private:
   void AddVirtualEdge(IngoingCrossNode const & node, CrossNode const & finalNode,
                       EdgeWeight weight);
 
+  // Returns overlay index of the mwm or kInvalidOverlayMwmIndex if the mwm is absent in
+  // the overlay or the overlay was built for another version of the mwm.
+  TOverlayMwmIndex GetOverlayMwmIndex(Index::MwmId const & mwmId) const;
+
+  // Returns mwm id by the overlay index. The id is not alive if there is no
+  // routing file for the mwm.
+  Index::MwmId const & GetOverlayMwmId(TOverlayMwmIndex mwm) const;
+
+  // Makes border cross by the overlay vertex. If the target mwm was absent or has another
+  // version in the overlay the cross is constructed by the cross context of the target mwm.
+  // Returns invalid cross if there is no routing file for the source or the target mwm.
+  BorderCross ConstructBorderCross(OverlayVertex const & vertex) const;
+
   map<CrossNode, vector<CrossWeightedEdge> > m_virtualEdges;
 
   mutable RoutingIndexManager m_indexManager;
 
+  CrossMwmOverlayGraph const * m_overlay = nullptr;
+  mutable map<Index::MwmId, TOverlayMwmIndex> m_overlayMwmIndexes;
+  mutable vector<Index::MwmId> m_overlayMwmIds;
+  mutable vector<bool> m_overlayMwmIdsResolved;
+
   // Caching stuff.
   using TCachingKey = pair<TWrittenNodeId, Index::MwmId>;
 
@@ -1,5 +1,6 @@
 #pragma once
 
+#include "cross_mwm_overlay.hpp"
 #include "osrm_engine.hpp"
 #include "router.hpp"
 #include "routing_mapping.hpp"
@@ -34,11 +35,13 @@ using TCheckedPath = vector<RoutePathCross>;
  * \param finalGraphNodes The vector of final routing graph nodes.
  * \param route Storage for the result records about crossing maps.
  * \param indexManager Manager for getting indexes of new countries.
+ * \param overlay Offline-built graph over all border crossings. May be empty.
  * \param RoutingVisualizerFn Debug visualization function.
  * \return NoError if the path exists, error code otherwise.
  */
 IRouter::ResultCode CalculateCrossMwmPath(TRoutingNodes const & startGraphNodes,
                                           TRoutingNodes const & finalGraphNodes,
                                           RoutingIndexManager & indexManager,
+                                          CrossMwmOverlayGraph const & overlay,
                                           RouterDelegate const & delegate, TCheckedPath & route);
 }  // namespace routing
@@ -194,6 +194,55 @@ void FeaturesRoadGraph::FindClosestEdges(m2::PointD const & point, uint32_t coun
   finder.MakeResult(vicinities, count);
 }
 
+void FeaturesRoadGraph::FindClosestEdgesBatch(vector<m2::PointD> const & points, uint32_t count,
+                                              vector<vector<pair<Edge, m2::PointD>>> & vicinities) const
+{
+  vector<NearestEdgeFinder> finders;
+  vector<m2::RectD> rects;
+  finders.reserve(points.size());
+  rects.reserve(points.size());
+  m2::RectD batchRect;
+  for (m2::PointD const & point : points)
+  {
+    finders.emplace_back(point);
+    rects.push_back(
+        MercatorBounds::RectByCenterXYAndSizeInMeters(point, kMwmCrossingNodeEqualityRadiusMeters));
+    batchRect.Add(rects.back());
+  }
+
+  // Roads are loaded once for the whole batch and passed to finders of close points only.
+  auto const f = [&finders, &rects, this](FeatureType & ft)
+  {
+    if (ft.GetFeatureType() != feature::GEOM_LINE)
+      return;
+
+    double const speedKMPH = m_vehicleModel.GetSpeed(ft);
+    if (speedKMPH <= 0.0)
+      return;
+
+    FeatureID const featureId = ft.GetID();
+
+    IRoadGraph::RoadInfo const & roadInfo = GetCachedRoadInfo(featureId, ft, speedKMPH);
+
+    m2::RectD roadRect;
+    for (m2::PointD const & point : roadInfo.m_points)
+      roadRect.Add(point);
+
+    for (size_t i = 0; i < finders.size(); ++i)
+    {
+      if (rects[i].IsIntersect(roadRect))
+        finders[i].AddInformationSource(featureId, roadInfo);
+    }
+  };
+
+  if (!points.empty())
+    m_index.ForEachInRect(f, batchRect, GetStreetReadScale());
+
+  vicinities.resize(points.size());
+  for (size_t i = 0; i < finders.size(); ++i)
+    finders[i].MakeResult(vicinities[i], count);
+}
+
 void FeaturesRoadGraph::GetFeatureTypes(FeatureID const & featureId, feature::TypesHolder & types) const
 {
   FeatureType ft;
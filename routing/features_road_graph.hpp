@@ -68,6 +68,8 @@ public:
                                     CrossEdgesLoader & edgesLoader) const override;
   void FindClosestEdges(m2::PointD const & point, uint32_t count,
                         vector<pair<Edge, m2::PointD>> & vicinities) const override;
+  void FindClosestEdgesBatch(vector<m2::PointD> const & points, uint32_t count,
+                             vector<vector<pair<Edge, m2::PointD>>> & vicinities) const override;
   void GetFeatureTypes(FeatureID const & featureId, feature::TypesHolder & types) const override;
   void GetJunctionTypes(Junction const & junction, feature::TypesHolder & types) const override;
   void ClearState() override;
@@ -0,0 +1,354 @@
+#include "routing/isochrone.hpp"
+
+#include "indexer/feature.hpp"
+#include "indexer/index.hpp"
+#include "indexer/mercator.hpp"
+
+#include "base/assert.hpp"
+#include "base/logging.hpp"
+#include "base/thread.hpp"
+
+#include "std/algorithm.hpp"
+#include "std/functional.hpp"
+#include "std/limits.hpp"
+#include "std/queue.hpp"
+#include "std/shared_ptr.hpp"
+
+namespace
+{
+// OSRM weights are in deciseconds.
+double constexpr kOsrmWeightsInSecond = 10.0;
+uint32_t constexpr kNoFeature = numeric_limits<uint32_t>::max();
+
+double CrossProduct(m2::PointD const & o, m2::PointD const & a, m2::PointD const & b)
+{
+  return (a.x - o.x) * (b.y - o.y) - (a.y - o.y) * (b.x - o.x);
+}
+}  // namespace
+
+namespace routing
+{
+void MakeConvexHull(vector<m2::PointD> & points, vector<m2::PointD> & hull)
+{
+  hull.clear();
+  sort(points.begin(), points.end());
+  points.erase(unique(points.begin(), points.end()), points.end());
+  if (points.size() < 3)
+  {
+    hull = points;
+    return;
+  }
+
+  // Andrew's monotone chain.
+  hull.resize(2 * points.size());
+  size_t k = 0;
+  for (size_t i = 0; i < points.size(); ++i)
+  {
+    while (k >= 2 && CrossProduct(hull[k - 2], hull[k - 1], points[i]) <= 0)
+      --k;
+    hull[k++] = points[i];
+  }
+  for (size_t i = points.size() - 1, lower = k + 1; i > 0; --i)
+  {
+    while (k >= lower && CrossProduct(hull[k - 2], hull[k - 1], points[i - 1]) <= 0)
+      --k;
+    hull[k++] = points[i - 1];
+  }
+  // The last point is equal to the first one.
+  hull.resize(k - 1);
+}
+
+CarIsochroneGraph::CarIsochroneGraph(RoutingMapping const & mapping, Index const & index)
+  : m_mapping(mapping)
+{
+  auto const & facade = mapping.m_dataFacade;
+  uint32_t const nodesCount = facade.GetNumberOfNodes();
+
+  // Every original edge is kept by one of its nodes only, so both directions are taken
+  // from the edge flags. The first pass counts edges, the second one fills them.
+  auto const forEachOriginalEdge = [&](function<void(uint32_t, uint32_t, uint32_t)> const & f)
+  {
+    for (uint32_t node = 0; node < nodesCount; ++node)
+    {
+      for (auto e = facade.BeginEdges(node); e < facade.EndEdges(node); ++e)
+      {
+        QueryEdge::EdgeData const data = facade.GetEdgeData(e, node);
+        if (data.shortcut)
+          continue;
+        uint32_t const target = facade.GetTarget(e);
+        if (data.forward)
+          f(node, target, data.distance);
+        if (data.backward)
+          f(target, node, data.distance);
+      }
+    }
+  };
+
+  m_offsets.assign(nodesCount + 1, 0);
+  forEachOriginalEdge([this](uint32_t from, uint32_t, uint32_t)
+                      {
+                        ++m_offsets[from + 1];
+                      });
+  for (uint32_t node = 0; node < nodesCount; ++node)
+    m_offsets[node + 1] += m_offsets[node];
+
+  m_targets.resize(m_offsets.back());
+  m_weights.resize(m_offsets.back());
+  vector<uint32_t> positions(m_offsets.begin(), m_offsets.end() - 1);
+  forEachOriginalEdge([this, &positions](uint32_t from, uint32_t to, uint32_t weight)
+                      {
+                        uint32_t const pos = positions[from]++;
+                        m_targets[pos] = to;
+                        m_weights[pos] = weight;
+                      });
+
+  m_nodePoints.assign(nodesCount, m2::PointD::Zero());
+  m_hasPoint.assign(nodesCount, false);
+  Index::FeaturesLoaderGuard loader(index, mapping.GetMwmId());
+  FeatureType ft;
+  uint32_t loadedFid = kNoFeature;
+  for (uint32_t node = 0; node < nodesCount; ++node)
+  {
+    mapping.m_segMapping.ForEachFtSeg(node, [&](OsrmMappingTypes::FtSeg const & seg)
+    {
+      if (m_hasPoint[node])
+        return;
+      if (seg.m_fid != loadedFid)
+      {
+        loader.GetFeatureByIndex(seg.m_fid, ft);
+        ft.ParseGeometry(FeatureType::BEST_GEOMETRY);
+        loadedFid = seg.m_fid;
+      }
+      m_nodePoints[node] = ft.GetPoint(seg.m_pointStart);
+      m_hasPoint[node] = true;
+    });
+  }
+
+  LOG(LDEBUG, ("Isochrone graph:", nodesCount, "nodes,", m_targets.size(), "edges"));
+}
+
+void CarIsochroneWorkspace::Reset(uint32_t nodesCount)
+{
+  m_reached.clear();
+  m_queue.clear();
+  if (m_distances.size() != nodesCount)
+  {
+    m_distances.assign(nodesCount, 0);
+    m_generations.assign(nodesCount, 0);
+    m_generation = 0;
+  }
+
+  ++m_generation;
+  if (m_generation == 0)
+  {
+    // The counter has overflowed, marks have to be cleared once.
+    fill(m_generations.begin(), m_generations.end(), 0);
+    m_generation = 1;
+  }
+}
+
+bool CarIsochroneWorkspace::Relax(uint32_t node, int32_t distance)
+{
+  if (m_generations[node] == m_generation)
+  {
+    if (m_distances[node] <= distance)
+      return false;
+  }
+  else
+  {
+    m_generations[node] = m_generation;
+    m_reached.push_back(node);
+  }
+
+  m_distances[node] = distance;
+  m_queue.emplace_back(distance, node);
+  push_heap(m_queue.begin(), m_queue.end(), greater<pair<int32_t, uint32_t>>());
+  return true;
+}
+
+void CarIsochroneWorkspace::Calculate(CarIsochroneGraph const & graph,
+                                      FeatureGraphNode const & source,
+                                      IsochroneParams const & params, Isochrone & result)
+{
+  result.Clear();
+  uint32_t const nodesCount = graph.GetNodesCount();
+  Reset(nodesCount);
+
+  // Offsets of the phantom node are subtracted as OSRM does for source nodes.
+  PhantomNode const & phantom = source.node;
+  if (phantom.forward_node_id != INVALID_NODE_ID && phantom.forward_node_id < nodesCount)
+    Relax(phantom.forward_node_id, -phantom.GetForwardWeightPlusOffset());
+  if (phantom.reverse_node_id != INVALID_NODE_ID && phantom.reverse_node_id < nodesCount)
+    Relax(phantom.reverse_node_id, -phantom.GetReverseWeightPlusOffset());
+
+  int32_t const budget = static_cast<int32_t>(params.m_timeBudgetSec * kOsrmWeightsInSecond);
+  auto const comparator = greater<pair<int32_t, uint32_t>>();
+  while (!m_queue.empty())
+  {
+    pop_heap(m_queue.begin(), m_queue.end(), comparator);
+    int32_t const distance = m_queue.back().first;
+    uint32_t const node = m_queue.back().second;
+    m_queue.pop_back();
+
+    if (distance != m_distances[node])
+      continue;
+
+    graph.ForEachOutgoingEdge(node, [&](uint32_t target, uint32_t weight)
+    {
+      int32_t const targetDistance = distance + static_cast<int32_t>(weight);
+      if (targetDistance <= budget)
+        Relax(target, targetDistance);
+    });
+  }
+
+  m_points.clear();
+  for (uint32_t node : m_reached)
+  {
+    if (graph.HasNodePoint(node))
+      m_points.push_back(graph.GetNodePoint(node));
+    if (!params.m_needSegments)
+      continue;
+
+    double const timeSec = max(m_distances[node], 0) / kOsrmWeightsInSecond;
+    graph.ForEachFtSeg(node, [&](OsrmMappingTypes::FtSeg const & seg)
+    {
+      result.m_segments.emplace_back(FeatureID(graph.GetMwmId(), seg.m_fid), seg.m_pointStart,
+                                     seg.m_pointEnd, timeSec);
+    });
+  }
+  MakeConvexHull(m_points, result.m_hull);
+}
+
+void CalculateCarIsochrones(CarIsochroneGraph const & graph,
+                            vector<FeatureGraphNode> const & sources,
+                            IsochroneParams const & params, size_t threadsCount,
+                            vector<Isochrone> & results)
+{
+  results.clear();
+  results.resize(sources.size());
+
+  threads::RunInThreads(sources.size(), threadsCount, [&]()
+  {
+    auto workspace = make_shared<CarIsochroneWorkspace>();
+    return [&, workspace](size_t i)
+    {
+      workspace->Calculate(graph, sources[i], params, results[i]);
+    };
+  });
+}
+
+bool PedestrianIsochroneBuilder::Calculate(m2::PointD const & startPoint,
+                                           IsochroneParams const & params, Isochrone & result)
+{
+  result.Clear();
+  m_times.clear();
+
+  vector<pair<Edge, m2::PointD>> vicinities;
+  m_graph.FindClosestEdges(startPoint, 1 /* count */, vicinities);
+  if (vicinities.empty())
+    return false;
+
+  using TQueueItem = pair<double, Junction>;
+  priority_queue<TQueueItem, vector<TQueueItem>, greater<TQueueItem>> queue;
+  auto const relax = [&](Junction const & junction, double timeSec)
+  {
+    if (timeSec > params.m_timeBudgetSec)
+      return;
+    auto const it = m_times.find(junction);
+    if (it != m_times.end() && it->second <= timeSec)
+      return;
+    m_times[junction] = timeSec;
+    queue.emplace(timeSec, junction);
+  };
+
+  // The start edge is passed from the projection in both directions, as pedestrian roads are
+  // bidirectional.
+  Edge const & startEdge = vicinities.front().first;
+  m2::PointD const & projection = vicinities.front().second;
+  double const startSpeedMPS = m_graph.GetSpeedKMPH(startEdge) * 1000.0 / 3600.0;
+  if (startSpeedMPS <= 0.0)
+    return false;
+  for (Junction const & end : {startEdge.GetStartJunction(), startEdge.GetEndJunction()})
+    relax(end, MercatorBounds::DistanceOnEarth(projection, end.GetPoint()) / startSpeedMPS);
+
+  m_points.clear();
+  m_points.push_back(projection);
+  if (params.m_needSegments)
+  {
+    result.m_segments.emplace_back(startEdge.GetFeatureId(), startEdge.GetSegId(),
+                                   startEdge.GetSegId() + 1, 0.0 /* timeSec */);
+  }
+
+  while (!queue.empty())
+  {
+    double const timeSec = queue.top().first;
+    Junction const junction = queue.top().second;
+    queue.pop();
+
+    if (m_times[junction] < timeSec)
+      continue;
+    m_points.push_back(junction.GetPoint());
+
+    m_edges.clear();
+    m_graph.GetOutgoingEdges(junction, m_edges);
+    for (Edge const & edge : m_edges)
+    {
+      double const speedMPS = m_graph.GetSpeedKMPH(edge) * 1000.0 / 3600.0;
+      if (speedMPS <= 0.0)
+        continue;
+      double const lengthM = MercatorBounds::DistanceOnEarth(edge.GetStartJunction().GetPoint(),
+                                                             edge.GetEndJunction().GetPoint());
+      double const endTimeSec = timeSec + lengthM / speedMPS;
+      if (endTimeSec > params.m_timeBudgetSec)
+        continue;
+
+      relax(edge.GetEndJunction(), endTimeSec);
+      if (params.m_needSegments && !edge.IsFake())
+      {
+        result.m_segments.emplace_back(edge.GetFeatureId(), edge.GetSegId(),
+                                       edge.GetSegId() + 1, timeSec);
+      }
+    }
+  }
+
+  // Segments passed in both directions are left with the earliest time.
+  auto & segments = result.m_segments;
+  sort(segments.begin(), segments.end(), [](ReachableSegment const & l, ReachableSegment const & r)
+  {
+    if (l.m_featureId != r.m_featureId)
+      return l.m_featureId < r.m_featureId;
+    if (l.m_pointStart != r.m_pointStart)
+      return l.m_pointStart < r.m_pointStart;
+    return l.m_timeSec < r.m_timeSec;
+  });
+  segments.erase(unique(segments.begin(), segments.end(),
+                        [](ReachableSegment const & l, ReachableSegment const & r)
+                        {
+                          return l.m_featureId == r.m_featureId &&
+                                 l.m_pointStart == r.m_pointStart;
+                        }),
+                 segments.end());
+
+  MakeConvexHull(m_points, result.m_hull);
+  return true;
+}
+
+void CalculatePedestrianIsochrones(vector<m2::PointD> const & startPoints,
+                                   IsochroneParams const & params,
+                                   TRoadGraphFactory const & graphFactory, size_t threadsCount,
+                                   vector<Isochrone> & results)
+{
+  results.clear();
+  results.resize(startPoints.size());
+
+  threads::RunInThreads(startPoints.size(), threadsCount, [&]()
+  {
+    shared_ptr<IRoadGraph> graph = graphFactory();
+    auto builder = make_shared<PedestrianIsochroneBuilder>(*graph);
+    return [&, graph, builder](size_t i)
+    {
+      builder->Calculate(startPoints[i], params, results[i]);
+    };
+  });
+}
+}  // namespace routing
@@ -0,0 +1,160 @@
+#pragma once
+
+#include "routing/osrm_engine.hpp"
+#include "routing/road_graph.hpp"
+#include "routing/routing_mapping.hpp"
+
+#include "indexer/feature_decl.hpp"
+
+#include "geometry/point2d.hpp"
+
+#include "std/cstdint.hpp"
+#include "std/map.hpp"
+#include "std/utility.hpp"
+#include "std/vector.hpp"
+
+class Index;
+
+namespace routing
+{
+struct IsochroneParams
+{
+  /// Time budget of the isochrone.
+  double m_timeBudgetSec = 15 * 60;
+  /// Reachable segments take a lot of memory for big isochrones, set false if only
+  /// the hull is needed.
+  bool m_needSegments = true;
+};
+
+/// Part of a road between points m_pointStart and m_pointEnd of the feature.
+struct ReachableSegment
+{
+  ReachableSegment(FeatureID const & featureId, uint32_t pointStart, uint32_t pointEnd,
+                   double timeSec)
+    : m_featureId(featureId), m_pointStart(pointStart), m_pointEnd(pointEnd), m_timeSec(timeSec)
+  {
+  }
+
+  FeatureID m_featureId;
+  uint32_t m_pointStart;
+  uint32_t m_pointEnd;
+  /// Time to reach the segment from the start point.
+  double m_timeSec;
+};
+
+struct Isochrone
+{
+  void Clear()
+  {
+    m_segments.clear();
+    m_hull.clear();
+  }
+
+  bool IsEmpty() const { return m_hull.empty(); }
+
+  vector<ReachableSegment> m_segments;
+  /// Convex hull of the reachable roads in counterclockwise order starting from the leftmost
+  /// point.
+  vector<m2::PointD> m_hull;
+};
+
+/// Makes the convex hull of points in counterclockwise order starting from the leftmost point.
+/// points are sorted and deduplicated.
+void MakeConvexHull(vector<m2::PointD> & points, vector<m2::PointD> & hull);
+
+/*!
+ * \brief Car graph of one mwm for one-to-all searches.
+ * Contraction hierarchy isn't suitable for one-to-all searches, so original (not shortcut)
+ * OSRM edges are extracted from the facade once to the compressed sparse row format.
+ * The graph is read only, so it may be shared by threads.
+ * \warning The mapping must be mapped while the graph is used.
+ */
+class CarIsochroneGraph
+{
+public:
+  CarIsochroneGraph(RoutingMapping const & mapping, Index const & index);
+
+  uint32_t GetNodesCount() const { return static_cast<uint32_t>(m_offsets.size() - 1); }
+
+  template <class TFunctor>
+  void ForEachOutgoingEdge(uint32_t node, TFunctor && f) const
+  {
+    for (uint32_t i = m_offsets[node]; i < m_offsets[node + 1]; ++i)
+      f(m_targets[i], m_weights[i]);
+  }
+
+  /// \return the first point of the node or an empty point if the node has no geometry.
+  m2::PointD const & GetNodePoint(uint32_t node) const { return m_nodePoints[node]; }
+  bool HasNodePoint(uint32_t node) const { return m_hasPoint[node]; }
+
+  template <class TFunctor>
+  void ForEachFtSeg(uint32_t node, TFunctor && f) const
+  {
+    m_mapping.m_segMapping.ForEachFtSeg(node, f);
+  }
+
+  Index::MwmId const & GetMwmId() const { return m_mapping.GetMwmId(); }
+
+private:
+  RoutingMapping const & m_mapping;
+
+  vector<uint32_t> m_offsets;
+  vector<uint32_t> m_targets;
+  vector<uint32_t> m_weights;
+  vector<m2::PointD> m_nodePoints;
+  vector<bool> m_hasPoint;
+};
+
+/// Search state of car isochrones. Arrays have the size of the graph and are reused
+/// between searches without clearing, so one workspace should be used for many searches.
+class CarIsochroneWorkspace
+{
+public:
+  void Calculate(CarIsochroneGraph const & graph, FeatureGraphNode const & source,
+                 IsochroneParams const & params, Isochrone & result);
+
+private:
+  void Reset(uint32_t nodesCount);
+  bool Relax(uint32_t node, int32_t distance);
+
+  vector<int32_t> m_distances;
+  vector<uint32_t> m_generations;
+  uint32_t m_generation = 0;
+  vector<uint32_t> m_reached;
+  vector<pair<int32_t, uint32_t>> m_queue;
+  vector<m2::PointD> m_points;
+};
+
+/// Calculates isochrones for sources in threadsCount threads on the shared graph.
+/// Sources with invalid nodes get empty isochrones.
+void CalculateCarIsochrones(CarIsochroneGraph const & graph,
+                            vector<FeatureGraphNode> const & sources,
+                            IsochroneParams const & params, size_t threadsCount,
+                            vector<Isochrone> & results);
+
+/// Pedestrian isochrones on the road graph. The search state is kept between searches.
+/// \warning The class isn't thread safe as the road graph, use one builder per thread.
+class PedestrianIsochroneBuilder
+{
+public:
+  explicit PedestrianIsochroneBuilder(IRoadGraph const & graph) : m_graph(graph) {}
+
+  /// \return false if there are no roads near the start point.
+  bool Calculate(m2::PointD const & startPoint, IsochroneParams const & params,
+                 Isochrone & result);
+
+private:
+  IRoadGraph const & m_graph;
+
+  map<Junction, double> m_times;
+  IRoadGraph::TEdgeVector m_edges;
+  vector<m2::PointD> m_points;
+};
+
+/// Calculates pedestrian isochrones in threadsCount threads. Every thread has its own
+/// road graph made by graphFactory.
+void CalculatePedestrianIsochrones(vector<m2::PointD> const & startPoints,
+                                   IsochroneParams const & params,
+                                   TRoadGraphFactory const & graphFactory, size_t threadsCount,
+                                   vector<Isochrone> & results);
+}  // namespace routing
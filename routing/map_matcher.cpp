@@ -0,0 +1,363 @@
+#include "routing/map_matcher.hpp"
+
+#include "indexer/mercator.hpp"
+
+#include "base/assert.hpp"
+#include "base/logging.hpp"
+#include "base/thread.hpp"
+
+#include "std/algorithm.hpp"
+#include "std/limits.hpp"
+#include "std/queue.hpp"
+#include "std/shared_ptr.hpp"
+
+namespace
+{
+// Route distances may be longer than the speed limit allows because of GPS errors.
+double constexpr kSpeedTolerance = 1.5;
+double constexpr kImpossibleScore = -numeric_limits<double>::max();
+int constexpr kNoParent = -1;
+}  // namespace
+
+namespace routing
+{
+MapMatcher::MapMatcher(IRoadGraph const & graph, MapMatcherParams const & params)
+  : m_graph(graph), m_params(params)
+{
+}
+
+bool MapMatcher::Match(vector<TracePoint> const & trace, MatchingResult & result)
+{
+  result.m_points.assign(trace.size(), MatchedPoint());
+  result.m_routeParts.clear();
+
+  vector<vector<Candidate>> candidates;
+  FindCandidates(trace, candidates);
+
+  // Viterbi layers are made by trace points with candidates only.
+  vector<size_t> layers;
+  for (size_t i = 0; i < trace.size(); ++i)
+  {
+    if (!candidates[i].empty())
+      layers.push_back(i);
+  }
+  if (layers.empty())
+    return false;
+
+  vector<vector<double>> scores(layers.size());
+  vector<vector<int>> parents(layers.size());
+  for (size_t layer = 0; layer < layers.size(); ++layer)
+  {
+    vector<Candidate> const & current = candidates[layers[layer]];
+    scores[layer].assign(current.size(), kImpossibleScore);
+    parents[layer].assign(current.size(), kNoParent);
+
+    bool connected = false;
+    if (layer > 0)
+    {
+      TracePoint const & prevPoint = trace[layers[layer - 1]];
+      TracePoint const & point = trace[layers[layer]];
+      vector<Candidate> const & prev = candidates[layers[layer - 1]];
+      double const straightM = MercatorBounds::DistanceOnEarth(prevPoint.m_point, point.m_point);
+      double const boundM = GetMaxRouteDistance(prevPoint, point);
+
+      for (size_t j = 0; j < current.size(); ++j)
+      {
+        for (size_t i = 0; i < prev.size(); ++i)
+        {
+          if (scores[layer - 1][i] == kImpossibleScore)
+            continue;
+          double const routeM = GetRouteDistance(prev[i], current[j], boundM, nullptr);
+          if (routeM < 0.0)
+            continue;
+          double const score = scores[layer - 1][i] + current[j].m_emission -
+                               fabs(routeM - straightM) / m_params.m_transitionBetaM;
+          if (score > scores[layer][j])
+          {
+            scores[layer][j] = score;
+            parents[layer][j] = static_cast<int>(i);
+            connected = true;
+          }
+        }
+      }
+    }
+
+    // The first point or a break of the trace: a new chain of states is started.
+    if (!connected)
+    {
+      for (size_t j = 0; j < current.size(); ++j)
+      {
+        scores[layer][j] = current[j].m_emission;
+        parents[layer][j] = kNoParent;
+      }
+    }
+  }
+
+  // Backtracking. Every chain is restored from its best final state.
+  vector<pair<size_t, size_t>> states;
+  int state = kNoParent;
+  for (size_t layer = layers.size(); layer > 0; --layer)
+  {
+    vector<double> const & layerScores = scores[layer - 1];
+    if (state == kNoParent)
+    {
+      state = static_cast<int>(distance(layerScores.begin(),
+                                        max_element(layerScores.begin(), layerScores.end())));
+    }
+    states.emplace_back(layer - 1, state);
+    state = parents[layer - 1][state];
+  }
+  reverse(states.begin(), states.end());
+
+  for (size_t k = 0; k < states.size(); ++k)
+  {
+    size_t const layer = states[k].first;
+    Candidate const & candidate = candidates[layers[layer]][states[k].second];
+    MatchedPoint & point = result.m_points[layers[layer]];
+    point.m_featureId = candidate.m_edge.GetFeatureId();
+    point.m_segId = candidate.m_edge.GetSegId();
+    point.m_projection = candidate.m_projection;
+
+    if (parents[layer][states[k].second] == kNoParent)
+    {
+      result.m_routeParts.emplace_back();
+      result.m_routeParts.back().push_back(candidate.m_edge);
+      continue;
+    }
+
+    Candidate const & prev = candidates[layers[layer - 1]][states[k - 1].second];
+    IRoadGraph::TEdgeVector & route = result.m_routeParts.back();
+    IRoadGraph::TEdgeVector path;
+    double const boundM = GetMaxRouteDistance(trace[layers[layer - 1]], trace[layers[layer]]);
+    VERIFY(GetRouteDistance(prev, candidate, boundM, &path) >= 0.0, ());
+    for (Edge const & edge : path)
+    {
+      if (!route.back().SameRoadSegmentAndDirection(edge))
+        route.push_back(edge);
+    }
+    if (!route.back().SameRoadSegmentAndDirection(candidate.m_edge))
+      route.push_back(candidate.m_edge);
+  }
+  return true;
+}
+
+void MapMatcher::FindCandidates(vector<TracePoint> const & trace,
+                                vector<vector<Candidate>> & candidates)
+{
+  candidates.assign(trace.size(), vector<Candidate>());
+
+  vector<m2::PointD> batch;
+  vector<vector<pair<Edge, m2::PointD>>> vicinities;
+  size_t batchBegin = 0;
+  m2::RectD batchRect;
+  for (size_t i = 0; i <= trace.size(); ++i)
+  {
+    if (i < trace.size())
+    {
+      m2::RectD rect = batchRect;
+      rect.Add(trace[i].m_point);
+      m2::RectD const maxRect = MercatorBounds::RectByCenterXYAndSizeInMeters(
+          rect.Center(), m_params.m_batchRectSizeM);
+      if (batch.empty() || maxRect.IsRectInside(rect))
+      {
+        batch.push_back(trace[i].m_point);
+        batchRect = rect;
+        continue;
+      }
+    }
+
+    m_graph.FindClosestEdgesBatch(batch, m_params.m_maxCandidatesCount, vicinities);
+    ASSERT_EQUAL(vicinities.size(), batch.size(), ());
+    for (size_t j = 0; j < batch.size(); ++j)
+    {
+      for (auto const & vicinity : vicinities[j])
+      {
+        double const distanceM = MercatorBounds::DistanceOnEarth(batch[j], vicinity.second);
+        double const normalizedDistance = distanceM / m_params.m_gpsSigmaM;
+        bool const bidirectional = m_graph.GetRoadInfo(vicinity.first.GetFeatureId()).m_bidirectional;
+        candidates[batchBegin + j].emplace_back(vicinity.first, vicinity.second, bidirectional,
+                                                -0.5 * normalizedDistance * normalizedDistance);
+      }
+    }
+
+    batchBegin = i;
+    batch.clear();
+    batchRect = m2::RectD();
+    if (i < trace.size())
+    {
+      batch.push_back(trace[i].m_point);
+      batchRect.Add(trace[i].m_point);
+    }
+  }
+}
+
+double MapMatcher::GetMaxRouteDistance(TracePoint const & from, TracePoint const & to) const
+{
+  double const straightM = MercatorBounds::DistanceOnEarth(from.m_point, to.m_point);
+  double boundM = straightM * m_params.m_maxRouteFactor + m_params.m_maxDetourM;
+
+  double const timeSec = to.m_timestampSec - from.m_timestampSec;
+  if (from.m_timestampSec > 0.0 && timeSec > 0.0)
+  {
+    double const maxSpeedMPS = m_graph.GetMaxSpeedKMPH() * 1000.0 / 3600.0;
+    boundM = min(boundM, maxSpeedMPS * timeSec * kSpeedTolerance + m_params.m_maxDetourM);
+  }
+  return max(boundM, straightM);
+}
+
+double MapMatcher::GetRouteDistance(Candidate const & from, Candidate const & to, double boundM,
+                                    IRoadGraph::TEdgeVector * path)
+{
+  if (path)
+    path->clear();
+
+  Edge const & fromEdge = from.m_edge;
+  Edge const & toEdge = to.m_edge;
+  if (fromEdge.SameRoadSegmentAndDirection(toEdge))
+    return MercatorBounds::DistanceOnEarth(from.m_projection, to.m_projection);
+
+  // The path leaves the first edge by its end, or by its start if the road is bidirectional,
+  // and enters the second edge in the same way.
+  vector<pair<Junction, double>> exits = {
+      {fromEdge.GetEndJunction(),
+       MercatorBounds::DistanceOnEarth(from.m_projection, fromEdge.GetEndJunction().GetPoint())}};
+  if (from.m_bidirectional)
+  {
+    exits.emplace_back(fromEdge.GetStartJunction(),
+                       MercatorBounds::DistanceOnEarth(from.m_projection,
+                                                       fromEdge.GetStartJunction().GetPoint()));
+  }
+  vector<pair<Junction, double>> entries = {
+      {toEdge.GetStartJunction(),
+       MercatorBounds::DistanceOnEarth(toEdge.GetStartJunction().GetPoint(), to.m_projection)}};
+  if (to.m_bidirectional)
+  {
+    entries.emplace_back(toEdge.GetEndJunction(),
+                         MercatorBounds::DistanceOnEarth(toEdge.GetEndJunction().GetPoint(),
+                                                         to.m_projection));
+  }
+
+  double bestM = -1.0;
+  for (auto const & exit : exits)
+  {
+    if (exit.second > boundM)
+      continue;
+    // The search space may be dropped from the cache by the next search, so the path
+    // is restored right away.
+    SearchSpace const & space = GetSearchSpace(exit.first, boundM - exit.second);
+    for (auto const & entry : entries)
+    {
+      auto const it = space.m_labels.find(entry.first);
+      if (it == space.m_labels.end())
+        continue;
+      double const distanceM = exit.second + it->second.m_distanceM + entry.second;
+      if (distanceM > boundM || (bestM >= 0.0 && distanceM >= bestM))
+        continue;
+
+      bestM = distanceM;
+      if (path)
+      {
+        path->clear();
+        for (Junction junction = entry.first; !(junction == exit.first);)
+        {
+          Edge const & edge = space.m_labels.find(junction)->second.m_edge;
+          path->push_back(edge);
+          junction = edge.GetStartJunction();
+        }
+        reverse(path->begin(), path->end());
+      }
+    }
+  }
+  return bestM;
+}
+
+MapMatcher::SearchSpace const & MapMatcher::GetSearchSpace(Junction const & source, double boundM)
+{
+  auto const it = m_searchSpaces.find(source);
+  if (it != m_searchSpaces.end() && it->second.m_boundM >= boundM)
+  {
+    ++m_cacheHits;
+    return it->second;
+  }
+  ++m_cacheMisses;
+
+  if (m_searchSpaces.size() >= m_params.m_maxCachedSearchSpaces)
+  {
+    m_searchSpaces.clear();
+    m_outgoingEdges.clear();
+  }
+
+  // A bit more than asked is searched to reuse the space for close points.
+  SearchSpace & space = m_searchSpaces[source];
+  space.m_boundM = boundM * 2.0;
+  space.m_labels.clear();
+
+  using TQueueItem = pair<double, Junction>;
+  priority_queue<TQueueItem, vector<TQueueItem>, greater<TQueueItem>> queue;
+  space.m_labels.insert(make_pair(source, Label{0.0, Edge::MakeFake(source, source)}));
+  queue.emplace(0.0, source);
+  while (!queue.empty())
+  {
+    TQueueItem const item = queue.top();
+    queue.pop();
+    if (item.first > space.m_labels.find(item.second)->second.m_distanceM)
+      continue;
+
+    for (Edge const & edge : GetOutgoingEdges(item.second))
+    {
+      double const distanceM =
+          item.first + MercatorBounds::DistanceOnEarth(edge.GetStartJunction().GetPoint(),
+                                                       edge.GetEndJunction().GetPoint());
+      if (distanceM > space.m_boundM)
+        continue;
+
+      Junction const & target = edge.GetEndJunction();
+      auto const labelIt = space.m_labels.find(target);
+      if (labelIt == space.m_labels.end())
+      {
+        space.m_labels.insert(make_pair(target, Label{distanceM, edge}));
+      }
+      else if (distanceM < labelIt->second.m_distanceM)
+      {
+        labelIt->second.m_distanceM = distanceM;
+        labelIt->second.m_edge = edge;
+      }
+      else
+      {
+        continue;
+      }
+      queue.emplace(distanceM, target);
+    }
+  }
+  return space;
+}
+
+IRoadGraph::TEdgeVector const & MapMatcher::GetOutgoingEdges(Junction const & junction)
+{
+  auto const it = m_outgoingEdges.find(junction);
+  if (it != m_outgoingEdges.end())
+    return it->second;
+
+  IRoadGraph::TEdgeVector & edges = m_outgoingEdges[junction];
+  m_graph.GetOutgoingEdges(junction, edges);
+  return edges;
+}
+
+void MatchTraces(vector<vector<TracePoint>> const & traces, TRoadGraphFactory const & graphFactory,
+                 MapMatcherParams const & params, size_t threadsCount,
+                 vector<MatchingResult> & results)
+{
+  results.clear();
+  results.resize(traces.size());
+
+  threads::RunInThreads(traces.size(), threadsCount, [&]()
+  {
+    shared_ptr<IRoadGraph> graph = graphFactory();
+    auto matcher = make_shared<MapMatcher>(*graph, params);
+    return [&, graph, matcher](size_t i)
+    {
+      matcher->Match(traces[i], results[i]);
+    };
+  });
+}
+}  // namespace routing
@@ -0,0 +1,150 @@
+#pragma once
+
+#include "routing/road_graph.hpp"
+
+#include "indexer/feature_decl.hpp"
+
+#include "geometry/point2d.hpp"
+
+#include "std/map.hpp"
+#include "std/utility.hpp"
+#include "std/vector.hpp"
+
+namespace routing
+{
+/// Recorded GPS point of a trace.
+struct TracePoint
+{
+  TracePoint() : m_point(m2::PointD::Zero()), m_timestampSec(0.0) {}
+  TracePoint(m2::PointD const & point, double timestampSec)
+    : m_point(point), m_timestampSec(timestampSec)
+  {
+  }
+
+  /// Point in mercator.
+  m2::PointD m_point;
+  /// Unix time of the point. Points without time should have zero timestamps.
+  double m_timestampSec;
+};
+
+/// Trace point snapped to the road graph.
+struct MatchedPoint
+{
+  MatchedPoint() : m_segId(0), m_projection(m2::PointD::Zero()) {}
+
+  bool IsMatched() const { return m_featureId.IsValid(); }
+
+  FeatureID m_featureId;
+  uint32_t m_segId;
+  m2::PointD m_projection;
+};
+
+struct MatchingResult
+{
+  /// Snapped points in the order of the trace. Points which can't be matched have
+  /// invalid m_featureId.
+  vector<MatchedPoint> m_points;
+  /// Roads passed by the trace. The trace is split into several parts when
+  /// consecutive points can't be connected by the road graph.
+  vector<IRoadGraph::TEdgeVector> m_routeParts;
+};
+
+struct MapMatcherParams
+{
+  /// Maximal count of candidate edges for a trace point.
+  uint32_t m_maxCandidatesCount = 8;
+  /// Standard deviation of the GPS error in meters.
+  double m_gpsSigmaM = 10.0;
+  /// Scale in meters of the difference between the route and the straight distances
+  /// between consecutive points.
+  double m_transitionBetaM = 5.0;
+  /// A transition is impossible if the route distance is longer than the straight distance
+  /// multiplied by m_maxRouteFactor plus m_maxDetourM.
+  double m_maxRouteFactor = 2.0;
+  double m_maxDetourM = 200.0;
+  /// Consecutive trace points inside the rect of this size are looked up in the graph at once.
+  double m_batchRectSizeM = 1000.0;
+  /// Transitions cache is dropped when it has more search spaces.
+  size_t m_maxCachedSearchSpaces = 4096;
+};
+
+/*!
+ * \brief HMM map matcher. Hidden states are the closest edges of trace points,
+ * the emission probability depends on the distance from the point to the edge and
+ * the transition probability depends on the difference between the route distance
+ * and the straight distance of consecutive points (Newson and Krumm).
+ * The most probable sequence of edges is found by the Viterbi algorithm.
+ * \warning The class isn't thread safe as the road graph. Use one matcher per thread,
+ * see MatchTraces.
+ */
+class MapMatcher
+{
+public:
+  MapMatcher(IRoadGraph const & graph, MapMatcherParams const & params);
+
+  /// \return false if no point of the trace is matched.
+  bool Match(vector<TracePoint> const & trace, MatchingResult & result);
+
+  /// Route distances are calculated by one-to-many searches from edge ends. The searches are
+  /// cached, so transitions between the same roads of different points and traces are cheap.
+  size_t GetSearchCacheHits() const { return m_cacheHits; }
+  size_t GetSearchCacheMisses() const { return m_cacheMisses; }
+
+private:
+  struct Candidate
+  {
+    Candidate(Edge const & edge, m2::PointD const & projection, bool bidirectional,
+              double emission)
+      : m_edge(edge), m_projection(projection), m_bidirectional(bidirectional),
+        m_emission(emission)
+    {
+    }
+
+    Edge m_edge;
+    m2::PointD m_projection;
+    bool m_bidirectional;
+    double m_emission;
+  };
+
+  /// Shortest distance to a junction and the last edge of the shortest path.
+  struct Label
+  {
+    double m_distanceM;
+    Edge m_edge;
+  };
+
+  struct SearchSpace
+  {
+    double m_boundM = -1.0;
+    map<Junction, Label> m_labels;
+  };
+
+  void FindCandidates(vector<TracePoint> const & trace, vector<vector<Candidate>> & candidates);
+
+  /// \return route distance in meters between projections of candidates or a negative value
+  /// if it's longer than boundM. If path isn't nullptr it's filled with edges between candidates.
+  double GetRouteDistance(Candidate const & from, Candidate const & to, double boundM,
+                          IRoadGraph::TEdgeVector * path);
+
+  SearchSpace const & GetSearchSpace(Junction const & source, double boundM);
+
+  IRoadGraph::TEdgeVector const & GetOutgoingEdges(Junction const & junction);
+
+  double GetMaxRouteDistance(TracePoint const & from, TracePoint const & to) const;
+
+  IRoadGraph const & m_graph;
+  MapMatcherParams const m_params;
+
+  map<Junction, SearchSpace> m_searchSpaces;
+  map<Junction, IRoadGraph::TEdgeVector> m_outgoingEdges;
+  size_t m_cacheHits = 0;
+  size_t m_cacheMisses = 0;
+};
+
+/// Matches traces in threadsCount threads. Every thread has its own road graph made
+/// by graphFactory and its own matcher, traces are taken by threads one by one.
+/// results[i] is the result for traces[i].
+void MatchTraces(vector<vector<TracePoint>> const & traces, TRoadGraphFactory const & graphFactory,
+                 MapMatcherParams const & params, size_t threadsCount,
+                 vector<MatchingResult> & results);
+}  // namespace routing
@@ -0,0 +1,348 @@
+#pragma once
+
+#include "routing/alternative_routes_filters.hpp"
+
+#include "base/assert.hpp"
+
+#include "std/algorithm.hpp"
+#include "std/unordered_map.hpp"
+#include "std/unordered_set.hpp"
+#include "std/utility.hpp"
+#include "std/vector.hpp"
+
+#include "3party/osrm/osrm-backend/data_structures/internal_route_result.hpp"
+#include "3party/osrm/osrm-backend/data_structures/search_engine_data.hpp"
+#include "3party/osrm/osrm-backend/routing_algorithms/routing_base.hpp"
+
+namespace routing
+{
+/*!
+ * \brief Via-node alternative routes on the contraction hierarchy.
+ * One bidirectional search pruned at (1 + m_maxStretch) times the shortest weight is run.
+ * Nodes settled by both directions are via-node candidates. Candidates are ranked by
+ * the approximated weight and sharing computed from the search spaces (the plateau estimate),
+ * and then the best candidates are checked exactly: a via path s->v->t is rebuilt from
+ * the existing search heaps with two short half-searches, its sharing with all already
+ * chosen routes is computed and the T-test for local optimality is performed.
+ */
+template <class TDataFacade>
+class AlternativeRoutesFinder
+    : private BasicRoutingInterface<TDataFacade, AlternativeRoutesFinder<TDataFacade>>
+{
+  using TBase = BasicRoutingInterface<TDataFacade, AlternativeRoutesFinder<TDataFacade>>;
+  using TQueryHeap = SearchEngineData::QueryHeap;
+  using TSearchSpaceEdge = pair<NodeID, NodeID>;
+
+  // We check only the best candidates exactly to keep the total cost close to one query.
+  static size_t constexpr kMaxCheckedCandidatesPerRoute = 10;
+
+  struct Candidate
+  {
+    NodeID m_node;
+    int m_weight;
+    int m_sharing;
+
+    Candidate(NodeID node, int weight, int sharing)
+      : m_node(node), m_weight(weight), m_sharing(sharing)
+    {
+    }
+
+    bool operator<(Candidate const & rhs) const
+    {
+      return 2 * m_weight + m_sharing < 2 * rhs.m_weight + rhs.m_sharing;
+    }
+  };
+
+public:
+  AlternativeRoutesFinder(TDataFacade * facade, SearchEngineData & engineData,
+                          AlternativeRoutesParams const & params)
+    : TBase(facade), m_facade(facade), m_engineData(engineData), m_params(params)
+  {
+  }
+
+  /// Finds the shortest route and up to m_maxCount - 1 alternatives.
+  /// \return false if there is no route at all. The shortest route is the first in results.
+  bool operator()(PhantomNodes const & nodes, vector<InternalRouteResult> & results)
+  {
+    results.clear();
+    unsigned const nodesCount = m_facade->GetNumberOfNodes();
+    m_engineData.InitializeOrClearFirstThreadLocalStorage(nodesCount);
+    m_engineData.InitializeOrClearSecondThreadLocalStorage(nodesCount);
+    m_engineData.InitializeOrClearThirdThreadLocalStorage(nodesCount);
+
+    TQueryHeap & forwardHeap = *m_engineData.forward_heap_1;
+    TQueryHeap & reverseHeap = *m_engineData.reverse_heap_1;
+
+    PhantomNode const & source = nodes.source_phantom;
+    PhantomNode const & target = nodes.target_phantom;
+    if (source.forward_node_id != SPECIAL_NODEID)
+      forwardHeap.Insert(source.forward_node_id, -source.GetForwardWeightPlusOffset(),
+                         source.forward_node_id);
+    if (source.reverse_node_id != SPECIAL_NODEID)
+      forwardHeap.Insert(source.reverse_node_id, -source.GetReverseWeightPlusOffset(),
+                         source.reverse_node_id);
+    if (target.forward_node_id != SPECIAL_NODEID)
+      reverseHeap.Insert(target.forward_node_id, target.GetForwardWeightPlusOffset(),
+                         target.forward_node_id);
+    if (target.reverse_node_id != SPECIAL_NODEID)
+      reverseHeap.Insert(target.reverse_node_id, target.GetReverseWeightPlusOffset(),
+                         target.reverse_node_id);
+
+    m_minEdgeOffset =
+        min(source.GetForwardWeightPlusOffset(), source.GetReverseWeightPlusOffset());
+
+    // 1. The only full bidirectional search. It is not stopped at the shortest route and
+    // collects the search spaces for the sharing approximation.
+    NodeID middleNode = SPECIAL_NODEID;
+    int shortestWeight = INVALID_EDGE_WEIGHT;
+    vector<NodeID> viaCandidates;
+    vector<TSearchSpaceEdge> forwardSpace, reverseSpace;
+    while (forwardHeap.Size() + reverseHeap.Size() > 0)
+    {
+      if (forwardHeap.Size() > 0)
+        Step<true>(forwardHeap, reverseHeap, middleNode, shortestWeight, viaCandidates,
+                   forwardSpace);
+      if (reverseHeap.Size() > 0)
+        Step<false>(reverseHeap, forwardHeap, middleNode, shortestWeight, viaCandidates,
+                    reverseSpace);
+    }
+
+    if (shortestWeight == INVALID_EDGE_WEIGHT || middleNode == SPECIAL_NODEID)
+      return false;
+
+    vector<NodeID> packedShortest;
+    TBase::RetrievePackedPathFromHeap(forwardHeap, reverseHeap, middleNode, packedShortest);
+    results.emplace_back();
+    MakeResult(packedShortest, shortestWeight, nodes, results.back());
+
+    if (m_params.m_maxCount < 2)
+      return true;
+
+    // Already chosen routes. Sharing is computed against their union.
+    unordered_set<NodeID> chosenNodes;
+    for (PathData const & data : results.back().unpacked_path_segments.front())
+      chosenNodes.insert(data.node);
+
+    // 2. Plateau estimate: the part of the via path which is shared with the shortest path
+    // is approximated by sweeping both search spaces.
+    unordered_set<NodeID> const shortestNodes(packedShortest.begin(), packedShortest.end());
+    unordered_map<NodeID, int> forwardSharing, reverseSharing;
+    ApproximateSharing(forwardSpace, forwardHeap, shortestNodes, forwardSharing);
+    ApproximateSharing(reverseSpace, reverseHeap, shortestNodes, reverseSharing);
+
+    sort(viaCandidates.begin(), viaCandidates.end());
+    viaCandidates.erase(unique(viaCandidates.begin(), viaCandidates.end()), viaCandidates.end());
+
+    vector<Candidate> candidates;
+    for (NodeID const node : viaCandidates)
+    {
+      if (shortestNodes.count(node) != 0)
+        continue;
+      int const weight = forwardHeap.GetKey(node) + reverseHeap.GetKey(node);
+      int const sharing = GetSharing(forwardSharing, node) + GetSharing(reverseSharing, node);
+      if (PassesStretch(m_params, weight, sharing, shortestWeight) &&
+          PassesSharing(m_params, sharing, shortestWeight))
+        candidates.emplace_back(node, weight, sharing);
+    }
+    sort(candidates.begin(), candidates.end());
+
+    // 3. Exact checks of the best candidates.
+    size_t const maxChecked = kMaxCheckedCandidatesPerRoute * (m_params.m_maxCount - 1);
+    for (size_t i = 0; i < candidates.size() && i < maxChecked; ++i)
+    {
+      if (results.size() >= m_params.m_maxCount)
+        break;
+
+      vector<NodeID> packedPath;
+      int weight = INVALID_EDGE_WEIGHT;
+      if (!FindViaPath(candidates[i].m_node, packedPath, weight))
+        continue;
+      if (weight > shortestWeight * (1. + m_params.m_maxStretch))
+        continue;
+
+      InternalRouteResult alternative;
+      MakeResult(packedPath, weight, nodes, alternative);
+      vector<PathData> const & path = alternative.unpacked_path_segments.front();
+
+      // The first element of an unpacked path has no weight.
+      int sharing = 0;
+      for (size_t j = 1; j < path.size(); ++j)
+      {
+        if (chosenNodes.count(path[j].node) != 0)
+          sharing += path[j].segment_duration;
+      }
+      if (!PassesSharing(m_params, sharing, shortestWeight) ||
+          !PassesStretch(m_params, weight, sharing, shortestWeight))
+        continue;
+
+      auto const getShortestWeight = [this](NodeID from, NodeID to)
+      {
+        return GetShortestWeight(from, to);
+      };
+      if (!IsLocallyOptimal(m_params, path, candidates[i].m_node, shortestWeight,
+                            getShortestWeight))
+        continue;
+
+      for (PathData const & data : path)
+        chosenNodes.insert(data.node);
+      results.push_back(move(alternative));
+    }
+    return true;
+  }
+
+private:
+  template <bool kForward>
+  void Step(TQueryHeap & heap, TQueryHeap & oppositeHeap, NodeID & middleNode, int & upperBound,
+            vector<NodeID> & viaCandidates, vector<TSearchSpaceEdge> & searchSpace) const
+  {
+    NodeID const node = heap.DeleteMin();
+    int const distance = heap.GetKey(node);
+
+    int const scaledDistance =
+        static_cast<int>((distance + m_minEdgeOffset) / (1. + m_params.m_maxStretch));
+    if (upperBound != INVALID_EDGE_WEIGHT && scaledDistance > upperBound)
+    {
+      heap.DeleteAll();
+      return;
+    }
+
+    searchSpace.emplace_back(heap.GetData(node).parent, node);
+
+    if (oppositeHeap.WasInserted(node))
+    {
+      viaCandidates.push_back(node);
+      int const newDistance = oppositeHeap.GetKey(node) + distance;
+      if (newDistance >= 0 && newDistance < upperBound)
+      {
+        middleNode = node;
+        upperBound = newDistance;
+      }
+    }
+
+    for (auto const edge : m_facade->GetAdjacentEdgeRange(node))
+    {
+      auto const & data = m_facade->GetEdgeData(edge, node);
+      if (!(kForward ? data.forward : data.backward))
+        continue;
+
+      NodeID const to = m_facade->GetTarget(edge);
+      int const toDistance = distance + data.distance;
+      if (!heap.WasInserted(to))
+      {
+        heap.Insert(to, toDistance, node);
+      }
+      else if (toDistance < heap.GetKey(to))
+      {
+        heap.GetData(to).parent = node;
+        heap.DecreaseKey(to, toDistance);
+      }
+    }
+  }
+
+  static void ApproximateSharing(vector<TSearchSpaceEdge> const & searchSpace,
+                                 TQueryHeap & heap, unordered_set<NodeID> const & pathNodes,
+                                 unordered_map<NodeID, int> & sharing)
+  {
+    for (auto const & edge : searchSpace)
+    {
+      if (pathNodes.count(edge.second) != 0)
+      {
+        sharing.emplace(edge.second, heap.GetKey(edge.second));
+        continue;
+      }
+      auto const it = sharing.find(edge.first);
+      if (it != sharing.end())
+        sharing.emplace(edge.second, it->second);
+    }
+  }
+
+  static int GetSharing(unordered_map<NodeID, int> const & sharing, NodeID node)
+  {
+    auto const it = sharing.find(node);
+    return it == sharing.end() ? 0 : it->second;
+  }
+
+  /// Builds packed s->v->t path by continuing the existing forward and reverse searches from v.
+  bool FindViaPath(NodeID via, vector<NodeID> & packedPath, int & weight)
+  {
+    m_engineData.InitializeOrClearSecondThreadLocalStorage(m_facade->GetNumberOfNodes());
+    TQueryHeap & existingForwardHeap = *m_engineData.forward_heap_1;
+    TQueryHeap & existingReverseHeap = *m_engineData.reverse_heap_1;
+    TQueryHeap & newForwardHeap = *m_engineData.forward_heap_2;
+    TQueryHeap & newReverseHeap = *m_engineData.reverse_heap_2;
+
+    NodeID svMiddle = SPECIAL_NODEID;
+    int svWeight = INVALID_EDGE_WEIGHT;
+    newReverseHeap.Insert(via, 0, via);
+    while (!newReverseHeap.Empty())
+    {
+      TBase::RoutingStep(newReverseHeap, existingForwardHeap, &svMiddle, &svWeight,
+                         m_minEdgeOffset, false /* forward_direction */);
+    }
+    if (svMiddle == SPECIAL_NODEID)
+      return false;
+
+    NodeID vtMiddle = SPECIAL_NODEID;
+    int vtWeight = INVALID_EDGE_WEIGHT;
+    newForwardHeap.Insert(via, 0, via);
+    while (!newForwardHeap.Empty())
+    {
+      TBase::RoutingStep(newForwardHeap, existingReverseHeap, &vtMiddle, &vtWeight,
+                         m_minEdgeOffset, true /* forward_direction */);
+    }
+    if (vtMiddle == SPECIAL_NODEID)
+      return false;
+
+    weight = svWeight + vtWeight;
+
+    packedPath.clear();
+    TBase::RetrievePackedPathFromHeap(existingForwardHeap, newReverseHeap, svMiddle, packedPath);
+    // The via node is the last node of s->v and the first node of v->t.
+    packedPath.pop_back();
+    vector<NodeID> packedVtPath;
+    TBase::RetrievePackedPathFromHeap(newForwardHeap, existingReverseHeap, vtMiddle, packedVtPath);
+    packedPath.insert(packedPath.end(), packedVtPath.begin(), packedVtPath.end());
+    return true;
+  }
+
+  /// @return Weight of the shortest path between the nodes or INVALID_EDGE_WEIGHT.
+  int GetShortestWeight(NodeID from, NodeID to)
+  {
+    m_engineData.InitializeOrClearThirdThreadLocalStorage(m_facade->GetNumberOfNodes());
+    TQueryHeap & forwardHeap = *m_engineData.forward_heap_3;
+    TQueryHeap & reverseHeap = *m_engineData.reverse_heap_3;
+    forwardHeap.Insert(from, 0, from);
+    reverseHeap.Insert(to, 0, to);
+
+    NodeID middle = SPECIAL_NODEID;
+    int upperBound = INVALID_EDGE_WEIGHT;
+    while (forwardHeap.Size() + reverseHeap.Size() > 0)
+    {
+      if (!forwardHeap.Empty())
+        TBase::RoutingStep(forwardHeap, reverseHeap, &middle, &upperBound, 0, true);
+      if (!reverseHeap.Empty())
+        TBase::RoutingStep(reverseHeap, forwardHeap, &middle, &upperBound, 0, false);
+    }
+    return upperBound;
+  }
+
+  void MakeResult(vector<NodeID> const & packedPath, int weight, PhantomNodes const & nodes,
+                  InternalRouteResult & result) const
+  {
+    ASSERT(!packedPath.empty(), ());
+    result.segment_end_coordinates.push_back(nodes);
+    result.source_traversed_in_reverse.push_back(packedPath.front() !=
+                                                 nodes.source_phantom.forward_node_id);
+    result.target_traversed_in_reverse.push_back(packedPath.back() !=
+                                                 nodes.target_phantom.forward_node_id);
+    result.unpacked_path_segments.resize(1);
+    TBase::UnpackPath(packedPath, nodes, result.unpacked_path_segments.front());
+    result.shortest_path_length = weight;
+  }
+
+  TDataFacade * m_facade;
+  SearchEngineData & m_engineData;
+  AlternativeRoutesParams const m_params;
+  int m_minEdgeOffset = 0;
+};
+}  // namespace routing
@@ -1,5 +1,6 @@
 #include "osrm_engine.hpp"
 #include "osrm2feature_map.hpp"
+#include "osrm_alternative_routes.hpp"
 
 #include "base/logging.hpp"
 #include "base/timer.hpp"
@@ -17,6 +18,32 @@ bool IsRouteExist(InternalRouteResult const & r)
            r.source_traversed_in_reverse.empty());
 }
 
+void ConvertRouteResult(InternalRouteResult const & result, FeatureGraphNode const & source,
+                        FeatureGraphNode const & target, RawRoutingResult & rawRoutingResult)
+{
+  rawRoutingResult.sourceEdge = source;
+  rawRoutingResult.targetEdge = target;
+  rawRoutingResult.shortestPathLength = result.shortest_path_length;
+  for (auto const & path : result.unpacked_path_segments)
+  {
+    vector<RawPathData> data;
+    data.reserve(path.size());
+    for (auto const & element : path)
+    {
+      data.emplace_back(element.node, element.segment_duration);
+    }
+    rawRoutingResult.unpackedPathSegments.emplace_back(move(data));
+  }
+}
+
+bool IsValidTask(PhantomNodes const & nodes)
+{
+  return (nodes.source_phantom.forward_node_id != INVALID_NODE_ID ||
+          nodes.source_phantom.reverse_node_id != INVALID_NODE_ID) &&
+         (nodes.target_phantom.forward_node_id != INVALID_NODE_ID ||
+          nodes.target_phantom.reverse_node_id != INVALID_NODE_ID);
+}
+
 void GenerateRoutingTaskFromNodeId(NodeID const nodeId, bool const isStartNode,
                                    PhantomNode & taskNode)
 {
@@ -60,10 +87,7 @@ bool FindSingleRoute(FeatureGraphNode const & source, FeatureGraphNode const & t
   nodes.source_phantom = source.node;
   nodes.target_phantom = target.node;
 
-  if ((nodes.source_phantom.forward_node_id != INVALID_NODE_ID ||
-       nodes.source_phantom.reverse_node_id != INVALID_NODE_ID) &&
-      (nodes.target_phantom.forward_node_id != INVALID_NODE_ID ||
-       nodes.target_phantom.reverse_node_id != INVALID_NODE_ID))
+  if (IsValidTask(nodes))
   {
     result.segment_end_coordinates.push_back(nodes);
     pathFinder({nodes}, {}, result);
@@ -71,25 +95,45 @@ bool FindSingleRoute(FeatureGraphNode const & source, FeatureGraphNode const & t
 
   if (IsRouteExist(result))
   {
-    rawRoutingResult.sourceEdge = source;
-    rawRoutingResult.targetEdge = target;
-    rawRoutingResult.shortestPathLength = result.shortest_path_length;
-    for (auto const & path : result.unpacked_path_segments)
-    {
-      vector<RawPathData> data;
-      data.reserve(path.size());
-      for (auto const & element : path)
-      {
-        data.emplace_back(element.node, element.segment_duration);
-      }
-      rawRoutingResult.unpackedPathSegments.emplace_back(move(data));
-    }
+    ConvertRouteResult(result, source, target, rawRoutingResult);
     return true;
   }
 
   return false;
 }
 
+bool FindAlternativeRoutes(FeatureGraphNode const & source, FeatureGraphNode const & target,
+                           TRawDataFacade & facade, AlternativeRoutesParams const & params,
+                           vector<RawRoutingResult> & rawRoutingResults)
+{
+  rawRoutingResults.clear();
+
+  PhantomNodes nodes;
+  nodes.source_phantom = source.node;
+  nodes.target_phantom = target.node;
+  if (!IsValidTask(nodes))
+    return false;
+
+  SearchEngineData engineData;
+  AlternativeRoutesFinder<TRawDataFacade> finder(&facade, engineData, params);
+  vector<InternalRouteResult> results;
+
+  my::HighResTimer timer(true);
+  if (!finder(nodes, results))
+    return false;
+  LOG(LINFO, ("Duration of the alternative routes search", timer.ElapsedNano(), "ns. Routes:",
+              results.size()));
+
+  for (auto const & result : results)
+  {
+    if (!IsRouteExist(result))
+      continue;
+    rawRoutingResults.emplace_back();
+    ConvertRouteResult(result, source, target, rawRoutingResults.back());
+  }
+  return !rawRoutingResults.empty();
+}
+
 FeatureGraphNode::FeatureGraphNode(NodeID const nodeId, bool const isStartNode,
                                    Index::MwmId const & id)
     : segmentPoint(m2::PointD::Zero()), mwmId(id)
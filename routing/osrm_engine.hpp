@@ -13,6 +13,8 @@
 
 namespace routing
 {
+struct AlternativeRoutesParams;
+
 /// Single graph node representation for routing task
 struct FeatureGraphNode
 {
@@ -98,4 +100,17 @@ void FindWeightsMatrix(TRoutingNodes const & sources, TRoutingNodes const & targ
 bool FindSingleRoute(FeatureGraphNode const & source, FeatureGraphNode const & target,
                      TRawDataFacade & facade, RawRoutingResult & rawRoutingResult);
 
+/*! Find the shortest path and its alternatives in a single MWM between 2 OSRM nodes.
+   * All the routes are found with one bidirectional search, see AlternativeRoutesFinder.
+   * \param source Source OSRM graph node to make path.
+   * \param taget Target OSRM graph node to make path.
+   * \param facade OSRM routing data facade to recover graph information.
+   * \param params Limits for the count and the quality of alternatives.
+   * \param rawRoutingResults Routing results. The shortest route is the first one.
+   * \return true when path exists, false otherwise.
+   */
+bool FindAlternativeRoutes(FeatureGraphNode const & source, FeatureGraphNode const & target,
+                           TRawDataFacade & facade, AlternativeRoutesParams const & params,
+                           vector<RawRoutingResult> & rawRoutingResults);
+
 }  // namespace routing
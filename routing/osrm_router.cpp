@@ -1,5 +1,7 @@
+#include "alternative_routes_filters.hpp"
 #include "cross_mwm_router.hpp"
 #include "online_cross_fetcher.hpp"
+#include "isochrone.hpp"
 #include "osrm2feature_map.hpp"
 #include "osrm_helpers.hpp"
 #include "osrm_router.hpp"
@@ -26,6 +28,7 @@
 
 #include "std/algorithm.hpp"
 #include "std/limits.hpp"
+#include "std/map.hpp"
 #include "std/string.hpp"
 
 #include "3party/osrm/osrm-backend/data_structures/query_edge.hpp"
@@ -320,8 +323,9 @@ OsrmRouter::ResultCode OsrmRouter::CalculateRoute(m2::PointD const & startPoint,
   {
     LOG(LINFO, ("Multiple mwm routing case"));
     TCheckedPath finalPath;
-    ResultCode code = CalculateCrossMwmPath(startTask, m_cachedTargets, m_indexManager, delegate,
-                                            finalPath);
+    LoadCrossMwmOverlayIfNeeded();
+    ResultCode code = CalculateCrossMwmPath(startTask, m_cachedTargets, m_indexManager,
+                                            m_crossMwmOverlay, delegate, finalPath);
     timer.Reset();
     INTERRUPT_WHEN_CANCELLED(delegate);
     delegate.OnProgress(kCrossPathFoundProgress);
@@ -343,6 +347,161 @@ OsrmRouter::ResultCode OsrmRouter::CalculateRoute(m2::PointD const & startPoint,
   }
 }
 
+OsrmRouter::ResultCode OsrmRouter::CalculateIsochrones(vector<m2::PointD> const & startPoints,
+                                                       IsochroneParams const & params,
+                                                       size_t threadsCount,
+                                                       vector<Isochrone> & isochrones)
+{
+  isochrones.clear();
+  isochrones.resize(startPoints.size());
+  m_indexManager.Clear();
+
+  map<Index::MwmId, vector<size_t>> pointsByMwm;
+  for (size_t i = 0; i < startPoints.size(); ++i)
+  {
+    TRoutingMappingPtr mapping = m_indexManager.GetMappingByPoint(startPoints[i]);
+    if (mapping->IsValid())
+      pointsByMwm[mapping->GetMwmId()].push_back(i);
+  }
+
+  bool found = false;
+  for (auto const & mwmPoints : pointsByMwm)
+  {
+    TRoutingMappingPtr mapping =
+        m_indexManager.GetMappingByPoint(startPoints[mwmPoints.second.front()]);
+    MappingGuard mappingGuard(mapping);
+    UNUSED_VALUE(mappingGuard);
+
+    vector<FeatureGraphNode> sources;
+    vector<size_t> indices;
+    for (size_t i : mwmPoints.second)
+    {
+      TFeatureGraphNodeVec nodes;
+      if (FindPhantomNodes(startPoints[i], m2::PointD::Zero(), nodes, kMaxNodeCandidatesCount,
+                           mapping) != NoError || nodes.empty())
+      {
+        continue;
+      }
+      sources.push_back(nodes.front());
+      indices.push_back(i);
+    }
+    if (sources.empty())
+      continue;
+
+    CarIsochroneGraph const graph(*mapping, *m_pIndex);
+    vector<Isochrone> mwmIsochrones;
+    CalculateCarIsochrones(graph, sources, params, threadsCount, mwmIsochrones);
+    for (size_t i = 0; i < indices.size(); ++i)
+    {
+      found = found || !mwmIsochrones[i].IsEmpty();
+      isochrones[indices[i]] = move(mwmIsochrones[i]);
+    }
+  }
+
+  return found ? NoError : RouteNotFound;
+}
+
+OsrmRouter::ResultCode OsrmRouter::CalculateAlternativeRoutes(
+    m2::PointD const & startPoint, m2::PointD const & startDirection,
+    m2::PointD const & finalPoint, RouterDelegate const & delegate,
+    AlternativeRoutesParams const & params, vector<Route> & routes)
+{
+  routes.clear();
+  m_indexManager.Clear();
+
+  TRoutingMappingPtr startMapping = m_indexManager.GetMappingByPoint(startPoint);
+  TRoutingMappingPtr targetMapping = m_indexManager.GetMappingByPoint(finalPoint);
+
+  if (!startMapping->IsValid() || !targetMapping->IsValid() ||
+      startMapping->GetMwmId() != targetMapping->GetMwmId())
+  {
+    routes.emplace_back(GetName());
+    return CalculateRoute(startPoint, startDirection, finalPoint, delegate, routes.back());
+  }
+
+  MappingGuard startMappingGuard(startMapping);
+  UNUSED_VALUE(startMappingGuard);
+  delegate.OnProgress(kMwmLoadedProgress);
+
+  TFeatureGraphNodeVec startTask;
+  TFeatureGraphNodeVec finalTask;
+  {
+    ResultCode const code = FindPhantomNodes(startPoint, startDirection, startTask,
+                                             kMaxNodeCandidatesCount, startMapping);
+    if (code != NoError)
+      return code;
+  }
+  {
+    ResultCode const code = FindPhantomNodes(finalPoint, m2::PointD::Zero(), finalTask,
+                                             kMaxNodeCandidatesCount, startMapping);
+    if (code != NoError)
+      return code;
+  }
+  INTERRUPT_WHEN_CANCELLED(delegate);
+  delegate.OnProgress(kPointsFoundProgress);
+
+  // All the alternatives are searched between the first pair of connected nodes
+  // as FindRouteFromCases does for the single route.
+  vector<RawRoutingResult> routingResults;
+  for (auto const & targetEdge : finalTask)
+  {
+    for (auto const & sourceEdge : startTask)
+    {
+      if (FindAlternativeRoutes(sourceEdge, targetEdge, startMapping->m_dataFacade, params,
+                                routingResults))
+        break;
+    }
+    if (!routingResults.empty())
+      break;
+  }
+  if (routingResults.empty())
+    return RouteNotFound;
+  INTERRUPT_WHEN_CANCELLED(delegate);
+  delegate.OnProgress(kPathFoundProgress);
+
+  routes.reserve(routingResults.size());
+  for (RawRoutingResult const & routingResult : routingResults)
+  {
+    Route::TTurns turnsDir;
+    Route::TTimes times;
+    vector<m2::PointD> points;
+
+    ResultCode const code =
+        MakeTurnAnnotation(routingResult, startMapping, delegate, points, turnsDir, times);
+    if (code != NoError)
+      return code;
+
+    routes.emplace_back(GetName());
+    Route & route = routes.back();
+    route.SetGeometry(points.begin(), points.end());
+    route.SetTurnInstructions(turnsDir);
+    route.SetSectionTimes(times);
+  }
+  return NoError;
+}
+
+void OsrmRouter::LoadCrossMwmOverlayIfNeeded()
+{
+  if (m_crossMwmOverlayLoaded)
+    return;
+  m_crossMwmOverlayLoaded = true;
+
+  try
+  {
+    ModelReaderPtr reader(GetPlatform().GetReader(CROSS_MWM_OVERLAY_FILE));
+    m_crossMwmOverlay.Load(*reader.GetPtr());
+  }
+  catch (FileAbsentException const &)
+  {
+    LOG(LINFO, ("No cross mwm overlay file. Transit mwms will be expanded lazily."));
+  }
+  catch (RootException const & e)
+  {
+    LOG(LWARNING, ("Can't load cross mwm overlay:", e.Msg()));
+    m_crossMwmOverlay.Clear();
+  }
+}
+
 IRouter::ResultCode OsrmRouter::FindPhantomNodes(m2::PointD const & point,
                                                  m2::PointD const & direction,
                                                  TFeatureGraphNodeVec & res, size_t maxCount,
@@ -1,5 +1,6 @@
 #pragma once
 
+#include "routing/cross_mwm_overlay.hpp"
 #include "routing/osrm_data_facade.hpp"
 #include "routing/osrm_engine.hpp"
 #include "routing/route.hpp"
@@ -17,6 +18,8 @@ class FeatureType;
 
 namespace routing
 {
+struct Isochrone;
+struct IsochroneParams;
 struct RoutePathCross;
 using TCheckedPath = vector<RoutePathCross>;
 
@@ -35,6 +38,31 @@ public:
                             m2::PointD const & finalPoint, RouterDelegate const & delegate,
                             Route & route) override;
 
+  /*!
+   * \brief Calculates the shortest route and up to params.m_maxCount - 1 alternatives to it.
+   * Alternatives are found only when both points are in the same mwm, otherwise routes contains
+   * the single route calculated by CalculateRoute.
+   * \param routes Result routes. The shortest route is the first one.
+   * \return NoError if at least the shortest route is found, error code otherwise.
+   */
+  ResultCode CalculateAlternativeRoutes(m2::PointD const & startPoint,
+                                        m2::PointD const & startDirection,
+                                        m2::PointD const & finalPoint,
+                                        RouterDelegate const & delegate,
+                                        AlternativeRoutesParams const & params,
+                                        vector<Route> & routes);
+
+  /*!
+   * \brief Calculates car isochrones for start points in threadsCount threads.
+   * Points of one mwm share the graph of the mwm, it's built once per call.
+   * \param isochrones Result isochrones, isochrones[i] is empty if there are no roads
+   * near startPoints[i].
+   * \return NoError if at least one isochrone isn't empty, error code otherwise.
+   */
+  ResultCode CalculateIsochrones(vector<m2::PointD> const & startPoints,
+                                 IsochroneParams const & params, size_t threadsCount,
+                                 vector<Isochrone> & isochrones);
+
   virtual void ClearState() override;
 
   /*! Find single shortest path in a single MWM between 2 sets of edges
@@ -100,11 +128,17 @@ private:
   ResultCode MakeRouteFromCrossesPath(TCheckedPath const & path, RouterDelegate const & delegate,
                                       Route & route);
 
+  /// Loads CROSS_MWM_OVERLAY_FILE once. The overlay stays empty if there is no such file.
+  void LoadCrossMwmOverlayIfNeeded();
+
   Index const * m_pIndex;
 
   TFeatureGraphNodeVec m_cachedTargets;
   m2::PointD m_cachedTargetPoint;
 
   RoutingIndexManager m_indexManager;
+
+  CrossMwmOverlayGraph m_crossMwmOverlay;
+  bool m_crossMwmOverlayLoaded = false;
 };
 }  // namespace routing
@@ -224,6 +224,17 @@ void IRoadGraph::GetRegularOutgoingEdges(Junction const & junction, TEdgeVector
   ForEachFeatureClosestToCross(cross, loader);
 }
 
+void IRoadGraph::FindClosestEdgesBatch(vector<m2::PointD> const & points, uint32_t count,
+                                       vector<vector<pair<Edge, m2::PointD>>> & vicinities) const
+{
+  vicinities.resize(points.size());
+  for (size_t i = 0; i < points.size(); ++i)
+  {
+    vicinities[i].clear();
+    FindClosestEdges(points[i], count, vicinities[i]);
+  }
+}
+
 void IRoadGraph::ResetFakes()
 {
   m_outgoingEdges.clear();
@@ -6,8 +6,10 @@
 
 #include "indexer/feature_data.hpp"
 
+#include "std/function.hpp"
 #include "std/initializer_list.hpp"
 #include "std/map.hpp"
+#include "std/unique_ptr.hpp"
 #include "std/vector.hpp"
 
 namespace routing
@@ -149,6 +151,12 @@ public:
   virtual void FindClosestEdges(m2::PointD const & point, uint32_t count,
                                 vector<pair<Edge, m2::PointD>> & vicinities) const = 0;
 
+  /// Finds the closest edges for every point of the batch. Points of the batch are expected
+  /// to be close to each other, so implementations may load roads for the whole batch at once.
+  /// The default implementation calls FindClosestEdges for every point.
+  virtual void FindClosestEdgesBatch(vector<m2::PointD> const & points, uint32_t count,
+                                     vector<vector<pair<Edge, m2::PointD>>> & vicinities) const;
+
   /// @return Types for the specified feature
   virtual void GetFeatureTypes(FeatureID const & featureId, feature::TypesHolder & types) const = 0;
 
@@ -172,4 +180,6 @@ private:
   map<Junction, TEdgeVector> m_outgoingEdges;
 };
 
+using TRoadGraphFactory = function<unique_ptr<IRoadGraph>()>;
+
 }  // namespace routing
@@ -11,6 +11,7 @@
 
 #include "base/logging.hpp"
 
+#include "std/limits.hpp"
 #include "std/numeric.hpp"
 #include "std/utility.hpp"
 #include "std/algorithm.hpp"
@@ -22,6 +23,8 @@ namespace
 {
 double constexpr kLocationTimeThreshold = 60.0 * 1.0;
 double constexpr kOnEndToleranceM = 10.0;
+// Faster than any vehicle, the position can't move farther along the route between two fixes.
+double constexpr kMaxSpeedMPS = 100.0;
 
 }  //  namespace
 
@@ -209,22 +212,30 @@ void Route::GetCurrentDirectionPoint(m2::PointD & pt) const
 
 bool Route::MoveIterator(location::GpsInfo const & info) const
 {
+  double const radiusM = max(m_routingSettings.m_matchingThresholdM, info.m_horizontalAccuracy);
   double predictDistance = -1.0;
-  if (m_currentTime > 0.0 && info.HasSpeed())
+  // The whole rest of the route is checked for the first fix and after a long break.
+  double maxDistanceAheadM = numeric_limits<double>::max();
+  if (m_currentTime > 0.0)
   {
     /// @todo Need to distinguish GPS and WiFi locations.
     /// They may have different time metrics in case of incorrect system time on a device.
     double const deltaT = info.m_timestamp - m_currentTime;
     if (deltaT > 0.0 && deltaT < kLocationTimeThreshold)
-      predictDistance = info.m_speed * deltaT;
+    {
+      if (info.HasSpeed())
+        predictDistance = info.m_speed * deltaT;
+      maxDistanceAheadM = kMaxSpeedMPS * deltaT + 2 * radiusM;
+    }
   }
 
-  m2::RectD const rect = MercatorBounds::MetresToXY(
-        info.m_longitude, info.m_latitude,
-        max(m_routingSettings.m_matchingThresholdM, info.m_horizontalAccuracy));
-  FollowedPolyline::Iter const res = m_poly.UpdateProjectionByPrediction(rect, predictDistance);
+  m2::RectD const rect = MercatorBounds::MetresToXY(info.m_longitude, info.m_latitude, radiusM);
+  FollowedPolyline::Iter const res =
+      m_poly.UpdateProjectionByPrediction(rect, predictDistance, maxDistanceAheadM);
   if (m_simplifiedPoly.IsValid())
-    m_simplifiedPoly.UpdateProjectionByPrediction(rect, predictDistance);
+    m_simplifiedPoly.UpdateProjectionByPrediction(rect, predictDistance, maxDistanceAheadM);
+  if (res.IsValid())
+    m_currentTime = info.m_timestamp;
   return res.IsValid();
 }
 
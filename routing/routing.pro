@@ -16,10 +16,13 @@ SOURCES += \
     async_router.cpp \
     base/followed_polyline.cpp \
     car_model.cpp \
+    cross_mwm_overlay.cpp \
     cross_mwm_road_graph.cpp \
     cross_mwm_router.cpp \
     cross_routing_context.cpp \
     features_road_graph.cpp \
+    isochrone.cpp \
+    map_matcher.cpp \
     nearest_edge_finder.cpp \
     online_absent_fetcher.cpp \
     online_cross_fetcher.cpp \
@@ -46,19 +49,24 @@ SOURCES += \
     vehicle_model.cpp \
 
 HEADERS += \
+    alternative_routes_filters.hpp \
     async_router.hpp \
     base/astar_algorithm.hpp \
     base/followed_polyline.hpp \
     car_model.hpp \
+    cross_mwm_overlay.hpp \
     cross_mwm_road_graph.hpp \
     cross_mwm_router.hpp \
     cross_routing_context.hpp \
     directions_engine.hpp \
     features_road_graph.hpp \
+    isochrone.hpp \
+    map_matcher.hpp \
     nearest_edge_finder.hpp \
     online_absent_fetcher.hpp \
     online_cross_fetcher.hpp \
     osrm2feature_map.hpp \
+    osrm_alternative_routes.hpp \
     osrm_data_facade.hpp \
     osrm_engine.hpp \
     osrm_helpers.hpp \
@@ -2,8 +2,14 @@
 
 #include "routing/routing_integration_tests/routing_test_tools.hpp"
 
+#include "routing/alternative_routes_filters.hpp"
+#include "routing/isochrone.hpp"
+
 #include "../../indexer/mercator.hpp"
 
+#include "std/set.hpp"
+#include "std/utility.hpp"
+
 using namespace routing;
 
 namespace
@@ -247,4 +253,79 @@ namespace
 
     integration::TestRouteTime(route, 900.);
   }
+
+  /// @return Length of the segments of the second route which are segments of the first one.
+  double GetSharedLengthMeters(Route const & first, Route const & second)
+  {
+    vector<m2::PointD> const & firstPoints = first.GetPoly().GetPoints();
+    set<pair<m2::PointD, m2::PointD>> segments;
+    for (size_t i = 0; i + 1 < firstPoints.size(); ++i)
+      segments.emplace(firstPoints[i], firstPoints[i + 1]);
+
+    vector<m2::PointD> const & secondPoints = second.GetPoly().GetPoints();
+    double length = 0.;
+    for (size_t i = 0; i + 1 < secondPoints.size(); ++i)
+    {
+      if (segments.count(make_pair(secondPoints[i], secondPoints[i + 1])) != 0)
+        length += MercatorBounds::DistanceOnEarth(secondPoints[i], secondPoints[i + 1]);
+    }
+    return length;
+  }
+
+  UNIT_TEST(RussiaMoscowAlternativeRoutesTest)
+  {
+    AlternativeRoutesParams params;
+    vector<Route> routes;
+    IRouter::ResultCode const result = integration::CalculateAlternativeRoutes(
+        integration::GetOsrmComponents(), MercatorBounds::FromLatLon(55.7971, 37.53804), {0., 0.},
+        MercatorBounds::FromLatLon(55.8579, 37.40990), params, routes);
+    TEST_EQUAL(result, IRouter::NoError, ());
+    TEST(!routes.empty(), ());
+    TEST_LESS_OR_EQUAL(routes.size(), params.m_maxCount, ());
+
+    // There are several parallel roads between these points.
+    TEST_GREATER(routes.size(), 1, ());
+
+    double const shortestTime = routes.front().GetTotalTimeSec();
+    for (Route const & route : routes)
+    {
+      TEST(route.IsValid(), ());
+      // Weights are times, so the stretch is checked by the route time.
+      TEST_LESS_OR_EQUAL(route.GetTotalTimeSec(),
+                         shortestTime * (1. + params.m_maxStretch) + 1., ());
+    }
+
+    // Sharing is limited by weights, it's checked by lengths with a tolerance for the difference
+    // of speeds on shared and other roads.
+    double const shortestLength = routes.front().GetTotalDistanceMeters();
+    for (size_t i = 0; i < routes.size(); ++i)
+    {
+      for (size_t j = i + 1; j < routes.size(); ++j)
+      {
+        double const sharedLength = GetSharedLengthMeters(routes[i], routes[j]);
+        TEST_LESS(sharedLength, routes[j].GetTotalDistanceMeters(), (i, j));
+        TEST_LESS_OR_EQUAL(sharedLength, shortestLength * (params.m_maxSharing + 0.1), (i, j));
+      }
+    }
+  }
+
+  UNIT_TEST(RussiaMoscowIsochronesTest)
+  {
+    IsochroneParams params;
+    params.m_timeBudgetSec = 10 * 60;
+    vector<m2::PointD> const startPoints = {MercatorBounds::FromLatLon(55.7971, 37.53804),
+                                            MercatorBounds::FromLatLon(55.8579, 37.40990)};
+    vector<Isochrone> isochrones;
+    IRouter::ResultCode const result = integration::CalculateIsochrones(
+        integration::GetOsrmComponents(), startPoints, params, 2 /* threadsCount */, isochrones);
+    TEST_EQUAL(result, IRouter::NoError, ());
+    TEST_EQUAL(isochrones.size(), startPoints.size(), ());
+    for (Isochrone const & isochrone : isochrones)
+    {
+      TEST_GREATER(isochrone.m_hull.size(), 2, ());
+      TEST(!isochrone.m_segments.empty(), ());
+      for (ReachableSegment const & segment : isochrone.m_segments)
+        TEST_LESS_OR_EQUAL(segment.m_timeSec, params.m_timeBudgetSec, ());
+    }
+  }
 }  // namespace
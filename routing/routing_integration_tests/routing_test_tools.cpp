@@ -7,6 +7,7 @@
 #include "geometry/distance_on_sphere.hpp"
 #include "geometry/latlon.hpp"
 
+#include "routing/isochrone.hpp"
 #include "routing/online_absent_fetcher.hpp"
 #include "routing/online_cross_fetcher.hpp"
 #include "routing/road_graph_router.hpp"
@@ -204,6 +205,30 @@ namespace integration
     return TRouteResult(route, result);
   }
 
+  IRouter::ResultCode CalculateAlternativeRoutes(IRouterComponents const & routerComponents,
+                                                 m2::PointD const & startPoint,
+                                                 m2::PointD const & startDirection,
+                                                 m2::PointD const & finalPoint,
+                                                 AlternativeRoutesParams const & params,
+                                                 vector<Route> & routes)
+  {
+    RouterDelegate delegate;
+    OsrmRouter * router = dynamic_cast<OsrmRouter *>(routerComponents.GetRouter());
+    TEST(router, ());
+    return router->CalculateAlternativeRoutes(startPoint, startDirection, finalPoint, delegate,
+                                              params, routes);
+  }
+
+  IRouter::ResultCode CalculateIsochrones(IRouterComponents const & routerComponents,
+                                          vector<m2::PointD> const & startPoints,
+                                          IsochroneParams const & params, size_t threadsCount,
+                                          vector<Isochrone> & isochrones)
+  {
+    OsrmRouter * router = dynamic_cast<OsrmRouter *>(routerComponents.GetRouter());
+    TEST(router, ());
+    return router->CalculateIsochrones(startPoints, params, threadsCount, isochrones);
+  }
+
   void TestTurnCount(routing::Route const & route, uint32_t expectedTurnCount)
   {
     // We use -1 for ignoring the "ReachedYourDestination" turn record.
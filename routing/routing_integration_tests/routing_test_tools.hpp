@@ -60,6 +60,22 @@ namespace integration
                               m2::PointD const & startPoint, m2::PointD const & startDirection,
                               m2::PointD const & finalPoint);
 
+  /// Calculates routes by OsrmRouter::CalculateAlternativeRoutes.
+  /// routerComponents must be created by GetOsrmComponents.
+  IRouter::ResultCode CalculateAlternativeRoutes(IRouterComponents const & routerComponents,
+                                                 m2::PointD const & startPoint,
+                                                 m2::PointD const & startDirection,
+                                                 m2::PointD const & finalPoint,
+                                                 AlternativeRoutesParams const & params,
+                                                 vector<Route> & routes);
+
+  /// Calculates car isochrones by OsrmRouter::CalculateIsochrones.
+  /// routerComponents must be created by GetOsrmComponents.
+  IRouter::ResultCode CalculateIsochrones(IRouterComponents const & routerComponents,
+                                          vector<m2::PointD> const & startPoints,
+                                          IsochroneParams const & params, size_t threadsCount,
+                                          vector<Isochrone> & isochrones);
+
   void TestTurnCount(Route const & route, uint32_t expectedTurnCount);
 
   /// Testing route length.
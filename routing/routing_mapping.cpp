@@ -203,4 +203,15 @@ TRoutingMappingPtr RoutingIndexManager::GetMappingById(Index::MwmId const & id)
   return GetMappingByName(id.GetInfo()->GetCountryName());
 }
 
+Index::MwmId RoutingIndexManager::GetMwmIdByName(string const & mapName) const
+{
+  Index::MwmId const id = m_index.GetMwmIdByCountryFile(CountryFile(mapName));
+  if (!id.IsAlive() ||
+      !HasOptions(id.GetInfo()->GetLocalFile().GetFiles(), MapOptions::MapWithCarRouting))
+  {
+    return Index::MwmId();
+  }
+  return id;
+}
+
 }  // namespace routing
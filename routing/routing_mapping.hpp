@@ -108,6 +108,10 @@ public:
 
   TRoutingMappingPtr GetMappingById(Index::MwmId const & id);
 
+  /// Returns id of the mwm with car routing file without loading the mapping.
+  /// The id is not alive if there is no such mwm.
+  Index::MwmId GetMwmIdByName(string const & mapName) const;
+
   template <class TFunctor>
   void ForEachMapping(TFunctor toDo)
   {
@@ -0,0 +1,75 @@
+#include "testing/testing.hpp"
+
+#include "routing/alternative_routes_filters.hpp"
+
+using namespace routing;
+
+namespace
+{
+// Via path 0 -> 1 -> ... -> 6 with 10 weight units per segment.
+vector<PathData> MakePath()
+{
+  vector<PathData> path;
+  for (NodeID node = 0; node <= 6; ++node)
+  {
+    path.emplace_back(node, 0 /* name_id */, TurnInstruction::NoTurn,
+                      node == 0 ? 0 : 10 /* segment_duration */, TRAVEL_MODE_DEFAULT);
+  }
+  return path;
+}
+}  // namespace
+
+UNIT_TEST(AlternativeRoutes_LocalOptimality)
+{
+  AlternativeRoutesParams params;
+  params.m_localOptimality = 0.1;
+  int const kShortestWeight = 100;
+  vector<PathData> const path = MakePath();
+
+  // The window of 10 units before and after the via node 3 is 2 -> 3 -> 4.
+  vector<pair<NodeID, NodeID>> requests;
+  auto const shortcut = [&requests](NodeID from, NodeID to)
+  {
+    requests.emplace_back(from, to);
+    return 15;
+  };
+  TEST(!IsLocallyOptimal(params, path, 3 /* via */, kShortestWeight, shortcut), ());
+  TEST_EQUAL(requests, (vector<pair<NodeID, NodeID>>{{2, 4}}), ());
+
+  auto const noShortcut = [](NodeID, NodeID) { return 20; };
+  TEST(IsLocallyOptimal(params, path, 3 /* via */, kShortestWeight, noShortcut), ());
+
+  // The wider window 1 -> 5 has the shortcut too.
+  params.m_localOptimality = 0.2;
+  auto const wideShortcut = [](NodeID from, NodeID to) { return from == 1 && to == 5 ? 35 : 40; };
+  TEST(!IsLocallyOptimal(params, path, 3 /* via */, kShortestWeight, wideShortcut), ());
+
+  // The via node must be on the path.
+  TEST(!IsLocallyOptimal(params, path, 10 /* via */, kShortestWeight, noShortcut), ());
+}
+
+UNIT_TEST(AlternativeRoutes_Stretch)
+{
+  AlternativeRoutesParams params;
+  params.m_maxStretch = 0.15;
+  params.m_maxDetourStretch = 0.1;
+
+  TEST(PassesStretch(params, 105 /* weight */, 50 /* sharing */, 100 /* shortestWeight */), ());
+  TEST(!PassesStretch(params, 120 /* weight */, 0 /* sharing */, 100 /* shortestWeight */), ());
+  // The detour of 30 replaces 20 of the shortest route.
+  TEST(!PassesStretch(params, 110 /* weight */, 80 /* sharing */, 100 /* shortestWeight */), ());
+
+  // The T-test window doesn't change the detour bound.
+  params.m_localOptimality = 1.;
+  TEST(!PassesStretch(params, 110 /* weight */, 80 /* sharing */, 100 /* shortestWeight */), ());
+  params.m_maxDetourStretch = 0.6;
+  TEST(PassesStretch(params, 110 /* weight */, 80 /* sharing */, 100 /* shortestWeight */), ());
+}
+
+UNIT_TEST(AlternativeRoutes_Sharing)
+{
+  AlternativeRoutesParams params;
+  params.m_maxSharing = 0.75;
+  TEST(PassesSharing(params, 75 /* sharing */, 100 /* shortestWeight */), ());
+  TEST(!PassesSharing(params, 76 /* sharing */, 100 /* shortestWeight */), ());
+}
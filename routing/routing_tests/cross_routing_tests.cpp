@@ -1,5 +1,6 @@
 #include "testing/testing.hpp"
 
+#include "routing/cross_mwm_overlay.hpp"
 #include "routing/cross_mwm_road_graph.hpp"
 #include "routing/cross_mwm_router.hpp"
 #include "routing/cross_routing_context.hpp"
@@ -7,6 +8,10 @@
 #include "coding/reader.hpp"
 #include "coding/writer.hpp"
 
+#include "base/math.hpp"
+
+#include "std/algorithm.hpp"
+
 using namespace routing;
 
 namespace
@@ -143,4 +148,133 @@ UNIT_TEST(TestFindingByPoint)
   TEST_EQUAL(node.m_nodeId, 3, ());
   TEST(!newContext.FindIngoingNodeByPoint(p3, node), ());
 }
+
+void SaveAndLoadContext(routing::CrossRoutingContextWriter const & context,
+                        routing::CrossRoutingContextReader & newContext)
+{
+  vector<char> buffer;
+  MemWriter<vector<char> > writer(buffer);
+  context.Save(writer);
+  MemReader reader(buffer.data(), buffer.size());
+  newContext.Load(reader);
+}
+
+UNIT_TEST(TestCrossMwmOverlay)
+{
+  ms::LatLon const p1(1., 1.), p2(2., 2.);
+
+  // Map "a" goes to map "b" by the node 10 and takes back by the node 11.
+  routing::CrossRoutingContextWriter aContext;
+  aContext.AddIngoingNode(11, p2);
+  aContext.AddOutgoingNode(10, "b", p1);
+  aContext.ReserveAdjacencyMatrix();
+  aContext.SetAdjacencyCost(aContext.GetIngoingIterators().first,
+                            aContext.GetOutgoingIterators().first, 7);
+
+  // Map "b" goes to map "a" by the node 21 and to the absent map "c" by the node 22.
+  routing::CrossRoutingContextWriter bContext;
+  bContext.AddIngoingNode(20, p1);
+  bContext.AddOutgoingNode(21, "a", p2);
+  bContext.AddOutgoingNode(22, "c", p2);
+  bContext.ReserveAdjacencyMatrix();
+  bContext.SetAdjacencyCost(bContext.GetIngoingIterators().first,
+                            bContext.GetOutgoingIterators().first, 5);
+  bContext.SetAdjacencyCost(bContext.GetIngoingIterators().first,
+                            bContext.GetOutgoingIterators().first + 1, 3);
+
+  routing::CrossRoutingContextReader aReader, bReader;
+  SaveAndLoadContext(aContext, aReader);
+  SaveAndLoadContext(bContext, bReader);
+
+  routing::CrossMwmOverlayWriter overlayWriter;
+  overlayWriter.AddMwm("a", 1 /* timestamp */, aReader);
+  overlayWriter.AddMwm("b", 2 /* timestamp */, bReader);
+  routing::CrossMwmOverlayGraph builtOverlay;
+  overlayWriter.Build(builtOverlay);
+
+  vector<char> buffer;
+  MemWriter<vector<char> > writer(buffer);
+  builtOverlay.Save(writer);
+  MemReader reader(buffer.data(), buffer.size());
+  routing::CrossMwmOverlayGraph overlay;
+  overlay.Load(reader);
+
+  TEST_EQUAL(overlay.GetMwmCount(), 3, ());
+  TEST_EQUAL(overlay.GetVertexCount(), 3, ());
+  TEST_EQUAL(overlay.GetEdgeCount(), 3, ());
+  TOverlayMwmIndex const a = overlay.GetMwmIndex("a");
+  TOverlayMwmIndex const b = overlay.GetMwmIndex("b");
+  TEST_EQUAL(overlay.GetMwmName(a), "a", ());
+  TEST_EQUAL(overlay.GetMwmTimestamp(b), 2, ());
+  TEST_EQUAL(overlay.GetMwmIndex("d"), kInvalidOverlayMwmIndex, ());
+
+  TOverlayVertexIndex const aToB = overlay.FindVertexByIngoing(b, 20);
+  TEST_NOT_EQUAL(aToB, kInvalidOverlayVertexIndex, ());
+  TEST_EQUAL(overlay.FindVertexByOutgoing(a, 10, p1), aToB, ());
+  TEST_EQUAL(overlay.GetVertex(aToB).m_fromNode, 10, ());
+
+  TOverlayVertexIndex const bToA = overlay.FindVertexByIngoing(a, 11);
+  TEST_NOT_EQUAL(bToA, kInvalidOverlayVertexIndex, ());
+  TEST_EQUAL(overlay.FindVertexByIngoing(b, 21), kInvalidOverlayVertexIndex, ());
+
+  // The crossing to the absent map is kept with the outgoing point to be matched at routing time.
+  TOverlayMwmIndex const c = overlay.GetMwmIndex("c");
+  TEST_NOT_EQUAL(c, kInvalidOverlayMwmIndex, ());
+  TEST_EQUAL(overlay.GetMwmTimestamp(c), kAbsentOverlayMwmTimestamp, ());
+  TOverlayVertexIndex const bToC = overlay.FindVertexByOutgoing(b, 22, p2);
+  TEST_NOT_EQUAL(bToC, kInvalidOverlayVertexIndex, ());
+  TEST_EQUAL(overlay.GetVertex(bToC).m_toMwm, c, ());
+  TEST_EQUAL(overlay.GetVertex(bToC).m_toNode, kInvalidContextEdgeNodeId, ());
+  TEST(my::AlmostEqualAbs(overlay.GetVertex(bToC).m_point.lat, p2.lat, 1e-5), ());
+  TEST(my::AlmostEqualAbs(overlay.GetVertex(bToC).m_point.lon, p2.lon, 1e-5), ());
+
+  vector<OverlayEdge> edges;
+  overlay.ForEachOutgoingEdge(aToB, [&edges](OverlayEdge const & e) { edges.push_back(e); });
+  sort(edges.begin(), edges.end(), [](OverlayEdge const & l, OverlayEdge const & r)
+  {
+    return l.m_weight < r.m_weight;
+  });
+  TEST_EQUAL(edges.size(), 2, ());
+  TEST_EQUAL(edges[0].m_target, bToC, ());
+  TEST_EQUAL(edges[0].m_weight, 3, ());
+  TEST_EQUAL(edges[1].m_target, bToA, ());
+  TEST_EQUAL(edges[1].m_weight, 5, ());
+
+  edges.clear();
+  overlay.ForEachOutgoingEdge(bToA, [&edges](OverlayEdge const & e) { edges.push_back(e); });
+  TEST_EQUAL(edges.size(), 1, ());
+  TEST_EQUAL(edges[0].m_target, aToB, ());
+  TEST_EQUAL(edges[0].m_weight, 7, ());
+
+  edges.clear();
+  overlay.ForEachOutgoingEdge(bToC, [&edges](OverlayEdge const & e) { edges.push_back(e); });
+  TEST(edges.empty(), ("Edges through the absent map are unknown."));
+}
+
+UNIT_TEST(TestCrossMwmOverlayMwmVersions)
+{
+  ms::LatLon const p1(1., 1.);
+
+  // Map "a" goes to the map "b" which is absent in the overlay.
+  routing::CrossRoutingContextWriter aContext;
+  aContext.AddOutgoingNode(10, "b", p1);
+  aContext.ReserveAdjacencyMatrix();
+
+  routing::CrossRoutingContextReader aReader;
+  SaveAndLoadContext(aContext, aReader);
+
+  routing::CrossMwmOverlayWriter overlayWriter;
+  overlayWriter.AddMwm("a", 1 /* timestamp */, aReader);
+  routing::CrossMwmOverlayGraph overlay;
+  overlayWriter.Build(overlay);
+
+  TOverlayMwmIndex const a = overlay.GetMwmIndex("a");
+  TOverlayMwmIndex const b = overlay.GetMwmIndex("b");
+  TEST_NOT_EQUAL(b, kInvalidOverlayMwmIndex, ());
+
+  TEST(overlay.IsMwmUpToDate(a, 1 /* timestamp */), ());
+  TEST(!overlay.IsMwmUpToDate(a, 2 /* timestamp */), ("Mismatched mwm version."));
+  TEST(!overlay.IsMwmUpToDate(b, 1 /* timestamp */), ("Missing mwm data."));
+  TEST(!overlay.IsMwmUpToDate(b, kAbsentOverlayMwmTimestamp), ("Missing mwm data."));
+}
 }  // namespace
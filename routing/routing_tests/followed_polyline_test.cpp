@@ -1,9 +1,14 @@
+#include "testing/benchmark.hpp"
 #include "testing/testing.hpp"
 
 #include "routing/base/followed_polyline.hpp"
 
 #include "geometry/polyline2d.hpp"
 
+#include "base/timer.hpp"
+
+#include "std/cmath.hpp"
+
 namespace routing_test
 {
 using namespace routing;
@@ -11,6 +16,19 @@ using namespace routing;
 namespace
 {
   static const m2::PolylineD kTestDirectedPolyline({{0.0, 0.0}, {3.0, 0.0}, {5.0, 0.0}});
+
+  // Winding route which is long enough to be matched with the segments index.
+  m2::PolylineD MakeWindingPolyline(size_t pointsCount)
+  {
+    vector<m2::PointD> points;
+    points.reserve(pointsCount);
+    for (size_t i = 0; i < pointsCount; ++i)
+    {
+      double const x = i * 0.001;
+      points.emplace_back(x, 0.01 * sin(x * 10.0));
+    }
+    return m2::PolylineD(points);
+  }
 }  // namespace
 
 UNIT_TEST(FollowedPolylineInitializationFogTest)
@@ -116,4 +134,67 @@ UNIT_TEST(FollowedPolylineGetDistanceFromBeginM)
                                                           point);
   TEST_ALMOST_EQUAL_ULPS(distance, masterDistance, ());
 }
+
+UNIT_TEST(FollowedPolylineLongRouteProjectionTest)
+{
+  m2::PolylineD const testPolyline = MakeWindingPolyline(10000);
+  FollowedPolyline polyline(testPolyline.Begin(), testPolyline.End());
+  for (size_t i = 0; i + 1 < testPolyline.GetSize(); i += 7)
+  {
+    m2::PointD const pt = (testPolyline.GetPoint(i) + testPolyline.GetPoint(i + 1)) / 2;
+    auto const iter = polyline.UpdateProjection(MercatorBounds::RectByCenterXYAndSizeInMeters(pt, 20));
+    TEST(iter.IsValid(), (i));
+    TEST_EQUAL(iter.m_ind, i, ());
+    TEST_LESS(iter.m_pt.Length(pt), 1e-9, (iter.m_pt, pt));
+  }
+}
+
+UNIT_TEST(FollowedPolylineProjectionWindowTest)
+{
+  // The route goes forth and back along the same line.
+  vector<m2::PointD> points;
+  for (size_t i = 0; i <= 100; ++i)
+    points.emplace_back(i * 0.001, 0.0);
+  for (size_t i = 0; i <= 100; ++i)
+    points.emplace_back((100 - i) * 0.001, 0.0001);
+  FollowedPolyline polyline(points.begin(), points.end());
+
+  m2::RectD const posRect = MercatorBounds::RectByCenterXYAndSizeInMeters({0.0105, 0.0001}, 50);
+  auto iter = polyline.UpdateProjection(posRect, 2000.0 /* maxDistanceAheadM */);
+  TEST(iter.IsValid(), ());
+  TEST_EQUAL(iter.m_ind, 10, ());
+
+  FollowedPolyline unboundedPolyline(points.begin(), points.end());
+  iter = unboundedPolyline.UpdateProjection(posRect);
+  TEST(iter.IsValid(), ());
+  TEST_GREATER(iter.m_ind, 100, ());
+}
+
+BENCHMARK_TEST(FollowedPolylineGpsTrackReplay)
+{
+  size_t constexpr kPointsCount = 50000;
+  m2::PolylineD const testPolyline = MakeWindingPolyline(kPointsCount);
+  FollowedPolyline polyline(testPolyline.Begin(), testPolyline.End());
+
+  // Every GPS point is shifted from the route and is taken once, as in the real navigation,
+  // and the current position is moved by prediction, as in Route::MoveIterator().
+  my::Timer timer;
+  size_t prevIndex = polyline.GetCurrentIter().m_ind;
+  for (size_t i = 1; i < kPointsCount; ++i)
+  {
+    m2::PointD const pt = testPolyline.GetPoint(i) + m2::PointD(0.00003, 0.00003);
+    double const predictDistance =
+        MercatorBounds::DistanceOnEarth(testPolyline.GetPoint(i - 1), testPolyline.GetPoint(i));
+    auto const iter = polyline.UpdateProjectionByPrediction(
+        MercatorBounds::RectByCenterXYAndSizeInMeters(pt, 30), predictDistance);
+    TEST(iter.IsValid(), (i));
+
+    size_t const index = polyline.GetCurrentIter().m_ind;
+    TEST_EQUAL(index, iter.m_ind, (i));
+    TEST_GREATER_OR_EQUAL(index, prevIndex, (i));
+    prevIndex = index;
+  }
+  TEST_EQUAL(prevIndex, kPointsCount - 2, ("The current position must reach the last segment."));
+  LOG(LINFO, ("GPS points:", kPointsCount - 1, "replayed in", timer.ElapsedSeconds(), "seconds."));
+}
 }  // namespace routing_test
@@ -0,0 +1,100 @@
+#include "testing/testing.hpp"
+
+#include "routing/isochrone.hpp"
+#include "routing/routing_tests/road_graph_builder.hpp"
+
+#include "geometry/rect2d.hpp"
+
+namespace routing_test
+{
+using namespace routing;
+
+namespace
+{
+double constexpr kGridStep = 0.001;
+size_t constexpr kGridSize = 10;
+
+unique_ptr<IRoadGraph> MakeGridGraph()
+{
+  return unique_ptr<IRoadGraph>(new GridRoadGraph(kGridSize, kGridStep));
+}
+}  // namespace
+
+UNIT_TEST(MakeConvexHull_Smoke)
+{
+  vector<m2::PointD> points = {{0, 0}, {2, 0}, {1, 1}, {2, 2}, {0, 2}, {1, 0}, {0, 0}, {1, 2}};
+  vector<m2::PointD> hull;
+  MakeConvexHull(points, hull);
+  vector<m2::PointD> const expected = {{0, 0}, {2, 0}, {2, 2}, {0, 2}};
+  TEST_EQUAL(hull, expected, ());
+
+  points = {{1, 1}, {3, 3}};
+  MakeConvexHull(points, hull);
+  TEST_EQUAL(hull.size(), 2, ());
+}
+
+UNIT_TEST(PedestrianIsochrone_Grid)
+{
+  GridRoadGraph graph(kGridSize, kGridStep);
+  PedestrianIsochroneBuilder builder(graph);
+
+  // One grid step of 111 meters takes 80 seconds with the speed of 5 km/h,
+  // so junctions up to 2 steps away from the start are reachable.
+  IsochroneParams params;
+  params.m_timeBudgetSec = 200;
+  m2::PointD const start(5 * kGridStep, 5 * kGridStep);
+  Isochrone isochrone;
+  TEST(builder.Calculate(start, params, isochrone), ());
+
+  vector<m2::PointD> const expectedHull = {{3 * kGridStep, 5 * kGridStep},
+                                           {5 * kGridStep, 3 * kGridStep},
+                                           {7 * kGridStep, 5 * kGridStep},
+                                           {5 * kGridStep, 7 * kGridStep}};
+  TEST_EQUAL(isochrone.m_hull.size(), expectedHull.size(), (isochrone.m_hull));
+  for (size_t i = 0; i < expectedHull.size(); ++i)
+    TEST(isochrone.m_hull[i].EqualDxDy(expectedHull[i], 1e-9), (isochrone.m_hull));
+
+  // 4 segments from the start and 12 segments to the junctions 2 steps away.
+  TEST_EQUAL(isochrone.m_segments.size(), 16, ());
+  for (ReachableSegment const & segment : isochrone.m_segments)
+    TEST_LESS_OR_EQUAL(segment.m_timeSec, params.m_timeBudgetSec, ());
+
+  params.m_needSegments = false;
+  Isochrone hullOnly;
+  TEST(builder.Calculate(start, params, hullOnly), ());
+  TEST(hullOnly.m_segments.empty(), ());
+  TEST_EQUAL(hullOnly.m_hull, isochrone.m_hull, ());
+}
+
+UNIT_TEST(PedestrianIsochrone_Batch)
+{
+  IsochroneParams params;
+  params.m_timeBudgetSec = 300;
+
+  vector<m2::PointD> startPoints;
+  for (size_t i = 0; i < 16; ++i)
+    startPoints.emplace_back((i % 8 + 0.5) * kGridStep, (i / 2) * kGridStep);
+
+  unique_ptr<IRoadGraph> graph = MakeGridGraph();
+  PedestrianIsochroneBuilder builder(*graph);
+  vector<Isochrone> expected(startPoints.size());
+  for (size_t i = 0; i < startPoints.size(); ++i)
+    TEST(builder.Calculate(startPoints[i], params, expected[i]), (i));
+
+  vector<Isochrone> isochrones;
+  CalculatePedestrianIsochrones(startPoints, params, MakeGridGraph, 4 /* threadsCount */,
+                                isochrones);
+  TEST_EQUAL(isochrones.size(), expected.size(), ());
+  for (size_t i = 0; i < isochrones.size(); ++i)
+  {
+    TEST_EQUAL(isochrones[i].m_hull, expected[i].m_hull, (i));
+    TEST_EQUAL(isochrones[i].m_segments.size(), expected[i].m_segments.size(), (i));
+    for (size_t j = 0; j < isochrones[i].m_segments.size(); ++j)
+    {
+      TEST_EQUAL(isochrones[i].m_segments[j].m_featureId, expected[i].m_segments[j].m_featureId, ());
+      TEST_EQUAL(isochrones[i].m_segments[j].m_pointStart, expected[i].m_segments[j].m_pointStart,
+                 ());
+    }
+  }
+}
+}  // namespace routing_test
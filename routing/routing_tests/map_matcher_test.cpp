@@ -0,0 +1,154 @@
+#include "testing/benchmark.hpp"
+#include "testing/testing.hpp"
+
+#include "routing/map_matcher.hpp"
+#include "routing/routing_tests/road_graph_builder.hpp"
+
+#include "base/logging.hpp"
+#include "base/timer.hpp"
+
+#include "std/cstdlib.hpp"
+
+namespace routing_test
+{
+using namespace routing;
+
+namespace
+{
+double constexpr kGridStep = 0.001;
+
+// Points of a trace with 2 meters noise.
+void AddTracePoints(m2::PointD const & from, m2::PointD const & to, size_t count,
+                    vector<TracePoint> & trace)
+{
+  for (size_t i = 0; i < count; ++i)
+  {
+    double const noise = (i % 2 == 0 ? 1.0 : -1.0) * 0.00002;
+    m2::PointD const pt = from + (to - from) * (static_cast<double>(i) / count);
+    trace.emplace_back(pt + m2::PointD(noise, noise), 0.0 /* timestampSec */);
+  }
+}
+
+vector<TracePoint> MakeRandomWalkTrace(size_t gridSize, size_t segmentsCount)
+{
+  vector<TracePoint> trace;
+  m2::PointD pt((rand() % gridSize) * kGridStep, (rand() % gridSize) * kGridStep);
+  for (size_t i = 0; i < segmentsCount; ++i)
+  {
+    m2::PointD next = pt;
+    double & coord = (rand() % 2 == 0) ? next.x : next.y;
+    coord += (rand() % 2 == 0 ? kGridStep : -kGridStep);
+    if (coord < 0 || coord > (gridSize - 1) * kGridStep)
+      continue;
+    AddTracePoints(pt, next, 4, trace);
+    pt = next;
+  }
+  return trace;
+}
+}  // namespace
+
+UNIT_TEST(MapMatcher_StraightTrace)
+{
+  GridRoadGraph graph(10, kGridStep);
+  MapMatcher matcher(graph, MapMatcherParams());
+
+  vector<TracePoint> trace;
+  AddTracePoints({0.0005, 2 * kGridStep}, {0.0085, 2 * kGridStep}, 16, trace);
+
+  MatchingResult result;
+  TEST(matcher.Match(trace, result), ());
+  TEST_EQUAL(result.m_points.size(), trace.size(), ());
+  for (auto const & point : result.m_points)
+  {
+    TEST(point.IsMatched(), ());
+    TEST_EQUAL(point.m_featureId, MakeTestFeatureID(2), ());
+  }
+  TEST_EQUAL(result.m_routeParts.size(), 1, ());
+  for (Edge const & edge : result.m_routeParts.front())
+    TEST_EQUAL(edge.GetFeatureId(), MakeTestFeatureID(2), ());
+}
+
+UNIT_TEST(MapMatcher_TurnTrace)
+{
+  size_t constexpr kGridSize = 10;
+  GridRoadGraph graph(kGridSize, kGridStep);
+  MapMatcher matcher(graph, MapMatcherParams());
+
+  // Along the horizontal road 2 and then along the vertical road 5.
+  vector<TracePoint> trace;
+  AddTracePoints({0.0, 2 * kGridStep}, {5 * kGridStep, 2 * kGridStep}, 20, trace);
+  size_t const turnIndex = trace.size();
+  AddTracePoints({5 * kGridStep, 2 * kGridStep}, {5 * kGridStep, 7 * kGridStep}, 20, trace);
+
+  MatchingResult result;
+  TEST(matcher.Match(trace, result), ());
+  for (size_t i = 1; i + 1 < turnIndex; ++i)
+    TEST_EQUAL(result.m_points[i].m_featureId, MakeTestFeatureID(2), (i));
+  for (size_t i = turnIndex + 1; i < trace.size(); ++i)
+    TEST_EQUAL(result.m_points[i].m_featureId, MakeTestFeatureID(kGridSize + 5), (i));
+
+  TEST_EQUAL(result.m_routeParts.size(), 1, ());
+  IRoadGraph::TEdgeVector const & route = result.m_routeParts.front();
+  for (size_t i = 1; i < route.size(); ++i)
+    TEST_EQUAL(route[i - 1].GetEndJunction(), route[i].GetStartJunction(), (i));
+  TEST_GREATER(matcher.GetSearchCacheHits(), 0, ());
+}
+
+UNIT_TEST(MapMatcher_ParallelTraces)
+{
+  size_t constexpr kGridSize = 10;
+  srand(0);
+  vector<vector<TracePoint>> traces;
+  for (size_t i = 0; i < 16; ++i)
+    traces.push_back(MakeRandomWalkTrace(kGridSize, 10));
+
+  GridRoadGraph graph(kGridSize, kGridStep);
+  MapMatcher matcher(graph, MapMatcherParams());
+  vector<MatchingResult> expected(traces.size());
+  for (size_t i = 0; i < traces.size(); ++i)
+    matcher.Match(traces[i], expected[i]);
+
+  vector<MatchingResult> results;
+  MatchTraces(traces, []()
+              {
+                return unique_ptr<IRoadGraph>(new GridRoadGraph(kGridSize, kGridStep));
+              },
+              MapMatcherParams(), 4 /* threadsCount */, results);
+
+  TEST_EQUAL(results.size(), traces.size(), ());
+  for (size_t i = 0; i < traces.size(); ++i)
+  {
+    TEST_EQUAL(results[i].m_points.size(), expected[i].m_points.size(), ());
+    for (size_t j = 0; j < results[i].m_points.size(); ++j)
+    {
+      TEST_EQUAL(results[i].m_points[j].m_featureId, expected[i].m_points[j].m_featureId, ());
+      TEST_EQUAL(results[i].m_points[j].m_segId, expected[i].m_points[j].m_segId, ());
+    }
+    TEST_EQUAL(results[i].m_routeParts, expected[i].m_routeParts, ());
+  }
+}
+
+BENCHMARK_TEST(MapMatcherThroughput)
+{
+  size_t constexpr kGridSize = 20;
+  srand(0);
+  vector<vector<TracePoint>> traces;
+  size_t pointsCount = 0;
+  for (size_t i = 0; i < 64; ++i)
+  {
+    traces.push_back(MakeRandomWalkTrace(kGridSize, 50));
+    pointsCount += traces.back().size();
+  }
+
+  vector<MatchingResult> results;
+  my::Timer timer;
+  MatchTraces(traces, []()
+              {
+                return unique_ptr<IRoadGraph>(new GridRoadGraph(kGridSize, kGridStep));
+              },
+              MapMatcherParams(), 4 /* threadsCount */, results);
+  double const seconds = timer.ElapsedSeconds();
+  LOG(LINFO, ("Matched", pointsCount, "points in", seconds, "seconds,",
+              pointsCount / max(seconds, 1e-9), "points per second"));
+}
+}  // namespace routing_test
@@ -1,5 +1,7 @@
 #include "road_graph_builder.hpp"
 
+#include "routing/nearest_edge_finder.hpp"
+
 #include "indexer/mwm_set.hpp"
 
 #include "base/macros.hpp"
@@ -110,6 +112,37 @@ void RoadGraphMockSource::GetJunctionTypes(Junction const & junction, feature::T
   UNUSED_VALUE(types);
 }
 
+GridRoadGraph::GridRoadGraph(size_t size, double step)
+{
+  for (size_t vertical = 0; vertical < 2; ++vertical)
+  {
+    for (size_t k = 0; k < size; ++k)
+    {
+      IRoadGraph::RoadInfo ri;
+      for (size_t i = 0; i < size; ++i)
+      {
+        if (vertical)
+          ri.m_points.emplace_back(k * step, i * step);
+        else
+          ri.m_points.emplace_back(i * step, k * step);
+      }
+      ri.m_speedKMPH = 5.0;
+      ri.m_bidirectional = true;
+      m_roads.push_back(ri);
+      AddRoad(move(ri));
+    }
+  }
+}
+
+void GridRoadGraph::FindClosestEdges(m2::PointD const & point, uint32_t count,
+                                     vector<pair<Edge, m2::PointD>> & vicinities) const
+{
+  NearestEdgeFinder finder(point);
+  for (size_t i = 0; i < m_roads.size(); ++i)
+    finder.AddInformationSource(MakeTestFeatureID(i), m_roads[i]);
+  finder.MakeResult(vicinities, count);
+}
+
 FeatureID MakeTestFeatureID(uint32_t offset)
 {
   static TestValidFeatureIDProvider instance;
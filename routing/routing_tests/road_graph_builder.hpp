@@ -27,6 +27,22 @@ private:
   vector<RoadInfo> m_roads;
 };
 
+/// Grid of bidirectional roads with the speed 5 km/h. Road k < size is the horizontal road
+/// y = k * step, road size + k is the vertical road x = k * step.
+/// Unlike RoadGraphMockSource it finds the closest edges among all roads.
+class GridRoadGraph : public RoadGraphMockSource
+{
+public:
+  GridRoadGraph(size_t size, double step);
+
+  // routing::IRoadGraph overrides:
+  void FindClosestEdges(m2::PointD const & point, uint32_t count,
+                        vector<pair<routing::Edge, m2::PointD>> & vicinities) const override;
+
+private:
+  vector<RoadInfo> m_roads;
+};
+
 FeatureID MakeTestFeatureID(uint32_t offset);
 
 void InitRoadGraphMockSourceWithTest1(RoadGraphMockSource & graphMock);
@@ -22,6 +22,7 @@ static vector<turns::TurnItem> const kTestTurns({turns::TurnItem(1, turns::TurnD
 location::GpsInfo GetGps(double x, double y)
 {
   location::GpsInfo info;
+  info.m_timestamp = 0.0;
   info.m_latitude = MercatorBounds::YToLat(y);
   info.m_longitude = MercatorBounds::XToLon(x);
   info.m_horizontalAccuracy = 2;
@@ -157,3 +158,31 @@ UNIT_TEST(NextTurnsTest)
     TEST_EQUAL(turnsDist.size(), 1, ());
   }
 }
+
+UNIT_TEST(MoveIteratorLookAheadTest)
+{
+  // The route goes forth for about 110 km and back along the same line.
+  vector<m2::PointD> points;
+  for (size_t i = 0; i <= 1000; ++i)
+    points.emplace_back(i * 0.001, 0.0);
+  for (size_t i = 0; i <= 1000; ++i)
+    points.emplace_back((1000 - i) * 0.001, 0.0001);
+
+  // The second fix is closer to the way back, but it's too far along the route to get there
+  // in 20 seconds.
+  location::GpsInfo first = GetGps(0.0005, 0.0);
+  first.m_timestamp = 100.0;
+  location::GpsInfo second = GetGps(0.0105, 0.00007);
+  second.m_timestamp = 120.0;
+
+  Route route("TestRouter", points, "");
+  TEST(route.MoveIterator(first), ());
+  TEST(route.MoveIterator(second), ());
+  TEST_LESS(route.GetCurrentDistanceFromBeginMeters(), 2000.0, ());
+
+  // Without time the whole route is checked.
+  Route unboundedRoute("TestRouter", points, "");
+  second.m_timestamp = 0.0;
+  TEST(unboundedRoute.MoveIterator(second), ());
+  TEST_GREATER(unboundedRoute.GetCurrentDistanceFromBeginMeters(), 100000.0, ());
+}
@@ -8,6 +8,11 @@
 
 using std::atomic;
 using std::atomic_flag;
+using std::atomic_thread_fence;
+using std::memory_order_acquire;
+using std::memory_order_relaxed;
+using std::memory_order_release;
+using std::memory_order_seq_cst;
 
 #ifdef DEBUG_NEW
 #define new DEBUG_NEW
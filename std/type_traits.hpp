@@ -15,6 +15,7 @@ using std::is_integral;
 using std::is_pod;
 using std::is_same;
 using std::is_signed;
+using std::is_trivially_destructible;
 using std::is_unsigned;
 using std::make_signed;
 using std::make_unsigned;